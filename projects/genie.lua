@@ -674,12 +674,18 @@ if build_unit_tests then
 
 		files { "../src/unit_tests/**.h", "../src/unit_tests/**.cpp" }
 		includedirs { "../src", "../src/unit_tests", "../external/bgfx/include" }
+		if build_studio then
+			links { "editor" }
+		end
 		links { "animation", "renderer", "engine" }
 		if _OPTIONS["static-plugins"] then	
 			configuration { "vs*" }
 				links { "winmm", "psapi" }
 			configuration {} 
 				linkLib "bgfx"
+			configuration { "linux-*" }
+				links { "GL", "X11", "dl" }
+			configuration {}
 		end
 
 		useLua()
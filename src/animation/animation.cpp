@@ -1,8 +1,10 @@
 #include "animation/animation.h"
 #include "engine/blob.h"
+#include "engine/crc32.h"
 #include "engine/fs/file_system.h"
 #include "engine/log.h"
 #include "engine/matrix.h"
+#include "engine/mt/atomic.h"
 #include "engine/profiler.h"
 #include "engine/quat.h"
 #include "engine/resource_manager.h"
@@ -20,6 +22,7 @@ enum class Version
 	FIRST = 0,
 	COMPRESSION = 1,
 	ROOT_MOTION,
+	FLAGS,
 
 	LAST
 };
@@ -40,183 +43,327 @@ void AnimationManager::destroyResource(Resource& resource)
 }
 
 
+void AnimationManager::update()
+{
+	static const u32 BONE_REMAP_EVICTION_FRAMES = 300;
+
+	++m_frame;
+	if (m_frame % BONE_REMAP_EVICTION_FRAMES != 0) return;
+
+	PROFILE_FUNCTION();
+	for (Resource* resource : getResourceTable())
+	{
+		static_cast<Animation*>(resource)->evictBoneRemaps(m_frame - BONE_REMAP_EVICTION_FRAMES);
+	}
+}
+
+
 Animation::Animation(const Path& path, ResourceManagerBase& resource_manager, IAllocator& allocator)
 	: Resource(path, resource_manager, allocator)
 	, m_frame_count(0)
 	, m_fps(30)
 	, m_mem(allocator)
 	, m_bones(allocator)
+	, m_bone_remaps(allocator)
+	, m_bone_remaps_mutex(false)
 	, m_root_motion_bone_idx(-1)
 {
 }
 
 
-void Animation::getRelativePose(float time, Pose& pose, Model& model, float weight) const
+Animation::~Animation()
 {
-	PROFILE_FUNCTION();
-	ASSERT(!pose.is_absolute);
+	clearBoneRemaps();
+}
 
-	if (!model.isReady()) return;
+
+// returns the first key after frame, the sample is interpolated between this key and the previous one
+static int findKey(const u16* times, int count, int frame, int hint)
+{
+	static const int MAX_CURSOR_STEPS = 4;
+
+	if (hint > 0 && hint < count && times[hint - 1] <= frame)
+	{
+		for (int i = 0; i < MAX_CURSOR_STEPS; ++i)
+		{
+			if (hint == count - 1 || times[hint] > frame) return hint;
+			++hint;
+		}
+	}
+
+	int from = 1;
+	int to = count - 1;
+	while (from < to)
+	{
+		int mid = (from + to) >> 1;
+		if (times[mid] > frame)
+		{
+			to = mid;
+		}
+		else
+		{
+			from = mid + 1;
+		}
+	}
+	return from;
+}
+
+
+static void interpolate(const Vec3& a, const Vec3& b, Vec3* out, float t)
+{
+	lerp(a, b, out, t);
+}
+
+
+static void interpolate(const Quat& a, const Quat& b, Quat* out, float t)
+{
+	nlerp(a, b, out, t);
+}
+
+
+Vec3 Animation::Bone::getPosition(int key) const
+{
+	if (!quantized_pos) return pos[key];
+
+	const u16* q = quantized_pos + key * 3;
+	return Vec3(pos_min.x + q[0] * pos_scale.x, pos_min.y + q[1] * pos_scale.y, pos_min.z + q[2] * pos_scale.z);
+}
+
+
+Quat Animation::Bone::getRotation(int key) const
+{
+	if (!quantized_rot) return rot[key];
+
+	static const float SCALE = 1 / 32767.0f;
+	const i16* q = quantized_rot + key * 4;
+	Quat ret(q[0] * SCALE, q[1] * SCALE, q[2] * SCALE, q[3] * SCALE);
+	ret.normalize();
+	return ret;
+}
+
+
+template <typename T, typename F>
+static void sampleTrack(const u16* times, int count, F getKey, float time, int frame, float rcp_fps, int* key, T* out)
+{
+	if (count < 2)
+	{
+		*out = getKey(0);
+		return;
+	}
+
+	int idx = findKey(times, count, frame, *key);
+	*key = idx;
+	float t = float(time - times[idx - 1] * rcp_fps) / ((times[idx] - times[idx - 1]) * rcp_fps);
+	interpolate(getKey(idx - 1), getKey(idx), out, t);
+}
+
+
+template <bool IS_BLENDED>
+void Animation::samplePose(float time, Vec3* pos, Quat* rot, const int* bone_remap, float weight, AnimationCursor* cursor) const
+{
+	PROFILE_FUNCTION();
+	int bone_count = m_bones.size();
+	if (bone_count == 0) return;
 
 	int frame = (int)(time * m_fps);
 	float rcp_fps = 1.0f / m_fps;
 	frame = Math::clamp(frame, 0, m_frame_count);
-	Vec3* pos = pose.positions;
-	Quat* rot = pose.rotations;
+	const Bone* bones = &m_bones[0];
 
 	if (frame < m_frame_count)
 	{
-		for (Bone& bone : m_bones)
+		int tmp_keys[2] = {0, 0};
+		int* keys = tmp_keys;
+		if (cursor)
 		{
-			Model::BoneMap::iterator iter = model.getBoneIndex(bone.name);
-			if (!iter.isValid()) continue;
-
-			int idx = 1;
-			for (int c = bone.pos_count; idx < c; ++idx)
+			if (cursor->keys.size() != bone_count * 2)
 			{
-				if (bone.pos_times[idx] > frame) break;
+				cursor->keys.resize(bone_count * 2);
+				setMemory(&cursor->keys[0], 0, cursor->keys.size() * sizeof(cursor->keys[0]));
 			}
+			keys = &cursor->keys[0];
+		}
 
-			float t = float(time - bone.pos_times[idx - 1] * rcp_fps) /
-					  ((bone.pos_times[idx] - bone.pos_times[idx - 1]) * rcp_fps);
+		for (int i = 0; i < bone_count; ++i)
+		{
+			int model_bone_index = bone_remap ? bone_remap[i] : i;
+			if (model_bone_index < 0) continue;
 
-			int model_bone_index = iter.value();
+			const Bone& bone = bones[i];
+			int* bone_keys = cursor ? keys + i * 2 : keys;
 			Vec3 anim_pos;
-			lerp(bone.pos[idx - 1], bone.pos[idx], &anim_pos, t);
-			lerp(pos[model_bone_index], anim_pos, &pos[model_bone_index], weight);
-
-			idx = 1;
-			for (int c = bone.rot_count; idx < c; ++idx)
+			Quat anim_rot;
+			auto getPosition = [&bone](int key) { return bone.getPosition(key); };
+			auto getRotation = [&bone](int key) { return bone.getRotation(key); };
+			sampleTrack(bone.pos_times, bone.pos_count, getPosition, time, frame, rcp_fps, &bone_keys[0], &anim_pos);
+			sampleTrack(bone.rot_times, bone.rot_count, getRotation, time, frame, rcp_fps, &bone_keys[1], &anim_rot);
+			if (IS_BLENDED)
 			{
-				if (bone.rot_times[idx] > frame) break;
+				lerp(pos[model_bone_index], anim_pos, &pos[model_bone_index], weight);
+				nlerp(rot[model_bone_index], anim_rot, &rot[model_bone_index], weight);
+			}
+			else
+			{
+				pos[model_bone_index] = anim_pos;
+				rot[model_bone_index] = anim_rot;
 			}
-
-			t = float(time - bone.rot_times[idx - 1] * rcp_fps) /
-				((bone.rot_times[idx] - bone.rot_times[idx - 1]) * rcp_fps);
-
-			Quat anim_rot;
-			nlerp(bone.rot[idx - 1], bone.rot[idx], &anim_rot, t);
-			nlerp(rot[model_bone_index], anim_rot, &rot[model_bone_index], weight);
 		}
 	}
 	else
 	{
-		for (Bone& bone : m_bones)
+		for (int i = 0; i < bone_count; ++i)
 		{
-			Model::BoneMap::iterator iter = model.getBoneIndex(bone.name);
-			if (!iter.isValid()) continue;
+			int model_bone_index = bone_remap ? bone_remap[i] : i;
+			if (model_bone_index < 0) continue;
 
-			int model_bone_index = iter.value();
-			lerp(pos[model_bone_index], bone.pos[bone.pos_count - 1], &pos[model_bone_index], weight);
-			nlerp(rot[model_bone_index], bone.rot[bone.rot_count - 1], &rot[model_bone_index], weight);
+			const Bone& bone = bones[i];
+			Vec3 last_pos = bone.getPosition(bone.pos_count - 1);
+			Quat last_rot = bone.getRotation(bone.rot_count - 1);
+			if (IS_BLENDED)
+			{
+				lerp(pos[model_bone_index], last_pos, &pos[model_bone_index], weight);
+				nlerp(rot[model_bone_index], last_rot, &rot[model_bone_index], weight);
+			}
+			else
+			{
+				pos[model_bone_index] = last_pos;
+				rot[model_bone_index] = last_rot;
+			}
 		}
 	}
 }
 
 
-Transform Animation::getBoneTransform(float time, int bone_idx) const
+void Animation::getRelativePose(float time, Pose& pose, const int* bone_remap, float weight, AnimationCursor* cursor) const
 {
-	Transform ret;
-	int frame = (int)(time * m_fps);
-	float rcp_fps = 1.0f / m_fps;
-	frame = Math::clamp(frame, 0, m_frame_count);
+	ASSERT(!pose.is_absolute);
+	samplePose<true>(time, pose.positions, pose.rotations, bone_remap, weight, cursor);
+}
+
+
+void Animation::getRelativePose(float time, Pose& pose, const int* bone_remap, AnimationCursor* cursor) const
+{
+	ASSERT(!pose.is_absolute);
+	samplePose<false>(time, pose.positions, pose.rotations, bone_remap, 1, cursor);
+}
 
-	const Bone& bone = m_bones[bone_idx];
-	if (frame < m_frame_count)
-	{
-		int idx = 1;
-		for (int c = bone.pos_count; idx < c; ++idx)
-		{
-			if (bone.pos_times[idx] > frame) break;
-		}
 
-		float t = float(time - bone.pos_times[idx - 1] * rcp_fps) /
-			((bone.pos_times[idx] - bone.pos_times[idx - 1]) * rcp_fps);
-		lerp(bone.pos[idx - 1], bone.pos[idx], &ret.pos, t);
+void Animation::getRelativePose(float time, Pose& pose, Model& model, float weight, AnimationCursor* cursor) const
+{
+	if (!model.isReady()) return;
+
+	const int* bone_remap = getBoneRemap(model);
+	if (bone_remap) getRelativePose(time, pose, bone_remap, weight, cursor);
+}
 
-		idx = 1;
-		for (int c = bone.rot_count; idx < c; ++idx)
+
+void Animation::getRelativePose(float time, Pose& pose, Model& model, AnimationCursor* cursor) const
+{
+	if (!model.isReady()) return;
+
+	const int* bone_remap = getBoneRemap(model);
+	if (bone_remap) getRelativePose(time, pose, bone_remap, cursor);
+}
+
+
+void Animation::sampleBones(float time, Vec3* positions, Quat* rotations) const
+{
+	samplePose<false>(time, positions, rotations, nullptr, 1, nullptr);
+}
+
+
+const int* Animation::getBoneRemap(Model& model, int max_depth) const
+{
+	if (m_bones.empty()) return nullptr;
+
+	u32 skeleton_hash = model.getSkeletonHash();
+	u32 frame = static_cast<AnimationManager&>(m_resource_manager).getFrame();
+	MT::SpinLock lock(m_bone_remaps_mutex);
+	for (BoneRemap* remap : m_bone_remaps)
+	{
+		if (remap->skeleton_hash == skeleton_hash && remap->max_depth == max_depth)
 		{
-			if (bone.rot_times[idx] > frame) break;
+			remap->last_used_frame = frame;
+			return &remap->indices[0];
 		}
-
-		t = float(time - bone.rot_times[idx - 1] * rcp_fps) /
-			((bone.rot_times[idx] - bone.rot_times[idx - 1]) * rcp_fps);
-		nlerp(bone.rot[idx - 1], bone.rot[idx], &ret.rot, t);
 	}
-	else
+
+	BoneRemap* remap = LUMIX_NEW(getAllocator(), BoneRemap)(getAllocator());
+	remap->skeleton_hash = skeleton_hash;
+	remap->max_depth = max_depth;
+	remap->last_used_frame = frame;
+	remap->indices.resize(m_bones.size());
+	for (int i = 0, c = m_bones.size(); i < c; ++i)
 	{
-		ret.pos = bone.pos[bone.pos_count - 1];
-		ret.rot = bone.rot[bone.rot_count - 1];
+		Model::BoneMap::iterator iter = model.getBoneIndex(m_bones[i].name);
+		int bone = iter.isValid() ? iter.value() : -1;
+		if (bone >= 0 && max_depth > 0)
+		{
+			int depth = -1;
+			for (int j = bone; j >= 0; j = model.getBone(j).parent_idx) ++depth;
+			if (depth > max_depth) bone = -1;
+		}
+		remap->indices[i] = bone;
 	}
-	return ret;
+	m_bone_remaps.push(remap);
+	return &remap->indices[0];
 }
 
 
-int Animation::getBoneIndex(u32 name) const
+void Animation::evictBoneRemaps(u32 min_frame)
 {
-	for (int i = 0, c = m_bones.size(); i < c; ++i)
+	MT::SpinLock lock(m_bone_remaps_mutex);
+	for (int i = m_bone_remaps.size() - 1; i >= 0; --i)
 	{
-		if (m_bones[i].name == name) return i;
+		BoneRemap* remap = m_bone_remaps[i];
+		if (remap->last_used_frame >= min_frame) continue;
+
+		LUMIX_DELETE(getAllocator(), remap);
+		m_bone_remaps.eraseFast(i);
 	}
-	return -1;
 }
 
 
-void Animation::getRelativePose(float time, Pose& pose, Model& model) const
+void Animation::clearBoneRemaps()
 {
-	PROFILE_FUNCTION();
-	ASSERT(!pose.is_absolute);
+	MT::SpinLock lock(m_bone_remaps_mutex);
+	for (BoneRemap* remap : m_bone_remaps) LUMIX_DELETE(getAllocator(), remap);
+	m_bone_remaps.clear();
+}
 
-	if (!model.isReady()) return;
 
+Transform Animation::getBoneTransform(float time, int bone_idx) const
+{
+	Transform ret;
 	int frame = (int)(time * m_fps);
 	float rcp_fps = 1.0f / m_fps;
 	frame = Math::clamp(frame, 0, m_frame_count);
-	Vec3* pos = pose.positions;
-	Quat* rot = pose.rotations;
 
+	const Bone& bone = m_bones[bone_idx];
 	if (frame < m_frame_count)
 	{
-		for (Bone& bone : m_bones)
-		{
-			Model::BoneMap::iterator iter = model.getBoneIndex(bone.name);
-			if (!iter.isValid()) continue;
-
-			int idx = 1;
-			for (int c = bone.pos_count; idx < c; ++idx)
-			{
-				if (bone.pos_times[idx] > frame) break;
-			}
-
-			float t = float(time - bone.pos_times[idx - 1] * rcp_fps) /
-				((bone.pos_times[idx] - bone.pos_times[idx - 1]) * rcp_fps);
-			int model_bone_index = iter.value();
-			lerp(bone.pos[idx - 1], bone.pos[idx], &pos[model_bone_index], t);
-
-			idx = 1;
-			for (int c = bone.rot_count; idx < c; ++idx)
-			{
-				if (bone.rot_times[idx] > frame) break;
-			}
-
-			t = float(time - bone.rot_times[idx - 1] * rcp_fps) /
-				((bone.rot_times[idx] - bone.rot_times[idx - 1]) * rcp_fps);
-			nlerp(bone.rot[idx - 1], bone.rot[idx], &rot[model_bone_index], t);
-		}
+		int keys[2] = {0, 0};
+		auto getPosition = [&bone](int key) { return bone.getPosition(key); };
+		auto getRotation = [&bone](int key) { return bone.getRotation(key); };
+		sampleTrack(bone.pos_times, bone.pos_count, getPosition, time, frame, rcp_fps, &keys[0], &ret.pos);
+		sampleTrack(bone.rot_times, bone.rot_count, getRotation, time, frame, rcp_fps, &keys[1], &ret.rot);
 	}
 	else
 	{
-		for (Bone& bone : m_bones)
-		{
-			Model::BoneMap::iterator iter = model.getBoneIndex(bone.name);
-			if (!iter.isValid()) continue;
+		ret.pos = bone.getPosition(bone.pos_count - 1);
+		ret.rot = bone.getRotation(bone.rot_count - 1);
+	}
+	return ret;
+}
 
-			int model_bone_index = iter.value();
-			pos[model_bone_index] = bone.pos[bone.pos_count - 1];
-			rot[model_bone_index] = bone.rot[bone.rot_count - 1];
-		}
+
+int Animation::getBoneIndex(u32 name) const
+{
+	for (int i = 0, c = m_bones.size(); i < c; ++i)
+	{
+		if (m_bones[i].name == name) return i;
 	}
+	return -1;
 }
 
 
@@ -246,6 +393,9 @@ bool Animation::load(FS::IFile& file)
 	{
 		m_root_motion_bone_idx = -1;
 	}
+	u32 flags = 0;
+	if (header.version > (int)Version::FLAGS) file.read(&flags, sizeof(flags));
+	bool is_quantized = (flags & QUANTIZED_KEYS) != 0;
 	m_fps = header.fps;
 	file.read(&m_frame_count, sizeof(m_frame_count));
 	int bone_count;
@@ -259,15 +409,37 @@ bool Animation::load(FS::IFile& file)
 	InputBlob blob(&m_mem[0], size);
 	for (int i = 0; i < m_bones.size(); ++i)
 	{
-		m_bones[i].name = blob.read<u32>();
-
-		m_bones[i].pos_count = blob.read<int>();
-		m_bones[i].pos_times = (const u16*)blob.skip(m_bones[i].pos_count * sizeof(u16));
-		m_bones[i].pos = (const Vec3*)blob.skip(m_bones[i].pos_count * sizeof(Vec3));;
-		
-		m_bones[i].rot_count = blob.read<int>();
-		m_bones[i].rot_times = (const u16*)blob.skip(m_bones[i].rot_count * sizeof(u16));;
-		m_bones[i].rot = (const Quat*)blob.skip(m_bones[i].rot_count * sizeof(Quat));;
+		Bone& bone = m_bones[i];
+		bone.name = blob.read<u32>();
+		bone.pos = nullptr;
+		bone.rot = nullptr;
+		bone.quantized_pos = nullptr;
+		bone.quantized_rot = nullptr;
+
+		bone.pos_count = blob.read<int>();
+		bone.pos_times = (const u16*)blob.skip(bone.pos_count * sizeof(u16));
+		if (is_quantized)
+		{
+			bone.pos_min = blob.read<Vec3>();
+			Vec3 extent = blob.read<Vec3>();
+			bone.pos_scale = extent * (1 / 65535.0f);
+			bone.quantized_pos = (const u16*)blob.skip(bone.pos_count * 3 * sizeof(u16));
+		}
+		else
+		{
+			bone.pos = (const Vec3*)blob.skip(bone.pos_count * sizeof(Vec3));
+		}
+
+		bone.rot_count = blob.read<int>();
+		bone.rot_times = (const u16*)blob.skip(bone.rot_count * sizeof(u16));
+		if (is_quantized)
+		{
+			bone.quantized_rot = (const i16*)blob.skip(bone.rot_count * 4 * sizeof(i16));
+		}
+		else
+		{
+			bone.rot = (const Quat*)blob.skip(bone.rot_count * sizeof(Quat));
+		}
 	}
 
 	m_size = file.size();
@@ -275,7 +447,157 @@ bool Animation::load(FS::IFile& file)
 }
 
 
-IAllocator& Animation::getAllocator()
+AnimationPoseCache::AnimationPoseCache(IAllocator& allocator)
+	: m_allocator(allocator)
+	, m_mutex(false)
+	, m_samples(allocator)
+	, m_blocks(allocator)
+	, m_block_idx(0)
+	, m_block_pos(0)
+	, m_time_step(1 / 60.0f)
+	, m_hit_count(0)
+	, m_miss_count(0)
+	, m_last_hit_count(0)
+	, m_last_miss_count(0)
+{
+}
+
+
+AnimationPoseCache::~AnimationPoseCache()
+{
+	for (Block& block : m_blocks) m_allocator.deallocate(block.data);
+}
+
+
+void AnimationPoseCache::clear()
+{
+	m_last_hit_count = m_hit_count;
+	m_last_miss_count = m_miss_count;
+	PROFILE_INT("pose cache hits", m_last_hit_count);
+	PROFILE_INT("pose cache misses", m_last_miss_count);
+	m_hit_count = 0;
+	m_miss_count = 0;
+	m_samples.clear();
+	m_block_idx = 0;
+	m_block_pos = 0;
+}
+
+
+u8* AnimationPoseCache::allocate(int size)
+{
+	static const int BLOCK_SIZE = 64 * 1024;
+
+	while (m_block_idx < m_blocks.size())
+	{
+		Block& block = m_blocks[m_block_idx];
+		if (m_block_pos + size <= block.size)
+		{
+			u8* mem = block.data + m_block_pos;
+			m_block_pos += size;
+			return mem;
+		}
+		++m_block_idx;
+		m_block_pos = 0;
+	}
+
+	Block& block = m_blocks.emplace();
+	block.size = Math::maximum(BLOCK_SIZE, size);
+	block.data = (u8*)m_allocator.allocate(block.size);
+	m_block_pos = size;
+	return block.data;
+}
+
+
+// samples are returned by value, the hash map can grow in another job while the sample is used
+bool AnimationPoseCache::getSample(const Animation& animation, float time, Sample* sample)
+{
+	int quantized_time = int(time / m_time_step + 0.5f);
+	const Animation* animation_ptr = &animation;
+	u64 key = ((u64)crc32(&animation_ptr, sizeof(animation_ptr)) << 32) | (u32)quantized_time;
+	int bone_count = animation.getBoneCount();
+
+	{
+		MT::SpinLock lock(m_mutex);
+		auto iter = m_samples.find(key);
+		if (iter.isValid())
+		{
+			*sample = iter.value();
+			if (sample->animation != &animation) return false;
+			MT::atomicIncrement(&m_hit_count);
+			return true;
+		}
+		u8* mem = allocate(bone_count * (sizeof(Vec3) + sizeof(Quat)));
+		sample->animation = &animation;
+		sample->positions = (Vec3*)mem;
+		sample->rotations = (Quat*)(mem + bone_count * sizeof(Vec3));
+	}
+
+	MT::atomicIncrement(&m_miss_count);
+	animation.sampleBones(quantized_time * m_time_step, sample->positions, sample->rotations);
+
+	MT::SpinLock lock(m_mutex);
+	if (!m_samples.find(key).isValid()) m_samples.insert(key, *sample);
+	return true;
+}
+
+
+template <bool IS_BLENDED>
+void AnimationPoseCache::apply(const Animation& animation,
+	float time,
+	Pose& pose,
+	const int* bone_remap,
+	float weight)
+{
+	ASSERT(!pose.is_absolute);
+	Sample sample;
+	if (!getSample(animation, time, &sample))
+	{
+		if (IS_BLENDED) animation.getRelativePose(time, pose, bone_remap, weight);
+		else animation.getRelativePose(time, pose, bone_remap);
+		return;
+	}
+
+	Vec3* pos = pose.positions;
+	Quat* rot = pose.rotations;
+	for (int i = 0, c = animation.getBoneCount(); i < c; ++i)
+	{
+		int model_bone_index = bone_remap[i];
+		if (model_bone_index < 0) continue;
+
+		if (IS_BLENDED)
+		{
+			lerp(pos[model_bone_index], sample.positions[i], &pos[model_bone_index], weight);
+			nlerp(rot[model_bone_index], sample.rotations[i], &rot[model_bone_index], weight);
+		}
+		else
+		{
+			pos[model_bone_index] = sample.positions[i];
+			rot[model_bone_index] = sample.rotations[i];
+		}
+	}
+}
+
+
+void AnimationPoseCache::getRelativePose(const Animation& animation,
+	float time,
+	Pose& pose,
+	const int* bone_remap)
+{
+	apply<false>(animation, time, pose, bone_remap, 1);
+}
+
+
+void AnimationPoseCache::getRelativePose(const Animation& animation,
+	float time,
+	Pose& pose,
+	const int* bone_remap,
+	float weight)
+{
+	apply<true>(animation, time, pose, bone_remap, weight);
+}
+
+
+IAllocator& Animation::getAllocator() const
 {
 	return static_cast<AnimationManager&>(m_resource_manager).getAllocator();
 }
@@ -283,6 +605,7 @@ IAllocator& Animation::getAllocator()
 
 void Animation::unload(void)
 {
+	clearBoneRemaps();
 	m_bones.clear();
 	m_mem.clear();
 	m_frame_count = 0;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "engine/array.h"
+#include "engine/hash_map.h"
 #include "engine/matrix.h"
+#include "engine/mt/sync.h"
 #include "engine/resource.h"
 #include "engine/resource_manager_base.h"
 
@@ -25,9 +28,13 @@ public:
 	explicit AnimationManager(IAllocator& allocator)
 		: ResourceManagerBase(allocator)
 		, m_allocator(allocator)
+		, m_frame(0)
 	{}
 	~AnimationManager() {}
 	IAllocator& getAllocator() { return m_allocator; }
+	u32 getFrame() const { return m_frame; }
+	// called once per frame from the main thread, while no animation is sampled
+	void update();
 
 protected:
 	Resource* createResource(const Path& path) override;
@@ -35,6 +42,81 @@ protected:
 
 private:
 	IAllocator& m_allocator;
+	u32 m_frame;
+};
+
+
+class Animation;
+
+
+// keyframes used by the last sample of an animation instance, the next sample starts searching from them
+struct AnimationCursor
+{
+	explicit AnimationCursor(IAllocator& allocator)
+		: keys(allocator)
+	{
+	}
+
+	Array<int> keys;
+};
+
+
+// Per-frame cache of sampled animations. Instances playing the same animation at the same time,
+// quantized to the time step, share one sampling. Safe to use from multiple jobs.
+class AnimationPoseCache
+{
+public:
+	explicit AnimationPoseCache(IAllocator& allocator);
+	~AnimationPoseCache();
+
+	// discards samples of the previous frame
+	void clear();
+	void setTimeStep(float step) { m_time_step = step; }
+	float getTimeStep() const { return m_time_step; }
+	void getRelativePose(const Animation& animation,
+		float time,
+		Pose& pose,
+		const int* bone_remap);
+	void getRelativePose(const Animation& animation,
+		float time,
+		Pose& pose,
+		const int* bone_remap,
+		float weight);
+	// counts of the last cleared frame
+	int getHitCount() const { return m_last_hit_count; }
+	int getMissCount() const { return m_last_miss_count; }
+
+private:
+	struct Sample
+	{
+		const Animation* animation;
+		Vec3* positions;
+		Quat* rotations;
+	};
+
+	struct Block
+	{
+		u8* data;
+		int size;
+	};
+
+	template <bool IS_BLENDED>
+	void apply(const Animation& animation, float time, Pose& pose, const int* bone_remap, float weight);
+	bool getSample(const Animation& animation, float time, Sample* sample);
+	u8* allocate(int size);
+
+private:
+	IAllocator& m_allocator;
+	MT::SpinMutex m_mutex;
+	HashMap<u64, Sample> m_samples;
+	Array<Block> m_blocks;
+	int m_block_idx;
+	int m_block_pos;
+	float m_time_step;
+	volatile i32 m_hit_count;
+	volatile i32 m_miss_count;
+	int m_last_hit_count;
+	int m_last_miss_count;
 };
 
 
@@ -43,6 +125,12 @@ class Animation LUMIX_FINAL : public Resource
 	public:
 		static const u32 HEADER_MAGIC = 0x5f4c4146; // '_LAF'
 
+		enum Flags : u32
+		{
+			// positions are stored as 3 x u16 in the range of the bone, rotations as 4 x i16
+			QUANTIZED_KEYS = 1 << 0
+		};
+
 	public:
 		struct Header
 		{
@@ -53,19 +141,50 @@ class Animation LUMIX_FINAL : public Resource
 
 	public:
 		Animation(const Path& path, ResourceManagerBase& resource_manager, IAllocator& allocator);
+		~Animation();
 
 		int getRootMotionBoneIdx() const { return m_root_motion_bone_idx; }
 		Transform getBoneTransform(float time, int bone_idx) const;
-		void getRelativePose(float time, Pose& pose, Model& model) const;
-		void getRelativePose(float time, Pose& pose, Model& model, float weight) const;
+		void getRelativePose(float time, Pose& pose, Model& model, AnimationCursor* cursor = nullptr) const;
+		void getRelativePose(float time, Pose& pose, Model& model, float weight, AnimationCursor* cursor = nullptr) const;
+		void getRelativePose(float time, Pose& pose, const int* bone_remap, AnimationCursor* cursor = nullptr) const;
+		void getRelativePose(float time,
+			Pose& pose,
+			const int* bone_remap,
+			float weight,
+			AnimationCursor* cursor = nullptr) const;
+		// model bone index for each bone of the animation, -1 for bones missing in the model and, if max_depth > 0,
+		// for bones deeper than max_depth in the model's hierarchy; built once for each skeleton and depth
+		// and valid until the end of the frame
+		const int* getBoneRemap(Model& model, int max_depth = 0) const;
+		// drops remaps not used since min_frame, e.g. remaps of unloaded or reimported models
+		void evictBoneRemaps(u32 min_frame);
 		int getFrameCount() const { return m_frame_count; }
 		float getLength() const { return m_frame_count / (float)m_fps; }
 		int getFPS() const { return m_fps; }
 		int getBoneCount() const { return m_bones.size(); }
 		int getBoneIndex(u32 name) const;
+		// samples every bone of the animation, outputs are indexed by animation bone, not by model bone
+		void sampleBones(float time, Vec3* positions, Quat* rotations) const;
 
 	private:
-		IAllocator& getAllocator();
+		struct BoneRemap
+		{
+			explicit BoneRemap(IAllocator& allocator)
+				: indices(allocator)
+			{
+			}
+
+			u32 skeleton_hash;
+			int max_depth;
+			u32 last_used_frame;
+			Array<int> indices;
+		};
+
+		IAllocator& getAllocator() const;
+		template <bool IS_BLENDED>
+		void samplePose(float time, Vec3* pos, Quat* rot, const int* bone_remap, float weight, AnimationCursor* cursor) const;
+		void clearBoneRemaps();
 
 		void unload() override;
 		bool load(FS::IFile& file) override;
@@ -74,6 +193,9 @@ class Animation LUMIX_FINAL : public Resource
 		int	m_frame_count;
 		struct Bone
 		{
+			Vec3 getPosition(int key) const;
+			Quat getRotation(int key) const;
+
 			u32 name;
 			int pos_count;
 			const u16* pos_times;
@@ -81,9 +203,16 @@ class Animation LUMIX_FINAL : public Resource
 			int rot_count;
 			const u16* rot_times;
 			const Quat* rot;
+			// used instead of pos and rot in animations with QUANTIZED_KEYS
+			const u16* quantized_pos;
+			const i16* quantized_rot;
+			Vec3 pos_min;
+			Vec3 pos_scale;
 		};
 		Array<Bone> m_bones;
 		Array<u8> m_mem;
+		mutable Array<BoneRemap*> m_bone_remaps;
+		mutable MT::SpinMutex m_bone_remaps_mutex;
 		int m_fps;
 		int m_root_motion_bone_idx;
 };
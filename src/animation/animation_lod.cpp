@@ -0,0 +1,82 @@
+#include "animation/animation_lod.h"
+#include "engine/math_utils.h"
+#include "engine/quat.h"
+#include "engine/string.h"
+
+
+namespace Lumix
+{
+
+
+AnimationLODTier getAnimationLODTier(const Vec3& center,
+	float radius,
+	const AnimationLODView& view,
+	float reduced_screen_size,
+	float frozen_screen_size)
+{
+	if (!view.frustum.isSphereInside(center, radius)) return AnimationLODTier::FROZEN;
+
+	float screen_size = radius * view.size_scale;
+	if (!view.is_ortho)
+	{
+		float distance = (center - view.position).length();
+		if (distance <= radius) return AnimationLODTier::FULL;
+		screen_size /= distance;
+	}
+	if (screen_size < frozen_screen_size) return AnimationLODTier::FROZEN;
+	if (screen_size < reduced_screen_size) return AnimationLODTier::REDUCED;
+	return AnimationLODTier::FULL;
+}
+
+
+static void copyPose(const Pose& src, Pose& dst)
+{
+	if (dst.count != src.count) dst.resize(src.count);
+	copyMemory(dst.positions, src.positions, sizeof(src.positions[0]) * src.count);
+	copyMemory(dst.rotations, src.rotations, sizeof(src.rotations[0]) * src.count);
+	dst.is_absolute = src.is_absolute;
+}
+
+
+void AnimationLODState::setTier(AnimationLODTier new_tier, int phase)
+{
+	if (new_tier == tier) return;
+
+	tier = new_tier;
+	has_poses = false;
+	frames_to_update = 1 + phase % interval;
+	if (tier == AnimationLODTier::FROZEN) accumulated_time = 0;
+}
+
+
+bool AnimationLODState::isUpdateFrame()
+{
+	if (has_poses && --frames_to_update > 0)
+	{
+		++frames_since_update;
+		return false;
+	}
+	if (has_poses) frames_to_update = interval;
+	frames_since_update = 0;
+	return true;
+}
+
+
+void AnimationLODState::storePose(const Pose& pose)
+{
+	copyPose(has_poses ? next : pose, prev);
+	copyPose(pose, next);
+	has_poses = true;
+}
+
+
+void AnimationLODState::interpolatePose(Pose& pose)
+{
+	if (!has_poses || next.count != pose.count) return;
+	float t = Math::minimum(1.0f, (frames_since_update + 1) / (float)interval);
+	copyPose(prev, pose);
+	pose.blend(next, t);
+}
+
+
+} // namespace Lumix
@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include "engine/geometry.h"
+#include "engine/vec.h"
+#include "renderer/pose.h"
+
+
+namespace Lumix
+{
+
+
+enum class AnimationLODTier : u8
+{
+	FULL,
+	REDUCED,
+	FROZEN
+};
+
+
+struct AnimationLODView
+{
+	Frustum frustum;
+	Vec3 position;
+	// screen size = radius * size_scale / distance in perspective, radius * size_scale in ortho
+	float size_scale;
+	bool is_ortho;
+};
+
+
+// tier of an instance with the bounding sphere center, radius; instances outside of the view are frozen
+AnimationLODTier getAnimationLODTier(const Vec3& center,
+	float radius,
+	const AnimationLODView& view,
+	float reduced_screen_size,
+	float frozen_screen_size);
+
+
+// in the reduced tier the pose is evaluated every interval frames,
+// frames in between interpolate between the last two evaluated poses
+struct AnimationLODState
+{
+	explicit AnimationLODState(IAllocator& allocator)
+		: prev(allocator)
+		, next(allocator)
+	{
+	}
+
+	// phase spreads updates of instances entering the reduced tier together over the interval
+	void setTier(AnimationLODTier new_tier, int phase);
+	// returns true if the reduced tier evaluates a new pose in this frame
+	bool isUpdateFrame();
+	void storePose(const Pose& pose);
+	void interpolatePose(Pose& pose);
+
+	AnimationLODTier tier = AnimationLODTier::FULL;
+	int interval = 1;
+	int bone_depth = 0;
+	int frames_to_update = 0;
+	int frames_since_update = 0;
+	float accumulated_time = 0;
+	bool has_poses = false;
+	Pose prev;
+	Pose next;
+};
+
+
+} // namespace Lumix
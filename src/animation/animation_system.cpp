@@ -1,6 +1,7 @@
 #include "animation_system.h"
 
 #include "animation/animation.h"
+#include "animation/animation_lod.h"
 #include "animation/controller.h"
 #include "animation/events.h"
 #include "engine/base_proxy_allocator.h"
@@ -9,6 +10,9 @@
 #include "engine/engine.h"
 #include "engine/json_serializer.h"
 #include "engine/lua_wrapper.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/group.h"
+#include "engine/mtjd/manager.h"
 #include "engine/profiler.h"
 #include "engine/property_descriptor.h"
 #include "engine/property_register.h"
@@ -20,6 +24,7 @@
 #include "renderer/render_scene.h"
 #include <cfloat>
 #include <cmath>
+#include <cstdlib>
 
 
 namespace Lumix
@@ -29,6 +34,7 @@ namespace Lumix
 enum class AnimationSceneVersion
 {
 	SHARED_CONTROLLER,
+	LOD,
 
 	LATEST
 };
@@ -37,6 +43,7 @@ enum class AnimationSceneVersion
 static const ComponentType ANIMABLE_TYPE = PropertyRegister::getComponentType("animable");
 static const ComponentType CONTROLLER_TYPE = PropertyRegister::getComponentType("anim_controller");
 static const ComponentType SHARED_CONTROLLER_TYPE = PropertyRegister::getComponentType("shared_anim_controller");
+static const ComponentType LOD_TYPE = PropertyRegister::getComponentType("anim_lod");
 static const ResourceType ANIMATION_TYPE("animation");
 static const ResourceType CONTROLLER_RESOURCE_TYPE("anim_controller");
 
@@ -111,6 +118,7 @@ struct AnimationSystemImpl LUMIX_FINAL : public IPlugin
 	void createScenes(Universe& ctx) override;
 	void destroyScene(IScene* scene) override;
 	const char* getName() const override { return "animation"; }
+	void update(float) override { m_animation_manager.update(); }
 
 	IAllocator& m_allocator;
 	Engine& m_engine;
@@ -134,9 +142,41 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		Entity parent;
 	};
 
+	struct SharedControllerOrder
+	{
+		int parent;
+		int index;
+	};
+
+
+	struct EvictionCandidate
+	{
+		Anim::ControllerResource* resource;
+		int entry;
+		u32 last_used_frame;
+	};
+
+	static const int UPDATE_BATCH_SIZE = 32;
+
+	// settings of the anim_lod component, used by an animable or a controller on the same entity
+	struct LODSettings
+	{
+		Entity entity;
+		float reduced_screen_size;
+		float frozen_screen_size;
+		int reduced_interval;
+		int reduced_bone_depth;
+	};
+
 	struct Controller
 	{
-		Controller(IAllocator& allocator) : input(allocator), animations(allocator) {}
+		Controller(IAllocator& allocator)
+			: input(allocator)
+			, animations(allocator)
+			, animation_entries(allocator)
+			, lod(allocator)
+		{
+		}
 
 		Entity entity;
 		Anim::ControllerResource* resource = nullptr;
@@ -144,6 +184,8 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		u32 default_set = 0;
 		Array<u8> input;
 		HashMap<u32, Animation*> animations;
+		// index of the resource's set entry for each animation
+		HashMap<u32, int> animation_entries;
 
 		struct IK
 		{
@@ -154,16 +196,26 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			u32 bones[MAX_BONES_COUNT];
 			Vec3 target;
 		} inverse_kinematics[4];
+
+		AnimationLODState lod;
 	};
 
 
 	struct Animable
 	{
+		explicit Animable(IAllocator& allocator)
+			: cursor(allocator)
+			, lod(allocator)
+		{
+		}
+
 		float time;
 		float time_scale;
 		float start_time;
 		Animation* animation;
 		Entity entity;
+		AnimationCursor cursor;
+		AnimationLODState lod;
 	};
 
 
@@ -174,13 +226,29 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		, m_animables(allocator)
 		, m_controllers(allocator)
 		, m_shared_controllers(allocator)
+		, m_lods(allocator)
+		, m_pose_cache(allocator)
+		, m_reachable_animations(allocator)
+		, m_streamed_resources(allocator)
+		, m_eviction_candidates(allocator)
 		, m_event_stream(allocator)
+		, m_job_event_streams(allocator)
+		, m_shared_order(allocator)
+		, m_shared_batches(allocator)
+		, m_sync_point(true, allocator)
 	{
 		m_is_game_running = false;
+		m_lod_stats = {};
+		m_is_pose_cache_enabled = false;
+		m_streaming_frame = 0;
+		m_streaming_depth = 2;
+		m_streaming_budget = 64 * 1024 * 1024;
+		m_streamed_animations_size = 0;
 		m_render_scene = static_cast<RenderScene*>(universe.getScene(crc32("renderer")));
 		universe.registerComponentType(ANIMABLE_TYPE, this, &AnimationSceneImpl::serializeAnimable, &AnimationSceneImpl::deserializeAnimable);
 		universe.registerComponentType(CONTROLLER_TYPE, this, &AnimationSceneImpl::serializeController, &AnimationSceneImpl::deserializeController);
 		universe.registerComponentType(SHARED_CONTROLLER_TYPE, this, &AnimationSceneImpl::serializeSharedController, &AnimationSceneImpl::deserializeSharedController);
+		universe.registerComponentType(LOD_TYPE, this, &AnimationSceneImpl::serializeLOD, &AnimationSceneImpl::deserializeLOD);
 		ASSERT(m_render_scene);
 	}
 
@@ -201,9 +269,32 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	}
 
 
+	void serializeLOD(ISerializer& serializer, ComponentHandle cmp)
+	{
+		const LODSettings& lod = m_lods.get({cmp.index});
+		serializer.write("reduced_screen_size", lod.reduced_screen_size);
+		serializer.write("frozen_screen_size", lod.frozen_screen_size);
+		serializer.write("reduced_interval", lod.reduced_interval);
+		serializer.write("reduced_bone_depth", lod.reduced_bone_depth);
+	}
+
+
+	void deserializeLOD(IDeserializer& serializer, Entity entity, int /*scene_version*/)
+	{
+		LODSettings lod;
+		lod.entity = entity;
+		serializer.read(&lod.reduced_screen_size);
+		serializer.read(&lod.frozen_screen_size);
+		serializer.read(&lod.reduced_interval);
+		serializer.read(&lod.reduced_bone_depth);
+		m_lods.insert(entity, lod);
+		m_universe.addComponent(entity, LOD_TYPE, this, {entity.index});
+	}
+
+
 	void serializeAnimable(ISerializer& serializer, ComponentHandle cmp)
 	{
-		Animable& animable = m_animables[{cmp.index}];
+		Animable& animable = m_animables.get({cmp.index});
 		serializer.write("time_scale", animable.time_scale);
 		serializer.write("start_time", animable.start_time);
 		serializer.write("animation", animable.animation ? animable.animation->getPath().c_str() : "");
@@ -212,7 +303,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 
 	void deserializeAnimable(IDeserializer& serializer, Entity entity, int /*scene_version*/)
 	{
-		Animable& animable = m_animables.insert(entity);
+		Animable& animable = m_animables.emplace(entity, m_anim_system.m_allocator);
 		animable.entity = entity;
 		serializer.read(&animable.time_scale);
 		serializer.read(&animable.start_time);
@@ -271,6 +362,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			LUMIX_DELETE(m_anim_system.m_allocator, controller.root);
 		}
 		m_controllers.clear();
+		m_lods.clear();
 	}
 
 
@@ -383,19 +475,19 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 
 	float getAnimableTime(ComponentHandle cmp) override
 	{
-		return m_animables[{cmp.index}].time;
+		return m_animables.get({cmp.index}).time;
 	}
 
 
 	void setAnimableTime(ComponentHandle cmp, float time) override
 	{
-		m_animables[{cmp.index}].time = time;
+		m_animables.get({cmp.index}).time = time;
 	}
 
 
 	Animation* getAnimableAnimation(ComponentHandle cmp) override
 	{
-		return m_animables[{cmp.index}].animation;
+		return m_animables.get({cmp.index}).animation;
 	}
 
 	
@@ -403,7 +495,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	{
 		for (auto& controller : m_controllers)
 		{
-			initControllerRuntime(controller);
+			initControllerRuntime(controller, m_event_stream);
 		}
 		m_is_game_running = true;
 	}
@@ -440,6 +532,11 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			if (m_shared_controllers.find(entity) < 0) return INVALID_COMPONENT;
 			return {entity.index};
 		}
+		else if (type == LOD_TYPE)
+		{
+			if (m_lods.find(entity) < 0) return INVALID_COMPONENT;
+			return {entity.index};
+		}
 		return INVALID_COMPONENT;
 	}
 
@@ -449,6 +546,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		if (type == ANIMABLE_TYPE) return createAnimable(entity);
 		if (type == CONTROLLER_TYPE) return createController(entity);
 		if (type == SHARED_CONTROLLER_TYPE) return createSharedController(entity);
+		if (type == LOD_TYPE) return createLOD(entity);
 		return INVALID_COMPONENT;
 	}
 
@@ -474,7 +572,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		if (type == ANIMABLE_TYPE)
 		{
 			Entity entity = {component.index};
-			auto& animable = m_animables[entity];
+			auto& animable = m_animables.get(entity);
 			unloadAnimation(animable.animation);
 			m_animables.erase(entity);
 			m_universe.destroyComponent(entity, type, this, component);
@@ -494,6 +592,12 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			m_shared_controllers.erase(entity);
 			m_universe.destroyComponent(entity, type, this, component);
 		}
+		else if (type == LOD_TYPE)
+		{
+			Entity entity = {component.index};
+			m_lods.erase(entity);
+			m_universe.destroyComponent(entity, type, this, component);
+		}
 	}
 
 
@@ -522,6 +626,12 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			serializer.write(controller.entity);
 			serializer.write(controller.parent);
 		}
+
+		serializer.write(m_lods.size());
+		for (const LODSettings& lod : m_lods)
+		{
+			serializer.write(lod);
+		}
 	}
 
 
@@ -532,8 +642,10 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		m_animables.reserve(count);
 		for (int i = 0; i < count; ++i)
 		{
-			Animable animable;
-			serializer.read(animable.entity);
+			Entity entity;
+			serializer.read(entity);
+			Animable& animable = m_animables.emplace(entity, m_anim_system.m_allocator);
+			animable.entity = entity;
 			serializer.read(animable.time_scale);
 			serializer.read(animable.start_time);
 			animable.time = animable.start_time;
@@ -541,7 +653,6 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			char path[MAX_PATH_LENGTH];
 			serializer.readString(path, sizeof(path));
 			animable.animation = path[0] == '\0' ? nullptr : loadAnimation(Path(path));
-			m_animables.insert(animable.entity, animable);
 			ComponentHandle cmp = {animable.entity.index};
 			m_universe.addComponent(animable.entity, ANIMABLE_TYPE, this, cmp);
 		}
@@ -550,13 +661,16 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		m_controllers.reserve(count);
 		for (int i = 0; i < count; ++i)
 		{
-			Controller controller(m_anim_system.m_allocator);
-			serializer.read(controller.default_set);
-			serializer.read(controller.entity);
+			u32 default_set;
+			Entity entity;
+			serializer.read(default_set);
+			serializer.read(entity);
+			Controller& controller = m_controllers.emplace(entity, m_anim_system.m_allocator);
+			controller.default_set = default_set;
+			controller.entity = entity;
 			char tmp[MAX_PATH_LENGTH];
 			serializer.readString(tmp, lengthOf(tmp));
 			controller.resource = tmp[0] ? loadController(Path(tmp)) : nullptr;
-			m_controllers.insert(controller.entity, controller);
 			ComponentHandle cmp = { controller.entity.index };
 			m_universe.addComponent(controller.entity, CONTROLLER_TYPE, this, cmp);
 		}
@@ -572,6 +686,16 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			ComponentHandle cmp = {controller.entity.index};
 			m_universe.addComponent(controller.entity, SHARED_CONTROLLER_TYPE, this, cmp);
 		}
+
+		serializer.read(count);
+		m_lods.reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			LODSettings lod;
+			serializer.read(lod);
+			m_lods.insert(lod.entity, lod);
+			m_universe.addComponent(lod.entity, LOD_TYPE, this, {lod.entity.index});
+		}
 	}
 
 
@@ -584,10 +708,36 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	Entity getSharedControllerParent(ComponentHandle cmp) override { return m_shared_controllers[{cmp.index}].parent; }
 
 
-	float getTimeScale(ComponentHandle cmp) { return m_animables[{cmp.index}].time_scale; }
-	void setTimeScale(ComponentHandle cmp, float time_scale) { m_animables[{cmp.index}].time_scale = time_scale; }
-	float getStartTime(ComponentHandle cmp) { return m_animables[{cmp.index}].start_time; }
-	void setStartTime(ComponentHandle cmp, float time) { m_animables[{cmp.index}].start_time = time; }
+	float getLODReducedScreenSize(ComponentHandle cmp) { return m_lods.get({cmp.index}).reduced_screen_size; }
+	void setLODReducedScreenSize(ComponentHandle cmp, float size) { m_lods.get({cmp.index}).reduced_screen_size = size; }
+	float getLODFrozenScreenSize(ComponentHandle cmp) { return m_lods.get({cmp.index}).frozen_screen_size; }
+	void setLODFrozenScreenSize(ComponentHandle cmp, float size) { m_lods.get({cmp.index}).frozen_screen_size = size; }
+	int getLODReducedInterval(ComponentHandle cmp) { return m_lods.get({cmp.index}).reduced_interval; }
+	void setLODReducedInterval(ComponentHandle cmp, int interval) { m_lods.get({cmp.index}).reduced_interval = Math::maximum(interval, 1); }
+	int getLODReducedBoneDepth(ComponentHandle cmp) { return m_lods.get({cmp.index}).reduced_bone_depth; }
+	void setLODReducedBoneDepth(ComponentHandle cmp, int depth) { m_lods.get({cmp.index}).reduced_bone_depth = Math::maximum(depth, 0); }
+	AnimationLODStats getLODStats() const override { return m_lod_stats; }
+	void setAnimationStreamingDepth(int depth) override { m_streaming_depth = Math::maximum(depth, 0); }
+	void setAnimationStreamingBudget(int budget) override { m_streaming_budget = Math::maximum(budget, 0); }
+	int getStreamedAnimationsSize() const override { return m_streamed_animations_size; }
+	bool isPoseCacheEnabled() const override { return m_is_pose_cache_enabled; }
+
+
+	void setPoseCacheEnabled(bool enabled, float time_step) override
+	{
+		m_is_pose_cache_enabled = enabled;
+		m_pose_cache.setTimeStep(Math::maximum(time_step, 0.0001f));
+		m_pose_cache.clear();
+	}
+
+
+	AnimationPoseCache* getPoseCache() { return m_is_pose_cache_enabled ? &m_pose_cache : nullptr; }
+
+
+	float getTimeScale(ComponentHandle cmp) { return m_animables.get({cmp.index}).time_scale; }
+	void setTimeScale(ComponentHandle cmp, float time_scale) { m_animables.get({cmp.index}).time_scale = time_scale; }
+	float getStartTime(ComponentHandle cmp) { return m_animables.get({cmp.index}).start_time; }
+	void setStartTime(ComponentHandle cmp, float time) { m_animables.get({cmp.index}).start_time = time; }
 
 
 	void setControllerSource(ComponentHandle cmp, const Path& path)
@@ -597,7 +747,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		controller.resource = loadController(path);
 		if (controller.resource->isReady() && m_is_game_running)
 		{
-			initControllerRuntime(controller);
+			initControllerRuntime(controller, m_event_stream);
 		}
 	}
 
@@ -611,21 +761,21 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 
 	Path getAnimation(ComponentHandle cmp)
 	{
-		const auto& animable = m_animables[{cmp.index}];
+		const auto& animable = m_animables.get({cmp.index});
 		return animable.animation ? animable.animation->getPath() : Path("");
 	}
 
 
 	void setAnimation(ComponentHandle cmp, const Path& path)
 	{
-		auto& animable = m_animables[{cmp.index}];
+		auto& animable = m_animables.get({cmp.index});
 		unloadAnimation(animable.animation);
 		animable.animation = loadAnimation(path);
 		animable.time = 0;
 	}
 
 
-	void updateAnimable(Animable& animable, float time_delta)
+	void updateAnimable(Animable& animable, float time_delta, AnimationLODTier tier)
 	{
 		if (!animable.animation || !animable.animation->isReady()) return;
 		ComponentHandle model_instance = m_render_scene->getModelInstanceComponent(animable.entity);
@@ -637,10 +787,44 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		if (!pose) return;
 		if (!model->isReady()) return;
 
-		model->getPose(*pose);
-		pose->computeRelative(*model);
-		animable.animation->getRelativePose(animable.time, *pose, *model);
-		pose->computeAbsolute(*model);
+		if (tier == AnimationLODTier::FULL)
+		{
+			model->getPose(*pose);
+			pose->computeRelative(*model);
+			AnimationPoseCache* pose_cache = getPoseCache();
+			const int* bone_remap = pose_cache ? animable.animation->getBoneRemap(*model) : nullptr;
+			if (bone_remap)
+			{
+				pose_cache->getRelativePose(*animable.animation, animable.time, *pose, bone_remap);
+			}
+			else
+			{
+				animable.animation->getRelativePose(animable.time, *pose, *model, &animable.cursor);
+			}
+			pose->computeAbsolute(*model);
+		}
+		else if (tier == AnimationLODTier::REDUCED)
+		{
+			AnimationLODState& lod = animable.lod;
+			if (lod.isUpdateFrame())
+			{
+				model->getPose(*pose);
+				pose->computeRelative(*model);
+				const int* bone_remap = animable.animation->getBoneRemap(*model, lod.bone_depth);
+				AnimationPoseCache* pose_cache = getPoseCache();
+				if (bone_remap && pose_cache)
+				{
+					pose_cache->getRelativePose(*animable.animation, animable.time, *pose, bone_remap);
+				}
+				else if (bone_remap)
+				{
+					animable.animation->getRelativePose(animable.time, *pose, bone_remap, &animable.cursor);
+				}
+				pose->computeAbsolute(*model);
+				lod.storePose(*pose);
+			}
+			lod.interpolatePose(*pose);
+		}
 
 		float t = animable.time + time_delta * animable.time_scale;
 		float l = animable.animation->getLength();
@@ -654,15 +838,15 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 
 	void updateAnimable(ComponentHandle cmp, float time_delta) override
 	{
-		Animable& animable = m_animables[{cmp.index}];
-		updateAnimable(animable, time_delta);
+		Animable& animable = m_animables.get({cmp.index});
+		updateAnimable(animable, time_delta, AnimationLODTier::FULL);
 	}
 
 
 	void updateController(ComponentHandle cmp, float time_delta) override
 	{
 		Controller& controller = m_controllers.get({cmp.index});
-		updateController(controller, time_delta);
+		updateController(controller, time_delta, 0, m_event_stream);
 		processEventStream();
 		m_event_stream.clear();
 	}
@@ -722,10 +906,12 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		});
 		if (set_idx < 0) return;
 
-		for (auto& entry : ctrl.resource->m_animation_set)
+		for (int i = 0, c = ctrl.resource->m_animation_set.size(); i < c; ++i)
 		{
+			auto& entry = ctrl.resource->m_animation_set[i];
 			if (entry.set != set_idx) continue;
 			ctrl.animations[entry.hash] = entry.animation;
+			ctrl.animation_entries[entry.hash] = i;
 		}
 		if (ctrl.root) ctrl.root->onAnimationSetUpdated(ctrl.animations);
 	}
@@ -756,7 +942,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	}
 
 
-	bool initControllerRuntime(Controller& controller)
+	bool initControllerRuntime(Controller& controller, OutputBlob& event_stream)
 	{
 		if (!controller.resource->isReady()) return false;
 		if (controller.resource->m_input_decl.getSize() == 0) return false;
@@ -771,10 +957,12 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 				break;
 			}
 		}
-		for (auto& entry : controller.resource->m_animation_set)
+		for (int i = 0, c = controller.resource->m_animation_set.size(); i < c; ++i)
 		{
+			auto& entry = controller.resource->m_animation_set[i];
 			if (entry.set != set_idx) continue;
 			controller.animations.insert(entry.hash, entry.animation);
+			controller.animation_entries.insert(entry.hash, i);
 		}
 		setMemory(&controller.input[0], 0, controller.input.size());
 		Anim::RunningContext rc;
@@ -783,7 +971,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		rc.input = &controller.input[0];
 		rc.current = nullptr;
 		rc.anim_set = &controller.animations;
-		rc.event_stream = &m_event_stream;
+		rc.event_stream = &event_stream;
 		rc.controller = {controller.entity.index};
 		controller.root->enter(rc, nullptr);
 		return true;
@@ -811,14 +999,14 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		model->getPose(*pose);
 		pose->computeRelative(*model);
 
-		parent_controller.root->fillPose(m_anim_system.m_engine, *pose, *model, 1);
+		parent_controller.root->fillPose(m_anim_system.m_engine, *pose, *model, 1, getPoseCache(), 0);
 
 		pose->computeAbsolute(*model);
 
 	}
 
 
-	void updateController(Controller& controller, float time_delta)
+	void updateController(Controller& controller, float time_delta, int bone_depth, OutputBlob& event_stream)
 	{
 		if (!controller.resource->isReady())
 		{
@@ -827,7 +1015,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 			return;
 		}
 
-		if (!controller.root && !initControllerRuntime(controller)) return;
+		if (!controller.root && !initControllerRuntime(controller, event_stream)) return;
 
 		Anim::RunningContext rc;
 		rc.time_delta = time_delta;
@@ -835,7 +1023,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		rc.allocator = &m_anim_system.m_allocator;
 		rc.input = &controller.input[0];
 		rc.anim_set = &controller.animations;
-		rc.event_stream = &m_event_stream;
+		rc.event_stream = &event_stream;
 		rc.controller = {controller.entity.index};
 		controller.root = controller.root->update(rc, true);
 
@@ -850,7 +1038,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 		model->getPose(*pose);
 		pose->computeRelative(*model);
 
-		controller.root->fillPose(m_anim_system.m_engine, *pose, *model, 1);
+		controller.root->fillPose(m_anim_system.m_engine, *pose, *model, 1, getPoseCache(), bone_depth);
 
 		pose->computeAbsolute(*model);
 
@@ -863,6 +1051,32 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	}
 
 
+	// frozen controllers do not advance, reduced ones get the time of skipped frames in the next update
+	void updateControllerLOD(Controller& controller, float time_delta, OutputBlob& event_stream)
+	{
+		AnimationLODState& lod = controller.lod;
+		if (lod.tier == AnimationLODTier::FROZEN) return;
+
+		lod.accumulated_time += time_delta;
+		if (lod.tier == AnimationLODTier::FULL)
+		{
+			updateController(controller, lod.accumulated_time, 0, event_stream);
+			lod.accumulated_time = 0;
+			return;
+		}
+
+		ComponentHandle model_instance = m_render_scene->getModelInstanceComponent(controller.entity);
+		Pose* pose = model_instance.isValid() ? m_render_scene->getPose(model_instance) : nullptr;
+		if (lod.isUpdateFrame())
+		{
+			updateController(controller, lod.accumulated_time, lod.bone_depth, event_stream);
+			lod.accumulated_time = 0;
+			if (pose) lod.storePose(*pose);
+		}
+		if (pose) lod.interpolatePose(*pose);
+	}
+
+
 	void updateIK(Controller::IK& ik, Pose& pose, Model& model, Entity& entity)
 	{
 		decltype(model.getBoneIndex(0)) bones_iters[Controller::IK::MAX_BONES_COUNT];
@@ -930,29 +1144,260 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	}
 
 
-	void update(float time_delta, bool paused) override
+	bool getLODView(AnimationLODView* view)
+	{
+		ComponentHandle camera = m_render_scene->getCameraInSlot("main");
+		if (!camera.isValid()) return false;
+
+		view->frustum = m_render_scene->getCameraFrustum(camera);
+		view->position = m_universe.getPosition(m_render_scene->getCameraEntity(camera));
+		view->is_ortho = m_render_scene->isCameraOrtho(camera);
+		view->size_scale = view->is_ortho ? 1 / m_render_scene->getCameraOrthoSize(camera)
+										  : 1 / tanf(m_render_scene->getCameraFOV(camera) * 0.5f);
+		return true;
+	}
+
+
+	AnimationLODTier getLODTier(Entity entity, const LODSettings& settings, const AnimationLODView& view)
+	{
+		ComponentHandle model_instance = m_render_scene->getModelInstanceComponent(entity);
+		if (!model_instance.isValid()) return AnimationLODTier::FULL;
+		Model* model = m_render_scene->getModelInstanceModel(model_instance);
+		if (!model || !model->isReady()) return AnimationLODTier::FULL;
+
+		Vec3 pos = m_universe.getPosition(entity);
+		float radius = model->getBoundingRadius() * m_universe.getScale(entity);
+		return getAnimationLODTier(pos, radius, view, settings.reduced_screen_size, settings.frozen_screen_size);
+	}
+
+
+	void updateLODTier(Entity entity, AnimationLODState& lod, const AnimationLODView* view)
+	{
+		AnimationLODTier tier = AnimationLODTier::FULL;
+		int lod_idx = view ? m_lods.find(entity) : -1;
+		if (lod_idx >= 0)
+		{
+			const LODSettings& settings = m_lods.at(lod_idx);
+			tier = getLODTier(entity, settings, *view);
+			lod.interval = settings.reduced_interval;
+			lod.bone_depth = settings.reduced_bone_depth;
+		}
+
+		lod.setTier(tier, entity.index);
+
+		switch (tier)
+		{
+			case AnimationLODTier::FULL: ++m_lod_stats.full; break;
+			case AnimationLODTier::REDUCED: ++m_lod_stats.reduced; break;
+			case AnimationLODTier::FROZEN: ++m_lod_stats.frozen; break;
+		}
+	}
+
+
+	void updateLODTiers()
 	{
 		PROFILE_FUNCTION();
-		if (!m_is_game_running) return;
-		if (paused) return;
+		m_lod_stats = {};
+		AnimationLODView view;
+		const AnimationLODView* view_ptr = m_lods.size() > 0 && getLODView(&view) ? &view : nullptr;
+		for (Animable& animable : m_animables) updateLODTier(animable.entity, animable.lod, view_ptr);
+		for (Controller& controller : m_controllers) updateLODTier(controller.entity, controller.lod, view_ptr);
+		PROFILE_INT("full animation LOD", m_lod_stats.full);
+		PROFILE_INT("reduced animation LOD", m_lod_stats.reduced);
+		PROFILE_INT("frozen animation LOD", m_lod_stats.frozen);
+	}
 
-		m_event_stream.clear();
 
-		for (Animable& animable : m_animables)
+	// runs f(batch, event_stream) for each batch on the job system, event streams of batches are appended
+	// to m_event_stream in the order of batches, so events are processed in the same order as in a serial update
+	template <typename F> void runJobs(int batch_count, F& f)
+	{
+		if (batch_count == 0) return;
+		if (batch_count == 1)
+		{
+			f(0, m_event_stream);
+			return;
+		}
+
+		IAllocator& allocator = m_anim_system.m_allocator;
+		MTJD::Manager& manager = m_engine.getMTJDManager();
+		while (m_job_event_streams.size() < batch_count) m_job_event_streams.emplace(allocator);
+		for (int i = 0; i < batch_count; ++i)
+		{
+			OutputBlob* event_stream = &m_job_event_streams[i];
+			event_stream->clear();
+			MTJD::Job* job = MTJD::makeJob(manager,
+				[&f, i, event_stream]() {
+					PROFILE_BLOCK("Animation Job");
+					f(i, *event_stream);
+				},
+				allocator);
+			job->addDependency(&m_sync_point);
+			manager.schedule(job);
+		}
+		m_sync_point.sync();
+
+		for (int i = 0; i < batch_count; ++i)
 		{
-			AnimationSceneImpl::updateAnimable(animable, time_delta);
+			const OutputBlob& event_stream = m_job_event_streams[i];
+			if (event_stream.getPos() > 0) m_event_stream.write(event_stream.getData(), event_stream.getPos());
 		}
+	}
 
+
+	static int compareSharedControllerOrder(const void* a, const void* b)
+	{
+		const SharedControllerOrder* lhs = (const SharedControllerOrder*)a;
+		const SharedControllerOrder* rhs = (const SharedControllerOrder*)b;
+		if (lhs->parent != rhs->parent) return lhs->parent < rhs->parent ? -1 : 1;
+		return lhs->index - rhs->index;
+	}
+
+
+	// shared controllers with the same parent sample the same state machine instance, which advances
+	// the keyframe cursors of its animation nodes, so they are kept in one batch
+	void batchSharedControllers()
+	{
+		m_shared_order.clear();
+		m_shared_batches.clear();
+		if (m_shared_controllers.size() == 0) return;
+
+		for (int i = 0, c = m_shared_controllers.size(); i < c; ++i)
+		{
+			m_shared_order.push({m_shared_controllers.at(i).parent.index, i});
+		}
+		qsort(&m_shared_order[0], m_shared_order.size(), sizeof(m_shared_order[0]), compareSharedControllerOrder);
+
+		m_shared_batches.push(0);
+		for (int i = 1, c = m_shared_order.size(); i < c; ++i)
+		{
+			bool is_full = i - m_shared_batches.back() >= UPDATE_BATCH_SIZE;
+			if (is_full && m_shared_order[i].parent != m_shared_order[i - 1].parent) m_shared_batches.push(i);
+		}
+	}
+
+
+	// the resource manager is not thread safe, so animations are requested before the update jobs run
+	void updateAnimationStreaming()
+	{
+		PROFILE_FUNCTION();
+		++m_streaming_frame;
+		m_streamed_resources.clear();
 		for (Controller& controller : m_controllers)
 		{
-			AnimationSceneImpl::updateController(controller, time_delta);
+			Anim::ControllerResource* resource = controller.resource;
+			if (!resource || !resource->m_is_streamed || !resource->isReady()) continue;
+			if (m_streamed_resources.indexOf(resource) < 0) m_streamed_resources.push(resource);
+			if (!controller.root) continue;
+
+			m_reachable_animations.clear();
+			controller.root->getReachableAnimations(m_streaming_depth, m_reachable_animations);
+			for (u32 hash : m_reachable_animations)
+			{
+				auto iter = controller.animation_entries.find(hash);
+				if (!iter.isValid()) continue;
+				controller.animations[hash] = resource->requestAnimation(iter.value(), m_streaming_frame);
+			}
 		}
+		evictAnimations();
+	}
+
 
-		for (SharedController& controller : m_shared_controllers)
+	static int compareEvictionCandidates(const void* a, const void* b)
+	{
+		const EvictionCandidate* lhs = (const EvictionCandidate*)a;
+		const EvictionCandidate* rhs = (const EvictionCandidate*)b;
+		if (lhs->last_used_frame == rhs->last_used_frame) return 0;
+		return lhs->last_used_frame < rhs->last_used_frame ? -1 : 1;
+	}
+
+
+	// least recently used animations go first, animations requested in this frame are kept
+	void evictAnimations()
+	{
+		m_eviction_candidates.clear();
+		size_t loaded_size = 0;
+		for (Anim::ControllerResource* resource : m_streamed_resources)
 		{
-			AnimationSceneImpl::updateSharedController(controller, time_delta);
+			for (int i = 0, c = resource->m_animation_set.size(); i < c; ++i)
+			{
+				const auto& entry = resource->m_animation_set[i];
+				if (!entry.animation) continue;
+
+				loaded_size += entry.animation->size();
+				if (entry.last_used_frame != m_streaming_frame)
+				{
+					m_eviction_candidates.push({resource, i, entry.last_used_frame});
+				}
+			}
 		}
 
+		size_t budget = (size_t)m_streaming_budget;
+		if (loaded_size > budget && !m_eviction_candidates.empty())
+		{
+			qsort(&m_eviction_candidates[0],
+				m_eviction_candidates.size(),
+				sizeof(m_eviction_candidates[0]),
+				compareEvictionCandidates);
+			for (const EvictionCandidate& candidate : m_eviction_candidates)
+			{
+				if (loaded_size <= budget) break;
+				loaded_size -= candidate.resource->m_animation_set[candidate.entry].animation->size();
+				candidate.resource->evictAnimation(candidate.entry);
+			}
+		}
+		m_streamed_animations_size = (int)loaded_size;
+		PROFILE_INT("streamed animations KB", m_streamed_animations_size >> 10);
+	}
+
+
+	static int getBatchCount(int count)
+	{
+		return (count + UPDATE_BATCH_SIZE - 1) / UPDATE_BATCH_SIZE;
+	}
+
+
+	void update(float time_delta, bool paused) override
+	{
+		PROFILE_FUNCTION();
+		if (!m_is_game_running) return;
+		if (paused) return;
+
+		m_event_stream.clear();
+		if (m_is_pose_cache_enabled) m_pose_cache.clear();
+		updateAnimationStreaming();
+		updateLODTiers();
+
+		auto update_animables = [this, time_delta](int batch, OutputBlob&) {
+			int from = batch * UPDATE_BATCH_SIZE;
+			for (int i = from, c = Math::minimum(from + UPDATE_BATCH_SIZE, m_animables.size()); i < c; ++i)
+			{
+				Animable& animable = m_animables.at(i);
+				updateAnimable(animable, time_delta, animable.lod.tier);
+			}
+		};
+		runJobs(getBatchCount(m_animables.size()), update_animables);
+
+		auto update_controllers = [this, time_delta](int batch, OutputBlob& event_stream) {
+			int from = batch * UPDATE_BATCH_SIZE;
+			for (int i = from, c = Math::minimum(from + UPDATE_BATCH_SIZE, m_controllers.size()); i < c; ++i)
+			{
+				updateControllerLOD(m_controllers.at(i), time_delta, event_stream);
+			}
+		};
+		runJobs(getBatchCount(m_controllers.size()), update_controllers);
+
+		batchSharedControllers();
+		auto update_shared_controllers = [this, time_delta](int batch, OutputBlob&) {
+			int from = m_shared_batches[batch];
+			int to = batch + 1 < m_shared_batches.size() ? m_shared_batches[batch + 1] : m_shared_order.size();
+			for (int i = from; i < to; ++i)
+			{
+				updateSharedController(m_shared_controllers.at(m_shared_order[i].index), time_delta);
+			}
+		};
+		runJobs(m_shared_batches.size(), update_shared_controllers);
+
 		processEventStream();
 	}
 
@@ -1011,7 +1456,7 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 
 	ComponentHandle createAnimable(Entity entity)
 	{
-		Animable& animable = m_animables.insert(entity);
+		Animable& animable = m_animables.emplace(entity, m_anim_system.m_allocator);
 		animable.time = 0;
 		animable.animation = nullptr;
 		animable.entity = entity;
@@ -1043,6 +1488,21 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	}
 
 
+	ComponentHandle createLOD(Entity entity)
+	{
+		LODSettings lod;
+		lod.entity = entity;
+		lod.reduced_screen_size = 0.2f;
+		lod.frozen_screen_size = 0.02f;
+		lod.reduced_interval = 3;
+		lod.reduced_bone_depth = 0;
+		m_lods.insert(entity, lod);
+		ComponentHandle cmp = {entity.index};
+		m_universe.addComponent(entity, LOD_TYPE, this, cmp);
+		return cmp;
+	}
+
+
 	IPlugin& getPlugin() const override { return m_anim_system; }
 
 
@@ -1052,9 +1512,24 @@ struct AnimationSceneImpl LUMIX_FINAL : public AnimationScene
 	AssociativeArray<Entity, Animable> m_animables;
 	AssociativeArray<Entity, Controller> m_controllers;
 	AssociativeArray<Entity, SharedController> m_shared_controllers;
+	AssociativeArray<Entity, LODSettings> m_lods;
+	AnimationLODStats m_lod_stats;
+	AnimationPoseCache m_pose_cache;
+	bool m_is_pose_cache_enabled;
+	Array<u32> m_reachable_animations;
+	Array<Anim::ControllerResource*> m_streamed_resources;
+	Array<EvictionCandidate> m_eviction_candidates;
+	u32 m_streaming_frame;
+	int m_streaming_depth;
+	int m_streaming_budget;
+	int m_streamed_animations_size;
 	RenderScene* m_render_scene;
 	bool m_is_game_running;
 	OutputBlob m_event_stream;
+	Array<OutputBlob> m_job_event_streams;
+	Array<SharedControllerOrder> m_shared_order;
+	Array<int> m_shared_batches;
+	MTJD::Group m_sync_point;
 };
 
 
@@ -1092,6 +1567,29 @@ AnimationSystemImpl::AnimationSystemImpl(Engine& engine)
 		LUMIX_NEW(m_allocator, EntityPropertyDescriptor<AnimationSceneImpl>)(
 			"Parent", &AnimationSceneImpl::getSharedControllerParent, &AnimationSceneImpl::setSharedControllerParent));
 
+	PropertyRegister::add("anim_lod",
+		LUMIX_NEW(m_allocator, DecimalPropertyDescriptor<AnimationSceneImpl>)("Reduced screen size",
+			&AnimationSceneImpl::getLODReducedScreenSize,
+			&AnimationSceneImpl::setLODReducedScreenSize,
+			0,
+			FLT_MAX,
+			0.01f));
+	PropertyRegister::add("anim_lod",
+		LUMIX_NEW(m_allocator, DecimalPropertyDescriptor<AnimationSceneImpl>)("Frozen screen size",
+			&AnimationSceneImpl::getLODFrozenScreenSize,
+			&AnimationSceneImpl::setLODFrozenScreenSize,
+			0,
+			FLT_MAX,
+			0.01f));
+	auto* interval = LUMIX_NEW(m_allocator, IntPropertyDescriptor<AnimationSceneImpl>)(
+		"Reduced interval", &AnimationSceneImpl::getLODReducedInterval, &AnimationSceneImpl::setLODReducedInterval);
+	interval->setLimit(1, 60);
+	PropertyRegister::add("anim_lod", interval);
+	auto* bone_depth = LUMIX_NEW(m_allocator, IntPropertyDescriptor<AnimationSceneImpl>)(
+		"Reduced bone depth", &AnimationSceneImpl::getLODReducedBoneDepth, &AnimationSceneImpl::setLODReducedBoneDepth);
+	bone_depth->setLimit(0, 255);
+	PropertyRegister::add("anim_lod", bone_depth);
+
 
 	registerLuaAPI();
 }
@@ -1118,6 +1616,11 @@ void AnimationSystemImpl::registerLuaAPI()
 	REGISTER_FUNCTION(setControllerBoolInput);
 	REGISTER_FUNCTION(setControllerFloatInput);
 	REGISTER_FUNCTION(getControllerInputIndex);
+	REGISTER_FUNCTION(setPoseCacheEnabled);
+	REGISTER_FUNCTION(isPoseCacheEnabled);
+	REGISTER_FUNCTION(setAnimationStreamingDepth);
+	REGISTER_FUNCTION(setAnimationStreamingBudget);
+	REGISTER_FUNCTION(getStreamedAnimationsSize);
 
 	#undef REGISTER_FUNCTION
 
@@ -17,6 +17,14 @@ class ControllerResource;
 }
 
 
+struct AnimationLODStats
+{
+	int full;
+	int reduced;
+	int frozen;
+};
+
+
 struct AnimationScene : public IScene
 {
 	virtual const OutputBlob& getEventStream() const = 0;
@@ -39,6 +47,16 @@ struct AnimationScene : public IScene
 	virtual void setControllerDefaultSet(ComponentHandle cmp, int set) = 0;
 	virtual int getControllerDefaultSet(ComponentHandle cmp) = 0;
 	virtual Anim::ControllerResource* getControllerResource(ComponentHandle cmp) = 0;
+	// number of animables and controllers updated in each LOD tier in the last update
+	virtual AnimationLODStats getLODStats() const = 0;
+	// instances playing the same animation at the same time share sampled poses; times are quantized to time_step
+	virtual void setPoseCacheEnabled(bool enabled, float time_step) = 0;
+	virtual bool isPoseCacheEnabled() const = 0;
+	// controllers with streamed animations load animations of states within depth transitions from the active ones,
+	// unused animations are unloaded when loaded ones take more than budget bytes
+	virtual void setAnimationStreamingDepth(int depth) = 0;
+	virtual void setAnimationStreamingBudget(int budget) = 0;
+	virtual int getStreamedAnimationsSize() const = 0;
 };
 
 
@@ -303,12 +303,27 @@ ExpressionVM::ReturnValue ExpressionVM::evaluate(const u8* code, RunningContext&
 			case Instruction::RET_FLOAT: return pop<float>();
 			case Instruction::RET_BOOL: return pop<bool>();
 			case Instruction::ADD_FLOAT: push<float>(pop<float>() + pop<float>()); break;
-			case Instruction::SUB_FLOAT: push<float>(-pop<float>() + pop<float>()); break;
+			case Instruction::SUB_FLOAT:
+			{
+				float f = pop<float>();
+				push<float>(pop<float>() - f);
+			}
+			break;
 			case Instruction::PUSH_BOOL: cp = pushStackConst<bool>(cp); break;
 			case Instruction::PUSH_FLOAT: cp = pushStackConst<float>(cp); break;
 			case Instruction::PUSH_INT: cp = pushStackConst<int>(cp); break;
-			case Instruction::FLOAT_LT: push<bool>(pop<float>() > pop<float>()); break;
-			case Instruction::FLOAT_GT: push<bool>(pop<float>() < pop<float>()); break;
+			case Instruction::FLOAT_LT:
+			{
+				float f = pop<float>();
+				push<bool>(pop<float>() < f);
+			}
+			break;
+			case Instruction::FLOAT_GT:
+			{
+				float f = pop<float>();
+				push<bool>(pop<float>() > f);
+			}
+			break;
 			case Instruction::INT_EQ: push<bool>(pop<int>() == pop<int>()); break;
 			case Instruction::INT_NEQ: push<bool>(pop<int>() != pop<int>()); break;
 			case Instruction::MUL_FLOAT: push<float>(pop<float>() * pop<float>()); break;
@@ -340,6 +355,253 @@ ExpressionVM::ReturnValue ExpressionVM::evaluate(const u8* code, RunningContext&
 }
 
 
+static int getInstructionSize(u8 instr)
+{
+	switch (instr)
+	{
+		case Instruction::PUSH_BOOL: return 1 + sizeof(bool);
+		case Instruction::PUSH_FLOAT: return 1 + sizeof(float);
+		case Instruction::PUSH_INT:
+		case Instruction::INPUT_FLOAT:
+		case Instruction::INPUT_INT:
+		case Instruction::INPUT_BOOL: return 1 + sizeof(int);
+		case Instruction::CALL: return 1 + sizeof(u16);
+		default: return 1;
+	}
+}
+
+
+// rewrites bytecode in place, folded code is never longer than the code it was folded from
+class ExpressionOptimizer
+{
+public:
+	explicit ExpressionOptimizer(u8* code)
+		: m_code(code)
+		, m_size(0)
+		, m_stack_idx(0)
+	{
+	}
+
+
+	int fold(int size);
+
+private:
+	struct Value
+	{
+		int start;
+		Types type;
+		bool is_const;
+		union
+		{
+			float f_value;
+			int i_value;
+			bool b_value;
+		};
+	};
+
+
+	void write(const void* data, int size)
+	{
+		moveMemory(m_code + m_size, data, size);
+		m_size += size;
+	}
+
+
+	// replaces the code of the value with a single push
+	void writeConstant(Value& value)
+	{
+		m_size = value.start;
+		value.is_const = true;
+		u8 instr;
+		switch (value.type)
+		{
+			case Types::FLOAT:
+				instr = Instruction::PUSH_FLOAT;
+				write(&instr, 1);
+				write(&value.f_value, sizeof(value.f_value));
+				break;
+			case Types::INT:
+				instr = Instruction::PUSH_INT;
+				write(&instr, 1);
+				write(&value.i_value, sizeof(value.i_value));
+				break;
+			default:
+				instr = Instruction::PUSH_BOOL;
+				write(&instr, 1);
+				write(&value.b_value, sizeof(value.b_value));
+				break;
+		}
+	}
+
+
+	// removes the code of the value at stack_idx and moves the code of the values above it
+	void erase(int stack_idx)
+	{
+		int start = m_stack[stack_idx].start;
+		int end = stack_idx + 1 < m_stack_idx ? m_stack[stack_idx + 1].start : m_size;
+		moveMemory(m_code + start, m_code + end, m_size - end);
+		m_size -= end - start;
+		for (int i = stack_idx + 1; i < m_stack_idx; ++i)
+		{
+			m_stack[i].start -= end - start;
+			m_stack[i - 1] = m_stack[i];
+		}
+		--m_stack_idx;
+	}
+
+
+	static bool foldBinary(u8 instr, const Value& a, const Value& b, Value* result)
+	{
+		result->type = Types::BOOL;
+		switch (instr)
+		{
+			case Instruction::ADD_FLOAT: result->type = Types::FLOAT; result->f_value = a.f_value + b.f_value; return true;
+			case Instruction::SUB_FLOAT: result->type = Types::FLOAT; result->f_value = a.f_value - b.f_value; return true;
+			case Instruction::MUL_FLOAT: result->type = Types::FLOAT; result->f_value = a.f_value * b.f_value; return true;
+			case Instruction::DIV_FLOAT: result->type = Types::FLOAT; result->f_value = a.f_value / b.f_value; return true;
+			case Instruction::FLOAT_LT: result->b_value = a.f_value < b.f_value; return true;
+			case Instruction::FLOAT_GT: result->b_value = a.f_value > b.f_value; return true;
+			case Instruction::INT_EQ: result->b_value = a.i_value == b.i_value; return true;
+			case Instruction::INT_NEQ: result->b_value = a.i_value != b.i_value; return true;
+			case Instruction::AND: result->b_value = a.b_value && b.b_value; return true;
+			case Instruction::OR: result->b_value = a.b_value || b.b_value; return true;
+			default: return false;
+		}
+	}
+
+private:
+	u8* m_code;
+	int m_size;
+	Value m_stack[ExpressionVM::STACK_SIZE];
+	int m_stack_idx;
+};
+
+
+int ExpressionOptimizer::fold(int size)
+{
+	int pos = 0;
+	while (pos < size)
+	{
+		u8 instr[1 + sizeof(int)];
+		int instr_size = getInstructionSize(m_code[pos]);
+		if (pos + instr_size > size || m_stack_idx == lengthOf(m_stack)) return -1;
+		copyMemory(instr, m_code + pos, instr_size);
+		pos += instr_size;
+
+		Value* top = m_stack_idx > 0 ? &m_stack[m_stack_idx - 1] : nullptr;
+		Value* next = m_stack_idx > 1 ? &m_stack[m_stack_idx - 2] : nullptr;
+		switch (instr[0])
+		{
+			case Instruction::PUSH_BOOL:
+			case Instruction::PUSH_FLOAT:
+			case Instruction::PUSH_INT:
+			case Instruction::INPUT_FLOAT:
+			case Instruction::INPUT_INT:
+			case Instruction::INPUT_BOOL:
+			{
+				Value& value = m_stack[m_stack_idx];
+				++m_stack_idx;
+				value.start = m_size;
+				value.is_const = instr[0] == Instruction::PUSH_BOOL || instr[0] == Instruction::PUSH_FLOAT ||
+								 instr[0] == Instruction::PUSH_INT;
+				switch (instr[0])
+				{
+					case Instruction::PUSH_FLOAT:
+					case Instruction::INPUT_FLOAT: value.type = Types::FLOAT; break;
+					case Instruction::PUSH_INT:
+					case Instruction::INPUT_INT: value.type = Types::INT; break;
+					default: value.type = Types::BOOL; break;
+				}
+				value.i_value = 0;
+				if (value.is_const) copyMemory(&value.f_value, instr + 1, instr_size - 1);
+				write(instr, instr_size);
+				break;
+			}
+			case Instruction::CALL:
+			{
+				u16 func_idx = *(u16*)(instr + 1);
+				if (func_idx >= lengthOf(FUNCTIONS)) return -1;
+				int arity = FUNCTIONS[func_idx].arity();
+				if (m_stack_idx < arity) return -1;
+				if (arity == 1 && top->is_const && (func_idx == 0 || func_idx == 1))
+				{
+					top->f_value = func_idx == 0 ? sinf(top->f_value) : cosf(top->f_value);
+					writeConstant(*top);
+					break;
+				}
+				int start = arity > 0 ? m_stack[m_stack_idx - arity].start : m_size;
+				m_stack_idx -= arity;
+				Value& value = m_stack[m_stack_idx];
+				++m_stack_idx;
+				value.start = start;
+				value.is_const = false;
+				value.type = FUNCTIONS[func_idx].ret_type;
+				write(instr, instr_size);
+				break;
+			}
+			case Instruction::RET_FLOAT:
+			case Instruction::RET_BOOL:
+				write(instr, instr_size);
+				return pos == size && m_stack_idx == 1 ? m_size : -1;
+			case Instruction::UNARY_MINUS:
+			case Instruction::NOT:
+				if (!top) return -1;
+				if (top->is_const)
+				{
+					if (instr[0] == Instruction::NOT) top->b_value = !top->b_value;
+					else top->f_value = -top->f_value;
+					writeConstant(*top);
+					break;
+				}
+				write(instr, instr_size);
+				break;
+			default:
+			{
+				if (!next) return -1;
+				Value result;
+				result.start = next->start;
+				result.is_const = false;
+				if (next->is_const && top->is_const && foldBinary(instr[0], *next, *top, &result))
+				{
+					--m_stack_idx;
+					*next = result;
+					writeConstant(*next);
+					break;
+				}
+				bool is_logic = instr[0] == Instruction::AND || instr[0] == Instruction::OR;
+				if (is_logic && (next->is_const || top->is_const))
+				{
+					// `x or true` is true and `x and false` is false, the other constant is a no-op
+					bool absorbing = instr[0] == Instruction::OR;
+					bool constant = next->is_const ? next->b_value : top->b_value;
+					if (constant == absorbing)
+					{
+						--m_stack_idx;
+						result.type = Types::BOOL;
+						result.b_value = absorbing;
+						*next = result;
+						writeConstant(*next);
+					}
+					else
+					{
+						erase(top->is_const ? m_stack_idx - 1 : m_stack_idx - 2);
+					}
+					break;
+				}
+				// computes the result type, unknown instructions are left to the VM
+				if (!foldBinary(instr[0], *next, *top, &result)) return -1;
+				result.is_const = false;
+				--m_stack_idx;
+				*next = result;
+				write(instr, instr_size);
+				break;
+			}
+		}
+	}
+	return -1;
+}
+
+
 int ExpressionCompiler::toPostfix(const Token* input, Token* output, int count)
 {
 	Token func_stack[64];
@@ -702,12 +964,15 @@ int ExpressionCompiler::compile(const char* src,
 								*(bool*)out = bool_const_value;
 								out += sizeof(bool);
 							}
-							*out = Instruction::PUSH_FLOAT;
-							type_stack[type_stack_idx] = Types::FLOAT;
-							++type_stack_idx;
-							++out;
-							*(float*)out = float_const_value;
-							out += sizeof(float);
+							else
+							{
+								*out = Instruction::PUSH_FLOAT;
+								type_stack[type_stack_idx] = Types::FLOAT;
+								++type_stack_idx;
+								++out;
+								*(float*)out = float_const_value;
+								out += sizeof(float);
+							}
 						}
 					}
 				}
@@ -849,19 +1114,137 @@ int ExpressionCompiler::tokenize(const char* src, Token* tokens, int max_size)
 }
 
 
+static const u16 FINISHING_FUNCTION = 4;
+
+
+static const u8* matchTest(const u8* cp, const u8* end, Condition::Test* test)
+{
+	test->i_value = 0;
+	if (end - cp >= 1 + (int)sizeof(int) && cp[0] == Instruction::INPUT_BOOL)
+	{
+		test->offset = *(int*)(cp + 1);
+		cp += 1 + sizeof(int);
+		bool is_negated = cp < end && *cp == Instruction::NOT;
+		test->type = is_negated ? Condition::Test::BOOL_FALSE : Condition::Test::BOOL_TRUE;
+		return is_negated ? cp + 1 : cp;
+	}
+	if (end - cp >= 1 + (int)sizeof(u16) && cp[0] == Instruction::CALL && *(u16*)(cp + 1) == FINISHING_FUNCTION)
+	{
+		test->type = Condition::Test::FINISHING;
+		test->offset = 0;
+		return cp + 1 + sizeof(u16);
+	}
+
+	// input and constant in any order followed by a comparison, all operands are 4 bytes
+	static const int COMPARISON_SIZE = 2 * (1 + sizeof(int)) + 1;
+	if (end - cp < COMPARISON_SIZE) return nullptr;
+	bool is_swapped = cp[0] == Instruction::PUSH_FLOAT || cp[0] == Instruction::PUSH_INT;
+	const u8* input = is_swapped ? cp + 1 + sizeof(int) : cp;
+	const u8* constant = is_swapped ? cp : cp + 1 + sizeof(int);
+	u8 op = cp[COMPARISON_SIZE - 1];
+	if (input[0] == Instruction::INPUT_FLOAT && constant[0] == Instruction::PUSH_FLOAT &&
+		(op == Instruction::FLOAT_LT || op == Instruction::FLOAT_GT))
+	{
+		test->offset = *(int*)(input + 1);
+		test->f_value = *(float*)(constant + 1);
+		bool is_less = (op == Instruction::FLOAT_LT) != is_swapped;
+		test->type = is_less ? Condition::Test::FLOAT_LESS : Condition::Test::FLOAT_GREATER;
+		return cp + COMPARISON_SIZE;
+	}
+	if (input[0] == Instruction::INPUT_INT && constant[0] == Instruction::PUSH_INT &&
+		(op == Instruction::INT_EQ || op == Instruction::INT_NEQ))
+	{
+		test->offset = *(int*)(input + 1);
+		test->i_value = *(int*)(constant + 1);
+		test->type = op == Instruction::INT_EQ ? Condition::Test::INT_EQUAL : Condition::Test::INT_NOT_EQUAL;
+		return cp + COMPARISON_SIZE;
+	}
+	return nullptr;
+}
+
+
+static LUMIX_FORCE_INLINE bool evaluateTest(const Condition::Test& test, RunningContext& rc)
+{
+	switch (test.type)
+	{
+		case Condition::Test::BOOL_TRUE: return *(bool*)(rc.input + test.offset);
+		case Condition::Test::BOOL_FALSE: return !*(bool*)(rc.input + test.offset);
+		case Condition::Test::FLOAT_LESS: return *(float*)(rc.input + test.offset) < test.f_value;
+		case Condition::Test::FLOAT_GREATER: return *(float*)(rc.input + test.offset) > test.f_value;
+		case Condition::Test::INT_EQUAL: return *(int*)(rc.input + test.offset) == test.i_value;
+		case Condition::Test::INT_NOT_EQUAL: return *(int*)(rc.input + test.offset) != test.i_value;
+		case Condition::Test::FINISHING:
+			return rc.current->getTime() > rc.current->getLength() - rc.edge->length;
+	}
+	ASSERT(false);
+	return false;
+}
+
+
 Condition::Condition(IAllocator& allocator)
 	: bytecode(allocator)
+	, fast_path(FastPath::NONE)
+	, constant(false)
 {}
 
 
 bool Condition::operator()(RunningContext& rc)
 {
+	switch (fast_path)
+	{
+		case FastPath::CONSTANT: return constant;
+		case FastPath::TEST: return evaluateTest(tests[0], rc);
+		case FastPath::AND: return evaluateTest(tests[0], rc) && evaluateTest(tests[1], rc);
+		case FastPath::OR: return evaluateTest(tests[0], rc) || evaluateTest(tests[1], rc);
+		case FastPath::NONE: break;
+	}
 	ExpressionVM vm;
 	auto ret = vm.evaluate(&bytecode[0], rc);
 	return ret.b_value;
 }
 
 
+void Condition::optimize()
+{
+	fast_path = FastPath::NONE;
+	if (bytecode.empty()) return;
+
+	// fold fails half way on malformed code, keep the original then
+	Array<u8> folded(bytecode);
+	ExpressionOptimizer optimizer(&folded[0]);
+	int size = optimizer.fold(folded.size());
+	if (size > 0)
+	{
+		folded.resize(size);
+		bytecode.swap(folded);
+	}
+
+	const u8* cp = &bytecode[0];
+	const u8* end = cp + bytecode.size() - 1;
+	if (*end != Instruction::RET_BOOL) return;
+
+	if (end - cp == 1 + sizeof(bool) && cp[0] == Instruction::PUSH_BOOL)
+	{
+		constant = *(bool*)(cp + 1);
+		fast_path = FastPath::CONSTANT;
+		return;
+	}
+
+	cp = matchTest(cp, end, &tests[0]);
+	if (!cp) return;
+	if (cp == end)
+	{
+		fast_path = FastPath::TEST;
+		return;
+	}
+
+	cp = matchTest(cp, end, &tests[1]);
+	if (!cp || end - cp != 1) return;
+	if (*cp == Instruction::AND) fast_path = FastPath::AND;
+	else if (*cp == Instruction::OR) fast_path = FastPath::OR;
+}
+
+
 bool Condition::compile(const char* expression, InputDecl& decl)
 {
 	ExpressionCompiler compiler;
@@ -887,6 +1270,7 @@ bool Condition::compile(const char* expression, InputDecl& decl)
 		return false;
 	}
 	bytecode.resize(size);
+	optimize();
 	return true;
 }
 
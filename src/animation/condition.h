@@ -156,12 +156,49 @@ struct InputDecl
 
 struct Condition
 {
+	struct Test
+	{
+		enum Type : u8
+		{
+			BOOL_TRUE,
+			BOOL_FALSE,
+			FLOAT_LESS,
+			FLOAT_GREATER,
+			INT_EQUAL,
+			INT_NOT_EQUAL,
+			FINISHING
+		};
+
+		Type type;
+		int offset;
+		union
+		{
+			float f_value;
+			int i_value;
+		};
+	};
+
+	enum class FastPath : u8
+	{
+		NONE,
+		CONSTANT,
+		TEST,
+		AND,
+		OR
+	};
+
 	Condition(IAllocator& allocator);
 
 	bool operator()(RunningContext& rc);
 	bool compile(const char* expression, InputDecl& decl);
+	// folds constants in bytecode and picks a closed-form evaluator for common shapes,
+	// must be called whenever bytecode changes
+	void optimize();
 
 	Array<u8> bytecode;
+	FastPath fast_path;
+	bool constant;
+	Test tests[2];
 };
 
 
@@ -29,6 +29,7 @@ struct Header
 ControllerResource::ControllerResource(const Path& path, ResourceManagerBase& resource_manager, IAllocator& allocator)
 	: Resource(path, resource_manager, allocator)
 	, m_root(nullptr)
+	, m_is_streamed(false)
 	, m_allocator(allocator)
 	, m_animation_set(allocator)
 	, m_sets_names(allocator)
@@ -48,7 +49,7 @@ void ControllerResource::clearAnimationSets()
 	{
 		if (!entry.animation) continue;
 
-		removeDependency(*entry.animation);
+		if (entry.has_dependency) removeDependency(*entry.animation);
 		entry.animation->getResourceManager().unload(*entry.animation);
 	}
 	m_animation_set.clear();
@@ -120,6 +121,8 @@ bool ControllerResource::deserialize(InputBlob& blob)
 	clearAnimationSets();
 	auto* manager = m_resource_manager.getOwner().get(ANIMATION_TYPE);
 
+	m_is_streamed = false;
+	if (header.version > (int)Version::STREAMED_ANIMATIONS) blob.read(m_is_streamed);
 	int count = blob.read<int>();
 	m_animation_set.reserve(count);
 	for (int i = 0; i < count; ++i)
@@ -129,6 +132,11 @@ bool ControllerResource::deserialize(InputBlob& blob)
 		u32 key = blob.read<u32>();
 		char path[MAX_PATH_LENGTH];
 		blob.readString(path, lengthOf(path));
+		if (m_is_streamed)
+		{
+			m_animation_set.push({set, key, nullptr, Path(path), 0, false});
+			continue;
+		}
 		Animation* anim = path[0] ? (Animation*)manager->load(Path(path)) : nullptr;
 		addAnimation(set, key, anim);
 	}
@@ -183,12 +191,13 @@ void ControllerResource::serialize(OutputBlob& blob)
 		}
 
 	}
+	blob.write(m_is_streamed);
 	blob.write(m_animation_set.size());
 	for (AnimSetEntry& entry : m_animation_set)
 	{
 		blob.write(entry.set);
 		blob.write(entry.hash);
-		blob.writeString(entry.animation ? entry.animation->getPath().c_str() : "");
+		blob.writeString(entry.animation ? entry.animation->getPath().c_str() : entry.path.c_str());
 	}
 	blob.write(m_sets_names.size());
 	for (const StaticString<32>& name : m_sets_names)
@@ -200,11 +209,51 @@ void ControllerResource::serialize(OutputBlob& blob)
 
 void ControllerResource::addAnimation(int set, u32 hash, Animation* animation)
 {
-	m_animation_set.push({set, hash, animation});
+	m_animation_set.push({set, hash, animation, Path(), 0, animation != nullptr});
 	if(animation) addDependency(*animation);
 }
 
 
+Animation* ControllerResource::requestAnimation(int entry_idx, u32 frame)
+{
+	AnimSetEntry& entry = m_animation_set[entry_idx];
+	entry.last_used_frame = frame;
+	if (!entry.animation && entry.path.isValid())
+	{
+		auto* manager = m_resource_manager.getOwner().get(ANIMATION_TYPE);
+		entry.animation = (Animation*)manager->load(entry.path);
+	}
+	return entry.animation;
+}
+
+
+void ControllerResource::evictAnimation(int entry_idx)
+{
+	AnimSetEntry& entry = m_animation_set[entry_idx];
+	if (!entry.animation) return;
+
+	entry.path = entry.animation->getPath();
+	if (entry.has_dependency) removeDependency(*entry.animation);
+	entry.has_dependency = false;
+	entry.animation->getResourceManager().unload(*entry.animation);
+	entry.animation = nullptr;
+}
+
+
+void ControllerResource::setAnimation(int entry_idx, Animation* animation)
+{
+	AnimSetEntry& entry = m_animation_set[entry_idx];
+	if (entry.animation)
+	{
+		if (entry.has_dependency) removeDependency(*entry.animation);
+		entry.animation->getResourceManager().unload(*entry.animation);
+	}
+	entry.animation = animation;
+	entry.path = Path();
+	entry.has_dependency = false;
+}
+
+
 ComponentInstance* ControllerResource::createInstance(IAllocator& allocator)
 {
 	return m_root ? m_root->createInstance(allocator) : nullptr;
@@ -42,6 +42,7 @@ public:
 		ANIMATION_SETS,
 		MAX_ROOT_ROTATION_SPEED,
 		INPUT_REFACTOR,
+		STREAMED_ANIMATIONS,
 
 		LAST
 	};
@@ -58,18 +59,29 @@ public:
 	bool deserialize(InputBlob& blob);
 	IAllocator& getAllocator() { return m_allocator; }
 	void addAnimation(int set, u32 hash, Animation* animation);
+	// streamed resources load animations only when requested, returns null for empty slots
+	Animation* requestAnimation(int entry_idx, u32 frame);
+	void evictAnimation(int entry_idx);
+	// replaces the animation of the entry, the new animation is not a dependency
+	void setAnimation(int entry_idx, Animation* animation);
 
 	struct AnimSetEntry
 	{
 		int set;
 		u32 hash;
 		Animation* animation;
+		// path of the animation if it is not loaded
+		Path path;
+		u32 last_used_frame;
+		// streamed entries and entries loaded on demand are not dependencies of the controller
+		bool has_dependency;
 	};
 
 	Array<AnimSetEntry> m_animation_set;
 	Array<StaticString<32>> m_sets_names;
 	InputDecl m_input_decl;
 	Component* m_root;
+	bool m_is_streamed;
 
 private:
 	void clearAnimationSets();
@@ -747,6 +747,7 @@ void AnimationEditor::animationSlotsGUI()
 	auto& engine_anim_set = m_resource->getEngineResource()->m_animation_set;
 	auto& slots = m_resource->getAnimationSlots();
 	auto& sets = m_resource->getEngineResource()->m_sets_names;
+	ImGui::Checkbox("Stream animations", &m_resource->getEngineResource()->m_is_streamed);
 	ImGui::PushItemWidth(-1);
 	ImGui::Columns(sets.size() + 1);
 	ImGui::NextColumn();
@@ -803,26 +804,30 @@ void AnimationEditor::animationSlotsGUI()
 		for (int j = 0; j < sets.size(); ++j)
 		{
 			Anim::ControllerResource::AnimSetEntry* entry = nullptr;
-			for (auto& e : engine_anim_set)
+			int entry_idx = -1;
+			for (int k = 0; k < engine_anim_set.size(); ++k)
 			{
+				auto& e = engine_anim_set[k];
 				if (e.set == j && e.hash == slot_hash) 
 				{
 					entry = &e;
+					entry_idx = k;
 					break;
 				}
 			}
 
 			ImGui::PushItemWidth(ImGui::GetColumnWidth());
 			char tmp[MAX_PATH_LENGTH];
-			copyString(tmp, entry && entry->animation ? entry->animation->getPath().c_str() : "");
+			const char* path = "";
+			if (entry) path = entry->animation ? entry->animation->getPath().c_str() : entry->path.c_str();
+			copyString(tmp, path);
 			ImGui::PushID(j);
 			if (m_app.getAssetBrowser()->resourceInput("", "##res", tmp, lengthOf(tmp), ANIMATION_TYPE))
 			{
-				if (entry && entry->animation) entry->animation->getResourceManager().unload(*entry->animation);
 				auto* manager = m_app.getWorldEditor()->getEngine().getResourceManager().get(ANIMATION_TYPE);
 				if (entry)
 				{
-					entry->animation = (Animation*)manager->load(Path(tmp));
+					m_resource->getEngineResource()->setAnimation(entry_idx, (Animation*)manager->load(Path(tmp)));
 				}
 				else
 				{
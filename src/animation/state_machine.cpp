@@ -35,6 +35,46 @@ void Component::deserialize(InputBlob& blob, Container* parent, int version)
 }
 
 
+void ComponentInstance::getReachableAnimations(int depth, Array<u32>& hashes) const
+{
+	Anim::getReachableAnimations(source, depth, hashes);
+}
+
+
+void getReachableAnimations(const Component& component, int depth, Array<u32>& hashes)
+{
+	switch (component.type)
+	{
+		case Component::SIMPLE_ANIMATION:
+			for (u32 hash : ((const AnimationNode&)component).animations_hashes)
+			{
+				if (hashes.indexOf(hash) < 0) hashes.push(hash);
+			}
+			break;
+		case Component::BLEND1D:
+			for (const Blend1DNode::Item& item : ((const Blend1DNode&)component).items)
+			{
+				if (item.node) getReachableAnimations(*item.node, depth, hashes);
+			}
+			break;
+		case Component::STATE_MACHINE:
+			// entering a state machine enters one of its entries in the same transition
+			for (const StateMachine::Entry& entry : ((const StateMachine&)component).entries)
+			{
+				if (entry.node) getReachableAnimations(*entry.node, depth, hashes);
+			}
+			break;
+		case Component::EDGE: return;
+	}
+
+	if (depth <= 0) return;
+	for (const Edge* edge : ((const Node&)component).out_edges)
+	{
+		if (edge->to) getReachableAnimations(*edge->to, depth - 1, hashes);
+	}
+}
+
+
 struct EdgeInstance : public ComponentInstance
 {
 	EdgeInstance(Edge& _edge, IAllocator& _allocator)
@@ -62,6 +102,13 @@ struct EdgeInstance : public ComponentInstance
 	}
 
 
+	void getReachableAnimations(int depth, Array<u32>& hashes) const override
+	{
+		from->getReachableAnimations(depth, hashes);
+		to->getReachableAnimations(depth, hashes);
+	}
+
+
 	Transform getRootMotion() const override
 	{
 		return from->getRootMotion().interpolate(to->getRootMotion(), time / edge.length);
@@ -84,10 +131,10 @@ struct EdgeInstance : public ComponentInstance
 	}
 
 
-	void fillPose(Engine& engine, Pose& pose, Model& model, float weight) override
+	void fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth) override
 	{
-		from->fillPose(engine, pose, model, weight);
-		to->fillPose(engine, pose, model, weight * time / edge.length);
+		from->fillPose(engine, pose, model, weight, pose_cache, bone_depth);
+		to->fillPose(engine, pose, model, weight * time / edge.length, pose_cache, bone_depth);
 	}
 
 
@@ -151,6 +198,7 @@ void Edge::deserialize(InputBlob& blob, Container* parent, int version)
 	blob.read(size);
 	condition.bytecode.resize(size);
 	if(size > 0) blob.read(&condition.bytecode[0], size);
+	condition.optimize();
 	from->out_edges.push(this);
 }
 
@@ -206,11 +254,11 @@ Blend1DNodeInstance::Blend1DNodeInstance(Blend1DNode& _node)
 }
 
 
-void Blend1DNodeInstance::fillPose(Engine& engine, Pose& pose, Model& model, float weight)
+void Blend1DNodeInstance::fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth)
 {
 	if (!a0 || !a1) return;
-	a0->fillPose(engine, pose, model, weight);
-	a1->fillPose(engine, pose, model, weight * current_weight);
+	a0->fillPose(engine, pose, model, weight, pose_cache, bone_depth);
+	a1->fillPose(engine, pose, model, weight * current_weight, pose_cache, bone_depth);
 }
 
 
@@ -431,10 +479,12 @@ ComponentInstance* NodeInstance::checkOutEdges(Node& node, RunningContext& rc)
 
 struct AnimationNodeInstance : public NodeInstance
 {
-	AnimationNodeInstance(AnimationNode& _node)
+	AnimationNodeInstance(AnimationNode& _node, IAllocator& allocator)
 		: NodeInstance(_node)
 		, node(_node)
 		, resource(nullptr)
+		, animation_hash(0)
+		, cursor(allocator)
 	{
 		root_motion.pos = { 0, 0, 0};
 		root_motion.rot = { 0, 0, 0, 1 };
@@ -449,7 +499,8 @@ struct AnimationNodeInstance : public NodeInstance
 		time = 0;
 		if (node.animations_hashes.empty()) return;
 		int idx = Math::rand() % node.animations_hashes.size();
-		auto iter = anim_set.find(node.animations_hashes[idx]);
+		animation_hash = node.animations_hashes[idx];
+		auto iter = anim_set.find(animation_hash);
 		resource = iter.isValid() ? iter.value() : nullptr;
 	}
 
@@ -458,23 +509,44 @@ struct AnimationNodeInstance : public NodeInstance
 	float getLength() const override { return resource ? resource->getLength() : 0; }
 
 
-	void fillPose(Engine& engine, Pose& pose, Model& model, float weight) override
+	void fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth) override
 	{
-		if (!resource) return;
-		if (weight < 1)
+		if (!resource || !model.isReady()) return;
+		const int* bone_remap = resource->getBoneRemap(model, bone_depth);
+		if (!bone_remap) return;
+		if (pose_cache)
+		{
+			if (weight < 1)
+			{
+				pose_cache->getRelativePose(*resource, time, pose, bone_remap, weight);
+			}
+			else if (weight > 0)
+			{
+				pose_cache->getRelativePose(*resource, time, pose, bone_remap);
+			}
+		}
+		else if (weight < 1)
 		{
-			resource->getRelativePose(time, pose, model, weight);
+			resource->getRelativePose(time, pose, bone_remap, weight, &cursor);
 		}
 		else if (weight > 0)
 		{
-			resource->getRelativePose(time, pose, model);
+			resource->getRelativePose(time, pose, bone_remap, &cursor);
 		}
 	}
 
 
 	ComponentInstance* update(RunningContext& rc, bool check_edges) override
 	{
-		if (!resource) return check_edges ? checkOutEdges(node, rc) : this;
+		if (!resource && !node.animations_hashes.empty())
+		{
+			// streamed animations may be requested after the state is entered
+			auto iter = rc.anim_set->find(animation_hash);
+			resource = iter.isValid() ? iter.value() : nullptr;
+		}
+		// wait until a streamed animation is loaded
+		if (resource && resource->isEmpty()) return this;
+		if (!resource || !resource->isReady()) return check_edges ? checkOutEdges(node, rc) : this;
 
 		float old_time = time;
 		time += rc.time_delta;
@@ -485,7 +557,8 @@ struct AnimationNodeInstance : public NodeInstance
 			if (node.new_on_loop && !node.animations_hashes.empty())
 			{
 				int idx = Math::rand() % node.animations_hashes.size();
-				resource = (*rc.anim_set)[node.animations_hashes[idx]];
+				animation_hash = node.animations_hashes[idx];
+				resource = (*rc.anim_set)[animation_hash];
 			}
 		}
 
@@ -536,21 +609,24 @@ struct AnimationNodeInstance : public NodeInstance
 		time = 0;
 		if (node.animations_hashes.empty()) return;
 		int idx = Math::rand() % node.animations_hashes.size();
-		auto iter = rc.anim_set->find(node.animations_hashes[idx]);
+		animation_hash = node.animations_hashes[idx];
+		auto iter = rc.anim_set->find(animation_hash);
 		resource = iter.isValid() ? iter.value() : nullptr;
 	}
 
 
 	Animation* resource;
+	u32 animation_hash;
 	AnimationNode& node;
 	Transform root_motion;
 	float time;
+	AnimationCursor cursor;
 };
 
 
 ComponentInstance* AnimationNode::createInstance(IAllocator& allocator)
 {
-	return LUMIX_NEW(allocator, AnimationNodeInstance)(*this);
+	return LUMIX_NEW(allocator, AnimationNodeInstance)(*this, allocator);
 }
 
 
@@ -581,6 +657,17 @@ void StateMachineInstance::onAnimationSetUpdated(AnimSet& anim_set)
 }
 
 
+void StateMachineInstance::getReachableAnimations(int depth, Array<u32>& hashes) const
+{
+	if (current) current->getReachableAnimations(depth, hashes);
+	if (depth <= 0) return;
+	for (const Edge* edge : source.out_edges)
+	{
+		if (edge->to) Anim::getReachableAnimations(*edge->to, depth - 1, hashes);
+	}
+}
+
+
 ComponentInstance* StateMachineInstance::update(RunningContext& rc, bool check_edges)
 {
 	float old_time = time;
@@ -591,9 +678,9 @@ ComponentInstance* StateMachineInstance::update(RunningContext& rc, bool check_e
 }
 
 
-void StateMachineInstance::fillPose(Engine& engine, Pose& pose, Model& model, float weight)
+void StateMachineInstance::fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth)
 {
-	if(current) current->fillPose(engine, pose, model, weight);
+	if(current) current->fillPose(engine, pose, model, weight, pose_cache, bone_depth);
 }
 
 
@@ -661,6 +748,7 @@ void StateMachine::deserialize(InputBlob& blob, Container* parent, int version)
 		{
 			blob.read(&entry.condition.bytecode[0], size);
 		}
+		entry.condition.optimize();
 	}
 }
 
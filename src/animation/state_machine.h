@@ -11,6 +11,7 @@ namespace Lumix
 
 
 class Animation;
+class AnimationPoseCache;
 struct AnimationSystem;
 class Engine;
 class InputBlob;
@@ -40,11 +41,14 @@ struct ComponentInstance
 	virtual ~ComponentInstance() {}
 	virtual ComponentInstance* update(RunningContext& rc, bool check_edges) = 0;
 	virtual Transform getRootMotion() const = 0;
-	virtual void fillPose(Engine& engine, Pose& pose, Model& model, float weight) = 0;
+	// bones deeper than bone_depth keep their pose, 0 samples all bones
+	virtual void fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth) = 0;
 	virtual void enter(RunningContext& rc, ComponentInstance* from) = 0;
 	virtual float getTime() const = 0;
 	virtual float getLength() const = 0;
 	virtual void onAnimationSetUpdated(AnimSet& anim_set) = 0;
+	// animations of active states and of states reachable from them within depth transitions
+	virtual void getReachableAnimations(int depth, Array<u32>& hashes) const;
 
 	Component& source;
 };
@@ -148,7 +152,7 @@ struct Blend1DNodeInstance : public NodeInstance
 	Transform getRootMotion() const override;
 	float getTime() const override { return time; }
 	float getLength() const override { return a0 ? a0->getLength() : 0; }
-	void fillPose(Engine& engine, Pose& pose, Model& model, float weight) override;
+	void fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth) override;
 	ComponentInstance* update(RunningContext& rc, bool check_edges) override;
 	void enter(RunningContext& rc, ComponentInstance* from) override;
 	void onAnimationSetUpdated(AnimSet& anim_set) override;
@@ -187,12 +191,13 @@ struct StateMachineInstance : public NodeInstance
 	~StateMachineInstance();
 
 	ComponentInstance* update(RunningContext& rc, bool check_edges) override;
-	void fillPose(Engine& engine, Pose& pose, Model& model, float weight) override;
+	void fillPose(Engine& engine, Pose& pose, Model& model, float weight, AnimationPoseCache* pose_cache, int bone_depth) override;
 	void enter(RunningContext& rc, ComponentInstance* from) override;
 	float getTime() const override { return current ? current->getTime() : 0; }
 	float getLength() const override { return current ? current->getLength() : 0; }
 	Transform getRootMotion() const override;
 	void onAnimationSetUpdated(AnimSet& anim_set) override;
+	void getReachableAnimations(int depth, Array<u32>& hashes) const override;
 
 	StateMachine& source;
 	ComponentInstance* current;
@@ -221,6 +226,8 @@ struct StateMachine : public Container
 
 
 Component* createComponent(Component::Type type, IAllocator& allocator);
+// animations of the component and of states reachable from it within depth transitions
+void getReachableAnimations(const Component& component, int depth, Array<u32>& hashes);
 
 
 } // namespace Anim
@@ -14,6 +14,7 @@
 #include "engine/profiler.h"
 #include "engine/resource_manager.h"
 #include "engine/resource_manager_base.h"
+#include "engine/resource_manifest.h"
 #include "engine/system.h"
 #include "engine/timer.h"
 #include "engine/debug/debug.h"
@@ -25,6 +26,7 @@
 #include "renderer/renderer.h"
 #include "renderer/texture.h"
 #include "engine/universe/universe.h"
+#include "engine/universe_saver.h"
 #include <cstdio>
 #include <X11/Xlib.h>
 
@@ -36,6 +38,7 @@ namespace Lumix
 struct App
 {
 	App()
+		: m_preload_manifest(m_allocator)
 	{
 		m_universe = nullptr;
 		m_exit_code = 0;
@@ -230,34 +233,48 @@ struct App
 		if (!success) return;
 
 		ASSERT(file.getBuffer());
-		InputBlob blob(file.getBuffer(), (int)file.size());
-		#pragma pack(1)
-			struct Header
-			{
-				u32 magic;
-				int version;
-				u32 hash;
-				u32 engine_hash;
-			};
-		#pragma pack()
-		Header header;
-		blob.read(header);
-		if (crc32((const u8*)blob.getData() + sizeof(header), blob.getSize() - sizeof(header)) !=
-			header.hash)
+		Array<u8> storage(m_allocator);
+		int payload_size = 0;
+		const u8* payload = UniverseSaver::unpack(file.getBuffer(), (int)file.size(), storage, &payload_size);
+		if (!payload)
 		{
 			g_log_error.log("App") << "Universe corrupted";
 			return;
 		}
+		InputBlob blob(payload, payload_size);
 		bool deserialize_succeeded = m_engine->deserialize(*m_universe, blob);
 		if (!deserialize_succeeded)
 		{
 			g_log_error.log("App") << "Failed to deserialize universe";
 		}
+		m_preload_manifest.releasePreloaded();
+	}
+
+
+	void preloadResources(const char* universe_path)
+	{
+		char manifest_path[MAX_PATH_LENGTH];
+		ResourceManifest::getPath(manifest_path, lengthOf(manifest_path), universe_path);
+		auto& fs = m_engine->getFileSystem();
+		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path(manifest_path), FS::Mode::OPEN_AND_READ);
+		if (!file) return;
+
+		OutputBlob data(m_allocator);
+		file->getContents(data);
+		fs.close(*file);
+
+		m_preload_manifest.releasePreloaded();
+		InputBlob blob(data);
+		if (m_preload_manifest.deserialize(blob))
+		{
+			m_preload_manifest.preload(m_engine->getResourceManager());
+		}
 	}
 
 
 	void loadUniverse(const char* path)
 	{
+		preloadResources(path);
 		auto& fs = m_engine->getFileSystem();
 		FS::ReadCallback file_read_cb;
 		file_read_cb.bind<App, &App::universeFileLoaded>(this);
@@ -267,6 +284,7 @@ struct App
 
 	void shutdown()
 	{
+		m_preload_manifest.releasePreloaded();
 		m_engine->destroyUniverse(*m_universe);
 		FS::FileSystem::destroy(m_file_system);
 		LUMIX_DELETE(m_allocator, m_disk_file_device);
@@ -370,6 +388,7 @@ private:
 	FS::DiskFileDevice* m_disk_file_device;
 	FS::PackFileDevice* m_pack_file_device;
 	Timer* m_frame_timer;
+	ResourceManifest m_preload_manifest;
 	bool m_finished;
 	int m_exit_code;
 	char m_startup_script_path[MAX_PATH_LENGTH];
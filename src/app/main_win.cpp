@@ -17,9 +17,11 @@
 #include "engine/profiler.h"
 #include "engine/resource_manager.h"
 #include "engine/resource_manager_base.h"
+#include "engine/resource_manifest.h"
 #include "engine/system.h"
 #include "engine/timer.h"
 #include "engine/universe/universe.h"
+#include "engine/universe_saver.h"
 #include "gui/gui_system.h"
 #include "renderer/pipeline.h"
 #include "renderer/renderer.h"
@@ -70,6 +72,7 @@ public:
 		, m_exit_code(0)
 		, m_pipeline(nullptr)
 		, m_finished(false)
+		, m_preload_manifest(m_allocator)
 	{
 		m_frame_timer = Timer::create(m_allocator);
 		ASSERT(!s_instance);
@@ -339,23 +342,15 @@ public:
 		}
 
 		ASSERT(file.getBuffer());
-		InputBlob blob(file.getBuffer(), (int)file.size());
-		#pragma pack(1)
-			struct Header
-			{
-				u32 magic;
-				int version;
-				u32 hash;
-				u32 engine_hash;
-			};
-		#pragma pack()
-		Header header;
-		blob.read(header);
-		if (crc32((const u8*)blob.getData() + sizeof(header), blob.getSize() - sizeof(header)) != header.hash)
+		Array<u8> storage(m_allocator);
+		int payload_size = 0;
+		const u8* payload = UniverseSaver::unpack(file.getBuffer(), (int)file.size(), storage, &payload_size);
+		if (!payload)
 		{
 			g_log_error.log("App") << "Universe corrupted";
 			return;
 		}
+		InputBlob blob(payload, payload_size);
 		m_engine->destroyUniverse(*m_universe);
 		m_universe = &m_engine->createUniverse(true);
 		char basename[MAX_PATH_LENGTH];
@@ -368,6 +363,7 @@ public:
 		{
 			g_log_error.log("App") << "Failed to deserialize universe";
 		}
+		m_preload_manifest.releasePreloaded();
 	}
 
 
@@ -381,9 +377,31 @@ public:
 	}
 
 
+	void preloadResources(const char* universe_path)
+	{
+		char manifest_path[MAX_PATH_LENGTH];
+		ResourceManifest::getPath(manifest_path, lengthOf(manifest_path), universe_path);
+		auto& fs = m_engine->getFileSystem();
+		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path(manifest_path), FS::Mode::OPEN_AND_READ);
+		if (!file) return;
+
+		OutputBlob data(m_allocator);
+		file->getContents(data);
+		fs.close(*file);
+
+		m_preload_manifest.releasePreloaded();
+		InputBlob blob(data);
+		if (m_preload_manifest.deserialize(blob))
+		{
+			m_preload_manifest.preload(m_engine->getResourceManager());
+		}
+	}
+
+
 	void loadUniverse(const char* path)
 	{
 		copyString(m_universe_path, path);
+		preloadResources(m_universe_path);
 		auto& fs = m_engine->getFileSystem();
 		FS::ReadCallback file_read_cb;
 		file_read_cb.bind<App, &App::universeFileLoaded>(this);
@@ -393,6 +411,7 @@ public:
 
 	void shutdown()
 	{
+		m_preload_manifest.releasePreloaded();
 		auto* gui_system = static_cast<GUISystem*>(m_engine->getPluginManager().getPlugin("gui"));
 		gui_system->setInterface(nullptr);
 		LUMIX_DELETE(m_allocator, m_gui_interface);
@@ -518,6 +537,7 @@ private:
 	FS::PackFileDevice* m_pack_file_device;
 	Timer* m_frame_timer;
 	GUIInterface* m_gui_interface;
+	ResourceManifest m_preload_manifest;
 	bool m_finished;
 	bool m_window_mode;
 	int m_exit_code;
@@ -23,6 +23,7 @@ namespace Lumix
 
 
 static const u32 SOURCE_HASH = crc32("source");
+static const char* ASSET_DATABASE_FILENAME = "asset_database.bin";
 
 
 ResourceType AssetBrowser::getResourceType(const char* path) const
@@ -44,6 +45,7 @@ AssetBrowser::AssetBrowser(StudioApp& app)
 	: m_editor(*app.getWorldEditor())
 	, m_metadata(*app.getMetadata())
 	, m_resources(app.getWorldEditor()->getAllocator())
+	, m_database(app.getWorldEditor()->getAllocator())
 	, m_selected_resource(nullptr)
 	, m_autoreload_changed_resource(true)
 	, m_changed_files(app.getWorldEditor()->getAllocator())
@@ -64,6 +66,11 @@ AssetBrowser::AssetBrowser(StudioApp& app)
 	auto& allocator = editor.getAllocator();
 	m_filter[0] = '\0';
 	m_resources.emplace(allocator);
+	m_patch_base_path[0] = '\0';
+
+	m_database.getTypeResolver().bind<AssetBrowser, &AssetBrowser::resolveResourceType>(this);
+	m_database.getChangedCallback().bind<AssetBrowser, &AssetBrowser::onAssetChanged>(this);
+	m_database.load(ASSET_DATABASE_FILENAME);
 
 	const char* base_path = editor.getEngine().getDiskFileDevice()->getBasePath();
 	m_watchers[0] = FileSystemWatcher::create(base_path, allocator);
@@ -117,6 +124,8 @@ AssetBrowser::~AssetBrowser()
 
 	FileSystemWatcher::destroy(m_watchers[0]);
 	FileSystemWatcher::destroy(m_watchers[1]);
+
+	m_database.save(ASSET_DATABASE_FILENAME);
 }
 
 
@@ -165,6 +174,11 @@ void AssetBrowser::update()
 	{
 		findResources();
 	}
+	if (m_database.update())
+	{
+		fillResources();
+		m_database.save(ASSET_DATABASE_FILENAME);
+	}
 	if (!m_is_update_enabled) return;
 	bool is_empty;
 	{
@@ -208,15 +222,12 @@ void AssetBrowser::update()
 			{
 				int index = getTypeIndex(resource_type);
 				m_resources[index].eraseItemFast(path);
+				m_database.remove(path);
 				continue;
 			}
 		}
-
-		char dir[MAX_PATH_LENGTH];
-		char filename[MAX_PATH_LENGTH];
-		PathUtils::getDir(dir, sizeof(dir), path.c_str());
-		PathUtils::getFilename(filename, sizeof(filename), path.c_str());
-		addResource(dir, filename);
+		m_database.refresh(path, tmp_path);
+		addResource(path, resource_type);
 	}
 	m_changed_files.clear();
 }
@@ -341,7 +352,11 @@ void AssetBrowser::addPlugin(IPlugin& plugin)
 {
 	m_plugins.push(&plugin);
 	m_resources.emplace(m_editor.getAllocator());
-	if(m_is_init_finished) findResources();
+	if (m_is_init_finished)
+	{
+		m_database.resolveTypes();
+		fillResources();
+	}
 }
 
 
@@ -535,86 +550,74 @@ const Array<Path>& AssetBrowser::getResources(int type) const
 }
 
 
-int AssetBrowser::getResourceTypeIndex(const char* ext)
+static bool isIgnored(const Path& path)
 {
-	for (int i = 0; i < m_plugins.size(); ++i)
-	{
-		if (isValid(m_plugins[i]->getResourceType(ext))) return 1 + i;
-	}
-
-	return -1;
+	return startsWith(path.c_str(), "unit_tests/");
 }
 
 
-void AssetBrowser::addResource(const char* path, const char* filename)
+void AssetBrowser::addResource(const Path& path, ResourceType type)
 {
-	char ext[10];
-	PathUtils::getExtension(ext, sizeof(ext), filename);
-	makeLowercase(ext, lengthOf(ext), ext);
-
-	char fullpath[MAX_PATH_LENGTH];
-	copyString(fullpath, path);
-	catString(fullpath, "/");
-	catString(fullpath, filename);
-	
-	int index = getResourceTypeIndex(ext);
-
-	if (startsWith(path, "/unit_tests") != 0) return;
-	if (index < 0) return;
+	int index = getTypeIndex(type);
+	if (index <= 0 || isIgnored(path)) return;
 
-	Path path_obj(fullpath);
-	if (m_resources[index].indexOf(path_obj) == -1)
+	if (m_resources[index].indexOf(path) == -1)
 	{
-		m_resources[index].push(path_obj);
+		m_resources[index].push(path);
 	}
 }
 
 
-void AssetBrowser::processDir(const char* dir, int base_length)
+void AssetBrowser::onAssetChanged(const AssetDatabase::Asset& asset)
 {
-	auto* iter = PlatformInterface::createFileIterator(dir, m_editor.getAllocator());
-	PlatformInterface::FileInfo info;
-	while (getNextFile(iter, &info))
+	char source[MAX_PATH_LENGTH];
+	if (m_metadata.getString(asset.path.getHash(), SOURCE_HASH, source, lengthOf(source)))
 	{
-		if (info.filename[0] == '.') continue;
-
-		if (info.is_directory)
-		{
-			char child_path[MAX_PATH_LENGTH];
-			copyString(child_path, dir);
-			catString(child_path, "/");
-			catString(child_path, info.filename);
-			processDir(child_path, base_length);
-		}
-		else
-		{
-			addResource(dir + base_length, info.filename);
-		}
+		Path source_path(source);
+		m_database.setDependencies(asset.path, &source_path, 1);
 	}
-
-	destroyFileIterator(iter);
 }
 
 
-void AssetBrowser::findResources()
+void AssetBrowser::fillResources()
 {
+	PROFILE_FUNCTION();
 	for (auto& resources : m_resources)
 	{
 		resources.clear();
 	}
 
-	const char* base_path = m_editor.getEngine().getDiskFileDevice()->getBasePath();
-	processDir(base_path, stringLength(base_path));
+	for (int i = 0, c = m_database.getAssetCount(); i < c; ++i)
+	{
+		const AssetDatabase::Asset& asset = m_database.getAsset(i);
+		if (!isValid(asset.type) || isIgnored(asset.path)) continue;
+
+		int index = getTypeIndex(asset.type);
+		if (index > 0) m_resources[index].push(asset.path);
+	}
+}
+
+
+void AssetBrowser::findResources()
+{
+	const char* base_paths[2];
+	int base_paths_count = 0;
+	base_paths[base_paths_count++] = m_editor.getEngine().getDiskFileDevice()->getBasePath();
 	auto* patch_device = m_editor.getEngine().getPatchFileDevice();
 	if (patch_device)
 	{
-		processDir(patch_device->getBasePath(), stringLength(patch_device->getBasePath()));
+		base_paths[base_paths_count++] = patch_device->getBasePath();
 		copyString(m_patch_base_path, patch_device->getBasePath());
 	}
 	else
 	{
 		m_patch_base_path[0] = '\0';
 	}
+
+	// the stored database is shown until the background scan finishes
+	m_database.resolveTypes();
+	fillResources();
+	m_database.startScan(base_paths, base_paths_count);
 }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "editor/asset_database.h"
 #include "engine/array.h"
 #include "engine/delegate_list.h"
 #include "engine/path.h"
@@ -54,6 +55,7 @@ public:
 	void enableUpdate(bool enable) { m_is_update_enabled = enable; }
 	OnResourceChanged& resourceChanged() { return m_on_resource_changed; }
 	bool resourceList(char* buf, int max_size, ResourceType type, float height);
+	AssetDatabase& getDatabase() { return m_database; }
 
 public:
 	bool m_is_opened;
@@ -61,12 +63,12 @@ public:
 private:
 	void onFileChanged(const char* path);
 	void findResources();
-	void processDir(const char* path, int base_length);
-	void addResource(const char* path, const char* filename);
+	void fillResources();
+	void onAssetChanged(const AssetDatabase::Asset& asset);
+	void addResource(const Path& path, ResourceType type);
 	void onGUIResource();
 	void unloadResource();
 	void selectResource(Resource* resource, bool record_history);
-	int getResourceTypeIndex(const char* ext);
 	bool acceptExtension(const char* ext, ResourceType type);
 	void onToolbar();
 	void goBack();
@@ -75,6 +77,7 @@ private:
 	bool isAutoreload() const { return m_autoreload_changed_resource; }
 
 	ResourceType getResourceType(const char* path) const;
+	ResourceType resolveResourceType(const char* path) { return getResourceType(path); }
 
 private:
 	StudioApp& m_app;
@@ -86,6 +89,7 @@ private:
 	Array<IPlugin*> m_plugins;
 	MT::SpinMutex m_changed_files_mutex;
 	Array<Array<Path> > m_resources;
+	AssetDatabase m_database;
 	Resource* m_selected_resource;
 	WorldEditor& m_editor;
 	FileSystemWatcher* m_watchers[2];
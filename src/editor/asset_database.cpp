@@ -0,0 +1,494 @@
+#include "asset_database.h"
+#include "engine/blob.h"
+#include "engine/crc32.h"
+#include "engine/fs/os_file.h"
+#include "engine/log.h"
+#include "engine/math_utils.h"
+#include "engine/mt/task.h"
+#include "engine/path_utils.h"
+#include "engine/profiler.h"
+#include "engine/string.h"
+#include "platform_interface.h"
+#include <cstdlib>
+
+
+namespace Lumix
+{
+
+
+static const u32 ASSET_DATABASE_MAGIC = 0x41444254; // 'ADBT'
+static const int HASH_BUFFER_SIZE = 64 * 1024;
+
+
+enum class AssetDatabaseVersion : i32
+{
+	FIRST,
+
+	LATEST
+};
+
+
+static u32 getContentHash(const char* path, Array<u8>& buffer, IAllocator& allocator)
+{
+	FS::OsFile file;
+	if (!file.open(path, FS::Mode::OPEN_AND_READ, allocator)) return 0;
+
+	u32 hash = 0;
+	size_t size = file.size();
+	while (size > 0)
+	{
+		int chunk_size = (int)Math::minimum(size, (size_t)buffer.size());
+		if (!file.read(&buffer[0], chunk_size)) break;
+		hash = continueCrc32(hash, &buffer[0], chunk_size);
+		size -= chunk_size;
+	}
+	file.close();
+	return hash;
+}
+
+
+struct AssetScanTask LUMIX_FINAL : public MT::Task
+{
+	struct File
+	{
+		Path path;
+		u64 last_modified;
+		u32 content_hash;
+	};
+
+	struct KnownFile
+	{
+		u64 last_modified;
+		u32 content_hash;
+	};
+
+	explicit AssetScanTask(IAllocator& allocator)
+		: MT::Task(allocator)
+		, allocator(allocator)
+		, base_paths(allocator)
+		, known(allocator)
+		, seen(allocator)
+		, files(allocator)
+		, buffer(allocator)
+		, is_cancelled(false)
+	{
+		buffer.resize(HASH_BUFFER_SIZE);
+	}
+
+
+	int task() override
+	{
+		PROFILE_FUNCTION();
+		// later base paths override earlier ones, so they are scanned first and the overridden files are skipped
+		for (int i = base_paths.size() - 1; i >= 0; --i)
+		{
+			scanDir(base_paths[i], stringLength(base_paths[i]));
+		}
+		return 0;
+	}
+
+
+	void scanDir(const char* dir, int base_length)
+	{
+		auto* iter = PlatformInterface::createFileIterator(dir, allocator);
+		PlatformInterface::FileInfo info;
+		while (!is_cancelled && PlatformInterface::getNextFile(iter, &info))
+		{
+			if (info.filename[0] == '.') continue;
+
+			char child_path[MAX_PATH_LENGTH];
+			copyString(child_path, dir);
+			catString(child_path, "/");
+			catString(child_path, info.filename);
+			if (info.is_directory)
+			{
+				scanDir(child_path, base_length);
+				continue;
+			}
+
+			// relative to the base path without the leading slash, the same as file system watcher reports
+			const char* relative_path = child_path + base_length;
+			if (relative_path[0] == '/') ++relative_path;
+			Path path(relative_path);
+			if (seen.find(path.getHash()).isValid()) continue;
+			seen.insert(path.getHash(), true);
+
+			File& file = files.emplace();
+			file.path = path;
+			file.last_modified = PlatformInterface::getLastModified(child_path);
+			auto known_iter = known.find(path.getHash());
+			if (known_iter.isValid() && known_iter.value().last_modified == file.last_modified)
+			{
+				file.content_hash = known_iter.value().content_hash;
+			}
+			else
+			{
+				file.content_hash = getContentHash(child_path, buffer, allocator);
+			}
+		}
+		PlatformInterface::destroyFileIterator(iter);
+	}
+
+
+	IAllocator& allocator;
+	Array<StaticString<MAX_PATH_LENGTH>> base_paths;
+	HashMap<u32, KnownFile> known;
+	HashMap<u32, bool> seen;
+	Array<File> files;
+	Array<u8> buffer;
+	volatile bool is_cancelled;
+};
+
+
+// serialized size of an asset without its path
+static const int ASSET_FIXED_SIZE = sizeof(u32) + sizeof(u64) + sizeof(u32);
+
+
+static bool readPath(InputBlob& blob, char (&out)[MAX_PATH_LENGTH])
+{
+	i32 size;
+	if (!blob.read(&size, sizeof(size)) || size <= 0 || size > MAX_PATH_LENGTH) return false;
+	if (!blob.read(out, size)) return false;
+	return out[size - 1] == '\0';
+}
+
+
+AssetDatabase::AssetDatabase(IAllocator& allocator)
+	: m_allocator(allocator)
+	, m_assets(allocator)
+	, m_map(allocator)
+	, m_sorted(allocator)
+	, m_dependencies(allocator)
+	, m_scan_task(nullptr)
+	, m_is_sorted(false)
+{
+}
+
+
+AssetDatabase::~AssetDatabase()
+{
+	cancelScan();
+}
+
+
+void AssetDatabase::cancelScan()
+{
+	if (!m_scan_task) return;
+
+	m_scan_task->is_cancelled = true;
+	m_scan_task->destroy();
+	LUMIX_DELETE(m_allocator, m_scan_task);
+	m_scan_task = nullptr;
+}
+
+
+bool AssetDatabase::load(const char* path)
+{
+	PROFILE_FUNCTION();
+	FS::OsFile file;
+	if (!file.open(path, FS::Mode::OPEN_AND_READ, m_allocator)) return false;
+
+	Array<u8> data(m_allocator);
+	data.resize((int)file.size());
+	bool success = data.empty() || file.read(&data[0], data.size());
+	file.close();
+	if (!success || data.empty()) return false;
+
+	InputBlob blob(&data[0], data.size());
+	u32 magic;
+	i32 version;
+	if (!blob.read(&magic, sizeof(magic)) || magic != ASSET_DATABASE_MAGIC) return false;
+	if (!blob.read(&version, sizeof(version)) || version > (int)AssetDatabaseVersion::LATEST) return false;
+
+	m_assets.clear();
+	m_map.clear();
+	m_dependencies.clear();
+	m_is_sorted = false;
+
+	if (!loadAssets(blob))
+	{
+		// corrupted index, the next scan hashes all files again
+		g_log_warning.log("Editor") << path << " is corrupted, assets will be rescanned";
+		m_assets.clear();
+		m_map.clear();
+		m_dependencies.clear();
+		return false;
+	}
+	return true;
+}
+
+
+bool AssetDatabase::loadAssets(InputBlob& blob)
+{
+	// every entry takes at least its fixed part and a path size, so counts are bounded by the remaining data
+	int count;
+	if (!blob.read(&count, sizeof(count))) return false;
+	int remaining = blob.getSize() - blob.getPosition();
+	if (count < 0 || count > remaining / (ASSET_FIXED_SIZE + (int)sizeof(i32))) return false;
+
+	m_assets.reserve(count);
+	m_map.rehash(Math::nextPow2(count + 1));
+	char tmp[MAX_PATH_LENGTH];
+	for (int i = 0; i < count; ++i)
+	{
+		if (!readPath(blob, tmp)) return false;
+		Asset& asset = m_assets.emplace();
+		asset.path = tmp;
+		blob.read(asset.type.type);
+		blob.read(asset.last_modified);
+		if (!blob.read(&asset.content_hash, sizeof(asset.content_hash))) return false;
+		m_map.insert(asset.path.getHash(), i);
+	}
+
+	if (!blob.read(&count, sizeof(count))) return false;
+	remaining = blob.getSize() - blob.getPosition();
+	if (count < 0 || count > remaining / (int)(sizeof(u32) + sizeof(i32))) return false;
+	m_dependencies.reserve(count);
+	for (int i = 0; i < count; ++i)
+	{
+		u32 asset;
+		blob.read(asset);
+		if (!readPath(blob, tmp)) return false;
+		Dependency& dependency = m_dependencies.emplace();
+		dependency.asset = asset;
+		dependency.dependency = tmp;
+	}
+	return true;
+}
+
+
+bool AssetDatabase::save(const char* path)
+{
+	PROFILE_FUNCTION();
+	OutputBlob blob(m_allocator);
+	blob.reserve(m_assets.size() * 64 + 64);
+	blob.write(ASSET_DATABASE_MAGIC);
+	blob.write((i32)AssetDatabaseVersion::LATEST);
+	blob.write((i32)m_assets.size());
+	for (const Asset& asset : m_assets)
+	{
+		blob.writeString(asset.path.c_str());
+		blob.write(asset.type.type);
+		blob.write(asset.last_modified);
+		blob.write(asset.content_hash);
+	}
+	blob.write((i32)m_dependencies.size());
+	for (const Dependency& dependency : m_dependencies)
+	{
+		blob.write(dependency.asset);
+		blob.writeString(dependency.dependency.c_str());
+	}
+
+	FS::OsFile file;
+	if (!file.open(path, FS::Mode::CREATE_AND_WRITE, m_allocator)) return false;
+	bool success = file.write(blob.getData(), blob.getPos());
+	file.close();
+	return success;
+}
+
+
+void AssetDatabase::resolveTypes()
+{
+	PROFILE_FUNCTION();
+	for (Asset& asset : m_assets)
+	{
+		asset.type = m_type_resolver.isValid() ? m_type_resolver.invoke(asset.path.c_str()) : INVALID_RESOURCE_TYPE;
+	}
+}
+
+
+void AssetDatabase::startScan(const char* const* base_paths, int count)
+{
+	PROFILE_FUNCTION();
+	cancelScan();
+
+	m_scan_task = LUMIX_NEW(m_allocator, AssetScanTask)(m_allocator);
+	for (int i = 0; i < count; ++i)
+	{
+		m_scan_task->base_paths.emplace(base_paths[i]);
+	}
+	m_scan_task->known.rehash(Math::nextPow2(m_assets.size() + 1));
+	for (const Asset& asset : m_assets)
+	{
+		m_scan_task->known.insert(asset.path.getHash(), {asset.last_modified, asset.content_hash});
+	}
+	if (!m_scan_task->create("Asset Scan Task"))
+	{
+		g_log_error.log("Editor") << "Could not create asset scan task";
+		LUMIX_DELETE(m_allocator, m_scan_task);
+		m_scan_task = nullptr;
+	}
+}
+
+
+bool AssetDatabase::update()
+{
+	if (!m_scan_task || !m_scan_task->isFinished()) return false;
+
+	PROFILE_FUNCTION();
+	m_scan_task->destroy();
+	Array<bool> found(m_allocator);
+	found.resize(m_assets.size());
+	setMemory(found.empty() ? nullptr : &found[0], 0, found.size());
+	int old_count = m_assets.size();
+	for (const AssetScanTask::File& file : m_scan_task->files)
+	{
+		auto iter = m_map.find(file.path.getHash());
+		if (iter.isValid() && iter.value() < old_count) found[iter.value()] = true;
+		addAsset(file.path, file.last_modified, file.content_hash);
+	}
+	for (int i = old_count - 1; i >= 0; --i)
+	{
+		if (!found[i]) removeAsset(i);
+	}
+
+	LUMIX_DELETE(m_allocator, m_scan_task);
+	m_scan_task = nullptr;
+	return true;
+}
+
+
+void AssetDatabase::refresh(const Path& path, const char* full_path)
+{
+	u64 last_modified = PlatformInterface::getLastModified(full_path);
+	auto iter = m_map.find(path.getHash());
+	if (iter.isValid() && m_assets[iter.value()].last_modified == last_modified) return;
+
+	Array<u8> buffer(m_allocator);
+	buffer.resize(HASH_BUFFER_SIZE);
+	addAsset(path, last_modified, getContentHash(full_path, buffer, m_allocator));
+}
+
+
+void AssetDatabase::remove(const Path& path)
+{
+	auto iter = m_map.find(path.getHash());
+	if (iter.isValid()) removeAsset(iter.value());
+}
+
+
+void AssetDatabase::addAsset(const Path& path, u64 last_modified, u32 content_hash)
+{
+	auto iter = m_map.find(path.getHash());
+	if (iter.isValid())
+	{
+		Asset& asset = m_assets[iter.value()];
+		asset.last_modified = last_modified;
+		if (asset.content_hash == content_hash) return;
+
+		asset.content_hash = content_hash;
+		if (m_changed_callback.isValid()) m_changed_callback.invoke(asset);
+		return;
+	}
+
+	m_map.insert(path.getHash(), m_assets.size());
+	Asset& asset = m_assets.emplace();
+	asset.path = path;
+	asset.type = m_type_resolver.isValid() ? m_type_resolver.invoke(path.c_str()) : INVALID_RESOURCE_TYPE;
+	asset.last_modified = last_modified;
+	asset.content_hash = content_hash;
+	m_is_sorted = false;
+	if (m_changed_callback.isValid()) m_changed_callback.invoke(asset);
+}
+
+
+void AssetDatabase::removeAsset(int index)
+{
+	u32 hash = m_assets[index].path.getHash();
+	m_map.erase(hash);
+	m_assets.eraseFast(index);
+	if (index < m_assets.size()) m_map[m_assets[index].path.getHash()] = index;
+	m_dependencies.eraseItems([hash](const Dependency& dependency) { return dependency.asset == hash; });
+	m_is_sorted = false;
+}
+
+
+const AssetDatabase::Asset* AssetDatabase::getAsset(const Path& path) const
+{
+	auto iter = m_map.find(path.getHash());
+	return iter.isValid() ? &m_assets[iter.value()] : nullptr;
+}
+
+
+static int compareSortedAssets(const void* a, const void* b)
+{
+	return compareString(*(const char* const*)a, *(const char* const*)b);
+}
+
+
+void AssetDatabase::findAssets(ResourceType type, const char* prefix, Array<Path>& out)
+{
+	PROFILE_FUNCTION();
+	if (!m_is_sorted)
+	{
+		m_sorted.resize(m_assets.size());
+		for (int i = 0; i < m_assets.size(); ++i)
+		{
+			m_sorted[i].path = m_assets[i].path.c_str();
+			m_sorted[i].index = i;
+		}
+		if (!m_sorted.empty()) qsort(&m_sorted[0], m_sorted.size(), sizeof(m_sorted[0]), compareSortedAssets);
+		m_is_sorted = true;
+	}
+
+	char normalized[MAX_PATH_LENGTH];
+	PathUtils::normalize(prefix, normalized, lengthOf(normalized));
+
+	int begin = 0;
+	int end = m_sorted.size();
+	while (begin < end)
+	{
+		int mid = (begin + end) >> 1;
+		if (compareString(m_sorted[mid].path, normalized) < 0)
+		{
+			begin = mid + 1;
+		}
+		else
+		{
+			end = mid;
+		}
+	}
+
+	for (int i = begin; i < m_sorted.size() && startsWith(m_sorted[i].path, normalized); ++i)
+	{
+		const Asset& asset = m_assets[m_sorted[i].index];
+		if (!isValid(type) || asset.type == type) out.push(asset.path);
+	}
+}
+
+
+void AssetDatabase::setDependencies(const Path& path, const Path* dependencies, int count)
+{
+	u32 hash = path.getHash();
+	m_dependencies.eraseItems([hash](const Dependency& dependency) { return dependency.asset == hash; });
+	for (int i = 0; i < count; ++i)
+	{
+		Dependency& dependency = m_dependencies.emplace();
+		dependency.asset = hash;
+		dependency.dependency = dependencies[i];
+	}
+}
+
+
+void AssetDatabase::getDependencies(const Path& path, Array<Path>& out) const
+{
+	for (const Dependency& dependency : m_dependencies)
+	{
+		if (dependency.asset == path.getHash()) out.push(dependency.dependency);
+	}
+}
+
+
+void AssetDatabase::getDependents(const Path& path, Array<Path>& out) const
+{
+	for (const Dependency& dependency : m_dependencies)
+	{
+		if (dependency.dependency.getHash() != path.getHash()) continue;
+
+		auto iter = m_map.find(dependency.asset);
+		if (iter.isValid()) out.push(m_assets[iter.value()].path);
+	}
+}
+
+
+} // namespace Lumix
@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include "engine/array.h"
+#include "engine/delegate.h"
+#include "engine/hash_map.h"
+#include "engine/path.h"
+#include "engine/resource.h"
+
+
+namespace Lumix
+{
+
+
+struct AssetScanTask;
+class InputBlob;
+
+
+// Persistent index of files in the project. Loaded from disk at startup and reconciled with
+// the file system on a background thread; only files with a new mtime are hashed again.
+class LUMIX_EDITOR_API AssetDatabase
+{
+public:
+	struct Asset
+	{
+		Path path;
+		ResourceType type;
+		u64 last_modified;
+		u32 content_hash;
+	};
+
+	typedef Delegate<ResourceType(const char*)> TypeResolver;
+	typedef Delegate<void(const Asset&)> ChangedCallback;
+
+public:
+	explicit AssetDatabase(IAllocator& allocator);
+	~AssetDatabase();
+
+	bool load(const char* path);
+	bool save(const char* path);
+
+	TypeResolver& getTypeResolver() { return m_type_resolver; }
+	// called for new assets and assets with different content
+	ChangedCallback& getChangedCallback() { return m_changed_callback; }
+	void resolveTypes();
+
+	// files in later base paths override files with the same path in earlier ones
+	void startScan(const char* const* base_paths, int count);
+	bool isScanning() const { return m_scan_task != nullptr; }
+	// applies a finished scan, returns true if there was one
+	bool update();
+	// rereads one file after a change notification
+	void refresh(const Path& path, const char* full_path);
+	void remove(const Path& path);
+
+	int getAssetCount() const { return m_assets.size(); }
+	const Asset& getAsset(int index) const { return m_assets[index]; }
+	const Asset* getAsset(const Path& path) const;
+	// assets of the given type (any type if invalid) whose path starts with prefix
+	void findAssets(ResourceType type, const char* prefix, Array<Path>& out);
+
+	void setDependencies(const Path& path, const Path* dependencies, int count);
+	void getDependencies(const Path& path, Array<Path>& out) const;
+	void getDependents(const Path& path, Array<Path>& out) const;
+
+private:
+	struct SortedAsset
+	{
+		const char* path;
+		int index;
+	};
+
+	struct Dependency
+	{
+		u32 asset;
+		Path dependency;
+	};
+
+	bool loadAssets(InputBlob& blob);
+	void addAsset(const Path& path, u64 last_modified, u32 content_hash);
+	void removeAsset(int index);
+	void cancelScan();
+
+private:
+	IAllocator& m_allocator;
+	Array<Asset> m_assets;
+	HashMap<u32, int> m_map;
+	Array<SortedAsset> m_sorted;
+	Array<Dependency> m_dependencies;
+	TypeResolver m_type_resolver;
+	ChangedCallback m_changed_callback;
+	AssetScanTask* m_scan_task;
+	bool m_is_sorted;
+};
+
+
+} // namespace Lumix
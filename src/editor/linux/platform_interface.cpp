@@ -348,6 +348,7 @@ Lumix::u64 getLastModified(const char* file)
 {
 	struct stat tmp;
 	Lumix::u64 ret = 0;
+	if (stat(file, &tmp) != 0) return 0;
 	ret = tmp.st_mtim.tv_sec * 1000 + Lumix::u64(tmp.st_mtim.tv_nsec / 1000000);
 	return ret;
 }
@@ -34,10 +34,12 @@
 #include "engine/resource.h"
 #include "engine/resource_manager.h"
 #include "engine/resource_manager_base.h"
+#include "engine/resource_manifest.h"
 #include "engine/serializer.h"
 #include "engine/system.h"
 #include "engine/timer.h"
 #include "engine/universe/universe.h"
+#include "engine/universe_saver.h"
 #include "ieditor_command.h"
 #include "render_interface.h"
 
@@ -1741,6 +1743,7 @@ public:
 	void update() override
 	{
 		PROFILE_FUNCTION();
+		m_universe_saver.update();
 		updateGoTo();
 
 		if (!m_selected_entities.empty())
@@ -1973,12 +1976,17 @@ public:
 	{
 		g_log_info.log("Editor") << "Saving universe " << basename << "...";
 		
-		auto& fs = m_engine->getFileSystem();
+		while (m_engine->getFileSystem().hasWork()) m_engine->getFileSystem().updateAsyncTransactions();
+		ASSERT(m_universe);
+
 		StaticString<MAX_PATH_LENGTH> path("universes/", basename, ".unv");
-		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path(path), FS::Mode::CREATE_AND_WRITE);
-		save(*file);
-		fs.close(*file);
+		OutputBlob& blob = m_universe_saver.snapshot(*m_universe);
+		m_prefab_system->serialize(blob);
+		UniverseSaver::Callback callback;
+		callback.bind<WorldEditorImpl, &WorldEditorImpl::onUniverseSaved>(this);
+		m_universe_saver.saveAsync(Path(path), true, callback);
 
+		saveResourceManifest(basename);
 		serialize(basename);
 		m_is_universe_changed = false;
 
@@ -2272,26 +2280,21 @@ public:
 	}
 
 
+	void onUniverseSaved(const Path& path, bool success)
+	{
+		if (success) g_log_info.log("Editor") << "Universe saved to " << path;
+	}
+
+
 	void save(FS::IFile& file)
 	{
 		while (m_engine->getFileSystem().hasWork()) m_engine->getFileSystem().updateAsyncTransactions();
 
 		ASSERT(m_universe);
 
-		OutputBlob blob(m_allocator);
-		blob.reserve(64 * 1024);
-
-		Header header = {0xffffFFFF, (int)SerializedVersion::LATEST, 0, 0};
-		blob.write(header);
-		int hashed_offset = sizeof(header);
-
-		header.engine_hash = m_engine->serialize(*m_universe, blob);
+		OutputBlob& blob = m_universe_saver.snapshot(*m_universe);
 		m_prefab_system->serialize(blob);
-		header.hash = crc32((const u8*)blob.getData() + hashed_offset, blob.getPos() - hashed_offset);
-		*(Header*)blob.getData() = header;
-
-		g_log_info.log("editor") << "Universe saved";
-		file.write(blob.getData(), blob.getPos());
+		m_universe_saver.save(file);
 	}
 
 
@@ -2886,70 +2889,89 @@ public:
 		createUniverse();
 		m_universe->setName(basename);
 		g_log_info.log("Editor") << "Loading universe " << basename << "...";
+		ResourceManifest preload_manifest(m_allocator);
+		preloadResources(basename, preload_manifest);
 		deserialize(basename);
+		preload_manifest.releasePreloaded();
 		m_editor_icons->refresh();
 	}
 
 
-	void newUniverse() override
+	void preloadResources(const char* basename, ResourceManifest& manifest)
 	{
-		destroyUniverse();
-		createUniverse();
-		g_log_info.log("Editor") << "Universe created.";
+		auto& fs = m_engine->getFileSystem();
+		StaticString<MAX_PATH_LENGTH> path("universes/", basename, ".lpm");
+		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path(path), FS::Mode::OPEN_AND_READ);
+		if (!file) return;
+
+		OutputBlob data(m_allocator);
+		file->getContents(data);
+		fs.close(*file);
+
+		InputBlob blob(data);
+		if (!manifest.deserialize(blob))
+		{
+			g_log_warning.log("Editor") << "Invalid resource manifest " << path;
+			return;
+		}
+
+		auto& resource_manager = m_engine->getResourceManager();
+		resource_manager.setManifestRecorder(nullptr);
+		manifest.preload(resource_manager);
+		resource_manager.setManifestRecorder(&m_resource_manifest);
 	}
 
 
-	enum class SerializedVersion : int
+	void saveResourceManifest(const char* basename)
 	{
+		OutputBlob blob(m_allocator);
+		m_resource_manifest.serialize(blob, m_engine->getResourceManager());
 
-		LATEST
-	};
+		auto& fs = m_engine->getFileSystem();
+		StaticString<MAX_PATH_LENGTH> path("universes/", basename, ".lpm");
+		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path(path), FS::Mode::CREATE_AND_WRITE);
+		if (!file)
+		{
+			g_log_error.log("Editor") << "Failed to save resource manifest " << path;
+			return;
+		}
+		file->write(blob.getData(), blob.getPos());
+		fs.close(*file);
+	}
 
 
-	#pragma pack(1)
-		struct Header
-		{
-			u32 magic;
-			int version;
-			u32 hash;
-			u32 engine_hash;
-		};
-	#pragma pack()
+	void newUniverse() override
+	{
+		destroyUniverse();
+		createUniverse();
+		g_log_info.log("Editor") << "Universe created.";
+	}
 
 
 	void load(FS::IFile& file)
 	{
 		m_is_loading = true;
 		ASSERT(file.getBuffer());
-		Header header;
-		if (file.size() < sizeof(header))
-		{
-			g_log_error.log("Editor") << "Corrupted file.";
-			newUniverse();
-			m_is_loading = false;
-			return;
-		}
-
 		Timer* timer = Timer::create(m_allocator);
 		g_log_info.log("Editor") << "Parsing universe...";
-		InputBlob blob(file.getBuffer(), (int)file.size());
+
+		Array<u8> storage(m_allocator);
+		const u8* payload = nullptr;
+		int payload_size = 0;
 		u32 hash = 0;
-		blob.read(hash);
-		header.version = -1;
-		int hashed_offset = sizeof(hash);
-		if (hash == 0xFFFFffff)
+		if (file.size() >= sizeof(hash)) copyMemory(&hash, file.getBuffer(), sizeof(hash));
+		if (hash == UniverseSaver::MAGIC)
 		{
-			blob.rewind();
-			blob.read(header);
-			hashed_offset = sizeof(header);
-			hash = header.hash;
+			payload = UniverseSaver::unpack(file.getBuffer(), (int)file.size(), storage, &payload_size);
 		}
-		else
+		else if (file.size() >= 2 * sizeof(u32))
 		{
-			u32 engine_hash = 0;
-			blob.read(engine_hash);
+			// old files start with the hash and the engine hash
+			payload = (const u8*)file.getBuffer() + 2 * sizeof(u32);
+			payload_size = (int)file.size() - 2 * sizeof(u32);
+			if (crc32(payload, payload_size) != hash) payload = nullptr;
 		}
-		if (crc32((const u8*)blob.getData() + hashed_offset, blob.getSize() - hashed_offset) != hash)
+		if (!payload)
 		{
 			Timer::destroy(timer);
 			g_log_error.log("Editor") << "Corrupted file.";
@@ -2957,6 +2979,7 @@ public:
 			m_is_loading = false;
 			return;
 		}
+		InputBlob blob(payload, payload_size);
 
 		if (m_camera.isValid()) m_universe->destroyEntity(m_camera);
 
@@ -3026,6 +3049,8 @@ public:
 		, m_engine(&engine)
 		, m_entity_map(m_allocator)
 		, m_is_guid_pseudorandom(false)
+		, m_resource_manifest(m_allocator)
+		, m_universe_saver(engine, m_allocator)
 	{
 		for (auto& i : m_is_mouse_down) i = false;
 		for (auto& i : m_is_mouse_click) i = false;
@@ -3286,6 +3311,7 @@ public:
 		m_editor_icons->clear();
 		selectEntities(nullptr, 0);
 		m_camera = INVALID_ENTITY;
+		m_engine->getResourceManager().setManifestRecorder(nullptr);
 		m_engine->destroyUniverse(*m_universe);
 		m_universe = nullptr;
 	}
@@ -3326,6 +3352,8 @@ public:
 
 		m_is_universe_changed = false;
 		destroyUndoStack();
+		m_resource_manifest.clear();
+		m_engine->getResourceManager().setManifestRecorder(&m_resource_manifest);
 		m_universe = &m_engine->createUniverse(true);
 		Universe* universe = m_universe;
 
@@ -3731,6 +3759,8 @@ private:
 	u32 m_current_group_type;
 	bool m_is_universe_changed;
 	bool m_is_guid_pseudorandom;
+	ResourceManifest m_resource_manifest;
+	UniverseSaver m_universe_saver;
 };
 
 
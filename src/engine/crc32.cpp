@@ -92,4 +92,19 @@ u32 continueCrc32(u32 original_crc, const char* str)
 }
 
 
+u32 continueCrc32(u32 original_crc, const void* data, int length)
+{
+	const u8* c = static_cast<const u8*>(data);
+	u32 crc = ~original_crc;
+	int len = length;
+	while (len)
+	{
+		crc = (crc >> 8) ^ crc32Table[crc & 0xFF ^ *c];
+		--len;
+		++c;
+	}
+	return ~crc;
+}
+
+
 } // namespace Lumix
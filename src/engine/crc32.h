@@ -11,6 +11,7 @@ namespace Lumix
 LUMIX_ENGINE_API u32 crc32(const void* data, int length);
 LUMIX_ENGINE_API u32 crc32(const char* str);
 LUMIX_ENGINE_API u32 continueCrc32(u32 original_crc, const char* str);
+LUMIX_ENGINE_API u32 continueCrc32(u32 original_crc, const void* data, int length);
 
 
 } // namespace Lumix
\ No newline at end of file
@@ -1446,6 +1446,13 @@ public:
 
 
 	u32 serialize(Universe& ctx, OutputBlob& serializer) override
+	{
+		int pos = serializeUnhashed(ctx, serializer);
+		return crc32((const u8*)serializer.getData() + pos, serializer.getPos() - pos);
+	}
+
+
+	int serializeUnhashed(Universe& ctx, OutputBlob& serializer) override
 	{
 		SerializedEngineHeader header;
 		header.m_magic = SERIALIZED_ENGINE_MAGIC; // == '_LEN'
@@ -1463,8 +1470,7 @@ public:
 			serializer.writeString(scene->getPlugin().getName());
 			scene->serialize(serializer);
 		}
-		u32 crc = crc32((const u8*)serializer.getData() + pos, serializer.getPos() - pos);
-		return crc;
+		return pos;
 	}
 
 
@@ -73,6 +73,8 @@ public:
 
 	virtual void update(Universe& context) = 0;
 	virtual u32 serialize(Universe& ctx, OutputBlob& serializer) = 0;
+	// same as serialize, but leaves the hash to the caller; returns where the hashed data starts
+	virtual int serializeUnhashed(Universe& ctx, OutputBlob& serializer) = 0;
 	virtual bool deserialize(Universe& ctx, InputBlob& serializer) = 0;
 	virtual float getFPS() const = 0;
 	virtual double getTime() const = 0;
@@ -2,7 +2,9 @@
 #include "engine/iallocator.h"
 #include "engine/string.h"
 #include "engine/lumix.h"
+#include <cerrno>
 #include <cstdio>
+#include <sys/stat.h>
 #include <unistd.h>
 
 
@@ -96,6 +98,16 @@ bool OsFile::fileExists(const char* path)
 	return access(path, F_OK) != -1;
 }
 
+bool OsFile::deleteFile(const char* path)
+{
+	return unlink(path) == 0;
+}
+
+bool OsFile::makeDirectory(const char* path)
+{
+	return mkdir(path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0 || errno == EEXIST;
+}
+
 size_t OsFile::pos()
 {
 	ASSERT(nullptr != m_impl);
@@ -167,5 +179,34 @@ OsFile& OsFile::operator <<(float value)
 }
 
 
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+{
+}
+
+
+MappedFile::~MappedFile()
+{
+	ASSERT(!m_data);
+}
+
+
+bool MappedFile::open(const char* path)
+{
+	return false;
+}
+
+
+void MappedFile::close()
+{
+}
+
+
+void MappedFile::discard(size_t offset, size_t size)
+{
+}
+
+
 } // namespace FS
 } // namespace Lumix
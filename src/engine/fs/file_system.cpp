@@ -220,6 +220,16 @@ public:
 	}
 
 
+	// async opens are done one after another, remote devices can request the file before its turn
+	void prefetch(const DeviceList& device_list, const Path& file)
+	{
+		for (int i = 0; i < lengthOf(device_list.m_devices) && device_list.m_devices[i]; ++i)
+		{
+			device_list.m_devices[i]->prefetch(&file, 1);
+		}
+	}
+
+
 	IFile* open(const DeviceList& device_list, const Path& file, Mode mode) override
 	{
 		IFile* prev = createFile(device_list);
@@ -249,6 +259,7 @@ public:
 
 		if (prev)
 		{
+			if (mode & Mode::READ) prefetch(device_list, file);
 			AsyncItem& item = m_pending.emplace();
 
 			item.m_file = prev;
@@ -4,6 +4,11 @@
 
 namespace Lumix
 {
+
+
+class Path;
+
+
 namespace FS
 {
 
@@ -20,6 +25,8 @@ struct LUMIX_ENGINE_API IFileDevice
 	virtual void destroyFile(IFile* file) = 0;
 
 	virtual const char* name() const = 0;
+	// hint that the files are going to be opened for reading soon
+	virtual void prefetch(const Path* paths, int count) {}
 };
 
 
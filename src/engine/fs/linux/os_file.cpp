@@ -2,7 +2,11 @@
 #include "engine/iallocator.h"
 #include "engine/string.h"
 #include "engine/lumix.h"
+#include <cerrno>
 #include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 
@@ -96,6 +100,16 @@ bool OsFile::fileExists(const char* path)
 	return access(path, F_OK) != -1;
 }
 
+bool OsFile::deleteFile(const char* path)
+{
+	return unlink(path) == 0;
+}
+
+bool OsFile::makeDirectory(const char* path)
+{
+	return mkdir(path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0 || errno == EEXIST;
+}
+
 size_t OsFile::pos()
 {
 	ASSERT(nullptr != m_impl);
@@ -167,5 +181,57 @@ OsFile& OsFile::operator <<(float value)
 }
 
 
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+{
+}
+
+
+MappedFile::~MappedFile()
+{
+	ASSERT(!m_data);
+}
+
+
+bool MappedFile::open(const char* path)
+{
+	ASSERT(!m_data);
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) return false;
+	m_data = (u8*)data;
+	m_size = st.st_size;
+	return true;
+}
+
+
+void MappedFile::close()
+{
+	if (!m_data) return;
+	munmap(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+void MappedFile::discard(size_t offset, size_t size)
+{
+	ASSERT(offset + size <= m_size);
+	size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+	size_t from = (offset + page_size - 1) / page_size * page_size;
+	size_t to = (offset + size) / page_size * page_size;
+	if (from < to) madvise(m_data + from, to - from, MADV_DONTNEED);
+}
+
+
 } // namespace FS
 } // namespace Lumix
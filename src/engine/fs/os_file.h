@@ -36,9 +36,33 @@ namespace Lumix
 			OsFile& operator <<(float value);
 
 			static bool fileExists(const char* path);
+			static bool deleteFile(const char* path);
+			// creates a single directory level, returns true if the directory exists afterwards
+			static bool makeDirectory(const char* path);
 
 		private:
 			struct OsFileImpl* m_impl;
 		};
+
+
+		// private copy-on-write view of a whole file, pages are read on first access
+		class LUMIX_ENGINE_API MappedFile
+		{
+		public:
+			MappedFile();
+			~MappedFile();
+
+			bool open(const char* path);
+			void close();
+			bool isOpen() const { return m_data != nullptr; }
+			u8* getData() const { return m_data; }
+			size_t size() const { return m_size; }
+			// gives the range's pages back to the OS, they are read from the file again on next access
+			void discard(size_t offset, size_t size);
+
+		private:
+			u8* m_data;
+			size_t m_size;
+		};
 	} // ~namespace FS
 } // ~namespace Lumix
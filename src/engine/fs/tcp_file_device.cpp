@@ -1,144 +1,418 @@
 #include "engine/fs/tcp_file_device.h"
 #include "engine/iallocator.h"
+#include "engine/array.h"
 #include "engine/blob.h"
 #include "engine/fs/file_system.h"
+#include "engine/hash_map.h"
+#include "engine/lz.h"
+#include "engine/math_utils.h"
 #include "engine/mt/sync.h"
+#include "engine/mt/task.h"
 #include "engine/path.h"
+#include "engine/profiler.h"
 #include "engine/network.h"
+#include "engine/string.h"
 
 
 namespace Lumix
 {
 	namespace FS
 	{
-		static const u32 INVALID_FILE = 0xffffFFFF;
+		struct TCPRequest
+		{
+			explicit TCPRequest(IAllocator& allocator)
+				: data(allocator)
+				, semaphore(0, 1)
+				, is_success(false)
+				, is_received(false)
+				, is_dropped(false)
+			{}
 
-		class TCPFile LUMIX_FINAL : public IFile
+			Array<u8> data;
+			MT::Semaphore semaphore;
+			bool is_success;
+			// both are guarded by the requests mutex, a dropped request is deleted once it is received
+			bool is_received;
+			bool is_dropped;
+		};
+
+
+		// reads responses as they arrive, so the server never blocks on a client busy sending
+		class TCPReceiverTask LUMIX_FINAL : public MT::Task
 		{
 		public:
-			TCPFile(Net::TCPStream* stream, TCPFileDevice& device, MT::SpinMutex& spin_mutex) 
-				: m_device(device)
-				, m_stream(stream)
-				, m_spin_mutex(spin_mutex)
-				, m_file(INVALID_FILE)
+			TCPReceiverTask(TCPImpl& impl, IAllocator& allocator)
+				: MT::Task(allocator)
+				, m_impl(impl)
 			{}
 
-			~TCPFile() {}
+			int task() override;
 
-			IFileDevice& getDevice() override
+		private:
+			TCPImpl& m_impl;
+		};
+
+
+		struct TCPImpl
+		{
+			explicit TCPImpl(IAllocator& allocator)
+				: m_send_mutex(false)
+				, m_requests_mutex(false)
+				, m_allocator(allocator)
+				, m_connector(m_allocator)
+				, m_stream(nullptr)
+				, m_receiver(*this, allocator)
+				, m_requests(allocator)
+				, m_prefetched(allocator)
+				, m_packed(allocator)
+				, m_next_id(0)
+				, m_flags(0)
+				, m_is_broken(false)
+			{}
+
+
+			~TCPImpl()
 			{
-				return m_device;
+				ASSERT(m_requests.empty());
+				ASSERT(m_prefetched.empty());
 			}
 
-			bool open(const Path& path, Mode mode) override
+
+			TCPRequest* createRequest(u32* id)
 			{
-				if (!m_stream)
+				TCPRequest* request = LUMIX_NEW(m_allocator, TCPRequest)(m_allocator);
+				*id = m_next_id++;
+				if (m_is_broken)
+				{
+					request->is_received = true;
+					request->semaphore.signal();
+				}
+				else
 				{
-					return false;
+					m_requests.insert(*id, request);
 				}
+				return request;
+			}
 
-				i32 op = TCPCommand::OpenFile;
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(mode);
-				m_stream->writeString(path.c_str());
-				m_stream->read(m_file);
+			// prefetched response nobody is going to open, called with the requests mutex locked
+			void dropPrefetched(HashMap<u32, TCPRequest*>::iterator iter)
+			{
+				TCPRequest* request = iter.value();
+				m_prefetched.erase(iter);
+				if (request->is_received)
+				{
+					LUMIX_DELETE(m_allocator, request);
+				}
+				else
+				{
+					request->is_dropped = true;
+				}
+			}
 
-				return INVALID_FILE != m_file;
+
+			void dropPrefetched()
+			{
+				MT::SpinLock lock(m_requests_mutex);
+				while (!m_prefetched.empty()) dropPrefetched(m_prefetched.begin());
 			}
 
-			void close() override
+
+			void send(const OutputBlob& blob)
 			{
-				if (INVALID_FILE != m_file)
+				MT::SpinLock lock(m_send_mutex);
+				m_stream->write(blob.getData(), blob.getPos());
+			}
+
+
+			TCPRequest* requestRead(const Path& path)
+			{
+				u32 id;
+				TCPRequest* request;
 				{
-					i32 op = TCPCommand::Close;
+					MT::SpinLock lock(m_requests_mutex);
+					auto iter = m_prefetched.find(path.getHash());
+					if (iter.isValid())
+					{
+						request = iter.value();
+						m_prefetched.erase(iter);
+						return request;
+					}
+					request = createRequest(&id);
+				}
 
-					MT::SpinLock lock(m_spin_mutex);
-					m_stream->write(op);
-					m_stream->write(m_file);
+				OutputBlob blob(m_allocator);
+				blob.write((i32)TCPCommand::ReadFile);
+				blob.write(id);
+				blob.write(m_flags);
+				blob.writeString(path.c_str());
+				send(blob);
+				return request;
+			}
+
+
+			void prefetch(const Path* paths, int count)
+			{
+				OutputBlob blob(m_allocator);
+				int requested_count = 0;
+				{
+					MT::SpinLock lock(m_requests_mutex);
+					blob.write((i32)TCPCommand::ReadFiles);
+					blob.write(m_next_id);
+					blob.write(m_flags);
+					int count_pos = blob.getPos();
+					blob.write(requested_count);
+					for (int i = 0; i < count; ++i)
+					{
+						if (m_prefetched.find(paths[i].getHash()).isValid()) continue;
+
+						u32 id;
+						TCPRequest* request = createRequest(&id);
+						m_prefetched.insert(paths[i].getHash(), request);
+						blob.writeString(paths[i].c_str());
+						++requested_count;
+					}
+					copyMemory((u8*)blob.getMutableData() + count_pos, &requested_count, sizeof(requested_count));
 				}
+				if (requested_count > 0) send(blob);
 			}
 
-			bool read(void* buffer, size_t size) override
+
+			bool write(const Path& path, const Array<u8>& data)
 			{
-				i32 op = TCPCommand::Read;
+				u32 id;
+				TCPRequest* request;
+				{
+					MT::SpinLock lock(m_requests_mutex);
+					auto iter = m_prefetched.find(path.getHash());
+					if (iter.isValid()) dropPrefetched(iter);
+					request = createRequest(&id);
+				}
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(m_file);
-				m_stream->write((u64)size);
+				OutputBlob blob(m_allocator);
+				blob.reserve(data.size() + 64);
+				blob.write((i32)TCPCommand::WriteFile);
+				blob.write(id);
+				blob.writeString(path.c_str());
+				blob.write((u32)data.size());
+				if (!data.empty()) blob.write(&data[0], data.size());
+				send(blob);
+
+				request->semaphore.wait();
+				bool success = request->is_success;
+				LUMIX_DELETE(m_allocator, request);
+				return success;
+			}
 
-				m_stream->read(buffer, size);
-				bool successful = false;
-				m_stream->read(successful);
 
-				return successful;
+			bool receiveData(Array<u8>& data, u32 size)
+			{
+				data.resize(size);
+				u32 offset = 0;
+				while (offset < size)
+				{
+					u32 raw_size;
+					u32 packed_size;
+					if (!m_stream->read(raw_size) || !m_stream->read(packed_size)) return false;
+					if (raw_size > size - offset) return false;
+
+					if (packed_size == raw_size)
+					{
+						if (!m_stream->read(&data[offset], raw_size)) return false;
+					}
+					else
+					{
+						m_packed.resize(packed_size);
+						if (!m_stream->read(&m_packed[0], packed_size)) return false;
+						if (!lzDecompress(&m_packed[0], packed_size, &data[offset], raw_size)) return false;
+					}
+					offset += raw_size;
+				}
+				return true;
 			}
 
-			bool write(const void* buffer, size_t size) override
+
+			bool receiveResponse()
 			{
-				i32 op = TCPCommand::Write;
+				PROFILE_FUNCTION();
+				u32 id;
+				i32 size;
+				if (!m_stream->read(id) || !m_stream->read(size)) return false;
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(m_file);
-				m_stream->write((u64)size);
-				m_stream->write(buffer, size);
+				TCPRequest* request;
+				{
+					MT::SpinLock lock(m_requests_mutex);
+					auto iter = m_requests.find(id);
+					if (!iter.isValid()) return false;
+					request = iter.value();
+					m_requests.erase(iter);
+				}
+
+				bool success = size >= 0;
+				if (size > 0 && !receiveData(request->data, (u32)size)) success = false;
+				request->is_success = success;
+				complete(request);
+				return success || size < 0;
+			}
 
-				bool successful = false;
-				m_stream->read(successful);
 
-				return successful;
+			void complete(TCPRequest* request)
+			{
+				bool is_dropped;
+				{
+					MT::SpinLock lock(m_requests_mutex);
+					request->is_received = true;
+					is_dropped = request->is_dropped;
+				}
+				if (is_dropped)
+				{
+					LUMIX_DELETE(m_allocator, request);
+				}
+				else
+				{
+					request->semaphore.signal();
+				}
 			}
 
-			const void* getBuffer() const override
+
+			void failRequests()
 			{
-				return nullptr;
+				MT::SpinLock lock(m_requests_mutex);
+				m_is_broken = true;
+				for (TCPRequest* request : m_requests)
+				{
+					request->is_received = true;
+					if (request->is_dropped)
+					{
+						LUMIX_DELETE(m_allocator, request);
+					}
+					else
+					{
+						request->semaphore.signal();
+					}
+				}
+				m_requests.clear();
 			}
 
-			size_t size() override
+
+			MT::SpinMutex m_send_mutex;
+			MT::SpinMutex m_requests_mutex;
+			IAllocator& m_allocator;
+			Net::TCPConnector m_connector;
+			Net::TCPStream* m_stream;
+			TCPReceiverTask m_receiver;
+			HashMap<u32, TCPRequest*> m_requests;
+			HashMap<u32, TCPRequest*> m_prefetched;
+			Array<u8> m_packed;
+			u32 m_next_id;
+			u8 m_flags;
+			volatile bool m_is_broken;
+		};
+
+
+		int TCPReceiverTask::task()
+		{
+			while (m_impl.receiveResponse()) {}
+			m_impl.failRequests();
+			return 0;
+		}
+
+
+		class TCPFile LUMIX_FINAL : public IFile
+		{
+		public:
+			TCPFile(TCPImpl& impl, TCPFileDevice& device)
+				: m_device(device)
+				, m_impl(impl)
+				, m_data(impl.m_allocator)
+				, m_pos(0)
+				, m_write(false)
+			{}
+
+			~TCPFile() {}
+
+			IFileDevice& getDevice() override
 			{
-				i32 op = TCPCommand::Size;
-				u32 size = 0;
+				return m_device;
+			}
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(m_file);
+			bool open(const Path& path, Mode mode) override
+			{
+				if (!m_impl.m_stream) return false;
 
-				m_stream->read(size);
+				m_pos = 0;
+				m_data.clear();
+				m_write = !!(mode & Mode::WRITE);
+				if (m_write)
+				{
+					m_path = path;
+					return true;
+				}
 
-				return (size_t)size;
+				TCPRequest* request = m_impl.requestRead(path);
+				request->semaphore.wait();
+				bool success = request->is_success;
+				if (success) m_data.swap(request->data);
+				LUMIX_DELETE(m_impl.m_allocator, request);
+				return success;
 			}
 
-			bool seek(SeekMode base, size_t pos) override
+			void close() override
 			{
-				i32 op = TCPCommand::Seek;
+				if (m_write) m_impl.write(m_path, m_data);
+				m_write = false;
+				m_data.clear();
+			}
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(m_file);
-				m_stream->write(base);
-				m_stream->write((u64)pos);
+			bool read(void* buffer, size_t size) override
+			{
+				size_t amount = m_pos + size < (size_t)m_data.size() ? size : m_data.size() - m_pos;
+				if (amount > 0) copyMemory(buffer, &m_data[(int)m_pos], amount);
+				m_pos += amount;
+				return amount == size;
+			}
 
-				u8 res = 0;
-				m_stream->read(res);
+			bool write(const void* buffer, size_t size) override
+			{
+				if (m_pos + size > (size_t)m_data.size())
+				{
+					m_data.reserve(Math::maximum(m_data.size() * 2, int(m_pos + size)));
+					m_data.resize(int(m_pos + size));
+				}
+				if (size > 0) copyMemory(&m_data[(int)m_pos], buffer, size);
+				m_pos += size;
+				return true;
+			}
 
-				return res != 0;
+			const void* getBuffer() const override
+			{
+				return m_data.empty() ? nullptr : &m_data[0];
 			}
 
-			size_t pos() override
+			size_t size() override
 			{
-				i32 op = TCPCommand::Seek;
-				i32 pos = 0;
+				return m_data.size();
+			}
 
-				MT::SpinLock lock(m_spin_mutex);
-				m_stream->write(op);
-				m_stream->write(m_file);
+			bool seek(SeekMode base, size_t pos) override
+			{
+				size_t size = m_data.size();
+				switch (base)
+				{
+					case SeekMode::BEGIN: m_pos = pos; break;
+					case SeekMode::CURRENT: m_pos += pos; break;
+					case SeekMode::END: m_pos = size - pos; break;
+					default: ASSERT(0); break;
+				}
 
-				m_stream->read(pos);
+				bool ret = m_pos <= size;
+				m_pos = Math::minimum(m_pos, size);
+				return ret;
+			}
 
-				return (size_t)pos;
+			size_t pos() override
+			{
+				return m_pos;
 			}
 
 		private:
@@ -146,24 +420,11 @@ namespace Lumix
 			TCPFile(const TCPFile&);
 
 			TCPFileDevice& m_device;
-			Net::TCPStream* m_stream;
-			MT::SpinMutex& m_spin_mutex;
-			u32 m_file;
-		};
-
-		struct TCPImpl
-		{
-			explicit TCPImpl(IAllocator& allocator)
-				: m_spin_mutex(false)
-				, m_allocator(allocator)
-				, m_connector(m_allocator)
-				, m_stream(nullptr)
-			{}
-
-			IAllocator& m_allocator;
-			Net::TCPConnector m_connector;
-			Net::TCPStream* m_stream;
-			MT::SpinMutex m_spin_mutex;
+			TCPImpl& m_impl;
+			Array<u8> m_data;
+			Path m_path;
+			size_t m_pos;
+			bool m_write;
 		};
 
 		TCPFileDevice::TCPFileDevice()
@@ -173,7 +434,7 @@ namespace Lumix
 
 		IFile* TCPFileDevice::createFile(IFile*)
 		{
-			return LUMIX_NEW(m_impl->m_allocator, TCPFile)(m_impl->m_stream, *this, m_impl->m_spin_mutex);
+			return LUMIX_NEW(m_impl->m_allocator, TCPFile)(*m_impl, *this);
 		}
 
 		void TCPFileDevice::destroyFile(IFile* file)
@@ -185,13 +446,44 @@ namespace Lumix
 		{
 			m_impl = LUMIX_NEW(allocator, TCPImpl)(allocator);
 			m_impl->m_stream = m_impl->m_connector.connect(ip, port);
+			if (m_impl->m_stream) m_impl->m_receiver.create("TCP File Device Receiver");
 		}
 
 		void TCPFileDevice::disconnect()
 		{
-			m_impl->m_stream->write(TCPCommand::Disconnect);
-			m_impl->m_connector.close(m_impl->m_stream);
+			if (m_impl->m_stream)
+			{
+				OutputBlob blob(m_impl->m_allocator);
+				blob.write((i32)TCPCommand::Disconnect);
+				blob.write((u32)0);
+				m_impl->send(blob);
+				m_impl->m_receiver.destroy();
+				m_impl->m_connector.close(m_impl->m_stream);
+			}
+			m_impl->dropPrefetched();
 			LUMIX_DELETE(m_impl->m_allocator, m_impl);
+			m_impl = nullptr;
+		}
+
+		bool TCPFileDevice::isConnected() const
+		{
+			return m_impl && m_impl->m_stream && !m_impl->m_is_broken;
+		}
+
+		void TCPFileDevice::setCompression(bool enable)
+		{
+			m_impl->m_flags = enable ? TCPFileFlags::COMPRESSED : 0;
+		}
+
+		void TCPFileDevice::prefetch(const Path* paths, int count)
+		{
+			if (!m_impl || !m_impl->m_stream || count <= 0) return;
+			m_impl->prefetch(paths, count);
+		}
+
+		Net::TCPStream* TCPFileDevice::getStream()
+		{
+			return m_impl ? m_impl->m_stream : nullptr;
 		}
 	} // namespace FS
 } // ~namespace Lumix
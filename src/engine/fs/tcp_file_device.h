@@ -11,6 +11,7 @@ namespace Lumix
 	}
 
 	struct IAllocator;
+	class Path;
 
 	namespace FS
 	{
@@ -18,17 +19,16 @@ namespace Lumix
 		class TCPFileSystemTask;
 		struct TCPImpl;
 
+		// Every request starts with a command and a request ID, every response starts with
+		// the ID of the request it answers, so a client can have many requests in flight.
+		// File contents are sent whole, split into chunks which may be compressed.
 		struct TCPCommand
 		{
 			enum Value
 			{
-				OpenFile = 0,
-				Close,
-				Read,
-				Write,
-				Size,
-				Seek,
-				Pos,
+				ReadFile = 0,
+				ReadFiles,
+				WriteFile,
 				Disconnect,
 			};
 
@@ -39,6 +39,16 @@ namespace Lumix
 			i32 value;
 		};
 
+		struct TCPFileFlags
+		{
+			enum Value : u8
+			{
+				COMPRESSED = 1 << 0
+			};
+		};
+
+		static const u32 TCP_FILE_CHUNK_SIZE = 256 * 1024;
+
 		class LUMIX_ENGINE_API TCPFileDevice LUMIX_FINAL : public IFileDevice
 		{
 		public:
@@ -50,6 +60,11 @@ namespace Lumix
 
 			void connect(const char* ip, u16 port, IAllocator& allocator);
 			void disconnect();
+			bool isConnected() const;
+
+			void setCompression(bool enable);
+			// requests all files in one message, following opens of these paths do not wait for a round trip
+			void prefetch(const Path* paths, int count) override;
 
 			Net::TCPStream* getStream();
 
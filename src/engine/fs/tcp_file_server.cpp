@@ -1,9 +1,13 @@
 #include "engine/fs/tcp_file_server.h"
 
 #include "engine/array.h"
-#include "engine/free_list.h"
+#include "engine/blob.h"
 #include "engine/fs/os_file.h"
 #include "engine/fs/tcp_file_device.h"
+#include "engine/log.h"
+#include "engine/lz.h"
+#include "engine/math_utils.h"
+#include "engine/mt/sync.h"
 #include "engine/mt/task.h"
 #include "engine/path.h"
 #include "engine/profiler.h"
@@ -22,247 +26,331 @@ namespace FS
 {
 
 
-class TCPFileServerTask LUMIX_FINAL : public MT::Task
+struct TCPFileServerImpl;
+
+
+class TCPFileServerWorker LUMIX_FINAL : public MT::Task
 {
 public:
-	explicit TCPFileServerTask(IAllocator& allocator)
+	TCPFileServerWorker(TCPFileServerImpl& server, IAllocator& allocator)
 		: MT::Task(allocator)
-		, m_acceptor(allocator)
+		, m_server(server)
+		, m_response(allocator)
+		, m_chunk(allocator)
+		, m_packed(allocator)
 	{
-		setMemory(m_buffer, 0, sizeof(m_buffer));
-		setMemory(m_files, 0, sizeof(m_files));
+		m_chunk.resize(TCP_FILE_CHUNK_SIZE);
+		m_packed.resize(lzCompressBound(TCP_FILE_CHUNK_SIZE));
+		m_response.reserve(TCP_FILE_CHUNK_SIZE * 2);
 	}
 
 
-	~TCPFileServerTask()
+	int task() override;
+
+
+private:
+	bool flush(Net::TCPStream* stream)
 	{
+		bool ret = m_response.getPos() == 0 || stream->write(m_response.getData(), m_response.getPos());
+		m_response.clear();
+		return ret;
 	}
 
 
-	void openFile(Net::TCPStream* stream)
-	{
-		i32 mode = 0;
-		stream->read(mode);
-		stream->readString(m_buffer, lengthOf(m_buffer));
+	bool readFile(Net::TCPStream* stream, u32 id, u8 flags, const char* path);
+	bool readFiles(Net::TCPStream* stream);
+	bool writeFile(Net::TCPStream* stream);
+	bool serve(Net::TCPStream* stream);
+	void getFullPath(char* out, int max_size, const char* path) const;
 
-		i32 ret = -2;
-		i32 id = m_ids.alloc();
-		if (id > 0)
-		{
-			OsFile* file = LUMIX_NEW(getAllocator(), OsFile)();
-			m_files[id] = file;
+	TCPFileServerImpl& m_server;
+	OutputBlob m_response;
+	Array<u8> m_chunk;
+	Array<u8> m_packed;
+	char m_path[MAX_PATH_LENGTH];
+};
 
-			char path[MAX_PATH_LENGTH];
-			if (compareStringN(m_buffer, m_base_path.c_str(), m_base_path.length()) != 0)
-			{
-				copyString(path, m_base_path.c_str());
-				catString(path, m_buffer);
-			}
-			else
-			{
-				copyString(path, m_buffer);
-			}
-			ret = file->open(path, mode, getAllocator()) ? id : -1;
-			if (ret == -1)
-			{
-				m_ids.release(id);
-				file->close();
-				LUMIX_DELETE(getAllocator(), file);
-			}
-		}
-		stream->write(ret);
+
+class TCPFileServerTask LUMIX_FINAL : public MT::Task
+{
+public:
+	TCPFileServerTask(TCPFileServerImpl& server, IAllocator& allocator)
+		: MT::Task(allocator)
+		, m_server(server)
+		, m_acceptor(allocator)
+	{
 	}
 
 
-	void read(Net::TCPStream* stream)
-	{
-		bool read_successful = true;
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
+	int task() override;
 
-		u32 size = 0;
-		stream->read(size);
 
-		while (size > 0)
-		{
-			i32 read = (i32)size > lengthOf(m_buffer) ? lengthOf(m_buffer)
-														   : (i32)size;
-			read_successful &= file->read((void*)m_buffer, read);
-			stream->write((const void*)m_buffer, read);
-			size -= read;
-		}
+	Net::TCPAcceptor m_acceptor;
 
-		stream->write(read_successful);
-	}
+private:
+	TCPFileServerImpl& m_server;
+};
 
 
-	void close(Net::TCPStream* stream)
+struct TCPFileServerImpl
+{
+	explicit TCPFileServerImpl(IAllocator& allocator)
+		: m_allocator(allocator)
+		, m_task(*this, allocator)
+		, m_workers(allocator)
+		, m_clients(allocator)
+		, m_served_clients(allocator)
+		, m_clients_mutex(false)
+		, m_clients_semaphore(0, 0x7fffFFFF)
+		, m_port(0)
+		, m_is_finished(false)
 	{
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
-		m_ids.release(id);
-
-		file->close();
-		LUMIX_DELETE(getAllocator(), file);
 	}
 
 
-	void write(Net::TCPStream* stream)
+	void pushClient(Net::TCPStream* stream)
 	{
-		bool write_successful = true;
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
-
-		u32 size = 0;
-		stream->read(size);
-
-		while (size > 0)
 		{
-			i32 read = (i32)size > lengthOf(m_buffer) ? lengthOf(m_buffer)
-														   : (i32)size;
-			write_successful &= stream->read((void*)m_buffer, read);
-			file->write(m_buffer, read);
-			size -= read;
+			MT::SpinLock lock(m_clients_mutex);
+			m_clients.push(stream);
 		}
-
-		stream->write(write_successful);
+		m_clients_semaphore.signal();
 	}
 
 
-	void seek(Net::TCPStream* stream)
+	Net::TCPStream* popClient()
 	{
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
+		m_clients_semaphore.wait();
+		MT::SpinLock lock(m_clients_mutex);
+		Net::TCPStream* stream = m_clients[0];
+		m_clients.erase(0);
+		return stream;
+	}
 
-		u32 base = 0;
-		i32 offset = 0;
-		stream->read(base);
-		stream->read(offset);
 
-		u32 res = (u8)file->seek((SeekMode)base, offset);
-		stream->write(res);
+	// clients being served are shut down in stop(), so no worker stays blocked in a read
+	bool beginServing(Net::TCPStream* stream)
+	{
+		MT::SpinLock lock(m_clients_mutex);
+		if (m_is_finished) return false;
+		m_served_clients.push(stream);
+		return true;
 	}
 
 
-	void size(Net::TCPStream* stream)
+	void endServing(Net::TCPStream* stream)
 	{
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
+		MT::SpinLock lock(m_clients_mutex);
+		m_served_clients.eraseItemFast(stream);
+	}
 
-		u32 size = (u32)file->size();
-		stream->write(size);
+
+	void shutdownClients()
+	{
+		MT::SpinLock lock(m_clients_mutex);
+		m_is_finished = true;
+		for (Net::TCPStream* stream : m_served_clients) stream->shutdown();
 	}
 
 
-	void pos(Net::TCPStream* stream)
+	void setBasePath(const char* base_path)
 	{
-		u32 id = 0xffffFFFF;
-		stream->read(id);
-		OsFile* file = m_files[id];
+		int len = stringLength(base_path);
+		if (len <= 0) return;
 
-		u32 pos = (u32)file->pos();
-		stream->write(pos);
+		if (base_path[len - 1] == '/')
+		{
+			m_base_path = base_path;
+		}
+		else
+		{
+			char tmp[MAX_PATH_LENGTH];
+			copyString(tmp, base_path);
+			catString(tmp, "/");
+			m_base_path = tmp;
+		}
 	}
 
 
-	int task()
-	{
-		bool quit = false;
+	IAllocator& m_allocator;
+	TCPFileServerTask m_task;
+	Array<TCPFileServerWorker*> m_workers;
+	Array<Net::TCPStream*> m_clients;
+	Array<Net::TCPStream*> m_served_clients;
+	MT::SpinMutex m_clients_mutex;
+	MT::Semaphore m_clients_semaphore;
+	Path m_base_path;
+	u16 m_port;
+	volatile bool m_is_finished;
+};
 
-		m_acceptor.start("127.0.0.1", 10001);
+
+int TCPFileServerTask::task()
+{
+	while (!m_server.m_is_finished)
+	{
 		Net::TCPStream* stream = m_acceptor.accept();
+		if (!stream) break;
+		if (m_server.m_is_finished)
+		{
+			m_acceptor.close(stream);
+			break;
+		}
+		m_server.pushClient(stream);
+	}
+	return 0;
+}
+
 
-		while (!quit)
+int TCPFileServerWorker::task()
+{
+	while (Net::TCPStream* stream = m_server.popClient())
+	{
+		if (m_server.beginServing(stream))
 		{
-			PROFILE_BLOCK("File server operation")
-			i32 op = 0;
-			stream->read(op);
-			switch (op)
-			{
-				case TCPCommand::OpenFile:
-					openFile(stream);
-					break;
-				case TCPCommand::Close:
-					close(stream);
-					break;
-				case TCPCommand::Read:
-					read(stream);
-					break;
-				case TCPCommand::Write:
-					write(stream);
-					break;
-				case TCPCommand::Size:
-					size(stream);
-					break;
-				case TCPCommand::Seek:
-					seek(stream);
-					break;
-				case TCPCommand::Pos:
-					pos(stream);
-					break;
-				case TCPCommand::Disconnect:
-					quit = true;
-					break;
-				default:
-					ASSERT(0);
-					break;
-			}
+			serve(stream);
+			m_server.endServing(stream);
 		}
+		m_server.m_task.m_acceptor.close(stream);
+	}
+	return 0;
+}
+
 
-		m_acceptor.close(stream);
-		return 0;
+void TCPFileServerWorker::getFullPath(char* out, int max_size, const char* path) const
+{
+	const Path& base_path = m_server.m_base_path;
+	if (compareStringN(path, base_path.c_str(), base_path.length()) != 0)
+	{
+		copyString(out, max_size, base_path.c_str());
+		catString(out, max_size, path);
+	}
+	else
+	{
+		copyString(out, max_size, path);
 	}
+}
 
 
-	void stop() {}
+bool TCPFileServerWorker::readFile(Net::TCPStream* stream, u32 id, u8 flags, const char* path)
+{
+	PROFILE_FUNCTION();
+	char full_path[MAX_PATH_LENGTH];
+	getFullPath(full_path, lengthOf(full_path), path);
 
+	OsFile file;
+	if (!file.open(full_path, Mode::OPEN_AND_READ, getAllocator()))
+	{
+		m_response.write(id);
+		m_response.write((i32)-1);
+		return true;
+	}
 
-	void setBasePath(const char* base_path)
+	u32 size = (u32)file.size();
+	m_response.write(id);
+	m_response.write((i32)size);
+	bool is_stream_ok = true;
+	while (size > 0 && is_stream_ok)
 	{
-		int len = stringLength(base_path);
-		if (len <= 0) return;
+		// the size is already promised to the client, so a failed read is sent as zeroes
+		u32 raw_size = Math::minimum(size, TCP_FILE_CHUNK_SIZE);
+		if (!file.read(&m_chunk[0], raw_size)) setMemory(&m_chunk[0], 0, raw_size);
 
-		if (base_path[len - 1] == '/')
+		int packed_size = 0;
+		if (flags & TCPFileFlags::COMPRESSED)
 		{
-			m_base_path = base_path;
+			packed_size = lzCompress(&m_chunk[0], raw_size, &m_packed[0], raw_size - 1);
+		}
+		m_response.write(raw_size);
+		if (packed_size > 0)
+		{
+			m_response.write((u32)packed_size);
+			m_response.write(&m_packed[0], packed_size);
 		}
 		else
 		{
-			char tmp[MAX_PATH_LENGTH];
-			copyString(tmp, base_path);
-			catString(tmp, "/");
-			m_base_path = tmp;
+			m_response.write(raw_size);
+			m_response.write(&m_chunk[0], raw_size);
 		}
+		size -= raw_size;
+
+		if (m_response.getPos() >= (int)TCP_FILE_CHUNK_SIZE) is_stream_ok = flush(stream);
 	}
+	file.close();
+	return is_stream_ok;
+}
 
 
-	const char* getBasePath() const { return m_base_path.c_str(); }
+bool TCPFileServerWorker::readFiles(Net::TCPStream* stream)
+{
+	u32 first_id;
+	u8 flags;
+	i32 count;
+	if (!stream->read(first_id) || !stream->read(flags) || !stream->read(count)) return false;
 
-private:
-	Net::TCPAcceptor m_acceptor;
-	char m_buffer[0x50000];
-	OsFile* m_files[0x50000];
-	FreeList<i32, 0x50000> m_ids;
-	Path m_base_path;
-};
+	for (i32 i = 0; i < count; ++i)
+	{
+		if (!stream->readString(m_path, lengthOf(m_path))) return false;
+		if (!readFile(stream, first_id + i, flags, m_path)) return false;
+	}
+	return true;
+}
 
 
-struct TCPFileServerImpl
+bool TCPFileServerWorker::writeFile(Net::TCPStream* stream)
 {
-	explicit TCPFileServerImpl(IAllocator& allocator)
-		: m_task(allocator)
-		, m_allocator(allocator)
+	PROFILE_FUNCTION();
+	u32 id;
+	u32 size;
+	if (!stream->read(id) || !stream->readString(m_path, lengthOf(m_path)) || !stream->read(size)) return false;
+
+	char full_path[MAX_PATH_LENGTH];
+	getFullPath(full_path, lengthOf(full_path), m_path);
+	OsFile file;
+	bool is_open = file.open(full_path, Mode::CREATE_AND_WRITE, getAllocator());
+	bool success = is_open;
+	while (size > 0)
 	{
+		u32 chunk_size = Math::minimum(size, TCP_FILE_CHUNK_SIZE);
+		if (!stream->read(&m_chunk[0], chunk_size)) return false;
+		if (is_open) success = file.write(&m_chunk[0], chunk_size) && success;
+		size -= chunk_size;
 	}
+	if (is_open) file.close();
+
+	m_response.write(id);
+	m_response.write(success ? (i32)0 : (i32)-1);
+	return true;
+}
 
-	IAllocator& m_allocator;
-	TCPFileServerTask m_task;
-};
+
+bool TCPFileServerWorker::serve(Net::TCPStream* stream)
+{
+	for (;;)
+	{
+		PROFILE_BLOCK("File server operation");
+		i32 op = 0;
+		if (!stream->read(op)) return false;
+
+		bool success = false;
+		switch (op)
+		{
+			case TCPCommand::ReadFile:
+			{
+				u32 id;
+				u8 flags;
+				success = stream->read(id) && stream->read(flags) && stream->readString(m_path, lengthOf(m_path)) &&
+						  readFile(stream, id, flags, m_path);
+				break;
+			}
+			case TCPCommand::ReadFiles: success = readFiles(stream); break;
+			case TCPCommand::WriteFile: success = writeFile(stream); break;
+			case TCPCommand::Disconnect: return true;
+			default: ASSERT(0); break;
+		}
+		if (!success || !flush(stream)) return false;
+	}
+}
 
 
 TCPFileServer::TCPFileServer()
@@ -273,33 +361,56 @@ TCPFileServer::TCPFileServer()
 
 TCPFileServer::~TCPFileServer()
 {
-	if (m_impl)
-	{
-		LUMIX_DELETE(m_impl->m_allocator, m_impl);
-	}
+	if (m_impl) stop();
 }
 
 
-void TCPFileServer::start(const char* base_path, IAllocator& allocator)
+void TCPFileServer::start(const char* base_path, IAllocator& allocator, u16 port, int workers_count)
 {
 	m_impl = LUMIX_NEW(allocator, TCPFileServerImpl)(allocator);
-	m_impl->m_task.setBasePath(base_path);
+	m_impl->setBasePath(base_path);
+	m_impl->m_port = port;
+	if (!m_impl->m_task.m_acceptor.start("127.0.0.1", port))
+	{
+		g_log_error.log("Engine") << "TCP file server could not listen on port " << (u32)port;
+	}
+	for (int i = 0; i < workers_count; ++i)
+	{
+		TCPFileServerWorker* worker = LUMIX_NEW(allocator, TCPFileServerWorker)(*m_impl, allocator);
+		worker->create("TCP File Server Worker");
+		m_impl->m_workers.push(worker);
+	}
 	m_impl->m_task.create("TCP File Server Task");
 }
 
 
 void TCPFileServer::stop()
 {
-	m_impl->m_task.stop();
+	m_impl->m_is_finished = true;
+
+	// wake up the blocking accept
+	Net::TCPConnector connector(m_impl->m_allocator);
+	Net::TCPStream* stream = connector.connect("127.0.0.1", m_impl->m_port);
+	if (stream) connector.close(stream);
 	m_impl->m_task.destroy();
+
+	m_impl->shutdownClients();
+	for (int i = 0; i < m_impl->m_workers.size(); ++i) m_impl->pushClient(nullptr);
+	for (TCPFileServerWorker* worker : m_impl->m_workers)
+	{
+		worker->destroy();
+		LUMIX_DELETE(m_impl->m_allocator, worker);
+	}
+
 	LUMIX_DELETE(m_impl->m_allocator, m_impl);
 	m_impl = nullptr;
 }
 
+
 const char* TCPFileServer::getBasePath() const
 {
 	ASSERT(m_impl);
-	return m_impl->m_task.getBasePath();
+	return m_impl->m_base_path.c_str();
 }
 
 
@@ -309,4 +420,4 @@ const char* TCPFileServer::getBasePath() const
 } // namespace Lumix
 
 
-#endif
\ No newline at end of file
+#endif
@@ -19,7 +19,9 @@ namespace Lumix
 			TCPFileServer();
 			~TCPFileServer();
 
-			void start(const char* base_path, IAllocator& allocator);
+			// each connected client is served by one of workers_count threads
+			void start(const char* base_path, IAllocator& allocator, u16 port = 10001, int workers_count = 4);
+			// waits for connected clients to disconnect
 			void stop();
 			const char* getBasePath() const;
 
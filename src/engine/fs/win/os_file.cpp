@@ -104,6 +104,16 @@ bool OsFile::fileExists(const char* path)
 		!(dwAttrib & FILE_ATTRIBUTE_DIRECTORY));
 }
 
+bool OsFile::deleteFile(const char* path)
+{
+	return DeleteFile(path) != FALSE;
+}
+
+bool OsFile::makeDirectory(const char* path)
+{
+	return CreateDirectory(path, NULL) != FALSE || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
 size_t OsFile::pos()
 {
 	ASSERT(nullptr != m_impl);
@@ -176,5 +186,58 @@ OsFile& OsFile::operator <<(float value)
 }
 
 
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+{
+}
+
+
+MappedFile::~MappedFile()
+{
+	ASSERT(!m_data);
+}
+
+
+bool MappedFile::open(const char* path)
+{
+	ASSERT(!m_data);
+	HANDLE file = ::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	DWORD size_high;
+	DWORD size_low = ::GetFileSize(file, &size_high);
+	size_t size = ((size_t)size_high << 32) | size_low;
+	// the view keeps the mapping and the file alive
+	HANDLE mapping = size > 0 ? ::CreateFileMapping(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+	::CloseHandle(file);
+	if (!mapping) return false;
+	void* data = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	::CloseHandle(mapping);
+	if (!data) return false;
+
+	m_data = (u8*)data;
+	m_size = size;
+	return true;
+}
+
+
+void MappedFile::close()
+{
+	if (!m_data) return;
+	::UnmapViewOfFile(m_data);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+void MappedFile::discard(size_t offset, size_t size)
+{
+	ASSERT(offset + size <= m_size);
+	// copied pages can not be dropped from a view, trim them from the working set at least
+	::VirtualUnlock(m_data + offset, size);
+}
+
+
 } // namespace FS
 } // namespace Lumix
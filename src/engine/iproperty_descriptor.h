@@ -33,9 +33,15 @@ public:
 		BLOB
 	};
 
+	// direct access to a single value of the descriptor's type, without blobs and virtual calls
+	typedef void (*RawGetter)(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value);
+	typedef void (*RawSetter)(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value);
+
 public:
 	PropertyDescriptorBase()
 		: m_is_in_radians(false)
+		, m_raw_getter(nullptr)
+		, m_raw_setter(nullptr)
 	{
 	}
 	virtual ~PropertyDescriptorBase() {}
@@ -49,9 +55,13 @@ public:
 	void setName(const char* name);
 	PropertyDescriptorBase& setIsInRadians(bool is) { m_is_in_radians = is; return *this; }
 	bool isInRadians() const { return m_is_in_radians; }
+	RawGetter getRawGetter() const { return m_raw_getter; }
+	RawSetter getRawSetter() const { return m_raw_setter; }
 
 protected:
 	bool m_is_in_radians;
+	RawGetter m_raw_getter;
+	RawSetter m_raw_setter;
 	u32 m_name_hash;
 	StaticString<32> m_name;
 	Type m_type;
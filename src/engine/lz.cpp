@@ -0,0 +1,160 @@
+#include "engine/lz.h"
+#include "engine/math_utils.h"
+#include "engine/string.h"
+
+
+namespace Lumix
+{
+
+
+static const int MIN_MATCH = 4;
+static const int MAX_OFFSET = 0xffff;
+static const int HASH_BITS = 12;
+
+
+static u32 read32(const u8* ptr)
+{
+	u32 value;
+	copyMemory(&value, ptr, sizeof(value));
+	return value;
+}
+
+
+static u32 hash(u32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+
+static void writeLength(u8*& out, int length)
+{
+	while (length >= 255)
+	{
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = (u8)length;
+}
+
+
+static bool readLength(const u8*& in, const u8* in_end, int& length)
+{
+	u8 byte;
+	do
+	{
+		if (in >= in_end) return false;
+		byte = *in++;
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+
+static bool writeSequence(u8*& out,
+	const u8* out_end,
+	const u8* literals,
+	int literals_count,
+	int match_length,
+	int offset)
+{
+	int worst_size = 1 + literals_count + literals_count / 255 + 1 + 2 + match_length / 255 + 1;
+	if (out + worst_size > out_end) return false;
+
+	u8* token = out++;
+	if (literals_count >= 15) writeLength(out, literals_count - 15);
+	copyMemory(out, literals, literals_count);
+	out += literals_count;
+
+	int match_code = match_length > 0 ? match_length - MIN_MATCH : 0;
+	*token = u8((Math::minimum(literals_count, 15) << 4) | Math::minimum(match_code, 15));
+	if (match_length > 0)
+	{
+		*out++ = u8(offset & 0xff);
+		*out++ = u8(offset >> 8);
+		if (match_code >= 15) writeLength(out, match_code - 15);
+	}
+	return true;
+}
+
+
+int lzCompressBound(int size)
+{
+	return size + size / 255 + 16;
+}
+
+
+int lzCompress(const void* src, int src_size, void* dst, int dst_capacity)
+{
+	const u8* in = (const u8*)src;
+	u8* out = (u8*)dst;
+	const u8* out_end = out + dst_capacity;
+
+	int table[1 << HASH_BITS];
+	for (int& i : table) i = -1;
+
+	int anchor = 0;
+	int pos = 0;
+	while (pos + MIN_MATCH <= src_size)
+	{
+		u32 sequence = read32(in + pos);
+		u32 h = hash(sequence);
+		int candidate = table[h];
+		table[h] = pos;
+		if (candidate < 0 || pos - candidate > MAX_OFFSET || read32(in + candidate) != sequence)
+		{
+			++pos;
+			continue;
+		}
+
+		int match_length = MIN_MATCH;
+		while (pos + match_length < src_size && in[candidate + match_length] == in[pos + match_length])
+		{
+			++match_length;
+		}
+		if (!writeSequence(out, out_end, in + anchor, pos - anchor, match_length, pos - candidate)) return 0;
+		pos += match_length;
+		anchor = pos;
+	}
+
+	// the last sequence has only literals, decoder recognizes it by reaching the end of input
+	if (!writeSequence(out, out_end, in + anchor, src_size - anchor, 0, 0)) return 0;
+	return int(out - (u8*)dst);
+}
+
+
+bool lzDecompress(const void* src, int src_size, void* dst, int dst_size)
+{
+	const u8* in = (const u8*)src;
+	const u8* in_end = in + src_size;
+	u8* out = (u8*)dst;
+	u8* out_end = out + dst_size;
+
+	while (in < in_end)
+	{
+		u8 token = *in++;
+		int literals_count = token >> 4;
+		if (literals_count == 15 && !readLength(in, in_end, literals_count)) return false;
+		if (in + literals_count > in_end || out + literals_count > out_end) return false;
+		copyMemory(out, in, literals_count);
+		in += literals_count;
+		out += literals_count;
+
+		if (in == in_end) break;
+
+		if (in + 2 > in_end) return false;
+		int offset = in[0] | (in[1] << 8);
+		in += 2;
+		int match_length = token & 0xf;
+		if (match_length == 15 && !readLength(in, in_end, match_length)) return false;
+		match_length += MIN_MATCH;
+
+		if (offset == 0 || out - (u8*)dst < offset || out + match_length > out_end) return false;
+		const u8* match = out - offset;
+		for (int i = 0; i < match_length; ++i) out[i] = match[i];
+		out += match_length;
+	}
+	return out == out_end;
+}
+
+
+} // namespace Lumix
@@ -0,0 +1,18 @@
+#pragma once
+
+
+#include "engine/lumix.h"
+
+
+namespace Lumix
+{
+
+
+// small LZ77 codec meant for fast transfers, not for archival compression ratios
+LUMIX_ENGINE_API int lzCompressBound(int size);
+// returns compressed size or 0 if the result does not fit in dst_capacity
+LUMIX_ENGINE_API int lzCompress(const void* src, int src_size, void* dst, int dst_capacity);
+LUMIX_ENGINE_API bool lzDecompress(const void* src, int src_size, void* dst, int dst_size);
+
+
+} // namespace Lumix
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "group.h"
 #include "job.h"
 #include "manager.h"
 
@@ -35,6 +36,30 @@ template <class T> MTJD::Job* makeJob(MTJD::Manager& manager, T function, IAlloc
 }
 
 
+// calls f(from, to) for batches of [0, count) in jobs and waits for all of them in sync_point,
+// count <= batch_size runs on the calling thread; sync_point must not be shared by concurrent calls
+template <class T>
+void runBatches(MTJD::Manager& manager, MTJD::Group& sync_point, int count, int batch_size, T& f, IAllocator& allocator)
+{
+	if (count <= batch_size)
+	{
+		f(0, count);
+		return;
+	}
+
+	for (int from = 0; from < count; from += batch_size)
+	{
+		int to = from + batch_size < count ? from + batch_size : count;
+		MTJD::Job* job = makeJob(manager,
+			[&f, from, to]() { f(from, to); },
+			allocator);
+		job->addDependency(&sync_point);
+		manager.schedule(job);
+	}
+	sync_point.sync();
+}
+
+
 } // namespace MTJD
 
 
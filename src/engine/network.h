@@ -66,6 +66,8 @@ public:
 
 	bool read(void* buffer, size_t size);
 	bool write(const void* buffer, size_t size);
+	// makes pending and following reads and writes fail, safe to call from another thread
+	void shutdown();
 
 private:
 	TCPStream();
@@ -233,6 +233,8 @@ public:
 		setName(name);
 		m_single.getter = _getter;
 		m_single.setter = _setter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = INTEGER;
 		m_min = getIntPropertyMin();
 		m_max = getIntPropertyMax();
@@ -290,6 +292,21 @@ public:
 
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const IntPropertyDescriptor&>(desc);
+		*(int*)value = (static_cast<S*>(scene)->*that.m_single.getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const IntPropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_single.setter)(cmp, *(const int*)value);
+	}
+
+
+
 	union
 	{
 		struct
@@ -318,6 +335,8 @@ public:
 		setName(name);
 		m_getter = getter;
 		m_setter = setter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = PropertyDescriptorBase::BOOL;
 	}
 
@@ -340,6 +359,20 @@ public:
 	};
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const BoolPropertyDescriptor&>(desc);
+		*(bool*)value = (static_cast<S*>(scene)->*that.m_getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const BoolPropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_setter)(cmp, *(const bool*)value);
+	}
+
+
 	Getter m_getter;
 	Setter m_setter;
 };
@@ -359,6 +392,8 @@ public:
 		setName(name);
 		m_single.getter = getter;
 		m_single.setter = setter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = toPropertyType<T>();
 	}
 
@@ -405,6 +440,21 @@ public:
 
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const SimplePropertyDescriptor&>(desc);
+		*(T*)value = (static_cast<S*>(scene)->*that.m_single.getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const SimplePropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_single.setter)(cmp, *(const T*)value);
+	}
+
+
+
 	union
 	{
 		struct
@@ -628,6 +678,8 @@ public:
 		setName(name);
 		m_single.getter = _getter;
 		m_single.setter = _setter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = ENTITY;
 	}
 
@@ -672,6 +724,21 @@ public:
 
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const EntityPropertyDescriptor&>(desc);
+		*(Entity*)value = (static_cast<S*>(scene)->*that.m_single.getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const EntityPropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_single.setter)(cmp, *(const Entity*)value);
+	}
+
+
+
 	union {
 		struct
 		{
@@ -743,6 +810,8 @@ public:
 		m_setter = _setter;
 		m_array_getter = nullptr;
 		m_array_setter = nullptr;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_min = min;
 		m_max = max;
 		m_step = step;
@@ -801,6 +870,20 @@ public:
 	};
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const DecimalPropertyDescriptor&>(desc);
+		*(float*)value = (static_cast<S*>(scene)->*that.m_getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const DecimalPropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_setter)(cmp, *(const float*)value);
+	}
+
+
 	Getter m_getter;
 	Setter m_setter;
 	ArrayGetter m_array_getter;
@@ -838,6 +921,8 @@ public:
 		setName(name);
 		m_getter = _getter;
 		m_setter = _setter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = ENUM;
 	}
 
@@ -863,6 +948,20 @@ public:
 	const char* getEnumItemName(IScene* scene, ComponentHandle, int index) override { return GetItemName(index); }
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const EnumPropertyDescriptor&>(desc);
+		*(int*)value = (int)(static_cast<Scene*>(scene)->*that.m_getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const EnumPropertyDescriptor&>(desc);
+		(static_cast<Scene*>(scene)->*that.m_setter)(cmp, (Item)*(const int*)value);
+	}
+
+
 	Getter m_getter;
 	Setter m_setter;
 };
@@ -889,6 +988,8 @@ public:
 		m_setter = _setter;
 		m_enum_count_getter = count_getter;
 		m_enum_name_getter = enum_name_getter;
+		m_raw_getter = &getRaw;
+		m_raw_setter = &setRaw;
 		m_type = ENUM;
 	}
 
@@ -920,6 +1021,20 @@ public:
 	}
 
 private:
+	static void getRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, void* value)
+	{
+		auto& that = static_cast<const DynamicEnumPropertyDescriptor&>(desc);
+		*(int*)value = (static_cast<S*>(scene)->*that.m_getter)(cmp);
+	}
+
+
+	static void setRaw(const PropertyDescriptorBase& desc, IScene* scene, ComponentHandle cmp, const void* value)
+	{
+		auto& that = static_cast<const DynamicEnumPropertyDescriptor&>(desc);
+		(static_cast<S*>(scene)->*that.m_setter)(cmp, *(const int*)value);
+	}
+
+
 	Getter m_getter;
 	Setter m_setter;
 	EnumCountGetter m_enum_count_getter;
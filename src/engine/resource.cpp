@@ -7,6 +7,7 @@
 #include "engine/resource.h"
 #include "engine/resource_manager.h"
 #include "engine/resource_manager_base.h"
+#include "engine/resource_manifest.h"
 
 
 namespace Lumix
@@ -87,10 +88,13 @@ void Resource::fileLoaded(FS::IFile& file, bool success)
 		return;
 	}
 
+	ResourceManifest* manifest = m_resource_manager.getOwner().getManifestRecorder();
+	int prev_parent = manifest ? manifest->beginDependencies(m_path) : -1;
 	if (!load(file))
 	{
 		++m_failed_dep_count;
 	}
+	if (manifest) manifest->endDependencies(prev_parent);
 
 	--m_empty_dep_count;
 	checkState();
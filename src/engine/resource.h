@@ -79,6 +79,7 @@ protected:
 protected:
 	State m_desired_state;
 	u16 m_empty_dep_count;
+	u16 m_failed_dep_count;
 	size_t m_size;
 	ResourceManagerBase& m_resource_manager;
 
@@ -99,7 +100,6 @@ private:
 	ObserverCallback m_cb;
 	Path m_path;
 	u16 m_ref_count;
-	u16 m_failed_dep_count;
 	State m_current_state;
 	u32 m_async_op;
 }; // class Resource
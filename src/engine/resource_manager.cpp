@@ -10,6 +10,7 @@ namespace Lumix
 		: m_resource_managers(allocator)
 		, m_allocator(allocator)
 		, m_file_system(nullptr)
+		, m_manifest_recorder(nullptr)
 	{
 	}
 
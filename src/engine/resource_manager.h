@@ -20,6 +20,7 @@ class FileSystem;
 
 
 class ResourceManagerBase;
+class ResourceManifest;
 
 
 class LUMIX_ENGINE_API ResourceManager
@@ -44,11 +45,14 @@ public:
 	void enableUnload(bool enable);
 
 	FS::FileSystem& getFileSystem() { return *m_file_system; }
+	void setManifestRecorder(ResourceManifest* manifest) { m_manifest_recorder = manifest; }
+	ResourceManifest* getManifestRecorder() const { return m_manifest_recorder; }
 
 private:
 	IAllocator& m_allocator;
 	ResourceManagerTable m_resource_managers;
 	FS::FileSystem* m_file_system;
+	ResourceManifest* m_manifest_recorder;
 };
 
 
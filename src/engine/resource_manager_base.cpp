@@ -1,4 +1,5 @@
 #include "engine/resource_manager_base.h"
+#include "engine/resource_manifest.h"
 #include "engine/crc32.h"
 #include "engine/log.h"
 #include "engine/lumix.h"
@@ -14,6 +15,7 @@ namespace Lumix
 	{
 		owner.add(type, this);
 		m_owner = &owner;
+		m_type = type;
 	}
 
 	void ResourceManagerBase::destroy(void)
@@ -51,6 +53,9 @@ namespace Lumix
 			resource = createResource(path);
 			m_resources.insert(path.getHash(), resource);
 		}
+
+		ResourceManifest* manifest = m_owner->getManifestRecorder();
+		if (manifest) manifest->add(m_type, path);
 		
 		if(resource->isEmpty())
 		{
@@ -2,6 +2,7 @@
 
 
 #include "engine/hash_map.h"
+#include "engine/resource.h"
 
 
 namespace Lumix
@@ -15,8 +16,6 @@ class FileSystem;
 
 
 class Path;
-class Resource;
-struct ResourceType;
 class ResourceManager;
 
 
@@ -56,6 +55,7 @@ private:
 	IAllocator& m_allocator;
 	ResourceTable m_resources;
 	ResourceManager* m_owner;
+	ResourceType m_type;
 	bool m_is_unload_enabled;
 };
 
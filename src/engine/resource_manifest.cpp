@@ -0,0 +1,201 @@
+#include "engine/resource_manifest.h"
+#include "engine/blob.h"
+#include "engine/log.h"
+#include "engine/path_utils.h"
+#include "engine/profiler.h"
+#include "engine/resource_manager.h"
+#include "engine/resource_manager_base.h"
+#include "engine/string.h"
+
+
+namespace Lumix
+{
+
+
+enum class ManifestVersion : int
+{
+	FIRST,
+
+	LATEST
+};
+
+
+static ResourceManagerBase* getManager(ResourceManager& resource_manager, ResourceType type)
+{
+	auto iter = resource_manager.getAll().find(type.type);
+	return iter.isValid() ? iter.value() : nullptr;
+}
+
+
+ResourceManifest::ResourceManifest(IAllocator& allocator)
+	: m_allocator(allocator)
+	, m_entries(allocator)
+	, m_map(allocator)
+	, m_preloaded(allocator)
+	, m_current_parent(-1)
+{
+}
+
+
+ResourceManifest::~ResourceManifest()
+{
+	releasePreloaded();
+}
+
+
+void ResourceManifest::clear()
+{
+	m_entries.clear();
+	m_map.clear();
+	m_current_parent = -1;
+}
+
+
+void ResourceManifest::add(ResourceType type, const Path& path)
+{
+	if (m_map.find(path.getHash()).isValid()) return;
+
+	m_map.insert(path.getHash(), m_entries.size());
+	Entry& entry = m_entries.emplace();
+	entry.type = type;
+	entry.path = path;
+	entry.parent = m_current_parent;
+}
+
+
+int ResourceManifest::beginDependencies(const Path& path)
+{
+	int prev = m_current_parent;
+	auto iter = m_map.find(path.getHash());
+	m_current_parent = iter.isValid() ? iter.value() : -1;
+	return prev;
+}
+
+
+void ResourceManifest::endDependencies(int prev_parent)
+{
+	m_current_parent = prev_parent;
+}
+
+
+void ResourceManifest::serialize(OutputBlob& blob, ResourceManager& resource_manager) const
+{
+	// only resources still alive are written, parents are remapped to the filtered indices
+	Array<int> remap(m_allocator);
+	remap.resize(m_entries.size());
+	int count = 0;
+	for (int i = 0, c = m_entries.size(); i < c; ++i)
+	{
+		const Entry& entry = m_entries[i];
+		remap[i] = -1;
+		ResourceManagerBase* manager = getManager(resource_manager, entry.type);
+		if (!manager) continue;
+		auto iter = manager->getResourceTable().find(entry.path.getHash());
+		if (!iter.isValid()) continue;
+		if (iter.value()->getRefCount() == 0 || iter.value()->isFailure()) continue;
+		remap[i] = count;
+		++count;
+	}
+
+	blob.write((u32)MAGIC);
+	blob.write((int)ManifestVersion::LATEST);
+	blob.write(count);
+	for (int i = 0, c = m_entries.size(); i < c; ++i)
+	{
+		if (remap[i] < 0) continue;
+		const Entry& entry = m_entries[i];
+		blob.write(entry.type.type);
+		blob.write(entry.parent < 0 ? -1 : remap[entry.parent]);
+		blob.writeString(entry.path.c_str());
+	}
+}
+
+
+static bool readPath(InputBlob& blob, char (&path)[MAX_PATH_LENGTH])
+{
+	i32 size;
+	if (!blob.read(&size, sizeof(size))) return false;
+	if (size <= 0 || size > lengthOf(path)) return false;
+	if (!blob.read(path, size)) return false;
+	return path[size - 1] == '\0';
+}
+
+
+bool ResourceManifest::deserialize(InputBlob& blob)
+{
+	clear();
+	u32 magic;
+	int version;
+	blob.read(magic);
+	blob.read(version);
+	if (magic != MAGIC || version > (int)ManifestVersion::LATEST) return false;
+
+	// type, parent and path length, the smallest possible entry
+	static const int MIN_ENTRY_SIZE = sizeof(u32) + sizeof(int) + sizeof(i32);
+	int count = 0;
+	if (!blob.read(&count, sizeof(count)) || count < 0 ||
+		count > (blob.getSize() - blob.getPosition()) / MIN_ENTRY_SIZE)
+	{
+		g_log_warning.log("Engine") << "Corrupted resource manifest, ignoring it";
+		return false;
+	}
+
+	m_entries.reserve(count);
+	for (int i = 0; i < count; ++i)
+	{
+		ResourceType type;
+		int parent;
+		char path[MAX_PATH_LENGTH];
+		blob.read(type.type);
+		blob.read(parent);
+		if (!readPath(blob, path))
+		{
+			g_log_warning.log("Engine") << "Corrupted resource manifest, ignoring it";
+			clear();
+			return false;
+		}
+		m_current_parent = parent < i ? parent : -1;
+		add(type, Path(path));
+	}
+	m_current_parent = -1;
+	return true;
+}
+
+
+void ResourceManifest::preload(ResourceManager& resource_manager)
+{
+	PROFILE_FUNCTION();
+	// leaves first, so the deepest dependencies are already in flight when their users parse
+	for (int i = m_entries.size() - 1; i >= 0; --i)
+	{
+		const Entry& entry = m_entries[i];
+		ResourceManagerBase* manager = getManager(resource_manager, entry.type);
+		if (!manager) continue;
+		m_preloaded.push(manager->load(entry.path));
+	}
+}
+
+
+void ResourceManifest::releasePreloaded()
+{
+	for (Resource* resource : m_preloaded)
+	{
+		resource->getResourceManager().unload(*resource);
+	}
+	m_preloaded.clear();
+}
+
+
+void ResourceManifest::getPath(char* out, int max_size, const char* universe_path)
+{
+	char dir[MAX_PATH_LENGTH];
+	char basename[MAX_PATH_LENGTH];
+	PathUtils::getDir(dir, lengthOf(dir), universe_path);
+	PathUtils::getBasename(basename, lengthOf(basename), universe_path);
+	copyString(out, max_size, dir);
+	catString(out, max_size, basename);
+	catString(out, max_size, ".lpm");
+}
+
+
+} // namespace Lumix
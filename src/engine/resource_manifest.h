@@ -0,0 +1,64 @@
+#pragma once
+
+
+#include "engine/array.h"
+#include "engine/hash_map.h"
+#include "engine/path.h"
+#include "engine/resource.h"
+
+
+namespace Lumix
+{
+
+
+class InputBlob;
+class OutputBlob;
+class ResourceManager;
+
+
+// Ordered list of resources requested while a universe was loaded.
+// Saved next to the universe and replayed on the next load, so the whole
+// dependency chain (model -> material -> shader -> texture) is issued at once
+// instead of being discovered one file read at a time.
+class LUMIX_ENGINE_API ResourceManifest
+{
+public:
+	struct Entry
+	{
+		ResourceType type;
+		Path path;
+		int parent;
+	};
+
+public:
+	static const u32 MAGIC = 0x5f4c504d; // '_LPM'
+
+public:
+	explicit ResourceManifest(IAllocator& allocator);
+	~ResourceManifest();
+
+	void clear();
+	void add(ResourceType type, const Path& path);
+	int beginDependencies(const Path& path);
+	void endDependencies(int prev_parent);
+	int getCount() const { return m_entries.size(); }
+	const Entry& getEntry(int index) const { return m_entries[index]; }
+
+	void serialize(OutputBlob& blob, ResourceManager& resource_manager) const;
+	bool deserialize(InputBlob& blob);
+
+	void preload(ResourceManager& resource_manager);
+	void releasePreloaded();
+
+	static void getPath(char* out, int max_size, const char* universe_path);
+
+private:
+	IAllocator& m_allocator;
+	Array<Entry> m_entries;
+	HashMap<u32, int> m_map;
+	Array<Resource*> m_preloaded;
+	int m_current_parent;
+};
+
+
+} // namespace Lumix
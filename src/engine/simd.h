@@ -5,7 +5,7 @@
 
 
 #ifdef _WIN32
-	#include <xmmintrin.h>
+	#include <emmintrin.h>
 #else
 	#include <cmath>
 #endif
@@ -42,6 +42,18 @@ namespace Lumix
 	}
 
 
+	LUMIX_FORCE_INLINE void f4StoreUnaligned(void* dest, float4 src)
+	{
+		_mm_storeu_ps((float*)dest, src);
+	}
+
+
+	LUMIX_FORCE_INLINE void f4Transpose(float4& a, float4& b, float4& c, float4& d)
+	{
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+	}
+
+
 	LUMIX_FORCE_INLINE int f4MoveMask(float4 a)
 	{
 		return _mm_movemask_ps(a);
@@ -101,6 +113,74 @@ namespace Lumix
 		return _mm_max_ps(a, b);
 	}
 
+
+	typedef __m128i int4;
+
+
+	LUMIX_FORCE_INLINE int4 i4LoadUnaligned(const void* src)
+	{
+		return _mm_loadu_si128((const __m128i*)src);
+	}
+
+
+	// zero extends 4 bytes
+	LUMIX_FORCE_INLINE int4 i4LoadU8(const void* src)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i v = _mm_cvtsi32_si128(*(const int*)src);
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+	}
+
+
+	// zero extends 4 u16
+	LUMIX_FORCE_INLINE int4 i4LoadU16(const void* src)
+	{
+		return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)src), _mm_setzero_si128());
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Splat(i32 value)
+	{
+		return _mm_set1_epi32(value);
+	}
+
+
+	LUMIX_FORCE_INLINE void i4StoreUnaligned(void* dest, int4 src)
+	{
+		_mm_storeu_si128((__m128i*)dest, src);
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Add(int4 a, int4 b)
+	{
+		return _mm_add_epi32(a, b);
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4And(int4 a, int4 b)
+	{
+		return _mm_and_si128(a, b);
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Or(int4 a, int4 b)
+	{
+		return _mm_or_si128(a, b);
+	}
+
+
+	LUMIX_FORCE_INLINE void i4Transpose(int4& a, int4& b, int4& c, int4& d)
+	{
+		__m128i ab_lo = _mm_unpacklo_epi32(a, b);
+		__m128i cd_lo = _mm_unpacklo_epi32(c, d);
+		__m128i ab_hi = _mm_unpackhi_epi32(a, b);
+		__m128i cd_hi = _mm_unpackhi_epi32(c, d);
+		a = _mm_unpacklo_epi64(ab_lo, cd_lo);
+		b = _mm_unpackhi_epi64(ab_lo, cd_lo);
+		c = _mm_unpacklo_epi64(ab_hi, cd_hi);
+		d = _mm_unpackhi_epi64(ab_hi, cd_hi);
+	}
+
 #else 
 	struct float4
 	{
@@ -132,6 +212,25 @@ namespace Lumix
 	}
 
 
+	LUMIX_FORCE_INLINE void f4StoreUnaligned(void* dest, float4 src)
+	{
+		(*(float4*)dest) = src;
+	}
+
+
+	LUMIX_FORCE_INLINE void f4Transpose(float4& a, float4& b, float4& c, float4& d)
+	{
+		float4 ta = {a.x, b.x, c.x, d.x};
+		float4 tb = {a.y, b.y, c.y, d.y};
+		float4 tc = {a.z, b.z, c.z, d.z};
+		float4 td = {a.w, b.w, c.w, d.w};
+		a = ta;
+		b = tb;
+		c = tc;
+		d = td;
+	}
+
+
 	LUMIX_FORCE_INLINE int f4MoveMask(float4 a)
 	{
 		return (a.w < 0 ? (1 << 3) : 0) | 
@@ -239,6 +338,80 @@ namespace Lumix
 		};
 	}
 
+
+	struct int4
+	{
+		i32 x, y, z, w;
+	};
+
+
+	LUMIX_FORCE_INLINE int4 i4LoadUnaligned(const void* src)
+	{
+		return *(const int4*)src;
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4LoadU8(const void* src)
+	{
+		const u8* v = (const u8*)src;
+		return {v[0], v[1], v[2], v[3]};
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4LoadU16(const void* src)
+	{
+		const u16* v = (const u16*)src;
+		return {v[0], v[1], v[2], v[3]};
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Splat(i32 value)
+	{
+		return {value, value, value, value};
+	}
+
+
+	LUMIX_FORCE_INLINE void i4StoreUnaligned(void* dest, int4 src)
+	{
+		(*(int4*)dest) = src;
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Add(int4 a, int4 b)
+	{
+		return{
+			i32(u32(a.x) + u32(b.x)),
+			i32(u32(a.y) + u32(b.y)),
+			i32(u32(a.z) + u32(b.z)),
+			i32(u32(a.w) + u32(b.w))
+		};
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4And(int4 a, int4 b)
+	{
+		return {a.x & b.x, a.y & b.y, a.z & b.z, a.w & b.w};
+	}
+
+
+	LUMIX_FORCE_INLINE int4 i4Or(int4 a, int4 b)
+	{
+		return {a.x | b.x, a.y | b.y, a.z | b.z, a.w | b.w};
+	}
+
+
+	LUMIX_FORCE_INLINE void i4Transpose(int4& a, int4& b, int4& c, int4& d)
+	{
+		int4 ta = {a.x, b.x, c.x, d.x};
+		int4 tb = {a.y, b.y, c.y, d.y};
+		int4 tc = {a.z, b.z, c.z, d.z};
+		int4 td = {a.w, b.w, c.w, d.w};
+		a = ta;
+		b = tb;
+		c = tc;
+		d = td;
+	}
+
 #endif
 
 
@@ -214,6 +214,36 @@ void Universe::setTransform(Entity entity, const Vec3& pos, const Quat& rot)
 }
 
 
+void Universe::setTransforms(const Entity* entities, const Transform* transforms, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		auto& tmp = m_entities[entities[i].index];
+		tmp.position = transforms[i].pos;
+		tmp.rotation = transforms[i].rot;
+	}
+
+	// local transforms are updated only after all entities are written, so a parent and its child
+	// in the same batch both keep their new transforms regardless of their order
+	for (int i = 0; i < count; ++i)
+	{
+		int hierarchy_idx = m_entities[entities[i].index].hierarchy;
+		if (hierarchy_idx < 0) continue;
+
+		Hierarchy& h = m_hierarchy[hierarchy_idx];
+		if (!h.parent.isValid()) continue;
+
+		h.local_transform = getTransform(h.parent).inverted() * getTransform(entities[i]);
+		h.local_scale = getScale(h.parent) * getScale(entities[i]);
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		transformEntity(entities[i], false);
+	}
+}
+
+
 Transform Universe::getTransform(Entity entity) const
 {
 	auto& transform = m_entities[entity.index];
@@ -87,6 +87,7 @@ public:
 	void setTransformKeepChildren(Entity entity, const Transform& transform, float scale);
 	void setTransform(Entity entity, const Transform& transform, float scale);
 	void setTransform(Entity entity, const Vec3& pos, const Quat& rot);
+	void setTransforms(const Entity* entities, const Transform* transforms, int count);
 	Transform getTransform(Entity entity) const;
 	void setRotation(Entity entity, float x, float y, float z, float w);
 	void setRotation(Entity entity, const Quat& rot);
@@ -0,0 +1,273 @@
+#include "engine/universe_saver.h"
+#include "engine/crc32.h"
+#include "engine/engine.h"
+#include "engine/fs/disk_file_device.h"
+#include "engine/fs/file_system.h"
+#include "engine/fs/os_file.h"
+#include "engine/log.h"
+#include "engine/lz.h"
+#include "engine/mt/atomic.h"
+#include "engine/mt/thread.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/manager.h"
+#include "engine/profiler.h"
+#include "engine/string.h"
+
+
+namespace Lumix
+{
+
+
+// header is followed by the size of the serialized data, the size it is stored with, and the stored data
+static const int SIZES_SIZE = 2 * sizeof(u32);
+static const int PAYLOAD_OFFSET = sizeof(UniverseSaver::Header) + SIZES_SIZE;
+
+
+struct UniverseSaver::Buffer
+{
+	enum State : i32
+	{
+		IDLE,
+		SNAPSHOT,
+		SAVING,
+		DONE
+	};
+
+	explicit Buffer(IAllocator& allocator)
+		: blob(allocator)
+		, packed(allocator)
+		, engine_hash_from(0)
+		, engine_hash_to(0)
+		, is_success(false)
+		, is_file_open(false)
+		, state(IDLE)
+	{}
+
+	// fills the header and sizes; compressed data go to `packed`, otherwise `blob` is written as is
+	void finish(bool compress)
+	{
+		PROFILE_FUNCTION();
+		u8* data = (u8*)blob.getMutableData();
+		u32 raw_size = u32(blob.getPos() - PAYLOAD_OFFSET);
+		u32 stored_size = raw_size;
+		packed.clear();
+		if (compress && raw_size > 0)
+		{
+			packed.resize(SIZES_SIZE + lzCompressBound(raw_size));
+			int packed_size = lzCompress(data + PAYLOAD_OFFSET, raw_size, &packed[SIZES_SIZE], raw_size - 1);
+			if (packed_size > 0)
+			{
+				stored_size = packed_size;
+				packed.resize(SIZES_SIZE + packed_size);
+				copyMemory(&packed[0], &raw_size, sizeof(raw_size));
+				copyMemory(&packed[sizeof(raw_size)], &stored_size, sizeof(stored_size));
+			}
+			else
+			{
+				packed.clear();
+			}
+		}
+
+		Header& header = *(Header*)data;
+		header.magic = MAGIC;
+		header.version = (int)Version::LATEST;
+		header.engine_hash = crc32(data + engine_hash_from, engine_hash_to - engine_hash_from);
+		copyMemory(data + sizeof(Header), &raw_size, sizeof(raw_size));
+		copyMemory(data + sizeof(Header) + sizeof(raw_size), &stored_size, sizeof(stored_size));
+		if (packed.empty())
+		{
+			header.hash = crc32(data + sizeof(Header), blob.getPos() - sizeof(Header));
+		}
+		else
+		{
+			header.hash = crc32(&packed[0], packed.size());
+		}
+	}
+
+	template <typename File> bool write(File& file)
+	{
+		if (packed.empty()) return file.write(blob.getData(), blob.getPos());
+		return file.write(blob.getData(), sizeof(Header)) && file.write(&packed[0], packed.size());
+	}
+
+	OutputBlob blob;
+	Array<u8> packed;
+	FS::OsFile file;
+	bool is_file_open;
+	Path path;
+	Callback callback;
+	int engine_hash_from;
+	int engine_hash_to;
+	bool is_success;
+	volatile i32 state;
+};
+
+
+UniverseSaver::UniverseSaver(Engine& engine, IAllocator& allocator)
+	: m_engine(engine)
+	, m_allocator(allocator)
+	, m_snapshot(nullptr)
+{
+	for (Buffer*& buffer : m_buffers) buffer = LUMIX_NEW(m_allocator, Buffer)(m_allocator);
+}
+
+
+UniverseSaver::~UniverseSaver()
+{
+	wait();
+	for (Buffer* buffer : m_buffers) LUMIX_DELETE(m_allocator, buffer);
+}
+
+
+UniverseSaver::Buffer& UniverseSaver::getIdleBuffer()
+{
+	for (;;)
+	{
+		update();
+		for (Buffer* buffer : m_buffers)
+		{
+			if (buffer->state == Buffer::IDLE) return *buffer;
+		}
+		MT::sleep(1);
+	}
+}
+
+
+OutputBlob& UniverseSaver::snapshot(Universe& universe)
+{
+	PROFILE_FUNCTION();
+	ASSERT(!m_snapshot);
+	m_snapshot = &getIdleBuffer();
+	m_snapshot->state = Buffer::SNAPSHOT;
+
+	OutputBlob& blob = m_snapshot->blob;
+	blob.clear();
+	Header header = {};
+	blob.write(header);
+	blob.write((u64)0);
+	int engine_begin = m_engine.serializeUnhashed(universe, blob);
+	m_snapshot->engine_hash_from = engine_begin;
+	m_snapshot->engine_hash_to = blob.getPos();
+	return blob;
+}
+
+
+void UniverseSaver::save(FS::IFile& file)
+{
+	ASSERT(m_snapshot);
+	m_snapshot->finish(false);
+	m_snapshot->write(file);
+	m_snapshot->state = Buffer::IDLE;
+	m_snapshot = nullptr;
+}
+
+
+void UniverseSaver::saveAsync(const Path& path, bool compress, const Callback& callback)
+{
+	ASSERT(m_snapshot);
+	Buffer* buffer = m_snapshot;
+	m_snapshot = nullptr;
+	buffer->path = path;
+	buffer->callback = callback;
+	buffer->is_success = false;
+	buffer->state = Buffer::SAVING;
+
+	// the file system's device chain is not thread safe, so the job writes to an OS file opened here
+	char full_path[MAX_PATH_LENGTH];
+	FS::DiskFileDevice* disk = m_engine.getDiskFileDevice();
+	if (!disk || (path.length() > 1 && path.c_str()[1] == ':'))
+	{
+		copyString(full_path, path.c_str());
+	}
+	else
+	{
+		copyString(full_path, disk->getBasePath());
+		catString(full_path, path.c_str());
+	}
+	buffer->is_file_open = buffer->file.open(full_path, FS::Mode::CREATE_AND_WRITE, m_allocator);
+
+	MTJD::Job* job = MTJD::makeJob(m_engine.getMTJDManager(),
+		[buffer, compress]() {
+			PROFILE_BLOCK("Save universe");
+			buffer->finish(compress);
+			if (buffer->is_file_open) buffer->is_success = buffer->write(buffer->file);
+			MT::memoryBarrier();
+			buffer->state = Buffer::DONE;
+		},
+		m_allocator);
+	m_engine.getMTJDManager().schedule(job);
+}
+
+
+void UniverseSaver::update()
+{
+	for (Buffer* buffer : m_buffers)
+	{
+		if (buffer->state != Buffer::DONE) continue;
+
+		MT::memoryBarrier();
+		if (buffer->is_file_open) buffer->file.close();
+		buffer->is_file_open = false;
+		buffer->packed.clear();
+		buffer->state = Buffer::IDLE;
+		if (!buffer->is_success) g_log_error.log("Engine") << "Failed to save " << buffer->path;
+		if (buffer->callback.isValid()) buffer->callback.invoke(buffer->path, buffer->is_success);
+	}
+}
+
+
+void UniverseSaver::wait()
+{
+	while (isSaving())
+	{
+		update();
+		MT::sleep(1);
+	}
+	update();
+}
+
+
+bool UniverseSaver::isSaving() const
+{
+	for (Buffer* buffer : m_buffers)
+	{
+		if (buffer->state == Buffer::SAVING) return true;
+	}
+	return false;
+}
+
+
+const u8* UniverseSaver::unpack(const void* data, int size, Array<u8>& storage, int* payload_size)
+{
+	PROFILE_FUNCTION();
+	if (size < (int)sizeof(Header)) return nullptr;
+
+	const u8* bytes = (const u8*)data;
+	Header header;
+	copyMemory(&header, bytes, sizeof(header));
+	if (header.magic != MAGIC || header.version > (int)Version::LATEST) return nullptr;
+	if (crc32(bytes + sizeof(header), size - sizeof(header)) != header.hash) return nullptr;
+
+	if (header.version < (int)Version::COMPRESSED)
+	{
+		*payload_size = size - sizeof(header);
+		return bytes + sizeof(header);
+	}
+
+	if (size < PAYLOAD_OFFSET) return nullptr;
+	u32 raw_size;
+	u32 stored_size;
+	copyMemory(&raw_size, bytes + sizeof(header), sizeof(raw_size));
+	copyMemory(&stored_size, bytes + sizeof(header) + sizeof(raw_size), sizeof(stored_size));
+	if (stored_size != u32(size - PAYLOAD_OFFSET)) return nullptr;
+
+	*payload_size = (int)raw_size;
+	if (stored_size == raw_size) return bytes + PAYLOAD_OFFSET;
+
+	storage.resize(raw_size);
+	if (!lzDecompress(bytes + PAYLOAD_OFFSET, stored_size, &storage[0], raw_size)) return nullptr;
+	return &storage[0];
+}
+
+
+} // namespace Lumix
@@ -0,0 +1,78 @@
+#pragma once
+
+
+#include "engine/array.h"
+#include "engine/blob.h"
+#include "engine/delegate.h"
+#include "engine/path.h"
+
+
+namespace Lumix
+{
+
+
+class Engine;
+class Universe;
+namespace FS
+{
+struct IFile;
+}
+
+
+// Saves universes without stalling the caller. The universe is serialized on the calling thread
+// into one of two buffers, compression, hashing and the file write then run on a job.
+class LUMIX_ENGINE_API UniverseSaver
+{
+public:
+	typedef Delegate<void(const Path&, bool)> Callback;
+
+	#pragma pack(1)
+		struct Header
+		{
+			u32 magic;
+			int version;
+			u32 hash;
+			u32 engine_hash;
+		};
+	#pragma pack()
+
+	enum class Version : int
+	{
+		FIRST,
+		COMPRESSED,
+
+		LATEST
+	};
+
+	static const u32 MAGIC = 0xffffFFFF;
+
+public:
+	UniverseSaver(Engine& engine, IAllocator& allocator);
+	~UniverseSaver();
+
+	// serializes the engine part of the universe, callers append their own data to the returned blob
+	OutputBlob& snapshot(Universe& universe);
+	void save(FS::IFile& file);
+	void saveAsync(const Path& path, bool compress, const Callback& callback);
+	// calls callbacks of finished saves
+	void update();
+	void wait();
+	bool isSaving() const;
+
+	// checks the hash and decompresses if needed, returns the data written after snapshot or nullptr
+	static const u8* unpack(const void* data, int size, Array<u8>& storage, int* payload_size);
+
+private:
+	struct Buffer;
+
+	Buffer& getIdleBuffer();
+
+private:
+	Engine& m_engine;
+	IAllocator& m_allocator;
+	Buffer* m_buffers[2];
+	Buffer* m_snapshot;
+};
+
+
+} // namespace Lumix
@@ -167,5 +167,11 @@ bool TCPStream::write(const void* buffer, size_t size)
 }
 
 
+void TCPStream::shutdown()
+{
+	::shutdown(m_socket, SD_BOTH);
+}
+
+
 } // namespace Net
 } // namespace Lumix
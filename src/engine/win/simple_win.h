@@ -43,7 +43,12 @@
 #define CREATE_SUSPENDED 0x00000004
 #define EXCEPTION_EXECUTE_HANDLER 1
 #define GetFileAttributes  GetFileAttributesA
+#define DeleteFile DeleteFileA
+#define CreateDirectory CreateDirectoryA
 #define CreateFile CreateFileA
+#define CreateFileMapping CreateFileMappingA
+#define PAGE_WRITECOPY 0x08
+#define FILE_MAP_COPY 0x0001
 #define CreateSemaphore CreateSemaphoreA
 #define CreateMutex CreateMutexA
 #define CreateEvent CreateEventA
@@ -110,6 +115,7 @@ CreateWindowExA(0L,                 \
 #define FILE_NOTIFY_CHANGE_SECURITY 0x00000100
 #define CALLBACK __stdcall
 #define ERROR_OPERATION_ABORTED 995L
+#define ERROR_ALREADY_EXISTS 183L
 #define FILE_ACTION_ADDED 0x00000001
 #define FILE_ACTION_REMOVED 0x00000002
 #define FILE_ACTION_MODIFIED 0x00000003
@@ -537,6 +543,19 @@ WINBASEAPI VOID WINAPI RaiseException(DWORD dwExceptionCode,
 WINBASEAPI BOOL WINAPI QueryPerformanceCounter(LARGE_INTEGER* lpPerformanceCount);
 WINBASEAPI BOOL WINAPI QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency);
 WINBASEAPI BOOL WINAPI CancelIoEx(HANDLE hFile, LPOVERLAPPED lpOverlapped);
+WINBASEAPI HANDLE WINAPI CreateFileMappingA(HANDLE hFile,
+	LPSECURITY_ATTRIBUTES lpFileMappingAttributes,
+	DWORD flProtect,
+	DWORD dwMaximumSizeHigh,
+	DWORD dwMaximumSizeLow,
+	LPCSTR lpName);
+WINBASEAPI LPVOID WINAPI MapViewOfFile(HANDLE hFileMappingObject,
+	DWORD dwDesiredAccess,
+	DWORD dwFileOffsetHigh,
+	DWORD dwFileOffsetLow,
+	SIZE_T dwNumberOfBytesToMap);
+WINBASEAPI BOOL WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress);
+WINBASEAPI BOOL WINAPI VirtualUnlock(LPVOID lpAddress, SIZE_T dwSize);
 WINBASEAPI BOOL WINAPI ReadDirectoryChangesW(HANDLE hDirectory,
 	LPVOID lpBuffer,
 	DWORD nBufferLength,
@@ -566,6 +585,9 @@ WINBASEAPI BOOL WINAPI FindClose(HANDLE hFindFile);
 WINBASEAPI BOOL WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
 WINBASEAPI VOID WINAPI OutputDebugStringA(LPCSTR lpOutputString);
 WINBASEAPI DWORD WINAPI GetFileAttributesA(LPCSTR lpFileName);
+WINBASEAPI BOOL WINAPI DeleteFileA(LPCSTR lpFileName);
+WINBASEAPI BOOL WINAPI CreateDirectoryA(LPCSTR lpPathName, LPSECURITY_ATTRIBUTES lpSecurityAttributes);
+WINBASEAPI DWORD WINAPI GetLastError();
 WINUSERAPI BOOL WINAPI OpenClipboard(HWND hWndNewOwner);
 WINUSERAPI HANDLE WINAPI SetClipboardData(UINT uFormat, HANDLE hMem);
 
@@ -30,6 +30,8 @@ namespace Lumix
 
 	static const ComponentType LUA_SCRIPT_TYPE = PropertyRegister::getComponentType("lua_script");
 	static const ResourceType LUA_SCRIPT_RESOURCE_TYPE("lua_script");
+	static const char* const CALLBACK_NAMES[] = {"onContact", "onTrigger", "onPathFinished"};
+	static_assert(sizeof(CALLBACK_NAMES) / sizeof(CALLBACK_NAMES[0]) == (int)LuaScriptScene::Callback::COUNT, "missing callback names");
 
 
 	enum class LuaSceneVersion : int
@@ -50,10 +52,12 @@ namespace Lumix
 		void destroyScene(IScene* scene) override;
 		const char* getName() const override { return "lua_script"; }
 		LuaScriptManager& getScriptManager() { return m_script_manager; }
+		const char* getProfilerName(const Path& path);
 
 		Engine& m_engine;
 		Debug::Allocator m_allocator;
 		LuaScriptManager m_script_manager;
+		HashMap<u32, char*> m_profiler_names;
 	};
 
 
@@ -66,11 +70,13 @@ namespace Lumix
 			int func;
 		};
 
+		// grouped by script, func is a registry reference to the script's update function
 		struct UpdateData
 		{
 			LuaScript* script;
+			const char* profiler_name;
 			lua_State* state;
-			int environment;
+			int func;
 		};
 
 
@@ -82,6 +88,7 @@ namespace Lumix
 				, m_state(nullptr)
 				, m_environment(-1)
 				, m_thread_ref(-1)
+				, m_are_callbacks_cached(false)
 			{
 			}
 
@@ -89,6 +96,9 @@ namespace Lumix
 			lua_State* m_state;
 			int m_environment;
 			int m_thread_ref;
+			// registry references to Callback functions, LUA_NOREF for missing ones
+			int m_callbacks[(int)Callback::COUNT];
+			bool m_are_callbacks_cached;
 			Array<Property> m_properties;
 		};
 
@@ -297,6 +307,8 @@ namespace Lumix
 			int parameter_count;
 			lua_State* state;
 			bool is_in_progress;
+			// the environment is below the function on the stack
+			bool has_environment;
 			ScriptComponent* cmp;
 			int scr_index;
 		};
@@ -330,6 +342,30 @@ namespace Lumix
 		}
 
 
+		IFunctionCall* beginFunctionCall(ComponentHandle cmp, int scr_index, Callback callback) override
+		{
+			auto* script_cmp = m_scripts[{cmp.index}];
+			auto& script = script_cmp->m_scripts[scr_index];
+			if (!script.m_state) return nullptr;
+			if (!script.m_are_callbacks_cached) return beginFunctionCall(cmp, scr_index, CALLBACK_NAMES[(int)callback]);
+
+			ASSERT(!m_function_call.is_in_progress);
+			int func = script.m_callbacks[(int)callback];
+			if (func == LUA_NOREF) return nullptr;
+
+			lua_rawgeti(script.m_state, LUA_REGISTRYINDEX, func);
+
+			m_function_call.state = script.m_state;
+			m_function_call.cmp = script_cmp;
+			m_function_call.is_in_progress = true;
+			m_function_call.has_environment = false;
+			m_function_call.parameter_count = 0;
+			m_function_call.scr_index = scr_index;
+
+			return &m_function_call;
+		}
+
+
 		IFunctionCall* beginFunctionCall(ComponentHandle cmp, int scr_index, const char* function) override
 		{
 			ASSERT(!m_function_call.is_in_progress);
@@ -349,6 +385,7 @@ namespace Lumix
 			m_function_call.state = script.m_state;
 			m_function_call.cmp = script_cmp;
 			m_function_call.is_in_progress = true;
+			m_function_call.has_environment = true;
 			m_function_call.parameter_count = 0;
 			m_function_call.scr_index = scr_index;
 
@@ -370,7 +407,7 @@ namespace Lumix
 				g_log_warning.log("Lua Script") << lua_tostring(script.m_state, -1);
 				lua_pop(script.m_state, 1);
 			}
-			lua_pop(script.m_state, 1);
+			if (m_function_call.has_environment) lua_pop(script.m_state, 1);
 		}
 
 
@@ -565,6 +602,66 @@ namespace Lumix
 		}
 
 
+		template <typename T> static int LUA_getRawProperty(lua_State* L)
+		{
+			auto* desc = LuaWrapper::toType<PropertyDescriptorBase*>(L, lua_upvalueindex(1));
+			auto getter = (PropertyDescriptorBase::RawGetter)LuaWrapper::toType<void*>(L, lua_upvalueindex(2));
+			auto* scene = LuaWrapper::checkArg<IScene*>(L, 1);
+			ComponentHandle cmp = LuaWrapper::checkArg<ComponentHandle>(L, 2);
+			T value;
+			getter(*desc, scene, cmp, &value);
+			LuaWrapper::push(L, value);
+			return 1;
+		}
+
+
+		template <typename T> static int LUA_setRawProperty(lua_State* L)
+		{
+			auto* desc = LuaWrapper::toType<PropertyDescriptorBase*>(L, lua_upvalueindex(1));
+			auto setter = (PropertyDescriptorBase::RawSetter)LuaWrapper::toType<void*>(L, lua_upvalueindex(2));
+			auto* scene = LuaWrapper::checkArg<IScene*>(L, 1);
+			ComponentHandle cmp = LuaWrapper::checkArg<ComponentHandle>(L, 2);
+			T value = LuaWrapper::checkArg<T>(L, 3);
+			setter(*desc, scene, cmp, &value);
+			return 0;
+		}
+
+
+		template <typename T>
+		static void registerRawProperty(lua_State* L, PropertyDescriptorBase* desc, const char* setter, const char* getter)
+		{
+			lua_pushlightuserdata(L, desc);
+			lua_pushlightuserdata(L, (void*)desc->getRawSetter());
+			lua_pushcclosure(L, &LUA_setRawProperty<T>, 2);
+			lua_setfield(L, -2, setter);
+
+			lua_pushlightuserdata(L, desc);
+			lua_pushlightuserdata(L, (void*)desc->getRawGetter());
+			lua_pushcclosure(L, &LUA_getRawProperty<T>, 2);
+			lua_setfield(L, -2, getter);
+		}
+
+
+		static bool registerRawProperty(lua_State* L, PropertyDescriptorBase* desc, const char* setter, const char* getter)
+		{
+			if (!desc->getRawGetter() || !desc->getRawSetter()) return false;
+
+			switch (desc->getType())
+			{
+				case PropertyDescriptorBase::DECIMAL: registerRawProperty<float>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::INTEGER:
+				case PropertyDescriptorBase::ENUM: registerRawProperty<int>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::BOOL: registerRawProperty<bool>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::COLOR:
+				case PropertyDescriptorBase::VEC3: registerRawProperty<Vec3>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::VEC2: registerRawProperty<Vec2>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::INT2: registerRawProperty<Int2>(L, desc, setter, getter); return true;
+				case PropertyDescriptorBase::ENTITY: registerRawProperty<Entity>(L, desc, setter, getter); return true;
+				default: return false;
+			}
+		}
+
+
 		static int LUA_getProperty(lua_State* L)
 		{
 			auto* desc = LuaWrapper::toType<PropertyDescriptorBase*>(L, lua_upvalueindex(1));
@@ -806,6 +903,8 @@ namespace Lumix
 							copyString(getter, "get");
 							catString(setter, tmp);
 							catString(getter, tmp);
+							if (registerRawProperty(L, desc, setter, getter)) break;
+
 							lua_pushlightuserdata(L, desc);
 							lua_pushinteger(L, cmp_type.index);
 							lua_pushcclosure(L, &LUA_setProperty, 2);
@@ -1041,14 +1140,8 @@ namespace Lumix
 				}
 			}
 
-			for(int i = 0; i < m_updates.size(); ++i)
-			{
-				if(m_updates[i].state == inst.m_state)
-				{
-					m_updates.eraseFast(i);
-					break;
-				}
-			}
+			removeUpdate(inst.m_state);
+			uncacheCallbacks(inst);
 
 			luaL_unref(inst.m_state, LUA_REGISTRYINDEX, inst.m_thread_ref);
 			luaL_unref(inst.m_state, LUA_REGISTRYINDEX, inst.m_environment);
@@ -1076,19 +1169,71 @@ namespace Lumix
 		}
 
 
-		void startScript(ScriptInstance& instance, bool is_restart)
+		void removeUpdate(lua_State* state)
 		{
-			if (is_restart)
+			for (int i = 0; i < m_updates.size(); ++i)
 			{
-				for (int i = 0; i < m_updates.size(); ++i)
+				if (m_updates[i].state == state)
 				{
-					if (m_updates[i].state == instance.m_state)
-					{
-						m_updates.eraseFast(i);
-						break;
-					}
+					luaL_unref(state, LUA_REGISTRYINDEX, m_updates[i].func);
+					m_updates.erase(i);
+					break;
+				}
+			}
+		}
+
+
+		void addUpdate(LuaScript* script, lua_State* state, int func)
+		{
+			int idx = m_updates.size();
+			for (int i = m_updates.size() - 1; i >= 0; --i)
+			{
+				if (m_updates[i].script == script)
+				{
+					idx = i + 1;
+					break;
+				}
+			}
+			UpdateData update_data;
+			update_data.script = script;
+			update_data.profiler_name = m_system.getProfilerName(script->getPath());
+			update_data.state = state;
+			update_data.func = func;
+			m_updates.insert(idx, update_data);
+		}
+
+
+		static void uncacheCallbacks(ScriptInstance& instance)
+		{
+			if (!instance.m_are_callbacks_cached) return;
+			for (int func : instance.m_callbacks) luaL_unref(instance.m_state, LUA_REGISTRYINDEX, func);
+			instance.m_are_callbacks_cached = false;
+		}
+
+
+		// expects the environment on the top of the stack
+		static void cacheCallbacks(ScriptInstance& instance)
+		{
+			uncacheCallbacks(instance);
+			for (int i = 0; i < (int)Callback::COUNT; ++i)
+			{
+				if (lua_getfield(instance.m_state, -1, CALLBACK_NAMES[i]) == LUA_TFUNCTION)
+				{
+					instance.m_callbacks[i] = luaL_ref(instance.m_state, LUA_REGISTRYINDEX);
+				}
+				else
+				{
+					instance.m_callbacks[i] = LUA_NOREF;
+					lua_pop(instance.m_state, 1);
 				}
 			}
+			instance.m_are_callbacks_cached = true;
+		}
+
+
+		void startScript(ScriptInstance& instance, bool is_restart)
+		{
+			if (is_restart) removeUpdate(instance.m_state);
 
 			if (lua_rawgeti(instance.m_state, LUA_REGISTRYINDEX, instance.m_environment) != LUA_TTABLE)
 			{
@@ -1098,12 +1243,13 @@ namespace Lumix
 			}
 			if (lua_getfield(instance.m_state, -1, "update") == LUA_TFUNCTION)
 			{
-				auto& update_data = m_updates.emplace();
-				update_data.script = instance.m_script;
-				update_data.state = instance.m_state;
-				update_data.environment = instance.m_environment;
+				addUpdate(instance.m_script, instance.m_state, luaL_ref(instance.m_state, LUA_REGISTRYINDEX));
 			}
-			lua_pop(instance.m_state, 1);
+			else
+			{
+				lua_pop(instance.m_state, 1);
+			}
+			cacheCallbacks(instance);
 
 			if (!is_restart)
 			{
@@ -1133,7 +1279,13 @@ namespace Lumix
 		{
 			m_scripts_init_called = false;
 			m_is_game_running = false;
+			for (auto& update_data : m_updates) luaL_unref(update_data.state, LUA_REGISTRYINDEX, update_data.func);
 			m_updates.clear();
+			// scripts reloaded while the game is not running replace their functions
+			for (auto* script_cmp : m_scripts)
+			{
+				for (auto& instance : script_cmp->m_scripts) uncacheCallbacks(instance);
+			}
 			m_timers.clear();
 		}
 
@@ -1515,26 +1667,29 @@ namespace Lumix
 
 			updateTimers(time_delta);
 
-			for (int i = 0; i < m_updates.size(); ++i)
+			PROFILE_INT("script updates", m_updates.size());
+			int i = 0;
+			while (i < m_updates.size())
 			{
-				UpdateData update_item = m_updates[i];
-				if (lua_rawgeti(update_item.state, LUA_REGISTRYINDEX, update_item.environment) != LUA_TTABLE)
+				LuaScript* script = m_updates[i].script;
+				PROFILE_BLOCK(m_updates[i].profiler_name);
+				for (; i < m_updates.size() && m_updates[i].script == script; ++i)
 				{
-					ASSERT(false);
-				}
-				if (lua_getfield(update_item.state, -1, "update") != LUA_TFUNCTION)
-				{
-					lua_pop(update_item.state, 2);
-					continue;
-				}
+					UpdateData update_item = m_updates[i];
+					if (lua_rawgeti(update_item.state, LUA_REGISTRYINDEX, update_item.func) != LUA_TFUNCTION)
+					{
+						ASSERT(false);
+						lua_pop(update_item.state, 1);
+						continue;
+					}
 
-				lua_pushnumber(update_item.state, time_delta);
-				if (lua_pcall(update_item.state, 1, 0, 0) != LUA_OK)
-				{
-					g_log_error.log("Lua Script") << lua_tostring(update_item.state, -1);
-					lua_pop(update_item.state, 1);
+					lua_pushnumber(update_item.state, time_delta);
+					if (lua_pcall(update_item.state, 1, 0, 0) != LUA_OK)
+					{
+						g_log_error.log("Lua Script") << lua_tostring(update_item.state, -1);
+						lua_pop(update_item.state, 1);
+					}
 				}
-				lua_pop(update_item.state, 1);
 			}
 		}
 
@@ -1682,6 +1837,7 @@ namespace Lumix
 		: m_engine(engine)
 		, m_allocator(engine.getAllocator())
 		, m_script_manager(m_allocator)
+		, m_profiler_names(m_allocator)
 	{
 		m_script_manager.create(LUA_SCRIPT_RESOURCE_TYPE, engine.getResourceManager());
 
@@ -1694,10 +1850,25 @@ namespace Lumix
 
 	LuaScriptSystemImpl::~LuaScriptSystemImpl()
 	{
+		for (char* name : m_profiler_names) m_allocator.deallocate(name);
 		m_script_manager.destroy();
 	}
 
 
+	// profiler keeps block names, so they must outlive the scripts
+	const char* LuaScriptSystemImpl::getProfilerName(const Path& path)
+	{
+		auto iter = m_profiler_names.find(path.getHash());
+		if (iter.isValid()) return iter.value();
+
+		int len = stringLength(path.c_str());
+		char* name = (char*)m_allocator.allocate(len + 1);
+		copyString(name, len + 1, path.c_str());
+		m_profiler_names.insert(path.getHash(), name);
+		return name;
+	}
+
+
 	void LuaScriptSystemImpl::createScenes(Universe& ctx)
 	{
 		auto* scene = LUMIX_NEW(m_allocator, LuaScriptSceneImpl)(*this, ctx);
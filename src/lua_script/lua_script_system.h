@@ -56,12 +56,23 @@ public:
 
 	typedef int (*lua_CFunction) (lua_State *L);
 
+	// functions called by other plugins, they are looked up once when a script starts
+	enum class Callback : int
+	{
+		ON_CONTACT,
+		ON_TRIGGER,
+		ON_PATH_FINISHED,
+
+		COUNT
+	};
+
 public:
 	virtual Path getScriptPath(ComponentHandle cmp, int scr_index) = 0;	
 	virtual void setScriptPath(ComponentHandle cmp, int scr_index, const Path& path) = 0;
 	virtual ComponentHandle getComponent(Entity entity) = 0;
 	virtual int getEnvironment(ComponentHandle cmp, int scr_index) = 0;
 	virtual IFunctionCall* beginFunctionCall(ComponentHandle cmp, int scr_index, const char* function) = 0;
+	virtual IFunctionCall* beginFunctionCall(ComponentHandle cmp, int scr_index, Callback callback) = 0;
 	virtual void endFunctionCall() = 0;
 	virtual int getScriptCount(ComponentHandle cmp) = 0;
 	virtual lua_State* getState(ComponentHandle cmp, int scr_index) = 0;
@@ -53,7 +53,15 @@ struct StudioAppPlugin LUMIX_FINAL : public StudioApp::IPlugin
 
 		if (ImGui::BeginDock("Navigation", &is_opened, ImGuiWindowFlags_NoScrollWithMouse))
 		{
-			if (ImGui::Button("Generate")) scene->generateNavmesh();
+			if (scene->isGeneratingNavmesh())
+			{
+				ImGui::ProgressBar(scene->getNavmeshGenerationProgress(), ImVec2(-80, 0));
+				ImGui::SameLine();
+				if (ImGui::Button("Cancel")) scene->cancelNavmeshGeneration();
+				ImGui::EndDock();
+				return;
+			}
+			if (ImGui::Button("Generate")) scene->generateNavmeshAsync();
 			ImGui::SameLine();
 			if (ImGui::Button("Load"))
 			{
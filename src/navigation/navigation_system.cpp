@@ -5,27 +5,40 @@
 #include "engine/blob.h"
 #include "engine/crc32.h"
 #include "engine/engine.h"
+#include "engine/fs/disk_file_device.h"
+#include "engine/fs/file_system.h"
 #include "engine/fs/os_file.h"
+#include "engine/hash_map.h"
 #include "engine/iallocator.h"
 #include "engine/log.h"
 #include "engine/lua_wrapper.h"
 #include "engine/lumix.h"
+#include "engine/lz.h"
+#include "engine/mt/atomic.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/group.h"
+#include "engine/mtjd/manager.h"
 #include "engine/profiler.h"
 #include "engine/property_descriptor.h"
 #include "engine/property_register.h"
+#include "engine/resource_manager_base.h"
 #include "engine/serializer.h"
+#include "engine/string.h"
+#include "engine/timer.h"
 #include "engine/universe/universe.h"
 #include "engine/vec.h"
 #include "lua_script/lua_script_system.h"
 #include "renderer/material.h"
 #include "renderer/model.h"
 #include "renderer/render_scene.h"
+#include "renderer/terrain.h"
 #include "renderer/texture.h"
 #include <DetourAlloc.h>
 #include <DetourCrowd.h>
 #include <DetourNavMesh.h>
 #include <DetourNavMeshBuilder.h>
 #include <DetourNavMeshQuery.h>
+#include <DetourTileCacheBuilder.h>
 #include <Recast.h>
 #include <RecastAlloc.h>
 #include <cmath>
@@ -46,8 +59,17 @@ enum class NavigationSceneVersion : int
 
 static const ComponentType NAVMESH_AGENT_TYPE = PropertyRegister::getComponentType("navmesh_agent");
 static const ComponentType ANIM_CONTROLLER_TYPE = PropertyRegister::getComponentType("anim_controller");
-static const int CELLS_PER_TILE_SIDE = 256;
+static const ComponentType MODEL_INSTANCE_TYPE = PropertyRegister::getComponentType("renderable");
+static const int CELLS_PER_TILE_SIDE = 240; // tile cache layers store their size in a byte
 static const float CELL_SIZE = 0.3f;
+static const int TILES_IN_FLIGHT_PER_THREAD = 4;
+static const int MAX_TILE_LAYERS = 4;
+static const int TILE_CACHE_SCRATCH_SIZE = 1 << 20;
+static const float OBSTACLE_UPDATE_BUDGET = 0.002f;
+static const int MAX_CROWD_AGENTS = 2000;
+static const int MAX_MOVE_REQUESTS_PER_FRAME = 128;
+static const u32 NAVMESH_FILE_MAGIC = 0x564E414C; // 'LANV'
+static const int NAVMESH_FILE_PAGE_SIZE = 4096;
 static void registerLuaAPI(lua_State* L);
 
 
@@ -64,6 +86,8 @@ struct Agent
 	float height;
 	int agent;
 	bool is_finished;
+	bool is_move_pending = false;
+	bool is_teleport_pending = false;
 	u32 flags = 0;
 	Vec3 root_motion = {0, 0, 0};
 	float speed = 0;
@@ -72,6 +96,62 @@ struct Agent
 };
 
 
+enum class NavmeshFileVersion : int
+{
+	FIRST,
+
+	LATEST
+};
+
+
+struct NavmeshFileHeader
+{
+	u32 magic;
+	int version;
+	AABB aabb;
+	int num_tiles_x;
+	int num_tiles_z;
+	dtNavMeshParams params;
+	int tile_count;
+};
+
+
+// tile blobs start at page boundaries, the navmesh uses them right from the mapped file
+struct NavmeshFileTile
+{
+	u64 offset;
+	int size;
+	int x;
+	int z;
+	int layer;
+};
+
+
+static bool isValidNavmeshFileHeader(const NavmeshFileHeader& header, size_t file_size)
+{
+	return header.version <= (int)NavmeshFileVersion::LATEST && header.num_tiles_x >= 0 && header.num_tiles_z >= 0 &&
+		   header.tile_count >= 0 && file_size >= sizeof(header) &&
+		   (size_t)header.tile_count <= (file_size - sizeof(header)) / sizeof(NavmeshFileTile);
+}
+
+
+// tiles are checked before they reach the navmesh, written so that corrupted offsets can not overflow
+static bool isValidNavmeshFileTile(const NavmeshFileTile& tile, const NavmeshFileHeader& header, size_t file_size)
+{
+	return tile.size > 0 && tile.offset <= file_size && (u64)tile.size <= file_size - tile.offset &&
+		   tile.offset % NAVMESH_FILE_PAGE_SIZE == 0 && tile.x >= 0 && tile.x < header.num_tiles_x && tile.z >= 0 &&
+		   tile.z < header.num_tiles_z && tile.layer >= 0 && tile.layer < MAX_TILE_LAYERS;
+}
+
+
+struct MoveRequest
+{
+	Entity entity;
+	Vec3 dest;
+	float speed;
+};
+
+
 struct NavigationSystem LUMIX_FINAL : public IPlugin
 {
 	NavigationSystem(Engine& engine)
@@ -136,14 +216,232 @@ struct NavigationSystem LUMIX_FINAL : public IPlugin
 NavigationSystem* NavigationSystem::s_instance = nullptr;
 
 
+// memory allocated by dtAlloc
+struct TileData
+{
+	u8* data;
+	int size;
+};
+
+
+static void freeTileData(Array<TileData>& tiles)
+{
+	for (TileData& tile : tiles) dtFree(tile.data);
+	tiles.clear();
+}
+
+
+struct Obstacle
+{
+	enum Type : u8
+	{
+		CYLINDER,
+		BOX
+	};
+
+	Type type;
+	Vec3 min;
+	Vec3 max;
+};
+
+
+// lzDecompress needs the exact raw size, so it's stored in front of the compressed data
+struct LZTileCacheCompressor LUMIX_FINAL : public dtTileCacheCompressor
+{
+	int maxCompressedSize(const int buffer_size) override { return sizeof(int) + lzCompressBound(buffer_size); }
+
+
+	dtStatus compress(const u8* buffer,
+		const int buffer_size,
+		u8* compressed,
+		const int max_compressed_size,
+		int* compressed_size) override
+	{
+		int size = lzCompress(buffer, buffer_size, compressed + sizeof(int), max_compressed_size - sizeof(int));
+		if (size == 0) return DT_FAILURE;
+		copyMemory(compressed, &buffer_size, sizeof(buffer_size));
+		*compressed_size = size + sizeof(int);
+		return DT_SUCCESS;
+	}
+
+
+	dtStatus decompress(const u8* compressed,
+		const int compressed_size,
+		u8* buffer,
+		const int max_buffer_size,
+		int* buffer_size) override
+	{
+		int size;
+		if (compressed_size < (int)sizeof(size)) return DT_FAILURE;
+		copyMemory(&size, compressed, sizeof(size));
+		if (size > max_buffer_size) return DT_FAILURE;
+		if (!lzDecompress(compressed + sizeof(size), compressed_size - sizeof(size), buffer, size)) return DT_FAILURE;
+		*buffer_size = size;
+		return DT_SUCCESS;
+	}
+};
+
+
+// scratch memory of one tile rebuild, everything is released at once by reset()
+struct TileCacheLinearAllocator LUMIX_FINAL : public dtTileCacheAlloc
+{
+	explicit TileCacheLinearAllocator(IAllocator& allocator)
+		: m_allocator(allocator)
+		, m_overflow(allocator)
+		, m_top(0)
+	{
+		m_buffer = (u8*)allocator.allocate(TILE_CACHE_SCRATCH_SIZE);
+	}
+
+
+	~TileCacheLinearAllocator()
+	{
+		reset();
+		m_allocator.deallocate(m_buffer);
+	}
+
+
+	void reset() override
+	{
+		m_top = 0;
+		for (void* ptr : m_overflow) m_allocator.deallocate(ptr);
+		m_overflow.clear();
+	}
+
+
+	void* alloc(const int size) override
+	{
+		int aligned_size = (size + 15) & ~15;
+		if (m_top + aligned_size > TILE_CACHE_SCRATCH_SIZE)
+		{
+			void* ptr = m_allocator.allocate(size);
+			m_overflow.push(ptr);
+			return ptr;
+		}
+		void* ptr = m_buffer + m_top;
+		m_top += aligned_size;
+		return ptr;
+	}
+
+
+	void free(void* ptr) override {}
+
+
+	IAllocator& m_allocator;
+	Array<void*> m_overflow;
+	u8* m_buffer;
+	int m_top;
+};
+
+
+// compressed heightfield layers of a tile, obstacles are stamped into them when the tile is rebuilt
+struct TileLayers
+{
+	explicit TileLayers(IAllocator& allocator)
+		: layers(allocator)
+	{
+	}
+
+	~TileLayers() { freeTileData(layers); }
+
+	Array<TileData> layers;
+};
+
+
+// copies of a tile's layers and of the obstacles touching it, rebuilt by a job
+struct ObstacleTileRebuild
+{
+	explicit ObstacleTileRebuild(IAllocator& allocator)
+		: layers(allocator)
+		, obstacles(allocator)
+		, nav_tiles(allocator)
+		, is_done(false)
+	{
+	}
+
+	~ObstacleTileRebuild()
+	{
+		freeTileData(layers);
+		freeTileData(nav_tiles);
+	}
+
+	int x;
+	int z;
+	rcConfig config;
+	Array<TileData> layers;
+	Array<Obstacle> obstacles;
+	Array<TileData> nav_tiles;
+	volatile bool is_done;
+};
+
+
+// geometry of one tile gathered on the main thread, built by a job
+struct NavmeshTile
+{
+	explicit NavmeshTile(IAllocator& allocator)
+		: vertices(allocator)
+		, areas(allocator)
+		, layers(allocator)
+		, nav_data(nullptr)
+		, nav_data_size(0)
+		, error(nullptr)
+		, is_done(false)
+	{
+	}
+
+	~NavmeshTile() { freeTileData(layers); }
+
+	void addTriangle(const Vec3& a, const Vec3& b, const Vec3& c, u8 area)
+	{
+		vertices.push(a);
+		vertices.push(b);
+		vertices.push(c);
+		areas.push(area);
+	}
+
+	int x;
+	int z;
+	rcConfig config;
+	Array<Vec3> vertices;
+	Array<u8> areas;
+	Array<TileData> layers;
+	u8* nav_data;
+	int nav_data_size;
+	const char* error;
+	volatile bool is_done;
+};
+
+
+// model space triangles of a model's navigation relevant meshes
+struct ModelTriangles
+{
+	explicit ModelTriangles(IAllocator& allocator)
+		: vertices(allocator)
+		, is_walkable(allocator)
+	{
+	}
+
+	Array<Vec3> vertices;
+	Array<bool> is_walkable;
+};
+
+
+struct TileBuildData
+{
+	rcHeightfield* solid = nullptr;
+	rcCompactHeightfield* chf = nullptr;
+	rcContourSet* cset = nullptr;
+	rcPolyMesh* polymesh = nullptr;
+	rcPolyMeshDetail* detail_mesh = nullptr;
+};
+
+
 struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 {
 	NavigationSceneImpl(NavigationSystem& system, Universe& universe, IAllocator& allocator)
 		: m_allocator(allocator)
 		, m_universe(universe)
 		, m_system(system)
-		, m_detail_mesh(nullptr)
-		, m_polymesh(nullptr)
 		, m_navquery(nullptr)
 		, m_navmesh(nullptr)
 		, m_debug_compact_heightfield(nullptr)
@@ -155,9 +453,39 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		, m_crowd(nullptr)
 		, m_script_scene(nullptr)
 		, m_on_update(m_allocator)
-	{
+		, m_tiles_in_flight(m_allocator)
+		, m_tiles_sync_point(true, m_allocator)
+		, m_next_tile(0)
+		, m_finished_tiles(0)
+		, m_is_generating(false)
+		, m_is_generation_cancelled(false)
+		, m_generation_failed(false)
+		, m_tile_bins(m_allocator)
+		, m_binned_instances(m_allocator)
+		, m_are_bins_dirty(true)
+		, m_model_triangles(m_allocator)
+		, m_tile_layers(m_allocator)
+		, m_obstacles(m_allocator)
+		, m_next_obstacle_id(0)
+		, m_dirty_obstacle_tiles(m_allocator)
+		, m_obstacle_rebuilds(m_allocator)
+		, m_obstacles_sync_point(true, m_allocator)
+		, m_crowd_sync_point(true, m_allocator)
+		, m_is_crowd_updating(false)
+		, m_is_crowd_step_ready(false)
+		, m_move_requests(m_allocator)
+		, m_teleports(m_allocator)
+		, m_is_moving_agents(false)
+		, m_mapped_tile_refs(m_allocator)
+		, m_is_streaming_dirty(false)
+		, m_is_streaming_area_set(false)
+	{
+		m_navmesh_path[0] = '\0';
+		m_obstacle_timer = Timer::create(m_allocator);
 		setGeneratorParams(0.3f, 0.1f, 0.3f, 2.0f, 60.0f, 0.3f);
 		m_universe.entityTransformed().bind<NavigationSceneImpl, &NavigationSceneImpl::onEntityMoved>(this);
+		m_universe.componentAdded().bind<NavigationSceneImpl, &NavigationSceneImpl::onComponentChanged>(this);
+		m_universe.componentDestroyed().bind<NavigationSceneImpl, &NavigationSceneImpl::onComponentChanged>(this);
 		universe.registerComponentType(NAVMESH_AGENT_TYPE, this, &NavigationSceneImpl::serializeAgent, &NavigationSceneImpl::deserializeAgent);
 	}
 
@@ -165,7 +493,12 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	~NavigationSceneImpl()
 	{
 		m_universe.entityTransformed().unbind<NavigationSceneImpl, &NavigationSceneImpl::onEntityMoved>(this);
+		m_universe.componentAdded().unbind<NavigationSceneImpl, &NavigationSceneImpl::onComponentChanged>(this);
+		m_universe.componentDestroyed().unbind<NavigationSceneImpl, &NavigationSceneImpl::onComponentChanged>(this);
+		stopTileJobs();
 		clearNavmesh();
+		clearModelTriangles();
+		Timer::destroy(m_obstacle_timer);
 	}
 
 
@@ -175,40 +508,48 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
+	void onComponentChanged(const ComponentUID& cmp)
+	{
+		if (cmp.type != MODEL_INSTANCE_TYPE) return;
+		m_are_bins_dirty = true;
+		// the model might get unloaded
+		clearModelTriangles();
+	}
+
+
 	void onEntityMoved(Entity entity)
 	{
+		// only model instances are binned, terrains are gathered for every tile
+		if (m_universe.hasComponent(entity, MODEL_INSTANCE_TYPE)) m_are_bins_dirty = true;
+		if (m_is_moving_agents) return;
 		auto iter = m_agents.find(entity);
 		if (!iter.isValid()) return;
-		if (iter.value().agent < 0) return;
-		const Agent& agent = iter.value();
-		Vec3 pos = m_universe.getPosition(iter.key());
-		const dtCrowdAgent* dt_agent = m_crowd->getAgent(agent.agent);
-		if ((pos - *(Vec3*)dt_agent->npos).squaredLength() > 0.1f)
-		{
-			Vec3 target_pos = *(Vec3*)dt_agent->targetPos;
-			float speed = dt_agent->params.maxSpeed;
-			m_crowd->removeAgent(agent.agent);
-			addCrowdAgent(iter.value());
-			if (!agent.is_finished)
-			{
-				navigate(entity, target_pos, speed, agent.stop_distance);
-			}
-		}
+		Agent& agent = iter.value();
+		if (agent.agent < 0 || agent.is_teleport_pending) return;
+
+		// the crowd might be updating on a worker thread, teleports are applied by update
+		agent.is_teleport_pending = true;
+		m_teleports.push(entity);
 	}
 
 
 	void clearNavmesh()
 	{
-		rcFreePolyMeshDetail(m_detail_mesh);
-		rcFreePolyMesh(m_polymesh);
+		waitForCrowd();
+		clearMoveRequests();
+		stopObstacleJobs();
+		for (TileLayers* layers : m_tile_layers) LUMIX_DELETE(m_allocator, layers);
+		m_tile_layers.clear();
+		m_dirty_obstacle_tiles.clear();
 		dtFreeNavMeshQuery(m_navquery);
 		dtFreeNavMesh(m_navmesh);
 		dtFreeCrowd(m_crowd);
+		m_navmesh_file.close();
+		m_mapped_tile_refs.clear();
+		m_navmesh_path[0] = '\0';
 		rcFreeCompactHeightfield(m_debug_compact_heightfield);
 		rcFreeHeightField(m_debug_heightfield);
 		rcFreeContourSet(m_debug_contours);
-		m_detail_mesh = nullptr;
-		m_polymesh = nullptr;
 		m_navquery = nullptr;
 		m_navmesh = nullptr;
 		m_crowd = nullptr;
@@ -218,10 +559,10 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
-	void rasterizeGeometry(const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	void gatherGeometry(const AABB& aabb, NavmeshTile& tile)
 	{
-		rasterizeMeshes(aabb, ctx, cfg, solid);
-		rasterizeTerrains(aabb, ctx, cfg, solid);
+		gatherMeshes(aabb, tile);
+		gatherTerrains(aabb, tile);
 	}
 
 
@@ -236,7 +577,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
-	void rasterizeTerrains(const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	void gatherTerrains(const AABB& aabb, NavmeshTile& tile)
 	{
 		PROFILE_FUNCTION();
 		const float walkable_threshold = cosf(Math::degreesToRadians(60));
@@ -244,51 +585,62 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
 		if (!render_scene) return;
 
+		Array<Vec3> prev_row(m_allocator);
+		Array<Vec3> row(m_allocator);
 		ComponentHandle cmp = render_scene->getFirstTerrain();
 		while (cmp != INVALID_COMPONENT)
 		{
+			Terrain* terrain = render_scene->getTerrain(cmp);
 			Entity entity = render_scene->getTerrainEntity(cmp);
 			Vec3 pos = m_universe.getPosition(entity);
 			Quat rot = m_universe.getRotation(entity);
 			Vec2 res = render_scene->getTerrainResolution(cmp);
-			float scaleXZ = render_scene->getTerrainXZScale(cmp);
+			float scaleXZ = terrain->getXZScale();
 			AABB terrain_space_aabb = getTerrainSpaceAABB(pos, rot, aabb);
 			int from_z = (int)Math::clamp(terrain_space_aabb.min.z / scaleXZ - 1, 0.0f, res.y - 1);
 			int to_z = (int)Math::clamp(terrain_space_aabb.max.z / scaleXZ + 1, 0.0f, res.y - 1);
 			int from_x = (int)Math::clamp(terrain_space_aabb.min.x / scaleXZ - 1, 0.0f, res.x - 1);
 			int to_x = (int)Math::clamp(terrain_space_aabb.max.x / scaleXZ + 1, 0.0f, res.x - 1);
-			for (int j = from_z; j < to_z; ++j)
+
+			Texture* heightmap = terrain->m_heightmap;
+			const u16* heights = heightmap ? (const u16*)heightmap->getData() : nullptr;
+			ASSERT(!heights || heightmap->bytes_per_pixel == 2);
+			int width = terrain->getWidth();
+			int height = terrain->getHeight();
+			float y_scale = terrain->getYScale() / 65535.0f;
+			row.resize(to_x - from_x + 1);
+			prev_row.resize(to_x - from_x + 1);
+
+			// every height is sampled and transformed once, quads use two rows of vertices
+			for (int j = from_z; j <= to_z; ++j)
 			{
-				for (int i = from_x; i < to_x; ++i)
+				int z = Math::minimum(j, height - 1);
+				for (int i = from_x; i <= to_x; ++i)
 				{
-					float x = i * scaleXZ;
-					float z = j * scaleXZ;
-					float h0 = render_scene->getTerrainHeightAt(cmp, x, z);
-					Vec3 p0 = pos + rot.rotate(Vec3(x, h0, z));
-
-					x = (i + 1) * scaleXZ;
-					z = j * scaleXZ;
-					float h1 = render_scene->getTerrainHeightAt(cmp, x, z);
-					Vec3 p1 = pos + rot.rotate(Vec3(x, h1, z));
-
-					x = (i + 1) * scaleXZ;
-					z = (j + 1) * scaleXZ;
-					float h2 = render_scene->getTerrainHeightAt(cmp, x, z);
-					Vec3 p2 = pos + rot.rotate(Vec3(x, h2, z));
-
-					x = i * scaleXZ;
-					z = (j + 1) * scaleXZ;
-					float h3 = render_scene->getTerrainHeightAt(cmp, x, z);
-					Vec3 p3 = pos + rot.rotate(Vec3(x, h3, z));
-
-					Vec3 n = crossProduct(p1 - p0, p0 - p2).normalized();
-					u8 area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &p0.x, &p1.x, &p2.x, area, solid);
-
-					n = crossProduct(p2 - p0, p0 - p3).normalized();
-					area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
-					rcRasterizeTriangle(&ctx, &p0.x, &p2.x, &p3.x, area, solid);
+					int x = Math::minimum(i, width - 1);
+					float h = heights ? heights[x + z * width] * y_scale : 0;
+					row[i - from_x] = pos + rot.rotate(Vec3(i * scaleXZ, h, j * scaleXZ));
 				}
+
+				if (j > from_z)
+				{
+					for (int i = 0; i < to_x - from_x; ++i)
+					{
+						const Vec3& p0 = prev_row[i];
+						const Vec3& p1 = prev_row[i + 1];
+						const Vec3& p2 = row[i + 1];
+						const Vec3& p3 = row[i];
+
+						Vec3 n = crossProduct(p1 - p0, p0 - p2).normalized();
+						u8 area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
+						tile.addTriangle(p0, p1, p2, area);
+
+						n = crossProduct(p2 - p0, p0 - p3).normalized();
+						area = n.y > walkable_threshold ? RC_WALKABLE_AREA : 0;
+						tile.addTriangle(p0, p2, p3, area);
+					}
+				}
+				row.swap(prev_row);
 			}
 
 			cmp = render_scene->getNextTerrain(cmp);
@@ -296,24 +648,168 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
-	void rasterizeMeshes(const AABB& aabb, rcContext& ctx, rcConfig& cfg, rcHeightfield& solid)
+	// cached models are referenced until the cache is cleared, so they can not be destroyed while observed
+	const ModelTriangles& getModelTriangles(Model* model)
 	{
-		PROFILE_FUNCTION();
-		const float walkable_threshold = cosf(Math::degreesToRadians(45));
+		auto iter = m_model_triangles.find(model);
+		if (iter.isValid() && iter.value()) return *iter.value();
 
-		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
-		if (!render_scene) return;
+		PROFILE_FUNCTION();
+		ModelTriangles* triangles = LUMIX_NEW(m_allocator, ModelTriangles)(m_allocator);
+		if (iter.isValid())
+		{
+			iter.value() = triangles;
+		}
+		else
+		{
+			m_model_triangles.insert(model, triangles);
+			model->getResourceManager().load(*model);
+			model->getObserverCb().bind<NavigationSceneImpl, &NavigationSceneImpl::onModelStateChanged>(this);
+		}
 
 		u32 no_navigation_flag = Material::getCustomFlag("no_navigation");
 		u32 nonwalkable_flag = Material::getCustomFlag("nonwalkable");
+		bool is16 = model->areIndices16();
+		auto lod = model->getLODMeshIndices(0);
+		for (int mesh_idx = lod.from; mesh_idx <= lod.to; ++mesh_idx)
+		{
+			auto& mesh = model->getMesh(mesh_idx);
+			if (mesh.material->isCustomFlag(no_navigation_flag)) continue;
+			bool is_walkable = !mesh.material->isCustomFlag(nonwalkable_flag);
+			auto* vertices = &model->getVertices()[mesh.attribute_array_offset / model->getVertexDecl().getStride()];
+			const u16* indices16 = model->getIndices16();
+			const u32* indices32 = model->getIndices32();
+			for (int i = 0; i < mesh.indices_count; ++i)
+			{
+				int idx = mesh.indices_offset + i;
+				triangles->vertices.push(vertices[is16 ? indices16[idx] : indices32[idx]]);
+			}
+			for (int i = 0; i < mesh.indices_count; i += 3)
+			{
+				triangles->is_walkable.push(is_walkable);
+			}
+		}
+		return *triangles;
+	}
+
+
+	// a reloaded model has different geometry, its triangles are gathered again on the next use
+	void onModelStateChanged(Resource::State, Resource::State, Resource& resource)
+	{
+		auto iter = m_model_triangles.find(static_cast<Model*>(&resource));
+		if (!iter.isValid() || !iter.value()) return;
+		LUMIX_DELETE(m_allocator, iter.value());
+		iter.value() = nullptr;
+	}
+
+
+	void clearModelTriangles()
+	{
+		for (auto iter = m_model_triangles.begin(), end = m_model_triangles.end(); iter != end; ++iter)
+		{
+			Model* model = iter.key();
+			model->getObserverCb().unbind<NavigationSceneImpl, &NavigationSceneImpl::onModelStateChanged>(this);
+			model->getResourceManager().unload(*model);
+			LUMIX_DELETE(m_allocator, iter.value());
+		}
+		m_model_triangles.clear();
+	}
+
+
+	AABB getTileAABB(int x, int z) const
+	{
+		Vec3 bmin(m_aabb.min.x + x * CELLS_PER_TILE_SIDE * CELL_SIZE - (1 + m_config.borderSize) * m_config.cs,
+			m_aabb.min.y,
+			m_aabb.min.z + z * CELLS_PER_TILE_SIDE * CELL_SIZE - (1 + m_config.borderSize) * m_config.cs);
+		Vec3 bmax(bmin.x + CELLS_PER_TILE_SIDE * CELL_SIZE + (1 + m_config.borderSize) * m_config.cs,
+			m_aabb.max.y,
+			bmin.z + CELLS_PER_TILE_SIDE * CELL_SIZE + (1 + m_config.borderSize) * m_config.cs);
+		return AABB(bmin, bmax);
+	}
+
+
+	// buckets model instances by the tiles their bounding boxes touch
+	void updateBins()
+	{
+		if (!m_are_bins_dirty) return;
+		PROFILE_FUNCTION();
+		m_are_bins_dirty = false;
+
+		int tile_count = m_num_tiles_x * m_num_tiles_z;
+		m_tile_bins.resize(tile_count + 1);
+		for (int& bin : m_tile_bins) bin = 0;
+		m_binned_instances.clear();
+
+		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
+		if (!render_scene || tile_count == 0) return;
+
+		struct Range
+		{
+			ComponentHandle cmp;
+			int from_x, from_z, to_x, to_z;
+		};
+		Array<Range> ranges(m_allocator);
+		const float tile_size = CELLS_PER_TILE_SIDE * CELL_SIZE;
+		const float border = (1 + m_config.borderSize) * m_config.cs;
 		for (auto model_instance = render_scene->getFirstModelInstance(); model_instance != INVALID_COMPONENT;
 			 model_instance = render_scene->getNextModelInstance(model_instance))
 		{
 			auto* model = render_scene->getModelInstanceModel(model_instance);
-			if (!model) return;
-			ASSERT(model->isReady());
+			if (!model || !model->isReady()) continue;
+
+			Entity entity = render_scene->getModelInstanceEntity(model_instance);
+			AABB model_aabb = model->getAABB();
+			model_aabb.transform(m_universe.getMatrix(entity));
+
+			Range& range = ranges.emplace();
+			range.cmp = model_instance;
+			range.from_x = Math::clamp(int((model_aabb.min.x - m_aabb.min.x) / tile_size) - 1, 0, m_num_tiles_x - 1);
+			range.from_z = Math::clamp(int((model_aabb.min.z - m_aabb.min.z) / tile_size) - 1, 0, m_num_tiles_z - 1);
+			range.to_x = Math::clamp(int((model_aabb.max.x - m_aabb.min.x + border) / tile_size), 0, m_num_tiles_x - 1);
+			range.to_z = Math::clamp(int((model_aabb.max.z - m_aabb.min.z + border) / tile_size), 0, m_num_tiles_z - 1);
+			for (int z = range.from_z; z <= range.to_z; ++z)
+			{
+				for (int x = range.from_x; x <= range.to_x; ++x)
+				{
+					++m_tile_bins[x + z * m_num_tiles_x + 1];
+				}
+			}
+		}
+
+		for (int i = 1; i <= tile_count; ++i) m_tile_bins[i] += m_tile_bins[i - 1];
+		m_binned_instances.resize(m_tile_bins[tile_count]);
+		for (const Range& range : ranges)
+		{
+			for (int z = range.from_z; z <= range.to_z; ++z)
+			{
+				for (int x = range.from_x; x <= range.to_x; ++x)
+				{
+					m_binned_instances[m_tile_bins[x + z * m_num_tiles_x]++] = range.cmp;
+				}
+			}
+		}
+		for (int i = tile_count; i > 0; --i) m_tile_bins[i] = m_tile_bins[i - 1];
+		m_tile_bins[0] = 0;
+	}
+
 
-			bool is16 = model->areIndices16();
+	void gatherMeshes(const AABB& aabb, NavmeshTile& tile)
+	{
+		PROFILE_FUNCTION();
+		const float walkable_threshold = cosf(Math::degreesToRadians(45));
+
+		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
+		if (!render_scene) return;
+
+		if (tile.x < 0 || tile.z < 0 || tile.x >= m_num_tiles_x || tile.z >= m_num_tiles_z) return;
+		updateBins();
+		int tile_index = tile.x + tile.z * m_num_tiles_x;
+
+		for (int bin_idx = m_tile_bins[tile_index], end = m_tile_bins[tile_index + 1]; bin_idx < end; ++bin_idx)
+		{
+			ComponentHandle model_instance = m_binned_instances[bin_idx];
+			auto* model = render_scene->getModelInstanceModel(model_instance);
+			if (!model || !model->isReady()) continue;
 
 			Entity entity = render_scene->getModelInstanceEntity(model_instance);
 			Matrix mtx = m_universe.getMatrix(entity);
@@ -321,42 +817,17 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 			model_aabb.transform(mtx);
 			if (!model_aabb.overlaps(aabb)) continue;
 
-			auto lod = model->getLODMeshIndices(0);
-			for (int mesh_idx = lod.from; mesh_idx <= lod.to; ++mesh_idx)
+			const ModelTriangles& triangles = getModelTriangles(model);
+			const Vec3* vertices = triangles.vertices.begin();
+			for (int i = 0, count = triangles.is_walkable.size(); i < count; ++i)
 			{
-				auto& mesh = model->getMesh(mesh_idx);
-				if (mesh.material->isCustomFlag(no_navigation_flag)) continue;
-				bool is_walkable = !mesh.material->isCustomFlag(nonwalkable_flag);
-				auto* vertices =
-					&model->getVertices()[mesh.attribute_array_offset / model->getVertexDecl().getStride()];
-				if (is16)
-				{
-					const u16* indices16 = model->getIndices16();
-					for (int i = 0; i < mesh.indices_count; i += 3)
-					{
-						Vec3 a = mtx.transform(vertices[indices16[mesh.indices_offset + i]]);
-						Vec3 b = mtx.transform(vertices[indices16[mesh.indices_offset + i + 1]]);
-						Vec3 c = mtx.transform(vertices[indices16[mesh.indices_offset + i + 2]]);
+				Vec3 a = mtx.transform(vertices[i * 3]);
+				Vec3 b = mtx.transform(vertices[i * 3 + 1]);
+				Vec3 c = mtx.transform(vertices[i * 3 + 2]);
 
-						Vec3 n = crossProduct(a - b, a - c).normalized();
-						u8 area = n.y > walkable_threshold && is_walkable ? RC_WALKABLE_AREA : 0;
-						rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
-					}
-				}
-				else
-				{
-					const u32* indices32 = model->getIndices32();
-					for (int i = 0; i < mesh.indices_count; i += 3)
-					{
-						Vec3 a = mtx.transform(vertices[indices32[mesh.indices_offset + i]]);
-						Vec3 b = mtx.transform(vertices[indices32[mesh.indices_offset + i + 1]]);
-						Vec3 c = mtx.transform(vertices[indices32[mesh.indices_offset + i + 2]]);
-
-						Vec3 n = crossProduct(a - b, a - c).normalized();
-						u8 area = n.y > walkable_threshold && is_walkable ? RC_WALKABLE_AREA : 0;
-						rcRasterizeTriangle(&ctx, &a.x, &b.x, &c.x, area, solid);
-					}
-				}
+				Vec3 n = crossProduct(a - b, a - c).normalized();
+				u8 area = n.y > walkable_threshold && triangles.is_walkable[i] ? RC_WALKABLE_AREA : 0;
+				tile.addTriangle(a, b, c, area);
 			}
 		}
 	}
@@ -371,7 +842,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 
 		for (int i = 0, c = m_script_scene->getScriptCount(cmp); i < c; ++i)
 		{
-			auto* call = m_script_scene->beginFunctionCall(cmp, i, "onPathFinished");
+			auto* call = m_script_scene->beginFunctionCall(cmp, i, LuaScriptScene::Callback::ON_PATH_FINISHED);
 			if (!call) continue;
 
 			m_script_scene->endFunctionCall();
@@ -403,12 +874,20 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
+	// the crowd step of this frame was kicked off in the last lateUpdate and ran during rendering
 	void update(float time_delta, bool paused) override
 	{
 		PROFILE_FUNCTION();
+		waitForCrowd();
+		if (m_is_generating) updateNavmeshGeneration();
+		updateObstacles();
+		updateStreaming();
 		if (!m_crowd) return;
+		processTeleports();
 		if (paused) return;
-		m_crowd->update(time_delta, nullptr);
+		if (!m_is_crowd_step_ready) m_crowd->update(time_delta, nullptr);
+		m_is_crowd_step_ready = false;
+		processMoveRequests();
 
 		for (auto& agent : m_agents)
 		{
@@ -473,6 +952,8 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 			const dtCrowdAgent* dt_agent = m_crowd->getAgent(agent.agent);
 			if (dt_agent->paused) continue;
 
+			// agents moved by the crowd are not teleported, scripts called below may teleport any agent
+			m_is_moving_agents = true;
 			m_universe.setPosition(agent.entity, *(Vec3*)dt_agent->npos);
 
 			if ((agent.flags & Agent::USE_ROOT_MOTION) == 0)
@@ -497,7 +978,9 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 				Transform root_motion = anim_scene->getControllerRootMotion(ctrl);
 				m_universe.setRotation(agent.entity, m_universe.getRotation(agent.entity) * root_motion.rot);
 			}
+			m_is_moving_agents = false;
 
+			if (agent.is_move_pending) continue;
 			if (dt_agent->ncorners == 0 && dt_agent->targetState != DT_CROWDAGENT_TARGET_REQUESTING)
 			{
 				if (!agent.is_finished)
@@ -522,6 +1005,114 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 				agent.is_finished = false;
 			}
 		}
+
+		kickCrowdUpdate(time_delta);
+	}
+
+
+	void kickCrowdUpdate(float time_delta)
+	{
+		ASSERT(!m_is_crowd_updating);
+		m_is_crowd_updating = true;
+		MTJD::Manager& manager = m_system.m_engine.getMTJDManager();
+		MTJD::Job* job = MTJD::makeJob(manager,
+			[this, time_delta]() {
+				PROFILE_BLOCK("Crowd update");
+				m_crowd->update(time_delta, nullptr);
+			},
+			m_allocator);
+		job->addDependency(&m_crowd_sync_point);
+		manager.schedule(job);
+	}
+
+
+	// must be called before the crowd or the navmesh is touched on the main thread
+	void waitForCrowd()
+	{
+		if (!m_is_crowd_updating) return;
+		PROFILE_FUNCTION();
+		m_crowd_sync_point.sync();
+		m_is_crowd_updating = false;
+		m_is_crowd_step_ready = true;
+	}
+
+
+	void processMoveRequests()
+	{
+		if (m_move_requests.empty()) return;
+		PROFILE_FUNCTION();
+		int count = Math::minimum(m_move_requests.size(), MAX_MOVE_REQUESTS_PER_FRAME);
+		PROFILE_INT("move requests", count);
+		dtQueryFilter filter;
+		static const float ext[] = { 1.0f, 20.0f, 1.0f };
+		for (int i = 0; i < count; ++i)
+		{
+			const MoveRequest& request = m_move_requests[i];
+			auto iter = m_agents.find(request.entity);
+			if (!iter.isValid()) continue;
+			Agent& agent = iter.value();
+			agent.is_move_pending = false;
+			if (agent.agent < 0) continue;
+
+			dtPolyRef end_poly_ref;
+			m_navquery->findNearestPoly(&request.dest.x, ext, &filter, &end_poly_ref, 0);
+			dtCrowdAgentParams params = m_crowd->getAgent(agent.agent)->params;
+			params.maxSpeed = request.speed;
+			m_crowd->updateAgentParameters(agent.agent, &params);
+			if (!m_crowd->requestMoveTarget(agent.agent, end_poly_ref, &request.dest.x))
+			{
+				g_log_warning.log("Navigation") << "requestMoveTarget failed";
+				agent.is_finished = true;
+			}
+		}
+		for (int i = count, c = m_move_requests.size(); i < c; ++i)
+		{
+			m_move_requests[i - count] = m_move_requests[i];
+		}
+		m_move_requests.resize(m_move_requests.size() - count);
+	}
+
+
+	// agents moved by something else than the crowd are put where they were moved
+	void processTeleports()
+	{
+		if (m_teleports.empty()) return;
+		PROFILE_FUNCTION();
+		for (Entity entity : m_teleports)
+		{
+			auto iter = m_agents.find(entity);
+			if (!iter.isValid()) continue;
+			Agent& agent = iter.value();
+			agent.is_teleport_pending = false;
+			if (agent.agent < 0) continue;
+
+			Vec3 pos = m_universe.getPosition(entity);
+			const dtCrowdAgent* dt_agent = m_crowd->getAgent(agent.agent);
+			if ((pos - *(Vec3*)dt_agent->npos).squaredLength() <= 0.1f) continue;
+
+			Vec3 target_pos = *(Vec3*)dt_agent->targetPos;
+			float speed = dt_agent->params.maxSpeed;
+			m_crowd->removeAgent(agent.agent);
+			addCrowdAgent(agent);
+			// a pending move request is applied to the new crowd agent
+			if (!agent.is_finished && !agent.is_move_pending)
+			{
+				navigate(entity, target_pos, speed, agent.stop_distance);
+			}
+		}
+		m_teleports.clear();
+	}
+
+
+	void clearMoveRequests()
+	{
+		for (Agent& agent : m_agents)
+		{
+			agent.is_move_pending = false;
+			agent.is_teleport_pending = false;
+		}
+		m_move_requests.clear();
+		m_teleports.clear();
 	}
 
 
@@ -586,6 +1177,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	const dtCrowdAgent* getDetourAgent(Entity entity) override
 	{
 		if (!m_crowd) return nullptr;
+		waitForCrowd();
 
 		auto iter = m_agents.find(entity);
 		if (iter == m_agents.end()) return nullptr;
@@ -601,6 +1193,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
 		if (!render_scene) return;
 		if (!m_crowd) return;
+		waitForCrowd();
 
 		auto iter = m_agents.find(entity);
 		if (iter == m_agents.end()) return;
@@ -679,7 +1272,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 
 	bool isNavmeshReady() const override
 	{
-		return m_navmesh != nullptr;
+		return m_navmesh != nullptr && !m_is_generating;
 	}
 
 
@@ -688,9 +1281,19 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		if (!success) return;
 		if (!initNavmesh()) return;
 
+		NavmeshFileHeader header;
+		if (file.size() >= sizeof(header) && file.read(&header, sizeof(header)) && header.magic == NAVMESH_FILE_MAGIC)
+		{
+			if (!loadCopiedTiles(file, header)) clearNavmesh();
+			file.close();
+			return;
+		}
+		file.seek(FS::SeekMode::BEGIN, 0);
+
 		file.read(&m_aabb, sizeof(m_aabb));
 		file.read(&m_num_tiles_x, sizeof(m_num_tiles_x));
 		file.read(&m_num_tiles_z, sizeof(m_num_tiles_z));
+		m_are_bins_dirty = true;
 		dtNavMeshParams params;
 		file.read(&params, sizeof(params));
 		if (dtStatusFailed(m_navmesh->init(&params)))
@@ -704,6 +1307,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 			{
 				int data_size;
 				file.read(&data_size, sizeof(data_size));
+				if (data_size == 0) continue;
 				u8* data = (u8*)dtAlloc(data_size, DT_ALLOC_PERM);
 				file.read(data, data_size);
 				if (dtStatusFailed(m_navmesh->addTile(data, data_size, DT_TILE_FREE_DATA, 0, 0)))
@@ -720,9 +1324,88 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
+	// page aligned navmesh read into memory when it can not be mapped, the navmesh owns copies of the tiles
+	bool loadCopiedTiles(FS::IFile& file, const NavmeshFileHeader& header)
+	{
+		size_t file_size = file.size();
+		if (!isValidNavmeshFileHeader(header, file_size))
+		{
+			g_log_error.log("Navigation") << "Corrupted navmesh " << m_navmesh_path;
+			return false;
+		}
+		Array<NavmeshFileTile> tiles(m_allocator);
+		tiles.resize(header.tile_count);
+		if (!tiles.empty() && !file.read(&tiles[0], tiles.size() * sizeof(tiles[0]))) return false;
+		for (const NavmeshFileTile& tile : tiles)
+		{
+			if (!isValidNavmeshFileTile(tile, header, file_size))
+			{
+				g_log_error.log("Navigation") << "Corrupted navmesh " << m_navmesh_path;
+				return false;
+			}
+		}
+
+		m_aabb = header.aabb;
+		m_num_tiles_x = header.num_tiles_x;
+		m_num_tiles_z = header.num_tiles_z;
+		m_are_bins_dirty = true;
+		if (dtStatusFailed(m_navmesh->init(&header.params)))
+		{
+			g_log_error.log("Navigation") << "Could not init Detour navmesh";
+			return false;
+		}
+
+		for (const NavmeshFileTile& tile : tiles)
+		{
+			u8* data = (u8*)dtAlloc(tile.size, DT_ALLOC_PERM);
+			if (!file.seek(FS::SeekMode::BEGIN, (size_t)tile.offset) || !file.read(data, tile.size) ||
+				dtStatusFailed(m_navmesh->addTile(data, tile.size, DT_TILE_FREE_DATA, 0, nullptr)))
+			{
+				g_log_error.log("Navigation") << "Could not add Detour tile.";
+				dtFree(data);
+				return false;
+			}
+		}
+
+		if (!m_crowd) initCrowd();
+		return true;
+	}
+
+
+	// absolute paths are used as they are, others are relative to the disk device like in the file system
+	void getDiskPath(const char* path, char* out, int max_size)
+	{
+		FS::DiskFileDevice* device = m_system.m_engine.getDiskFileDevice();
+		if (!device || (path[0] != '\0' && path[1] == ':'))
+		{
+			copyString(out, max_size, path);
+			return;
+		}
+		copyString(out, max_size, device->getBasePath());
+		catString(out, max_size, path);
+	}
+
+
 	bool load(const char* path) override
 	{
+		stopTileJobs();
 		clearNavmesh();
+		copyString(m_navmesh_path, path);
+
+		char disk_path[MAX_PATH_LENGTH];
+		getDiskPath(path, disk_path, lengthOf(disk_path));
+		if (m_navmesh_file.open(disk_path))
+		{
+			auto* header = (const NavmeshFileHeader*)m_navmesh_file.getData();
+			if (m_navmesh_file.size() >= sizeof(*header) && header->magic == NAVMESH_FILE_MAGIC)
+			{
+				if (initMappedNavmesh()) return true;
+				clearNavmesh();
+				return false;
+			}
+			// files saved before the navmesh was mappable
+			m_navmesh_file.close();
+		}
 
 		FS::ReadCallback cb;
 		cb.bind<NavigationSceneImpl, &NavigationSceneImpl::fileLoaded>(this);
@@ -730,31 +1413,177 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		return fs.openAsync(fs.getDefaultDevice(), Path(path), FS::Mode::OPEN_AND_READ, cb) != FS::FileSystem::INVALID_ASYNC;
 	}
 
-	
+	
+	const NavmeshFileTile* getMappedTiles() const
+	{
+		return (const NavmeshFileTile*)(m_navmesh_file.getData() + sizeof(NavmeshFileHeader));
+	}
+
+
+	bool initMappedNavmesh()
+	{
+		const NavmeshFileHeader& header = *(const NavmeshFileHeader*)m_navmesh_file.getData();
+		size_t file_size = m_navmesh_file.size();
+		if (!isValidNavmeshFileHeader(header, file_size))
+		{
+			g_log_error.log("Navigation") << "Corrupted navmesh " << m_navmesh_path;
+			return false;
+		}
+		const NavmeshFileTile* tiles = getMappedTiles();
+		for (int i = 0; i < header.tile_count; ++i)
+		{
+			if (!isValidNavmeshFileTile(tiles[i], header, file_size))
+			{
+				g_log_error.log("Navigation") << "Corrupted navmesh " << m_navmesh_path;
+				return false;
+			}
+		}
+
+		if (!initNavmesh()) return false;
+		m_aabb = header.aabb;
+		m_num_tiles_x = header.num_tiles_x;
+		m_num_tiles_z = header.num_tiles_z;
+		m_are_bins_dirty = true;
+		if (dtStatusFailed(m_navmesh->init(&header.params)))
+		{
+			g_log_error.log("Navigation") << "Could not init Detour navmesh";
+			return false;
+		}
+
+		m_mapped_tile_refs.resize(header.tile_count);
+		for (dtTileRef& ref : m_mapped_tile_refs) ref = 0;
+		m_is_streaming_dirty = true;
+		updateStreaming();
+		if (!m_crowd) initCrowd();
+		return true;
+	}
+
+
+	bool isInStreamingArea(int x, int z) const
+	{
+		if (!m_is_streaming_area_set) return true;
+		return x >= m_streaming_from_x && x <= m_streaming_to_x && z >= m_streaming_from_z && z <= m_streaming_to_z;
+	}
+
+
+	void setNavmeshStreamingArea(const Vec3& center, float radius) override
+	{
+		const float tile_size = CELLS_PER_TILE_SIDE * CELL_SIZE;
+		int from_x = (int)floorf((center.x - radius - m_aabb.min.x) / tile_size);
+		int from_z = (int)floorf((center.z - radius - m_aabb.min.z) / tile_size);
+		int to_x = (int)floorf((center.x + radius - m_aabb.min.x) / tile_size);
+		int to_z = (int)floorf((center.z + radius - m_aabb.min.z) / tile_size);
+		bool is_set = radius > 0;
+		if (is_set == m_is_streaming_area_set && from_x == m_streaming_from_x && from_z == m_streaming_from_z &&
+			to_x == m_streaming_to_x && to_z == m_streaming_to_z)
+		{
+			return;
+		}
+
+		m_is_streaming_area_set = is_set;
+		m_streaming_from_x = from_x;
+		m_streaming_from_z = from_z;
+		m_streaming_to_x = to_x;
+		m_streaming_to_z = to_z;
+		m_is_streaming_dirty = true;
+	}
+
+
+	// tiles of a mapped navmesh reference the file, only those in the streaming area are in the navmesh
+	void updateStreaming()
+	{
+		if (!m_is_streaming_dirty || !m_navmesh_file.isOpen() || !m_navmesh) return;
+
+		PROFILE_FUNCTION();
+		m_is_streaming_dirty = false;
+		const NavmeshFileTile* tiles = getMappedTiles();
+		for (int i = 0, c = m_mapped_tile_refs.size(); i < c; ++i)
+		{
+			const NavmeshFileTile& tile = tiles[i];
+			dtTileRef& ref = m_mapped_tile_refs[i];
+			bool is_in_area = isInStreamingArea(tile.x, tile.z);
+			if (is_in_area == (ref != 0)) continue;
+
+			waitForCrowd();
+			if (is_in_area)
+			{
+				u8* data = m_navmesh_file.getData() + tile.offset;
+				if (dtStatusFailed(m_navmesh->addTile(data, tile.size, 0, 0, &ref)))
+				{
+					g_log_error.log("Navigation") << "Could not add Detour tile.";
+					ref = 0;
+				}
+			}
+			else
+			{
+				m_navmesh->removeTile(ref, nullptr, nullptr);
+				ref = 0;
+				m_navmesh_file.discard((size_t)tile.offset, tile.size);
+			}
+		}
+	}
+
+
 	bool save(const char* path) override
 	{
-		if (!m_navmesh) return false;
+		if (!isNavmeshReady()) return false;
+		if (m_navmesh_file.isOpen() && equalStrings(path, m_navmesh_path))
+		{
+			g_log_error.log("Navigation") << "Can not overwrite " << path << ", the navmesh is mapped from it";
+			return false;
+		}
 
 		FS::OsFile file;
 		if (!file.open(path, FS::Mode::CREATE_AND_WRITE, m_allocator)) return false;
 
-		file.write(&m_aabb, sizeof(m_aabb));
-		file.write(&m_num_tiles_x, sizeof(m_num_tiles_x));
-		file.write(&m_num_tiles_z, sizeof(m_num_tiles_z));
-		auto params = m_navmesh->getParams();
-		file.write(params, sizeof(*params));
-		for (int j = 0; j < m_num_tiles_z; ++j)
+		const dtNavMesh* navmesh = m_navmesh;
+		Array<NavmeshFileTile> tiles(m_allocator);
+		for (int i = 0, c = navmesh->getMaxTiles(); i < c; ++i)
 		{
-			for (int i = 0; i < m_num_tiles_x; ++i)
-			{
-				const auto* tile = m_navmesh->getTileAt(i, j, 0);
-				file.write(&tile->dataSize, sizeof(tile->dataSize));
-				file.write(tile->data, tile->dataSize);
-			}
+			const dtMeshTile* tile = navmesh->getTile(i);
+			if (!tile->header) continue;
+			NavmeshFileTile& entry = tiles.emplace();
+			entry.size = tile->dataSize;
+			entry.x = tile->header->x;
+			entry.z = tile->header->y;
+			entry.layer = tile->header->layer;
+		}
+
+		auto alignToPage = [](u64 offset) { return (offset + NAVMESH_FILE_PAGE_SIZE - 1) & ~u64(NAVMESH_FILE_PAGE_SIZE - 1); };
+		u64 offset = alignToPage(sizeof(NavmeshFileHeader) + tiles.size() * sizeof(NavmeshFileTile));
+		for (NavmeshFileTile& entry : tiles)
+		{
+			entry.offset = offset;
+			offset = alignToPage(offset + entry.size);
+		}
+
+		NavmeshFileHeader header;
+		header.magic = NAVMESH_FILE_MAGIC;
+		header.version = (int)NavmeshFileVersion::LATEST;
+		header.aabb = m_aabb;
+		header.num_tiles_x = m_num_tiles_x;
+		header.num_tiles_z = m_num_tiles_z;
+		header.params = *navmesh->getParams();
+		header.tile_count = tiles.size();
+		bool success = file.write(&header, sizeof(header));
+		if (!tiles.empty()) success = success && file.write(&tiles[0], tiles.size() * sizeof(tiles[0]));
+
+		static const u8 padding[NAVMESH_FILE_PAGE_SIZE] = {};
+		u64 pos = sizeof(header) + tiles.size() * sizeof(NavmeshFileTile);
+		int entry_idx = 0;
+		for (int i = 0, c = navmesh->getMaxTiles(); i < c; ++i)
+		{
+			const dtMeshTile* tile = navmesh->getTile(i);
+			if (!tile->header) continue;
+			const NavmeshFileTile& entry = tiles[entry_idx];
+			++entry_idx;
+			success = success && file.write(padding, size_t(entry.offset - pos));
+			success = success && file.write(tile->data, tile->dataSize);
+			pos = entry.offset + tile->dataSize;
 		}
 
 		file.close();
-		return true;
+		return success;
 	}
 
 
@@ -962,6 +1791,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		int x = int((pos.x - m_aabb.min.x + (1 + m_config.borderSize) * m_config.cs) / (CELLS_PER_TILE_SIDE * CELL_SIZE));
 		int z = int((pos.z - m_aabb.min.z + (1 + m_config.borderSize) * m_config.cs) / (CELLS_PER_TILE_SIDE * CELL_SIZE));
 		const dtMeshTile* tile = m_navmesh->getTileAt(x, z, 0);
+		if (!tile) return;
 		auto render_scene = static_cast<RenderScene*>(m_universe.getScene(crc32("renderer")));
 		if (!render_scene) return;
 
@@ -985,6 +1815,9 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 
 	void stopGame() override
 	{
+		waitForCrowd();
+		clearMoveRequests();
+		m_is_crowd_step_ready = false;
 		if (m_crowd)
 		{
 			for (Agent& agent : m_agents)
@@ -1003,7 +1836,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		auto* scene = m_universe.getScene(crc32("lua_script"));
 		m_script_scene = static_cast<LuaScriptScene*>(scene);
 		
-		if (m_navmesh && !m_crowd) initCrowd();
+		if (isNavmeshReady() && !m_crowd) initCrowd();
 	}
 
 
@@ -1011,8 +1844,9 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	{
 		ASSERT(!m_crowd);
 
+		m_is_crowd_step_ready = false;
 		m_crowd = dtAllocCrowd();
-		if (!m_crowd->init(1000, 4.0f, m_navmesh))
+		if (!m_crowd->init(MAX_CROWD_AGENTS, 4.0f, m_navmesh))
 		{
 			dtFreeCrowd(m_crowd);
 			m_crowd = nullptr;
@@ -1036,6 +1870,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		Agent& agent = iter.value();
 		if (agent.agent < 0) return;
 
+		waitForCrowd();
 		m_crowd->resetMoveTarget(agent.agent);
 	}
 
@@ -1051,6 +1886,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		Agent& agent = iter.value();
 		if (agent.agent < 0) return;
 
+		waitForCrowd();
 		dtCrowdAgent* dt_agent = m_crowd->getEditableAgent(agent.agent);
 		if (dt_agent) dt_agent->paused = !active;
 	}
@@ -1065,31 +1901,40 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		if (iter == m_agents.end()) return false;
 		Agent& agent = iter.value();
 		if (agent.agent < 0) return false;
-		dtPolyRef end_poly_ref;
-		dtQueryFilter filter;
-		static const float ext[] = { 1.0f, 20.0f, 1.0f };
-		m_navquery->findNearestPoly(&dest.x, ext, &filter, &end_poly_ref, 0);
-		dtCrowdAgentParams params = m_crowd->getAgent(agent.agent)->params;
-		params.maxSpeed = speed;
-		m_crowd->updateAgentParameters(agent.agent, &params);
-		if (m_crowd->requestMoveTarget(agent.agent, end_poly_ref, &dest.x))
-		{
-			agent.stop_distance = stop_distance;
-			agent.is_finished = false;
-		}
-		else
+
+		// the crowd might be updating on a worker thread, requests are applied in batches by update
+		agent.stop_distance = stop_distance;
+		agent.is_finished = false;
+		if (agent.is_move_pending)
 		{
-			g_log_warning.log("Navigation") << "requestMoveTarget failed";
-			agent.is_finished = true;
+			for (MoveRequest& request : m_move_requests)
+			{
+				if (request.entity != entity) continue;
+				request.dest = dest;
+				request.speed = speed;
+				return true;
+			}
 		}
-		return !agent.is_finished;
+		agent.is_move_pending = true;
+		MoveRequest& request = m_move_requests.emplace();
+		request.entity = entity;
+		request.dest = dest;
+		request.speed = speed;
+		return true;
 	}
 
 
 	int getPolygonCount()
 	{
-		if (!m_polymesh) return 0;
-		return m_polymesh->npolys;
+		if (!m_navmesh) return 0;
+		const dtNavMesh* navmesh = m_navmesh;
+		int count = 0;
+		for (int i = 0, c = navmesh->getMaxTiles(); i < c; ++i)
+		{
+			const dtMeshTile* tile = navmesh->getTile(i);
+			if (tile->header) count += tile->header->polyCount;
+		}
+		return count;
 	}
 
 
@@ -1131,164 +1976,271 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	}
 
 
-	bool generateTile(int x, int z, bool keep_data) override
+	void initTile(int x, int z, NavmeshTile& tile)
 	{
 		PROFILE_FUNCTION();
-		if (!m_navmesh) return false;
-		m_navmesh->removeTile(m_navmesh->getTileRefAt(x, z, 0), 0, 0);
+		tile.x = x;
+		tile.z = z;
+		tile.config = m_config;
+		AABB aabb = getTileAABB(x, z);
+		rcVcopy(tile.config.bmin, &aabb.min.x);
+		rcVcopy(tile.config.bmax, &aabb.max.x);
+		gatherGeometry(aabb, tile);
+	}
 
-		rcContext ctx;
 
-		Vec3 bmin(m_aabb.min.x + x * CELLS_PER_TILE_SIDE * CELL_SIZE - (1 + m_config.borderSize) * m_config.cs,
-			m_aabb.min.y,
-			m_aabb.min.z + z * CELLS_PER_TILE_SIDE * CELL_SIZE - (1 + m_config.borderSize) * m_config.cs);
-		Vec3 bmax(bmin.x + CELLS_PER_TILE_SIDE * CELL_SIZE + (1 + m_config.borderSize) * m_config.cs,
-			m_aabb.max.y,
-			bmin.z + CELLS_PER_TILE_SIDE * CELL_SIZE + (1 + m_config.borderSize) * m_config.cs);
-		if (keep_data) m_debug_tile_origin = bmin;
-		rcVcopy(m_config.bmin, &bmin.x);
-		rcVcopy(m_config.bmax, &bmax.x);
-		rcHeightfield* solid = rcAllocHeightfield();
-		m_debug_heightfield = keep_data ? solid : nullptr;
-		if (!solid)
-		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Out of memory 'solid'.";
+	static void buildTileLayers(NavmeshTile& tile, rcContext& ctx, rcCompactHeightfield& chf)
+	{
+		const rcConfig& cfg = tile.config;
+		rcHeightfieldLayerSet* lset = rcAllocHeightfieldLayerSet();
+		if (!lset) return;
+		// a tile missing some of its layers would lose them on rebuild, such tiles ignore obstacles
+		if (rcBuildHeightfieldLayers(&ctx, chf, cfg.borderSize, cfg.walkableHeight, *lset) &&
+			lset->nlayers <= MAX_TILE_LAYERS)
+		{
+			LZTileCacheCompressor compressor;
+			for (int i = 0; i < lset->nlayers; ++i)
+			{
+				const rcHeightfieldLayer& layer = lset->layers[i];
+				dtTileCacheLayerHeader header;
+				header.magic = DT_TILECACHE_MAGIC;
+				header.version = DT_TILECACHE_VERSION;
+				header.tx = tile.x;
+				header.ty = tile.z;
+				header.tlayer = i;
+				rcVcopy(header.bmin, layer.bmin);
+				rcVcopy(header.bmax, layer.bmax);
+				header.width = (u8)layer.width;
+				header.height = (u8)layer.height;
+				header.minx = (u8)layer.minx;
+				header.maxx = (u8)layer.maxx;
+				header.miny = (u8)layer.miny;
+				header.maxy = (u8)layer.maxy;
+				header.hmin = (u16)layer.hmin;
+				header.hmax = (u16)layer.hmax;
+
+				TileData& compressed = tile.layers.emplace();
+				if (dtStatusFailed(dtBuildTileCacheLayer(
+						&compressor, &header, layer.heights, layer.areas, layer.cons, &compressed.data, &compressed.size)))
+				{
+					tile.layers.pop();
+					freeTileData(tile.layers);
+					break;
+				}
+			}
+		}
+		rcFreeHeightfieldLayerSet(lset);
+	}
+
+
+	// runs on worker threads, must not touch the universe
+	bool buildTileData(NavmeshTile& tile, rcContext& ctx, TileBuildData& data)
+	{
+		const rcConfig& cfg = tile.config;
+		data.solid = rcAllocHeightfield();
+		if (!data.solid)
+		{
+			tile.error = "Out of memory 'solid'.";
 			return false;
 		}
-		if (!rcCreateHeightfield(
-				&ctx, *solid, m_config.width, m_config.height, m_config.bmin, m_config.bmax, m_config.cs, m_config.ch))
+		if (!rcCreateHeightfield(&ctx, *data.solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not create solid heightfield.";
+			tile.error = "Could not create solid heightfield.";
 			return false;
 		}
-		rasterizeGeometry(AABB(bmin, bmax), ctx, m_config, *solid);
+		if (!tile.areas.empty())
+		{
+			rcRasterizeTriangles(&ctx, &tile.vertices[0].x, &tile.areas[0], tile.areas.size(), *data.solid);
+		}
 
-		rcFilterLowHangingWalkableObstacles(&ctx, m_config.walkableClimb, *solid);
-		rcFilterLedgeSpans(&ctx, m_config.walkableHeight, m_config.walkableClimb, *solid);
-		rcFilterWalkableLowHeightSpans(&ctx, m_config.walkableHeight, *solid);
+		rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *data.solid);
+		rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.solid);
+		rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *data.solid);
+		if (m_is_generation_cancelled) return false;
 
-		rcCompactHeightfield* chf = rcAllocCompactHeightfield();
-		m_debug_compact_heightfield = keep_data ? chf : nullptr;
-		if (!chf)
+		data.chf = rcAllocCompactHeightfield();
+		if (!data.chf)
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Out of memory 'chf'.";
+			tile.error = "Out of memory 'chf'.";
 			return false;
 		}
-
-		if (!rcBuildCompactHeightfield(&ctx, m_config.walkableHeight, m_config.walkableClimb, *solid, *chf))
+		if (!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.solid, *data.chf))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not build compact data.";
+			tile.error = "Could not build compact data.";
 			return false;
 		}
-
-		if (!m_debug_heightfield) rcFreeHeightField(solid);
-
-		if (!rcErodeWalkableArea(&ctx, m_config.walkableRadius, *chf))
+		if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *data.chf))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not erode.";
+			tile.error = "Could not erode.";
 			return false;
 		}
-
-		if (!rcBuildDistanceField(&ctx, *chf))
+		buildTileLayers(tile, ctx, *data.chf);
+		if (!rcBuildDistanceField(&ctx, *data.chf))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not build distance field.";
+			tile.error = "Could not build distance field.";
 			return false;
 		}
-
-		if (!rcBuildRegions(&ctx, *chf, m_config.borderSize, m_config.minRegionArea, m_config.mergeRegionArea))
+		if (!rcBuildRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not build regions.";
+			tile.error = "Could not build regions.";
 			return false;
 		}
+		if (m_is_generation_cancelled) return false;
 
-		rcContourSet* cset = rcAllocContourSet();
-		m_debug_contours = keep_data ? cset : nullptr;
-		if (!cset)
+		data.cset = rcAllocContourSet();
+		if (!data.cset)
 		{
-			ctx.log(RC_LOG_ERROR, "Could not generate navmesh: Out of memory 'cset'.");
+			tile.error = "Out of memory 'cset'.";
 			return false;
 		}
-		if (!rcBuildContours(&ctx, *chf, m_config.maxSimplificationError, m_config.maxEdgeLen, *cset))
+		if (!rcBuildContours(&ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cset))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not create contours.";
+			tile.error = "Could not create contours.";
 			return false;
 		}
 
-		m_polymesh = rcAllocPolyMesh();
-		if (!m_polymesh)
+		data.polymesh = rcAllocPolyMesh();
+		if (!data.polymesh)
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Out of memory 'm_polymesh'.";
+			tile.error = "Out of memory 'polymesh'.";
 			return false;
 		}
-		if (!rcBuildPolyMesh(&ctx, *cset, m_config.maxVertsPerPoly, *m_polymesh))
+		if (!rcBuildPolyMesh(&ctx, *data.cset, cfg.maxVertsPerPoly, *data.polymesh))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not triangulate contours.";
+			tile.error = "Could not triangulate contours.";
 			return false;
 		}
+		if (data.polymesh->npolys == 0) return true;
 
-		m_detail_mesh = rcAllocPolyMeshDetail();
-		if (!m_detail_mesh)
+		data.detail_mesh = rcAllocPolyMeshDetail();
+		if (!data.detail_mesh)
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Out of memory 'pmdtl'.";
+			tile.error = "Out of memory 'pmdtl'.";
 			return false;
 		}
-
 		if (!rcBuildPolyMeshDetail(
-				&ctx, *m_polymesh, *chf, m_config.detailSampleDist, m_config.detailSampleMaxError, *m_detail_mesh))
+				&ctx, *data.polymesh, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.detail_mesh))
 		{
-			g_log_error.log("Navigation") << "Could not generate navmesh: Could not build detail mesh.";
+			tile.error = "Could not build detail mesh.";
 			return false;
 		}
 
-		if (!m_debug_compact_heightfield) rcFreeCompactHeightfield(chf);
-		if (!m_debug_contours) rcFreeContourSet(cset);
-
-		unsigned char* nav_data = 0;
-		int nav_data_size = 0;
-
-		for (int i = 0; i < m_polymesh->npolys; ++i)
+		rcPolyMesh& polymesh = *data.polymesh;
+		for (int i = 0; i < polymesh.npolys; ++i)
 		{
-			m_polymesh->flags[i] = m_polymesh->areas[i] == RC_WALKABLE_AREA ? 1 : 0;
+			polymesh.flags[i] = polymesh.areas[i] == RC_WALKABLE_AREA ? 1 : 0;
 		}
 
 		dtNavMeshCreateParams params = {};
-		params.verts = m_polymesh->verts;
-		params.vertCount = m_polymesh->nverts;
-		params.polys = m_polymesh->polys;
-		params.polyAreas = m_polymesh->areas;
-		params.polyFlags = m_polymesh->flags;
-		params.polyCount = m_polymesh->npolys;
-		params.nvp = m_polymesh->nvp;
-		params.detailMeshes = m_detail_mesh->meshes;
-		params.detailVerts = m_detail_mesh->verts;
-		params.detailVertsCount = m_detail_mesh->nverts;
-		params.detailTris = m_detail_mesh->tris;
-		params.detailTriCount = m_detail_mesh->ntris;
-		params.walkableHeight = m_config.walkableHeight * m_config.ch;
-		params.walkableRadius = m_config.walkableRadius * m_config.cs;
-		params.walkableClimb = m_config.walkableClimb * m_config.ch;
-		params.tileX = x;
-		params.tileY = z;
-		rcVcopy(params.bmin, m_polymesh->bmin);
-		rcVcopy(params.bmax, m_polymesh->bmax);
-		params.cs = m_config.cs;
-		params.ch = m_config.ch;
+		params.verts = polymesh.verts;
+		params.vertCount = polymesh.nverts;
+		params.polys = polymesh.polys;
+		params.polyAreas = polymesh.areas;
+		params.polyFlags = polymesh.flags;
+		params.polyCount = polymesh.npolys;
+		params.nvp = polymesh.nvp;
+		params.detailMeshes = data.detail_mesh->meshes;
+		params.detailVerts = data.detail_mesh->verts;
+		params.detailVertsCount = data.detail_mesh->nverts;
+		params.detailTris = data.detail_mesh->tris;
+		params.detailTriCount = data.detail_mesh->ntris;
+		params.walkableHeight = cfg.walkableHeight * cfg.ch;
+		params.walkableRadius = cfg.walkableRadius * cfg.cs;
+		params.walkableClimb = cfg.walkableClimb * cfg.ch;
+		params.tileX = tile.x;
+		params.tileY = tile.z;
+		rcVcopy(params.bmin, polymesh.bmin);
+		rcVcopy(params.bmax, polymesh.bmax);
+		params.cs = cfg.cs;
+		params.ch = cfg.ch;
 		params.buildBvTree = false;
 
-		if (!dtCreateNavMeshData(&params, &nav_data, &nav_data_size))
+		if (!dtCreateNavMeshData(&params, &tile.nav_data, &tile.nav_data_size))
+		{
+			tile.error = "Could not build Detour navmesh.";
+			return false;
+		}
+		return true;
+	}
+
+
+	void buildTile(NavmeshTile& tile, bool keep_data)
+	{
+		PROFILE_FUNCTION();
+		rcContext ctx;
+		TileBuildData data;
+		buildTileData(tile, ctx, data);
+
+		if (keep_data)
+		{
+			rcFreeHeightField(m_debug_heightfield);
+			rcFreeCompactHeightfield(m_debug_compact_heightfield);
+			rcFreeContourSet(m_debug_contours);
+			m_debug_tile_origin = *(Vec3*)tile.config.bmin;
+			m_debug_heightfield = data.solid;
+			m_debug_compact_heightfield = data.chf;
+			m_debug_contours = data.cset;
+		}
+		else
+		{
+			rcFreeHeightField(data.solid);
+			rcFreeCompactHeightfield(data.chf);
+			rcFreeContourSet(data.cset);
+		}
+		rcFreePolyMesh(data.polymesh);
+		rcFreePolyMeshDetail(data.detail_mesh);
+	}
+
+
+	void removeTiles(int x, int z)
+	{
+		waitForCrowd();
+		const dtMeshTile* tiles[MAX_TILE_LAYERS + 1];
+		const dtNavMesh* navmesh = m_navmesh;
+		int count = navmesh->getTilesAt(x, z, tiles, lengthOf(tiles));
+		for (int i = 0; i < count; ++i)
+		{
+			m_navmesh->removeTile(navmesh->getTileRef(tiles[i]), 0, 0);
+		}
+	}
+
+
+	bool addTile(NavmeshTile& tile)
+	{
+		removeTiles(tile.x, tile.z);
+		setTileLayers(tile);
+		if (!tile.nav_data)
 		{
-			g_log_error.log("Navigation") << "Could not build Detour navmesh.";
+			if (!tile.error) return true;
+			g_log_error.log("Navigation") << "Could not generate navmesh tile " << tile.x << ", " << tile.z << ": "
+										  << tile.error;
 			return false;
 		}
-		if (dtStatusFailed(m_navmesh->addTile(nav_data, nav_data_size, DT_TILE_FREE_DATA, 0, nullptr)))
+		if (dtStatusFailed(m_navmesh->addTile(tile.nav_data, tile.nav_data_size, DT_TILE_FREE_DATA, 0, nullptr)))
 		{
 			g_log_error.log("Navigation") << "Could not add Detour tile.";
+			dtFree(tile.nav_data);
+			tile.nav_data = nullptr;
 			return false;
 		}
+		tile.nav_data = nullptr;
 		return true;
 	}
 
 
+	bool generateTile(int x, int z, bool keep_data) override
+	{
+		PROFILE_FUNCTION();
+		if (!m_navmesh || m_is_generating) return false;
+
+		NavmeshTile tile(m_allocator);
+		initTile(x, z, tile);
+		clearModelTriangles();
+		buildTile(tile, keep_data);
+		return addTile(tile);
+	}
+
+
 	void computeAABB()
 	{
 		m_aabb.set(Vec3(0, 0, 0), Vec3(0, 0, 0));
@@ -1348,11 +2300,26 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	bool generateNavmesh() override
 	{
 		PROFILE_FUNCTION();
+		if (!generateNavmeshAsync()) return false;
+		while (m_is_generating)
+		{
+			m_tiles_sync_point.sync();
+			updateNavmeshGeneration();
+		}
+		return !m_generation_failed;
+	}
+
+
+	bool generateNavmeshAsync() override
+	{
+		PROFILE_FUNCTION();
+		stopTileJobs();
 		clearNavmesh();
 
 		if (!initNavmesh()) return false;
 
 		computeAABB();
+		m_are_bins_dirty = true;
 		dtNavMeshParams params;
 		rcVcopy(params.orig, &m_aabb.min.x);
 		params.tileWidth = float(CELLS_PER_TILE_SIDE * CELL_SIZE);
@@ -1361,7 +2328,8 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 		rcCalcGridSize(&m_aabb.min.x, &m_aabb.max.x, CELL_SIZE, &grid_width, &grid_height);
 		m_num_tiles_x = (grid_width + CELLS_PER_TILE_SIDE - 1) / CELLS_PER_TILE_SIDE;
 		m_num_tiles_z = (grid_height + CELLS_PER_TILE_SIDE - 1) / CELLS_PER_TILE_SIDE;
-		params.maxTiles = m_num_tiles_x * m_num_tiles_z;
+		// every layer of a tile takes its own slot once obstacles rebuild the tile
+		params.maxTiles = m_num_tiles_x * m_num_tiles_z * MAX_TILE_LAYERS;
 		int tiles_bits = Math::log2(Math::nextPow2(params.maxTiles));
 		params.maxPolys = 1 << (22 - tiles_bits); // keep 10 bits for salt
 
@@ -1371,17 +2339,412 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 			return false;
 		}
 
-		for (int j = 0; j < m_num_tiles_z; ++j)
+		m_tile_layers.resize(m_num_tiles_x * m_num_tiles_z);
+		for (TileLayers*& layers : m_tile_layers) layers = nullptr;
+		m_next_tile = 0;
+		m_finished_tiles = 0;
+		m_generation_failed = false;
+		m_is_generation_cancelled = false;
+		m_is_generating = true;
+		updateNavmeshGeneration();
+		return true;
+	}
+
+
+	bool isGeneratingNavmesh() const override { return m_is_generating; }
+
+
+	float getNavmeshGenerationProgress() const override
+	{
+		int count = m_num_tiles_x * m_num_tiles_z;
+		return count > 0 ? m_finished_tiles / (float)count : 1;
+	}
+
+
+	void cancelNavmeshGeneration() override
+	{
+		if (!m_is_generating) return;
+		stopTileJobs();
+		clearNavmesh();
+	}
+
+
+	// adds finished tiles to the navmesh and gathers geometry for the next ones, main thread only
+	void updateNavmeshGeneration()
+	{
+		PROFILE_FUNCTION();
+		for (int i = m_tiles_in_flight.size() - 1; i >= 0; --i)
 		{
-			for (int i = 0; i < m_num_tiles_x; ++i)
+			NavmeshTile* tile = m_tiles_in_flight[i];
+			if (!tile->is_done) continue;
+
+			MT::memoryBarrier();
+			if (!addTile(*tile)) m_generation_failed = true;
+			LUMIX_DELETE(m_allocator, tile);
+			m_tiles_in_flight.eraseFast(i);
+			++m_finished_tiles;
+		}
+
+		MTJD::Manager& manager = m_system.m_engine.getMTJDManager();
+		int count = m_num_tiles_x * m_num_tiles_z;
+		int max_in_flight = Math::maximum(1, (int)manager.getCpuThreadsCount() * TILES_IN_FLIGHT_PER_THREAD);
+		while (m_next_tile < count && m_tiles_in_flight.size() < max_in_flight)
+		{
+			NavmeshTile* tile = LUMIX_NEW(m_allocator, NavmeshTile)(m_allocator);
+			initTile(m_next_tile % m_num_tiles_x, m_next_tile / m_num_tiles_x, *tile);
+			++m_next_tile;
+			m_tiles_in_flight.push(tile);
+
+			MTJD::Job* job = MTJD::makeJob(manager,
+				[this, tile]() {
+					PROFILE_BLOCK("Navmesh tile");
+					buildTile(*tile, false);
+					MT::memoryBarrier();
+					tile->is_done = true;
+				},
+				m_allocator);
+			job->addDependency(&m_tiles_sync_point);
+			manager.schedule(job);
+		}
+
+		if (m_next_tile == count && m_tiles_in_flight.empty())
+		{
+			m_is_generating = false;
+			clearModelTriangles();
+			if (m_generation_failed) g_log_error.log("Navigation") << "Navmesh generated with errors";
+		}
+	}
+
+
+	void stopTileJobs()
+	{
+		if (m_tiles_in_flight.empty())
+		{
+			m_is_generating = false;
+			return;
+		}
+
+		m_is_generation_cancelled = true;
+		m_tiles_sync_point.sync();
+		for (NavmeshTile* tile : m_tiles_in_flight)
+		{
+			dtFree(tile->nav_data);
+			LUMIX_DELETE(m_allocator, tile);
+		}
+		m_tiles_in_flight.clear();
+		clearModelTriangles();
+		m_is_generation_cancelled = false;
+		m_is_generating = false;
+	}
+
+
+	int addCylinderObstacle(const Vec3& pos, float radius, float height) override
+	{
+		Obstacle obstacle;
+		obstacle.type = Obstacle::CYLINDER;
+		obstacle.min.set(pos.x - radius, pos.y, pos.z - radius);
+		obstacle.max.set(pos.x + radius, pos.y + height, pos.z + radius);
+		return addObstacle(obstacle);
+	}
+
+
+	int addBoxObstacle(const Vec3& min, const Vec3& max) override
+	{
+		Obstacle obstacle;
+		obstacle.type = Obstacle::BOX;
+		obstacle.min = min;
+		obstacle.max = max;
+		return addObstacle(obstacle);
+	}
+
+
+	int addObstacle(const Obstacle& obstacle)
+	{
+		if (m_navmesh && m_tile_layers.empty())
+		{
+			g_log_warning.log("Navigation") << "Navmesh has no tile layers, obstacles are ignored until it's regenerated";
+		}
+		int id = m_next_obstacle_id++;
+		m_obstacles.insert(id, obstacle);
+		markObstacleTilesDirty(obstacle);
+		return id;
+	}
+
+
+	void removeObstacle(int obstacle) override
+	{
+		auto iter = m_obstacles.find(obstacle);
+		if (!iter.isValid()) return;
+		markObstacleTilesDirty(iter.value());
+		m_obstacles.erase(iter);
+	}
+
+
+	void getObstacleTiles(const Obstacle& obstacle, int* from_x, int* from_z, int* to_x, int* to_z) const
+	{
+		const float tile_size = CELLS_PER_TILE_SIDE * CELL_SIZE;
+		*from_x = Math::clamp(int((obstacle.min.x - m_aabb.min.x) / tile_size), 0, m_num_tiles_x - 1);
+		*from_z = Math::clamp(int((obstacle.min.z - m_aabb.min.z) / tile_size), 0, m_num_tiles_z - 1);
+		*to_x = Math::clamp(int((obstacle.max.x - m_aabb.min.x) / tile_size), 0, m_num_tiles_x - 1);
+		*to_z = Math::clamp(int((obstacle.max.z - m_aabb.min.z) / tile_size), 0, m_num_tiles_z - 1);
+	}
+
+
+	bool isObstacleInTile(const Obstacle& obstacle, int x, int z) const
+	{
+		int from_x, from_z, to_x, to_z;
+		getObstacleTiles(obstacle, &from_x, &from_z, &to_x, &to_z);
+		return x >= from_x && x <= to_x && z >= from_z && z <= to_z;
+	}
+
+
+	void markObstacleTilesDirty(const Obstacle& obstacle)
+	{
+		if (m_tile_layers.empty()) return;
+
+		int from_x, from_z, to_x, to_z;
+		getObstacleTiles(obstacle, &from_x, &from_z, &to_x, &to_z);
+		for (int z = from_z; z <= to_z; ++z)
+		{
+			for (int x = from_x; x <= to_x; ++x)
+			{
+				int tile_index = x + z * m_num_tiles_x;
+				if (m_dirty_obstacle_tiles.indexOf(tile_index) < 0) m_dirty_obstacle_tiles.push(tile_index);
+			}
+		}
+	}
+
+
+	// takes the layers built with the tile, obstacles already placed on it need a rebuild
+	void setTileLayers(NavmeshTile& tile)
+	{
+		int tile_index = tile.x + tile.z * m_num_tiles_x;
+		if (tile.x < 0 || tile.z < 0 || tile.x >= m_num_tiles_x || tile_index >= m_tile_layers.size()) return;
+
+		TileLayers*& layers = m_tile_layers[tile_index];
+		if (!layers) layers = LUMIX_NEW(m_allocator, TileLayers)(m_allocator);
+		freeTileData(layers->layers);
+		layers->layers.swap(tile.layers);
+
+		for (const Obstacle& obstacle : m_obstacles)
+		{
+			if (!isObstacleInTile(obstacle, tile.x, tile.z)) continue;
+			if (m_dirty_obstacle_tiles.indexOf(tile_index) < 0) m_dirty_obstacle_tiles.push(tile_index);
+			break;
+		}
+	}
+
+
+	static void markBoxArea(dtTileCacheLayer& layer, float cs, float ch, const Vec3& bmin, const Vec3& bmax)
+	{
+		const dtTileCacheLayerHeader& header = *layer.header;
+		const int w = header.width;
+		const int h = header.height;
+		const float* orig = header.bmin;
+		int min_x = (int)floorf((bmin.x - orig[0]) / cs);
+		int min_y = (int)floorf((bmin.y - orig[1]) / ch);
+		int min_z = (int)floorf((bmin.z - orig[2]) / cs);
+		int max_x = (int)floorf((bmax.x - orig[0]) / cs);
+		int max_y = (int)floorf((bmax.y - orig[1]) / ch);
+		int max_z = (int)floorf((bmax.z - orig[2]) / cs);
+		if (max_x < 0 || min_x >= w || max_z < 0 || min_z >= h) return;
+
+		min_x = Math::maximum(min_x, 0);
+		min_z = Math::maximum(min_z, 0);
+		max_x = Math::minimum(max_x, w - 1);
+		max_z = Math::minimum(max_z, h - 1);
+		for (int z = min_z; z <= max_z; ++z)
+		{
+			for (int x = min_x; x <= max_x; ++x)
+			{
+				int y = layer.heights[x + z * w];
+				if (y < min_y || y > max_y) continue;
+				layer.areas[x + z * w] = DT_TILECACHE_NULL_AREA;
+			}
+		}
+	}
+
+
+	// runs on worker threads, builds one Detour tile per layer with the obstacles carved out
+	static void rebuildObstacleTile(ObstacleTileRebuild& rebuild, IAllocator& allocator)
+	{
+		const rcConfig& cfg = rebuild.config;
+		LZTileCacheCompressor compressor;
+		TileCacheLinearAllocator alloc(allocator);
+		for (TileData& compressed : rebuild.layers)
+		{
+			alloc.reset();
+			dtTileCacheLayer* layer = nullptr;
+			if (dtStatusFailed(dtDecompressTileCacheLayer(&alloc, &compressor, compressed.data, compressed.size, &layer)))
 			{
-				if (!generateTile(i, j, false))
+				continue;
+			}
+
+			const dtTileCacheLayerHeader& header = *layer->header;
+			for (const Obstacle& obstacle : rebuild.obstacles)
+			{
+				if (obstacle.type == Obstacle::CYLINDER)
+				{
+					Vec3 pos = (obstacle.min + obstacle.max) * 0.5f;
+					pos.y = obstacle.min.y;
+					float radius = (obstacle.max.x - obstacle.min.x) * 0.5f;
+					float height = obstacle.max.y - obstacle.min.y;
+					dtMarkCylinderArea(*layer, header.bmin, cfg.cs, cfg.ch, &pos.x, radius, height, DT_TILECACHE_NULL_AREA);
+				}
+				else
 				{
-					return false;
+					markBoxArea(*layer, cfg.cs, cfg.ch, obstacle.min, obstacle.max);
 				}
 			}
+
+			if (dtStatusFailed(dtBuildTileCacheRegions(&alloc, *layer, cfg.walkableClimb))) continue;
+			dtTileCacheContourSet* lcset = dtAllocTileCacheContourSet(&alloc);
+			if (!lcset) continue;
+			if (dtStatusFailed(
+					dtBuildTileCacheContours(&alloc, *layer, cfg.walkableClimb, cfg.maxSimplificationError, *lcset)))
+			{
+				continue;
+			}
+			dtTileCachePolyMesh* lmesh = dtAllocTileCachePolyMesh(&alloc);
+			if (!lmesh) continue;
+			if (dtStatusFailed(dtBuildTileCachePolyMesh(&alloc, *lcset, *lmesh))) continue;
+			if (lmesh->npolys == 0) continue;
+
+			for (int i = 0; i < lmesh->npolys; ++i)
+			{
+				lmesh->flags[i] = lmesh->areas[i] == DT_TILECACHE_WALKABLE_AREA ? 1 : 0;
+			}
+
+			dtNavMeshCreateParams params = {};
+			params.verts = lmesh->verts;
+			params.vertCount = lmesh->nverts;
+			params.polys = lmesh->polys;
+			params.polyAreas = lmesh->areas;
+			params.polyFlags = lmesh->flags;
+			params.polyCount = lmesh->npolys;
+			params.nvp = lmesh->nvp;
+			params.walkableHeight = cfg.walkableHeight * cfg.ch;
+			params.walkableRadius = cfg.walkableRadius * cfg.cs;
+			params.walkableClimb = cfg.walkableClimb * cfg.ch;
+			params.tileX = rebuild.x;
+			params.tileY = rebuild.z;
+			params.tileLayer = header.tlayer;
+			rcVcopy(params.bmin, header.bmin);
+			rcVcopy(params.bmax, header.bmax);
+			params.cs = cfg.cs;
+			params.ch = cfg.ch;
+			params.buildBvTree = false;
+
+			TileData& nav_tile = rebuild.nav_tiles.emplace();
+			if (!dtCreateNavMeshData(&params, &nav_tile.data, &nav_tile.size)) rebuild.nav_tiles.pop();
+		}
+	}
+
+
+	bool isRebuildingTile(int tile_index) const
+	{
+		for (const ObstacleTileRebuild* rebuild : m_obstacle_rebuilds)
+		{
+			if (rebuild->x + rebuild->z * m_num_tiles_x == tile_index) return true;
+		}
+		return false;
+	}
+
+
+	void replaceTiles(ObstacleTileRebuild& rebuild)
+	{
+		removeTiles(rebuild.x, rebuild.z);
+		for (TileData& nav_tile : rebuild.nav_tiles)
+		{
+			if (dtStatusFailed(m_navmesh->addTile(nav_tile.data, nav_tile.size, DT_TILE_FREE_DATA, 0, nullptr)))
+			{
+				g_log_error.log("Navigation") << "Could not add Detour tile.";
+				continue;
+			}
+			nav_tile.data = nullptr;
 		}
-		return true;
+	}
+
+
+	// tiles touched by changed obstacles are rebuilt by jobs, work on the main thread is time boxed
+	void updateObstacles()
+	{
+		if (m_is_generating || !m_navmesh) return;
+		if (m_obstacle_rebuilds.empty() && m_dirty_obstacle_tiles.empty()) return;
+
+		PROFILE_FUNCTION();
+		m_obstacle_timer->tick();
+		for (int i = m_obstacle_rebuilds.size() - 1; i >= 0; --i)
+		{
+			ObstacleTileRebuild* rebuild = m_obstacle_rebuilds[i];
+			if (!rebuild->is_done) continue;
+
+			MT::memoryBarrier();
+			replaceTiles(*rebuild);
+			LUMIX_DELETE(m_allocator, rebuild);
+			m_obstacle_rebuilds.eraseFast(i);
+			if (m_obstacle_timer->getTimeSinceTick() > OBSTACLE_UPDATE_BUDGET) return;
+		}
+
+		MTJD::Manager& manager = m_system.m_engine.getMTJDManager();
+		int max_in_flight = Math::maximum(1, (int)manager.getCpuThreadsCount());
+		for (int i = 0; i < m_dirty_obstacle_tiles.size() && m_obstacle_rebuilds.size() < max_in_flight;)
+		{
+			if (m_obstacle_timer->getTimeSinceTick() > OBSTACLE_UPDATE_BUDGET) break;
+
+			// wait for the previous rebuild, results must not be applied out of order
+			int tile_index = m_dirty_obstacle_tiles[i];
+			if (isRebuildingTile(tile_index))
+			{
+				++i;
+				continue;
+			}
+			m_dirty_obstacle_tiles.erase(i);
+
+			TileLayers* layers = m_tile_layers[tile_index];
+			if (!layers || layers->layers.empty()) continue;
+
+			ObstacleTileRebuild* rebuild = LUMIX_NEW(m_allocator, ObstacleTileRebuild)(m_allocator);
+			rebuild->x = tile_index % m_num_tiles_x;
+			rebuild->z = tile_index / m_num_tiles_x;
+			rebuild->config = m_config;
+			for (const TileData& layer : layers->layers)
+			{
+				TileData& copy = rebuild->layers.emplace();
+				copy.data = (u8*)dtAlloc(layer.size, DT_ALLOC_TEMP);
+				copy.size = layer.size;
+				copyMemory(copy.data, layer.data, layer.size);
+			}
+			for (const Obstacle& obstacle : m_obstacles)
+			{
+				if (isObstacleInTile(obstacle, rebuild->x, rebuild->z)) rebuild->obstacles.push(obstacle);
+			}
+			m_obstacle_rebuilds.push(rebuild);
+
+			MTJD::Job* job = MTJD::makeJob(manager,
+				[this, rebuild]() {
+					PROFILE_BLOCK("Navmesh obstacle tile");
+					rebuildObstacleTile(*rebuild, m_allocator);
+					MT::memoryBarrier();
+					rebuild->is_done = true;
+				},
+				m_allocator);
+			job->addDependency(&m_obstacles_sync_point);
+			manager.schedule(job);
+		}
+	}
+
+
+	void stopObstacleJobs()
+	{
+		if (m_obstacle_rebuilds.empty()) return;
+
+		m_obstacles_sync_point.sync();
+		for (ObstacleTileRebuild* rebuild : m_obstacle_rebuilds)
+		{
+			LUMIX_DELETE(m_allocator, rebuild);
+		}
+		m_obstacle_rebuilds.clear();
 	}
 
 
@@ -1389,6 +2752,7 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	{
 		ASSERT(m_crowd);
 
+		waitForCrowd();
 		Vec3 pos = m_universe.getPosition(agent.entity);
 		dtCrowdAgentParams params = {};
 		params.radius = agent.radius;
@@ -1434,7 +2798,16 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 			Entity entity = { component.index };
 			auto iter = m_agents.find(entity);
 			const Agent& agent = iter.value();
-			if (m_crowd && agent.agent >= 0) m_crowd->removeAgent(agent.agent);
+			if (m_crowd && agent.agent >= 0)
+			{
+				waitForCrowd();
+				m_crowd->removeAgent(agent.agent);
+			}
+			if (agent.is_move_pending)
+			{
+				m_move_requests.eraseItems([entity](const MoveRequest& request) { return request.entity == entity; });
+			}
+			if (agent.is_teleport_pending) m_teleports.eraseItemFast(entity);
 			m_agents.erase(iter);
 			m_universe.destroyComponent(entity, type, this, component);
 		}
@@ -1595,10 +2968,8 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	IAllocator& m_allocator;
 	Universe& m_universe;
 	NavigationSystem& m_system;
-	rcPolyMesh* m_polymesh;
 	dtNavMesh* m_navmesh;
 	dtNavMeshQuery* m_navquery;
-	rcPolyMeshDetail* m_detail_mesh;
 	HashMap<Entity, Agent> m_agents;
 	rcCompactHeightfield* m_debug_compact_heightfield;
 	rcHeightfield* m_debug_heightfield;
@@ -1611,6 +2982,39 @@ struct NavigationSceneImpl LUMIX_FINAL : public NavigationScene
 	LuaScriptScene* m_script_scene;
 	dtCrowd* m_crowd;
 	DelegateList<void(float)> m_on_update;
+	Array<NavmeshTile*> m_tiles_in_flight;
+	MTJD::Group m_tiles_sync_point;
+	int m_next_tile;
+	int m_finished_tiles;
+	bool m_is_generating;
+	volatile bool m_is_generation_cancelled;
+	bool m_generation_failed;
+	Array<int> m_tile_bins;
+	Array<ComponentHandle> m_binned_instances;
+	bool m_are_bins_dirty;
+	HashMap<Model*, ModelTriangles*> m_model_triangles;
+	Array<TileLayers*> m_tile_layers;
+	HashMap<int, Obstacle> m_obstacles;
+	int m_next_obstacle_id;
+	Array<int> m_dirty_obstacle_tiles;
+	Array<ObstacleTileRebuild*> m_obstacle_rebuilds;
+	MTJD::Group m_obstacles_sync_point;
+	Timer* m_obstacle_timer;
+	MTJD::Group m_crowd_sync_point;
+	bool m_is_crowd_updating;
+	bool m_is_crowd_step_ready;
+	Array<MoveRequest> m_move_requests;
+	Array<Entity> m_teleports;
+	bool m_is_moving_agents;
+	FS::MappedFile m_navmesh_file;
+	char m_navmesh_path[MAX_PATH_LENGTH];
+	Array<dtTileRef> m_mapped_tile_refs;
+	bool m_is_streaming_dirty;
+	bool m_is_streaming_area_set;
+	int m_streaming_from_x;
+	int m_streaming_from_z;
+	int m_streaming_to_x;
+	int m_streaming_to_z;
 };
 
 
@@ -1676,6 +3080,10 @@ static void registerLuaAPI(lua_State* L)
 	REGISTER_FUNCTION(load);
 	REGISTER_FUNCTION(setGeneratorParams);
 	REGISTER_FUNCTION(getAgentSpeed);
+	REGISTER_FUNCTION(addCylinderObstacle);
+	REGISTER_FUNCTION(addBoxObstacle);
+	REGISTER_FUNCTION(removeObstacle);
+	REGISTER_FUNCTION(setNavmeshStreamingArea);
 
 	#undef REGISTER_FUNCTION
 }
@@ -23,8 +23,19 @@ public:
 	virtual float getAgentYawDiff(Entity entity) = 0;
 	virtual void setAgentRootMotion(Entity, const Vec3& root_motion) = 0;
 	virtual bool generateNavmesh() = 0;
+	// tiles are built on worker threads and added in update
+	virtual bool generateNavmeshAsync() = 0;
+	virtual bool isGeneratingNavmesh() const = 0;
+	virtual float getNavmeshGenerationProgress() const = 0;
+	virtual void cancelNavmeshGeneration() = 0;
 	virtual bool generateTile(int x, int z, bool keep_data) = 0;
 	virtual bool generateTileAt(const Vec3& pos, bool keep_data) = 0;
+	// obstacles rebuild the tiles they touch over the next frames, navmeshes loaded from a file ignore them
+	virtual int addCylinderObstacle(const Vec3& pos, float radius, float height) = 0;
+	virtual int addBoxObstacle(const Vec3& min, const Vec3& max) = 0;
+	virtual void removeObstacle(int obstacle) = 0;
+	// only tiles in the area are kept in a navmesh mapped from a file, radius <= 0 keeps all of them
+	virtual void setNavmeshStreamingArea(const Vec3& center, float radius) = 0;
 	virtual bool load(const char* path) = 0;
 	virtual bool save(const char* path) = 0;
 	virtual void debugDrawNavmesh(const Vec3& pos, bool inner_boundaries, bool outer_boundaries, bool portals) = 0;
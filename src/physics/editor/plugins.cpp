@@ -680,6 +680,20 @@ struct StudioAppPlugin LUMIX_FINAL : public StudioApp::IPlugin
 	}
 
 
+	void onSimulationGUI()
+	{
+		if (!ImGui::CollapsingHeader("Simulation")) return;
+
+		auto* scene = static_cast<PhysicsScene*>(m_editor.getUniverse()->getScene(crc32("physics")));
+		bool is_fixed = scene->getFixedTimeStep() > 0;
+		if (ImGui::Checkbox("Fixed time step", &is_fixed)) scene->setFixedTimeStep(is_fixed ? 1 / 60.0f : 0);
+		if (!is_fixed) return;
+
+		float hz = 1 / scene->getFixedTimeStep();
+		if (ImGui::DragFloat("Steps per second", &hz, 1, 10, 240)) scene->setFixedTimeStep(1 / Math::maximum(hz, 1.0f));
+	}
+
+
 	void onDebugGUI()
 	{
 		if (!ImGui::CollapsingHeader("Debug")) return;
@@ -993,6 +1007,7 @@ struct StudioAppPlugin LUMIX_FINAL : public StudioApp::IPlugin
 		{
 			onLayersGUI();
 			onCollisionMatrixGUI();
+			onSimulationGUI();
 			onRagdollGUI();
 			onDebugGUI();
 		}
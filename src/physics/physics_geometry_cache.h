@@ -0,0 +1,84 @@
+#pragma once
+
+
+#include "engine/lumix.h"
+
+
+namespace Lumix
+{
+
+
+// header of a cooked geometry in the cache, followed by data_size bytes of cooked data
+struct PhysicsGeometryCacheHeader
+{
+	static const u32 MAGIC = 0x43585043; // 'CPXC'
+	static const u32 VERSION = 1;
+
+	u32 magic;
+	u32 version;
+	u32 physx_version;
+	u32 is_convex;
+	u64 hash;
+	u32 vertex_count;
+	u32 index_count;
+	u32 data_size;
+	u32 reserved;
+};
+
+
+// FNV-1a, 64 bits
+inline u64 continuePhysicsGeometryHash(u64 hash, const void* data, int size)
+{
+	const u8* bytes = (const u8*)data;
+	for (int i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+
+// describes the source geometry, data_size is filled when the cooked data is known
+inline PhysicsGeometryCacheHeader makePhysicsGeometryCacheHeader(const void* verts,
+	int vertex_count,
+	int vertex_size,
+	const u32* indices,
+	int index_count,
+	bool is_convex,
+	u32 physx_version)
+{
+	PhysicsGeometryCacheHeader header;
+	header.magic = PhysicsGeometryCacheHeader::MAGIC;
+	header.version = PhysicsGeometryCacheHeader::VERSION;
+	header.physx_version = physx_version;
+	header.is_convex = is_convex ? 1 : 0;
+	header.vertex_count = (u32)vertex_count;
+	header.index_count = (u32)index_count;
+	header.data_size = 0;
+	header.reserved = 0;
+
+	u64 hash = 0xcbf29ce484222325ULL;
+	hash = continuePhysicsGeometryHash(hash, verts, vertex_count * vertex_size);
+	hash = continuePhysicsGeometryHash(hash, indices, index_count * (int)sizeof(indices[0]));
+	hash = continuePhysicsGeometryHash(hash, &header.is_convex, sizeof(header.is_convex));
+	hash = continuePhysicsGeometryHash(hash, &physx_version, sizeof(physx_version));
+	header.hash = hash;
+	return header;
+}
+
+
+// true if the cached file with the header and file_size bytes holds the geometry described by expected
+inline bool isPhysicsGeometryCacheValid(const PhysicsGeometryCacheHeader& header,
+	const PhysicsGeometryCacheHeader& expected,
+	size_t file_size)
+{
+	return header.magic == PhysicsGeometryCacheHeader::MAGIC && header.version == PhysicsGeometryCacheHeader::VERSION &&
+		   header.physx_version == expected.physx_version && header.is_convex == expected.is_convex &&
+		   header.hash == expected.hash && header.vertex_count == expected.vertex_count &&
+		   header.index_count == expected.index_count && header.data_size > 0 &&
+		   file_size == sizeof(header) + header.data_size;
+}
+
+
+} // namespace Lumix
@@ -1,9 +1,16 @@
 #include "physics_geometry_manager.h"
 #include "engine/fs/file_system.h"
+#include "engine/fs/os_file.h"
 #include "engine/log.h"
+#include "engine/mt/atomic.h"
+#include "engine/mt/thread.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/manager.h"
+#include "engine/profiler.h"
 #include "engine/resource_manager.h"
 #include "engine/string.h"
 #include "engine/vec.h"
+#include "physics/physics_geometry_cache.h"
 #include "physics/physics_system.h"
 #include <PxPhysicsAPI.h>
 
@@ -84,6 +91,188 @@ struct InputStream LUMIX_FINAL : public physx::PxInputStream
 };
 
 
+struct PhysicsGeometryManager::CookRequest
+{
+	explicit CookRequest(IAllocator& allocator)
+		: verts(allocator)
+		, indices(allocator)
+		, cooked(allocator)
+		, geometry(nullptr)
+		, is_success(false)
+		, is_done(false)
+	{
+	}
+
+	PhysicsGeometry* geometry;
+	PhysicsGeometryCacheHeader cache_header;
+	bool is_convex;
+	Array<Vec3> verts;
+	Array<u32> indices;
+	OutputStream cooked;
+	bool is_success;
+	volatile bool is_done;
+};
+
+
+static bool cookMesh(physx::PxCooking& cooking, PhysicsGeometryManager::CookRequest& request)
+{
+	if (request.is_convex)
+	{
+		physx::PxConvexMeshDesc meshDesc;
+		meshDesc.points.count = request.verts.size();
+		meshDesc.points.stride = sizeof(Vec3);
+		meshDesc.points.data = request.verts.begin();
+		meshDesc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+		return cooking.cookConvexMesh(meshDesc, request.cooked);
+	}
+
+	physx::PxTriangleMeshDesc meshDesc;
+	meshDesc.points.count = request.verts.size();
+	meshDesc.points.stride = sizeof(physx::PxVec3);
+	meshDesc.points.data = request.verts.begin();
+
+	meshDesc.triangles.count = request.indices.size() / 3;
+	meshDesc.triangles.stride = 3 * sizeof(physx::PxU32);
+	meshDesc.triangles.data = request.indices.begin();
+	return cooking.cookTriangleMesh(meshDesc, request.cooked);
+}
+
+
+PhysicsGeometryManager::PhysicsGeometryManager(PhysicsSystem& system, MTJD::Manager& mtjd, IAllocator& allocator)
+	: ResourceManagerBase(allocator)
+	, m_allocator(allocator)
+	, m_system(system)
+	, m_mtjd(mtjd)
+	, m_cook_requests(allocator)
+{
+}
+
+
+PhysicsGeometryManager::~PhysicsGeometryManager()
+{
+	finishCooking();
+}
+
+
+void PhysicsGeometryManager::finishCooking()
+{
+	while (!m_cook_requests.empty())
+	{
+		update();
+		if (!m_cook_requests.empty()) MT::sleep(1);
+	}
+}
+
+
+void PhysicsGeometryManager::setCacheDir(const char* path)
+{
+	m_cache_dir = path;
+	if (!m_cache_dir.empty() && !FS::OsFile::makeDirectory(path))
+	{
+		g_log_warning.log("Physics") << "Could not create " << path << ", cooked geometry will not be cached";
+		m_cache_dir = "";
+	}
+}
+
+
+void PhysicsGeometryManager::getCachePath(u64 hash, char* out, int max_size) const
+{
+	copyString(out, max_size, StaticString<MAX_PATH_LENGTH>(m_cache_dir, "/", hash, ".pxc"));
+}
+
+
+bool PhysicsGeometryManager::loadCached(PhysicsGeometry& geometry, const PhysicsGeometryCacheHeader& key)
+{
+	if (m_cache_dir.empty()) return false;
+
+	PROFILE_FUNCTION();
+	char path[MAX_PATH_LENGTH];
+	getCachePath(key.hash, path, lengthOf(path));
+	FS::OsFile file;
+	if (!file.open(path, FS::Mode::OPEN_AND_READ, m_allocator)) return false;
+
+	PhysicsGeometryCacheHeader header;
+	Array<u8> data(m_allocator);
+	bool is_valid = file.size() > sizeof(header) && file.read(&header, sizeof(header)) &&
+					isPhysicsGeometryCacheValid(header, key, file.size());
+	if (is_valid)
+	{
+		data.resize(header.data_size);
+		is_valid = file.read(&data[0], data.size());
+	}
+	file.close();
+
+	return is_valid && geometry.createMesh(key.is_convex != 0, &data[0], data.size());
+}
+
+
+PhysicsGeometryManager::CookRequest* PhysicsGeometryManager::cook(PhysicsGeometry& geometry,
+	const PhysicsGeometryCacheHeader& key,
+	Array<Vec3>& verts,
+	Array<u32>& indices)
+{
+	CookRequest* request = LUMIX_NEW(m_allocator, CookRequest)(m_allocator);
+	request->geometry = &geometry;
+	request->cache_header = key;
+	request->is_convex = key.is_convex != 0;
+	request->verts.swap(verts);
+	request->indices.swap(indices);
+	m_cook_requests.push(request);
+
+	char cache_path[MAX_PATH_LENGTH];
+	cache_path[0] = '\0';
+	if (!m_cache_dir.empty()) getCachePath(key.hash, cache_path, lengthOf(cache_path));
+	physx::PxCooking* cooking = m_system.getCooking();
+	IAllocator& allocator = m_allocator;
+	MTJD::Job* job = MTJD::makeJob(m_mtjd,
+		[request, cooking, cache_path, &allocator]() {
+			PROFILE_BLOCK("Cook physics geometry");
+			request->is_success = cookMesh(*cooking, *request);
+			FS::OsFile file;
+			if (request->is_success && cache_path[0] && file.open(cache_path, FS::Mode::CREATE_AND_WRITE, allocator))
+			{
+				PhysicsGeometryCacheHeader header = request->cache_header;
+				header.data_size = (u32)request->cooked.size;
+				file.write(&header, sizeof(header));
+				file.write(request->cooked.data, request->cooked.size);
+				file.close();
+			}
+			MT::memoryBarrier();
+			request->is_done = true;
+		},
+		m_allocator);
+	m_mtjd.schedule(job);
+	return request;
+}
+
+
+void PhysicsGeometryManager::update()
+{
+	for (int i = m_cook_requests.size() - 1; i >= 0; --i)
+	{
+		CookRequest* request = m_cook_requests[i];
+		if (!request->is_done) continue;
+
+		MT::memoryBarrier();
+		if (request->geometry)
+		{
+			PhysicsGeometry* geometry = request->geometry;
+			geometry->m_cook_request = nullptr;
+			if (request->is_success)
+			{
+				geometry->onCooked(request->is_convex, request->cooked.data, request->cooked.size);
+			}
+			else
+			{
+				geometry->onCooked(request->is_convex, nullptr, 0);
+			}
+		}
+		LUMIX_DELETE(m_allocator, request);
+		m_cook_requests.eraseFast(i);
+	}
+}
+
+
 Resource* PhysicsGeometryManager::createResource(const Path& path)
 {
 	return LUMIX_NEW(m_allocator, PhysicsGeometry)(path, *this, m_allocator);
@@ -100,11 +289,13 @@ PhysicsGeometry::PhysicsGeometry(const Path& path, ResourceManagerBase& resource
 	: Resource(path, resource_manager, allocator)
 	, convex_mesh(nullptr)
 	, tri_mesh(nullptr)
+	, m_cook_request(nullptr)
 {
 }
 
 PhysicsGeometry::~PhysicsGeometry()
 {
+	if (m_cook_request) m_cook_request->geometry = nullptr;
 }
 
 
@@ -124,66 +315,59 @@ bool PhysicsGeometry::load(FS::IFile& file)
 		return false;
 	}
 
-	PhysicsSystem& system = static_cast<PhysicsGeometryManager&>(m_resource_manager).getSystem();
+	auto& manager = static_cast<PhysicsGeometryManager&>(m_resource_manager);
 
 	i32 num_verts;
 	Array<Vec3> verts(getAllocator());
 	file.read(&num_verts, sizeof(num_verts));
 	verts.resize(num_verts);
-	file.read(&verts[0], sizeof(verts[0]) * verts.size());
+	file.read(verts.begin(), sizeof(verts[0]) * verts.size());
 
 	bool is_convex = header.m_convex != 0;
-	if (is_convex)
-	{
-		physx::PxConvexMeshDesc meshDesc;
-		meshDesc.points.count = verts.size();
-		meshDesc.points.stride = sizeof(Vec3);
-		meshDesc.points.data = &verts[0];
-		meshDesc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
-
-		OutputStream writeBuffer(getAllocator());
-		bool status = system.getCooking()->cookConvexMesh(meshDesc, writeBuffer);
-		if (!status)
-		{
-			convex_mesh = nullptr;
-			return false;
-		}
-
-		InputStream readBuffer(writeBuffer.data, writeBuffer.size);
-		convex_mesh = system.getPhysics()->createConvexMesh(readBuffer);
-		tri_mesh = nullptr;
-	}
-	else
+	Array<u32> tris(getAllocator());
+	if (!is_convex)
 	{
 		u32 num_indices;
-		Array<u32> tris(getAllocator());
 		file.read(&num_indices, sizeof(num_indices));
 		tris.resize(num_indices);
-		file.read(&tris[0], sizeof(tris[0]) * tris.size());
+		file.read(tris.begin(), sizeof(tris[0]) * tris.size());
+	}
+	PhysicsGeometryCacheHeader key = makePhysicsGeometryCacheHeader(
+		verts.begin(), verts.size(), sizeof(verts[0]), tris.begin(), tris.size(), is_convex, PX_PHYSICS_VERSION);
 
-		physx::PxTriangleMeshDesc meshDesc;
-		meshDesc.points.count = num_verts;
-		meshDesc.points.stride = sizeof(physx::PxVec3);
-		meshDesc.points.data = &verts[0];
+	m_size = file.size();
+	if (manager.loadCached(*this, key)) return true;
 
-		meshDesc.triangles.count = num_indices / 3;
-		meshDesc.triangles.stride = 3 * sizeof(physx::PxU32);
-		meshDesc.triangles.data = &tris[0];
+	// stays empty until the cooking job finishes
+	++m_empty_dep_count;
+	m_cook_request = manager.cook(*this, key, verts, tris);
+	return true;
+}
 
-		OutputStream writeBuffer(getAllocator());
-		if (!system.getCooking()->cookTriangleMesh(meshDesc, writeBuffer))
-		{
-			tri_mesh = nullptr;
-			return false;
-		}
 
-		InputStream readBuffer(writeBuffer.data, writeBuffer.size);
-		tri_mesh = system.getPhysics()->createTriangleMesh(readBuffer);
-		convex_mesh = nullptr;
+bool PhysicsGeometry::createMesh(bool is_convex, const u8* data, int size)
+{
+	PhysicsSystem& system = static_cast<PhysicsGeometryManager&>(m_resource_manager).getSystem();
+	InputStream stream((unsigned char*)data, size);
+	if (is_convex)
+	{
+		convex_mesh = system.getPhysics()->createConvexMesh(stream);
+		return convex_mesh != nullptr;
 	}
+	tri_mesh = system.getPhysics()->createTriangleMesh(stream);
+	return tri_mesh != nullptr;
+}
 
-	m_size = file.size();
-	return true;
+
+void PhysicsGeometry::onCooked(bool is_convex, const u8* data, int size)
+{
+	if (!data || !createMesh(is_convex, data, size))
+	{
+		g_log_error.log("Physics") << "Could not cook " << getPath().c_str();
+		++m_failed_dep_count;
+	}
+	--m_empty_dep_count;
+	checkState();
 }
 
 
@@ -195,6 +379,12 @@ IAllocator& PhysicsGeometry::getAllocator()
 
 void PhysicsGeometry::unload()
 {
+	if (m_cook_request)
+	{
+		m_cook_request->geometry = nullptr;
+		m_cook_request = nullptr;
+	}
+
 	if (convex_mesh) convex_mesh->release();
 	if (tri_mesh) tri_mesh->release();
 	convex_mesh = nullptr;
@@ -2,8 +2,10 @@
 
 
 #include "engine/lumix.h"
+#include "engine/array.h"
 #include "engine/resource.h"
 #include "engine/resource_manager_base.h"
+#include "engine/string.h"
 
 
 namespace physx
@@ -17,28 +19,53 @@ namespace Lumix
 {
 
 
+class PhysicsGeometry;
 class PhysicsSystem;
+struct PhysicsGeometryCacheHeader;
+struct Vec3;
+namespace MTJD
+{
+class Manager;
+}
 
 
+// Cooked PhysX meshes are cached in files named by the 64-bit hash of the source geometry,
+// meshes missing in the cache are cooked on worker threads.
 class PhysicsGeometryManager LUMIX_FINAL : public ResourceManagerBase
 {
 	public:
-		PhysicsGeometryManager(PhysicsSystem& system, IAllocator& allocator)
-			: ResourceManagerBase(allocator)
-			, m_allocator(allocator)
-			, m_system(system)
-		{}
-		~PhysicsGeometryManager() {}
+		struct CookRequest;
+
+	public:
+		PhysicsGeometryManager(PhysicsSystem& system, MTJD::Manager& mtjd, IAllocator& allocator);
+		~PhysicsGeometryManager();
 		IAllocator& getAllocator() { return m_allocator; }
 		PhysicsSystem& getSystem() { return m_system; }
 
+		// empty path disables the cache
+		void setCacheDir(const char* path);
+		// finishes loading of cooked geometries
+		void update();
+		void finishCooking();
+		bool loadCached(PhysicsGeometry& geometry, const PhysicsGeometryCacheHeader& key);
+		CookRequest* cook(PhysicsGeometry& geometry,
+			const PhysicsGeometryCacheHeader& key,
+			Array<Vec3>& verts,
+			Array<u32>& indices);
+
 	protected:
 		Resource* createResource(const Path& path) override;
 		void destroyResource(Resource& resource) override;
 
+	private:
+		void getCachePath(u64 hash, char* out, int max_size) const;
+
 	private:
 		IAllocator& m_allocator;
 		PhysicsSystem& m_system;
+		MTJD::Manager& m_mtjd;
+		StaticString<MAX_PATH_LENGTH> m_cache_dir;
+		Array<CookRequest*> m_cook_requests;
 };
 
 
@@ -69,11 +96,17 @@ class PhysicsGeometry LUMIX_FINAL : public Resource
 		physx::PxConvexMesh* convex_mesh;
 
 	private:
+		friend class PhysicsGeometryManager;
+
 		IAllocator& getAllocator();
+		bool createMesh(bool is_convex, const u8* data, int size);
+		void onCooked(bool is_convex, const u8* data, int size);
 
 		void unload(void) override;
 		bool load(FS::IFile& file) override;
 
+	private:
+		PhysicsGeometryManager::CookRequest* m_cook_request;
 };
 
 
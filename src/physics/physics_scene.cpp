@@ -7,10 +7,14 @@
 #include "engine/log.h"
 #include "engine/lua_wrapper.h"
 #include "engine/matrix.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/group.h"
+#include "engine/mtjd/manager.h"
 #include "engine/path.h"
 #include "engine/profiler.h"
 #include "engine/property_register.h"
 #include "engine/resource_manager.h"
+#include "engine/simd.h"
 #include "engine/resource_manager_base.h"
 #include "engine/serializer.h"
 #include "engine/universe/universe.h"
@@ -46,12 +50,15 @@ static const ComponentType D6_JOINT_TYPE = PropertyRegister::getComponentType("d
 static const ResourceType TEXTURE_TYPE("texture");
 static const ResourceType PHYSICS_TYPE("physics");
 static const u32 RENDERER_HASH = crc32("renderer");
+static const int MAX_SUBSTEPS = 4;
+static const int QUERY_BATCH_SIZE = 64;
 
 
 enum class PhysicsSceneVersion
 {
 	DYNAMIC_TYPE,
 	TRIGGERS,
+	FIXED_TIME_STEP,
 
 	LATEST,
 };
@@ -187,9 +194,79 @@ struct Heightfield
 	float m_xz_scale;
 	float m_y_scale;
 	int m_layer;
+	// copy of the heightfield's samples, edits are converted here and sent to PhysX once per frame
+	PxHeightFieldSample* m_samples;
+	int m_rows;
+	int m_columns;
+	int m_dirty_from_x;
+	int m_dirty_from_y;
+	int m_dirty_to_x;
+	int m_dirty_to_y;
 };
 
 
+static const u32 HEIGHTFIELD_TESS_FLAG = 0x80 << 16;
+
+
+static LUMIX_FORCE_INLINE int4 loadHeights(const u8* src, int bytes_per_pixel)
+{
+	if (bytes_per_pixel == 2) return i4LoadU16(src);
+	if (bytes_per_pixel == 1) return i4LoadU8(src);
+	return i4And(i4LoadUnaligned(src), i4Splat(0xff));
+}
+
+
+// dst[x * dst_stride + y] = height of src pixel (x, y), PhysX rows go along the texture's x axis
+static void convertHeights(const u8* LUMIX_RESTRICT src,
+	int bytes_per_pixel,
+	int src_stride,
+	int width,
+	int height,
+	PxHeightFieldSample* LUMIX_RESTRICT dst,
+	int dst_stride)
+{
+	static_assert(sizeof(PxHeightFieldSample) == sizeof(u32), "Unexpected size of PxHeightFieldSample");
+	const i32 bias = bytes_per_pixel == 2 ? -0x7fff : -0x7f;
+	const int src_row_size = src_stride * bytes_per_pixel;
+	bool can_use_simd = bytes_per_pixel == 1 || bytes_per_pixel == 2 || bytes_per_pixel == 4;
+	int simd_width = can_use_simd ? width & ~3 : 0;
+	int simd_height = can_use_simd ? height & ~3 : 0;
+
+	int4 bias4 = i4Splat(bias);
+	int4 mask4 = i4Splat(0xffff);
+	int4 flag4 = i4Splat(HEIGHTFIELD_TESS_FLAG);
+	for (int y = 0; y < simd_height; y += 4)
+	{
+		const u8* row = src + y * src_row_size;
+		for (int x = 0; x < simd_width; x += 4)
+		{
+			const u8* pixel = row + x * bytes_per_pixel;
+			int4 a = loadHeights(pixel, bytes_per_pixel);
+			int4 b = loadHeights(pixel + src_row_size, bytes_per_pixel);
+			int4 c = loadHeights(pixel + src_row_size * 2, bytes_per_pixel);
+			int4 d = loadHeights(pixel + src_row_size * 3, bytes_per_pixel);
+			i4Transpose(a, b, c, d);
+			PxHeightFieldSample* out = dst + x * dst_stride + y;
+			i4StoreUnaligned(out, i4Or(i4And(i4Add(a, bias4), mask4), flag4));
+			i4StoreUnaligned(out + dst_stride, i4Or(i4And(i4Add(b, bias4), mask4), flag4));
+			i4StoreUnaligned(out + dst_stride * 2, i4Or(i4And(i4Add(c, bias4), mask4), flag4));
+			i4StoreUnaligned(out + dst_stride * 3, i4Or(i4And(i4Add(d, bias4), mask4), flag4));
+		}
+	}
+
+	for (int y = 0; y < height; ++y)
+	{
+		const u8* row = src + y * src_row_size;
+		for (int x = y < simd_height ? simd_width : 0; x < width; ++x)
+		{
+			const u8* pixel = row + x * bytes_per_pixel;
+			i32 value = bytes_per_pixel == 2 ? *(const u16*)pixel : *pixel;
+			*(u32*)&dst[x * dst_stride + y] = ((u32)(value + bias) & 0xffff) | HEIGHTFIELD_TESS_FLAG;
+		}
+	}
+}
+
+
 struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 {
 	struct ContactCallback LUMIX_FINAL : public PxSimulationEventCallback
@@ -257,6 +334,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 			, type(_type)
 			, dynamic_type(DynamicType::STATIC)
 			, is_trigger(false)
+			, active_step(0)
 		{
 		}
 
@@ -278,6 +356,9 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		ActorType type;
 		DynamicType dynamic_type;
 		bool is_trigger;
+		Transform pose;
+		Transform prev_pose;
+		u32 active_step;
 
 	private:
 		void onStateChanged(Resource::State old_state, Resource::State new_state, Resource&);
@@ -290,7 +371,19 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		, m_actors(m_allocator)
 		, m_ragdolls(m_allocator)
 		, m_terrains(m_allocator)
-		, m_dynamic_actors(m_allocator)
+		, m_active_actors(m_allocator)
+		, m_last_active_actors(m_allocator)
+		, m_settled_actors(m_allocator)
+		, m_moved_entities(m_allocator)
+		, m_moved_transforms(m_allocator)
+		, m_step_index(0)
+		, m_query_sync_point(true, allocator)
+		, m_lua_raycasts(allocator)
+		, m_lua_hits(allocator)
+		, m_lua_sweeps(allocator)
+		, m_lua_overlaps(allocator)
+		, m_lua_overlap_results(allocator)
+		, m_heightfield_scratch(allocator)
 		, m_universe(context)
 		, m_is_game_running(false)
 		, m_contact_callback(*this)
@@ -300,6 +393,11 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		, m_script_scene(nullptr)
 		, m_debug_visualization_flags(0)
 		, m_is_updating_ragdoll(false)
+		, m_is_updating_actors(false)
+		, m_is_querying(false)
+		, m_is_simulating(false)
+		, m_fixed_time_step(0)
+		, m_time_accumulator(0)
 	{
 		setMemory(m_layers_names, 0, sizeof(m_layers_names));
 		for (int i = 0; i < lengthOf(m_layers_names); ++i)
@@ -337,6 +435,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 	~PhysicsSceneImpl()
 	{
+		waitForSimulation();
 		m_controller_manager->release();
 		m_default_material->release();
 		m_dummy_actor->release();
@@ -352,6 +451,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 	void clear() override
 	{
+		waitForSimulation();
 		for (auto& controller : m_controllers)
 		{
 			controller.m_controller->release();
@@ -375,7 +475,9 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 			LUMIX_DELETE(m_allocator, actor);
 		}
 		m_actors.clear();
-		m_dynamic_actors.clear();
+		m_active_actors.clear();
+		m_last_active_actors.clear();
+		m_settled_actors.clear();
 
 		m_terrains.clear();
 	}
@@ -392,7 +494,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 			for (int i = 0, c = m_script_scene->getScriptCount(cmp); i < c; ++i)
 			{
-				auto* call = m_script_scene->beginFunctionCall(cmp, i, "onTrigger");
+				auto* call = m_script_scene->beginFunctionCall(cmp, i, LuaScriptScene::Callback::ON_TRIGGER);
 				if (!call) continue;
 
 				call->add(e2.index);
@@ -417,7 +519,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 			for (int i = 0, c = m_script_scene->getScriptCount(cmp); i < c; ++i)
 			{
-				auto* call = m_script_scene->beginFunctionCall(cmp, i, "onContact");
+				auto* call = m_script_scene->beginFunctionCall(cmp, i, LuaScriptScene::Callback::ON_CONTACT);
 				if (!call) continue;
 
 				call->add(e2.index);
@@ -693,6 +795,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	}
 
 
+	// only converts the data, PhysX is updated in updateHeightfields
 	void updateHeighfieldData(ComponentHandle cmp,
 		int x,
 		int y,
@@ -703,57 +806,66 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	{
 		PROFILE_FUNCTION();
 		Heightfield& terrain = m_terrains[{cmp.index}];
-		
-		PxShape* shape;
-		terrain.m_actor->getShapes(&shape, 1);
-		PxHeightFieldGeometry geom;
-		shape->getHeightFieldGeometry(geom);
+		if (!terrain.m_samples) return;
+		ASSERT(x >= 0 && y >= 0 && x + width <= terrain.m_rows && y + height <= terrain.m_columns);
 
-		Array<PxHeightFieldSample> heights(m_allocator);
+		PxHeightFieldSample* dst = terrain.m_samples + x * terrain.m_columns + y;
+		convertHeights(src_data, bytes_per_pixel, width, width, height, dst, terrain.m_columns);
 
-		heights.resize(width * height);
-		if (bytes_per_pixel == 2)
+		if (terrain.m_dirty_to_x <= terrain.m_dirty_from_x)
 		{
-			const i16* LUMIX_RESTRICT data = (const i16*)src_data;
-			for (int j = 0; j < height; ++j)
-			{
-				for (int i = 0; i < width; ++i)
-				{
-					int idx = j + i * height;
-					int idx2 = i + j * width;
-					heights[idx].height = PxI16((i32)data[idx2] - 0x7fff);
-					heights[idx].materialIndex0 = heights[idx].materialIndex1 = 0;
-					heights[idx].setTessFlag();
-				}
-			}
+			terrain.m_dirty_from_x = x;
+			terrain.m_dirty_from_y = y;
+			terrain.m_dirty_to_x = x + width;
+			terrain.m_dirty_to_y = y + height;
+			return;
 		}
-		else
+		terrain.m_dirty_from_x = Math::minimum(terrain.m_dirty_from_x, x);
+		terrain.m_dirty_from_y = Math::minimum(terrain.m_dirty_from_y, y);
+		terrain.m_dirty_to_x = Math::maximum(terrain.m_dirty_to_x, x + width);
+		terrain.m_dirty_to_y = Math::maximum(terrain.m_dirty_to_y, y + height);
+	}
+
+
+	// sends all edits since the last call to PhysX in one modifySamples per heightfield
+	void updateHeightfields()
+	{
+		if (m_is_simulating) return;
+
+		for (auto& terrain : m_terrains)
 		{
-			ASSERT(bytes_per_pixel == 1);
-			const u8* LUMIX_RESTRICT data = src_data;
-			for (int j = 0; j < height; ++j)
+			if (terrain.m_dirty_to_x <= terrain.m_dirty_from_x) continue;
+			if (!terrain.m_actor) continue;
+
+			PROFILE_BLOCK("updateHeightfield");
+			int rows = terrain.m_dirty_to_x - terrain.m_dirty_from_x;
+			int columns = terrain.m_dirty_to_y - terrain.m_dirty_from_y;
+			m_heightfield_scratch.resize(rows * columns);
+			for (int i = 0; i < rows; ++i)
 			{
-				for (int i = 0; i < width; ++i)
-				{
-					int idx = j + i * height;
-					int idx2 = i + j * width;
-					heights[idx].height = PxI16((i32)data[idx2] - 0x7f);
-					heights[idx].materialIndex0 = heights[idx].materialIndex1 = 0;
-					heights[idx].setTessFlag();
-				}
+				copyMemory(&m_heightfield_scratch[i * columns],
+					terrain.m_samples + (terrain.m_dirty_from_x + i) * terrain.m_columns + terrain.m_dirty_from_y,
+					columns * sizeof(PxHeightFieldSample));
 			}
-		}
 
-		PxHeightFieldDesc hfDesc;
-		hfDesc.format = PxHeightFieldFormat::eS16_TM;
-		hfDesc.nbColumns = height;
-		hfDesc.nbRows = width;
-		hfDesc.samples.data = &heights[0];
-		hfDesc.samples.stride = sizeof(PxHeightFieldSample);
-		hfDesc.thickness = -1;
+			PxShape* shape;
+			terrain.m_actor->getShapes(&shape, 1);
+			PxHeightFieldGeometry geom;
+			shape->getHeightFieldGeometry(geom);
 
-		geom.heightField->modifySamples(y, x, hfDesc);
-		shape->setGeometry(geom);
+			PxHeightFieldDesc hfDesc;
+			hfDesc.format = PxHeightFieldFormat::eS16_TM;
+			hfDesc.nbColumns = columns;
+			hfDesc.nbRows = rows;
+			hfDesc.samples.data = &m_heightfield_scratch[0];
+			hfDesc.samples.stride = sizeof(PxHeightFieldSample);
+			hfDesc.thickness = -1;
+
+			geom.heightField->modifySamples(terrain.m_dirty_from_y, terrain.m_dirty_from_x, hfDesc);
+			shape->setGeometry(geom);
+			terrain.m_dirty_from_x = terrain.m_dirty_to_x = 0;
+			terrain.m_dirty_from_y = terrain.m_dirty_to_y = 0;
+		}
 	}
 
 
@@ -1162,6 +1274,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 	void destroyComponent(ComponentHandle cmp, ComponentType type) override
 	{
+		waitForSimulation();
 		if (type == HEIGHTFIELD_TYPE)
 		{
 			Entity entity = {cmp.index};
@@ -1183,7 +1296,9 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 			actor->setPhysxActor(nullptr);
 			LUMIX_DELETE(m_allocator, actor);
 			m_actors.erase(entity);
-			m_dynamic_actors.eraseItem(actor);
+			m_active_actors.eraseItemFast(actor);
+			m_last_active_actors.eraseItemFast(actor);
+			m_settled_actors.eraseItemFast(actor);
 			m_universe.destroyComponent(entity, type, this, cmp);
 		}
 		else if (type == RAGDOLL_TYPE)
@@ -1597,15 +1712,62 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	}
 
 
-	void updateDynamicActors()
+	// collects dynamic actors moved by the last step, sleeping actors are not reported by PhysX
+	void updateActiveActors()
+	{
+		PROFILE_FUNCTION();
+		++m_step_index;
+		m_last_active_actors.swap(m_active_actors);
+		m_active_actors.clear();
+
+		PxU32 count;
+		const PxActiveTransform* transforms = m_scene->getActiveTransforms(count);
+		for (PxU32 i = 0; i < count; ++i)
+		{
+			int idx = m_actors.find({(int)(intptr_t)transforms[i].userData});
+			if (idx < 0) continue;
+
+			RigidActor* actor = m_actors.at(idx);
+			if (actor->physx_actor != transforms[i].actor || actor->dynamic_type != DynamicType::DYNAMIC) continue;
+
+			actor->prev_pose = actor->pose;
+			actor->pose = fromPhysx(transforms[i].actor2World);
+			actor->active_step = m_step_index;
+			m_active_actors.push(actor);
+		}
+
+		for (auto* actor : m_last_active_actors)
+		{
+			if (actor->active_step == m_step_index) continue;
+			actor->prev_pose = actor->pose;
+			m_settled_actors.push(actor);
+		}
+	}
+
+
+	void updateDynamicActors(float t)
 	{
 		PROFILE_FUNCTION();
-		for (auto* actor : m_dynamic_actors)
+		m_moved_entities.clear();
+		m_moved_transforms.clear();
+		for (auto* actor : m_settled_actors)
+		{
+			if (actor->dynamic_type != DynamicType::DYNAMIC) continue;
+			m_moved_entities.push(actor->entity);
+			m_moved_transforms.push(actor->pose);
+		}
+		m_settled_actors.clear();
+		for (auto* actor : m_active_actors)
 		{
-			PxTransform trans = actor->physx_actor->getGlobalPose();
-			m_universe.setPosition(actor->entity, trans.p.x, trans.p.y, trans.p.z);
-			m_universe.setRotation(actor->entity, trans.q.x, trans.q.y, trans.q.z, trans.q.w);
+			if (actor->dynamic_type != DynamicType::DYNAMIC) continue;
+			m_moved_entities.push(actor->entity);
+			m_moved_transforms.push(t < 1 ? actor->prev_pose.interpolate(actor->pose, t) : actor->pose);
 		}
+		PROFILE_INT("active actors", m_moved_entities.size());
+
+		m_is_updating_actors = true;
+		m_universe.setTransforms(m_moved_entities.begin(), m_moved_transforms.begin(), m_moved_entities.size());
+		m_is_updating_actors = false;
 	}
 
 
@@ -1613,6 +1775,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	{
 		PROFILE_FUNCTION();
 		m_scene->simulate(time_delta);
+		m_is_simulating = true;
 	}
 
 
@@ -1620,6 +1783,14 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	{
 		PROFILE_FUNCTION();
 		m_scene->fetchResults(true);
+		m_is_simulating = false;
+		updateActiveActors();
+	}
+
+
+	void waitForSimulation()
+	{
+		if (m_is_simulating) fetchResults();
 	}
 
 
@@ -2201,23 +2372,77 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	}
 
 
+	void updateFixedStep(float time_delta)
+	{
+		waitForSimulation();
+		updateHeightfields();
+		applyQueuedForces();
+
+		m_time_accumulator += time_delta;
+		int substeps = 0;
+		while (m_time_accumulator >= m_fixed_time_step * 2 && substeps < MAX_SUBSTEPS)
+		{
+			simulateScene(m_fixed_time_step);
+			fetchResults();
+			m_time_accumulator -= m_fixed_time_step;
+			++substeps;
+		}
+		m_time_accumulator = Math::minimum(m_time_accumulator, m_fixed_time_step * 2);
+		PROFILE_INT("physics substeps", substeps);
+
+		updateRagdolls();
+		updateDynamicActors(Math::minimum(1.0f, m_time_accumulator / m_fixed_time_step));
+		updateControllers(time_delta);
+
+		render();
+	}
+
+
 	void update(float time_delta, bool paused) override
 	{
+		updateHeightfields();
 		if (!m_is_game_running || paused) return;
-		
+		if (m_fixed_time_step > 0)
+		{
+			updateFixedStep(time_delta);
+			return;
+		}
+
 		applyQueuedForces();
 
 		time_delta = Math::minimum(1 / 20.0f, time_delta);
 		simulateScene(time_delta);
 		fetchResults();
 		updateRagdolls();
-		updateDynamicActors();
+		updateDynamicActors(1);
 		updateControllers(time_delta);
 		
 		render();
 	}
 
 
+	void lateUpdate(float time_delta, bool paused) override
+	{
+		if (!m_is_game_running || paused || m_fixed_time_step <= 0) return;
+		if (m_time_accumulator < m_fixed_time_step) return;
+
+		// overlaps with rendering and the next frame's scripts, results are fetched in update
+		simulateScene(m_fixed_time_step);
+		m_time_accumulator -= m_fixed_time_step;
+	}
+
+
+	void setFixedTimeStep(float time_step) override
+	{
+		waitForSimulation();
+		m_fixed_time_step = Math::maximum(time_step, 0.0f);
+		m_time_accumulator = 0;
+	}
+
+
+	float getFixedTimeStep() const override { return m_fixed_time_step; }
+
+
 	ComponentHandle getActorComponent(Entity entity) override
 	{
 		int idx = m_actors.find(entity);
@@ -2270,6 +2495,8 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 
 	void stopGame() override
 	{
+		waitForSimulation();
+		m_time_accumulator = 0;
 		m_is_game_running = false;
 	}
 
@@ -2326,6 +2553,140 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	void moveController(ComponentHandle cmp, const Vec3& v) override { m_controllers[{cmp.index}].m_frame_change += v; }
 
 
+	// reads the i-th {origin, dir} table of the table at idx
+	static void checkRay(lua_State* L, int idx, int i, Vec3& origin, Vec3& dir)
+	{
+		lua_rawgeti(L, idx, i + 1);
+		if (!lua_istable(L, -1)) luaL_error(L, "ray %d is not a table", i + 1);
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+		if (!LuaWrapper::isType<Vec3>(L, -2) || !LuaWrapper::isType<Vec3>(L, -1))
+		{
+			luaL_error(L, "ray %d must be {origin, dir}", i + 1);
+		}
+		origin = LuaWrapper::toType<Vec3>(L, -2);
+		dir = LuaWrapper::toType<Vec3>(L, -1);
+		lua_pop(L, 3);
+	}
+
+
+	// pushes a table of hit entities (-1 for no hit) and a table of hit positions (false for no hit)
+	static void pushHits(lua_State* L, const RaycastHit* hits, int count)
+	{
+		lua_createtable(L, count, 0);
+		lua_createtable(L, count, 0);
+		for (int i = 0; i < count; ++i)
+		{
+			const RaycastHit& hit = hits[i];
+			LuaWrapper::push(L, hit.entity);
+			lua_rawseti(L, -3, i + 1);
+			if (hit.entity.isValid())
+			{
+				LuaWrapper::push(L, hit.position);
+			}
+			else
+			{
+				lua_pushboolean(L, 0);
+			}
+			lua_rawseti(L, -2, i + 1);
+		}
+	}
+
+
+	// Physics.raycastBatch(scene, {{origin, dir}, ...} [, distance]) returns a table of hit entities (-1 for no hit)
+	// and a table of hit positions (false for no hit)
+	static int LUA_raycastBatch(lua_State* L)
+	{
+		auto* scene = LuaWrapper::checkArg<PhysicsSceneImpl*>(L, 1);
+		LuaWrapper::checkTableArg(L, 2);
+		float distance = FLT_MAX;
+		if (lua_gettop(L) > 2) distance = LuaWrapper::checkArg<float>(L, 3);
+
+		int count = (int)lua_rawlen(L, 2);
+		Array<RaycastQuery>& queries = scene->m_lua_raycasts;
+		Array<RaycastHit>& hits = scene->m_lua_hits;
+		queries.resize(count);
+		hits.resize(count);
+		for (int i = 0; i < count; ++i)
+		{
+			RaycastQuery& query = queries[i];
+			checkRay(L, 2, i, query.origin, query.dir);
+			query.distance = distance;
+			query.ignored = INVALID_ENTITY;
+		}
+
+		scene->raycastBatch(queries.begin(), hits.begin(), count);
+		pushHits(L, hits.begin(), count);
+		return 2;
+	}
+
+
+	// Physics.sweepBatch(scene, {{origin, dir}, ...}, radius [, distance]) sweeps spheres,
+	// returns the same tables as raycastBatch
+	static int LUA_sweepBatch(lua_State* L)
+	{
+		auto* scene = LuaWrapper::checkArg<PhysicsSceneImpl*>(L, 1);
+		LuaWrapper::checkTableArg(L, 2);
+		float radius = LuaWrapper::checkArg<float>(L, 3);
+		float distance = FLT_MAX;
+		if (lua_gettop(L) > 3) distance = LuaWrapper::checkArg<float>(L, 4);
+
+		int count = (int)lua_rawlen(L, 2);
+		Array<SweepQuery>& queries = scene->m_lua_sweeps;
+		Array<RaycastHit>& hits = scene->m_lua_hits;
+		queries.resize(count);
+		hits.resize(count);
+		for (int i = 0; i < count; ++i)
+		{
+			SweepQuery& query = queries[i];
+			checkRay(L, 2, i, query.origin, query.dir);
+			query.distance = distance;
+			query.radius = radius;
+			query.ignored = INVALID_ENTITY;
+		}
+
+		scene->sweepBatch(queries.begin(), hits.begin(), count);
+		pushHits(L, hits.begin(), count);
+		return 2;
+	}
+
+
+	// Physics.overlapBatch(scene, {position, ...}, radius) returns a table of the first entity overlapping
+	// each sphere (-1 for none)
+	static int LUA_overlapBatch(lua_State* L)
+	{
+		auto* scene = LuaWrapper::checkArg<PhysicsSceneImpl*>(L, 1);
+		LuaWrapper::checkTableArg(L, 2);
+		float radius = LuaWrapper::checkArg<float>(L, 3);
+
+		int count = (int)lua_rawlen(L, 2);
+		Array<OverlapQuery>& queries = scene->m_lua_overlaps;
+		Array<Entity>& results = scene->m_lua_overlap_results;
+		queries.resize(count);
+		results.resize(count);
+		for (int i = 0; i < count; ++i)
+		{
+			OverlapQuery& query = queries[i];
+			lua_rawgeti(L, 2, i + 1);
+			if (!LuaWrapper::isType<Vec3>(L, -1)) return luaL_error(L, "position %d is not a vector", i + 1);
+			query.position = LuaWrapper::toType<Vec3>(L, -1);
+			query.radius = radius;
+			query.ignored = INVALID_ENTITY;
+			lua_pop(L, 1);
+		}
+
+		scene->overlapBatch(queries.begin(), results.begin(), count);
+
+		lua_createtable(L, count, 0);
+		for (int i = 0; i < count; ++i)
+		{
+			LuaWrapper::push(L, results[i]);
+			lua_rawseti(L, -2, i + 1);
+		}
+		return 1;
+	}
+
+
 	static int LUA_raycast(lua_State* L)
 	{
 		auto* scene = LuaWrapper::checkArg<PhysicsSceneImpl*>(L, 1);
@@ -2373,12 +2734,21 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	};
 
 
-	bool raycastEx(const Vec3& origin, const Vec3& dir, float distance, RaycastHit& result, Entity ignored) override
+	static void fillHit(const PxLocationHit& hit, RaycastHit& result)
 	{
-		PxVec3 physx_origin(origin.x, origin.y, origin.z);
-		PxVec3 unit_dir(dir.x, dir.y, dir.z);
-		PxReal max_distance = distance;
+		result.normal = fromPhysx(hit.normal);
+		result.position = fromPhysx(hit.position);
+		result.entity = INVALID_ENTITY;
+		if (hit.shape)
+		{
+			PxRigidActor* actor = hit.shape->getActor();
+			if (actor) result.entity = {(int)(intptr_t)actor->userData};
+		}
+	}
+
 
+	bool raycastEx(const Vec3& origin, const Vec3& dir, float distance, RaycastHit& result, Entity ignored) override
+	{
 		const PxHitFlags flags =
 			PxHitFlag::eDISTANCE | PxHitFlag::ePOSITION | PxHitFlag::eNORMAL;
 		PxRaycastBuffer hit;
@@ -2387,24 +2757,94 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		filter.entity = ignored;
 		PxQueryFilterData filter_data;
 		filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER;
-		bool status =
-			m_scene->raycast(physx_origin, unit_dir, max_distance, hit, flags, filter_data, &filter);
-		result.normal.x = hit.block.normal.x;
-		result.normal.y = hit.block.normal.y;
-		result.normal.z = hit.block.normal.z;
-		result.position.x = hit.block.position.x;
-		result.position.y = hit.block.position.y;
-		result.position.z = hit.block.position.z;
-		result.entity = INVALID_ENTITY;
-		if (hit.block.shape)
-		{
-			PxRigidActor* actor = hit.block.shape->getActor();
-			if (actor) result.entity = {(int)(intptr_t)actor->userData};
-		}
+		bool status = m_scene->raycast(toPhysx(origin), toPhysx(dir), distance, hit, flags, filter_data, &filter);
+		fillHit(hit.block, result);
 		return status;
 	}
 
 
+	// scene queries only read the scene, so batches run in parallel while the calling thread waits;
+	// all batches share m_query_sync_point, so they must not be started concurrently or from inside a query
+	template <typename F> void runQueryJobs(int count, F& f)
+	{
+		PROFILE_FUNCTION();
+		PROFILE_INT("queries", count);
+		ASSERT(!m_is_querying);
+		m_is_querying = true;
+		auto profiled = [&f](int from, int to) {
+			PROFILE_BLOCK("Physics queries");
+			f(from, to);
+		};
+		MTJD::runBatches(m_engine->getMTJDManager(), m_query_sync_point, count, QUERY_BATCH_SIZE, profiled, m_allocator);
+		m_is_querying = false;
+	}
+
+
+	void raycastBatch(const RaycastQuery* queries, RaycastHit* results, int count) override
+	{
+		auto f = [this, queries, results](int from, int to) {
+			const PxHitFlags flags = PxHitFlag::eDISTANCE | PxHitFlag::ePOSITION | PxHitFlag::eNORMAL;
+			PxQueryFilterData filter_data;
+			filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER;
+			Filter filter;
+			for (int i = from; i < to; ++i)
+			{
+				const RaycastQuery& query = queries[i];
+				PxRaycastBuffer hit;
+				filter.entity = query.ignored;
+				m_scene->raycast(toPhysx(query.origin), toPhysx(query.dir), query.distance, hit, flags, filter_data, &filter);
+				fillHit(hit.block, results[i]);
+			}
+		};
+		runQueryJobs(count, f);
+	}
+
+
+	void sweepBatch(const SweepQuery* queries, RaycastHit* results, int count) override
+	{
+		auto f = [this, queries, results](int from, int to) {
+			const PxHitFlags flags = PxHitFlag::eDISTANCE | PxHitFlag::ePOSITION | PxHitFlag::eNORMAL;
+			PxQueryFilterData filter_data;
+			filter_data.flags = PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER;
+			Filter filter;
+			for (int i = from; i < to; ++i)
+			{
+				const SweepQuery& query = queries[i];
+				PxSweepBuffer hit;
+				filter.entity = query.ignored;
+				PxSphereGeometry geom(query.radius);
+				PxTransform pose(toPhysx(query.origin));
+				m_scene->sweep(geom, pose, toPhysx(query.dir), query.distance, hit, flags, filter_data, &filter);
+				fillHit(hit.block, results[i]);
+			}
+		};
+		runQueryJobs(count, f);
+	}
+
+
+	void overlapBatch(const OverlapQuery* queries, Entity* results, int count) override
+	{
+		auto f = [this, queries, results](int from, int to) {
+			PxQueryFilterData filter_data;
+			filter_data.flags =
+				PxQueryFlag::eDYNAMIC | PxQueryFlag::eSTATIC | PxQueryFlag::ePREFILTER | PxQueryFlag::eANY_HIT;
+			Filter filter;
+			for (int i = from; i < to; ++i)
+			{
+				const OverlapQuery& query = queries[i];
+				PxOverlapBuffer hit;
+				filter.entity = query.ignored;
+				PxSphereGeometry geom(query.radius);
+				PxTransform pose(toPhysx(query.position));
+				m_scene->overlap(geom, pose, hit, filter_data, &filter);
+				results[i] = hit.hasBlock && hit.block.actor ? Entity{(int)(intptr_t)hit.block.actor->userData}
+															 : INVALID_ENTITY;
+			}
+		};
+		runQueryJobs(count, f);
+	}
+
+
 	void onEntityMoved(Entity entity)
 	{
 		int ctrl_idx = m_controllers.find(entity);
@@ -2431,13 +2871,15 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		}
 
 		int idx = m_actors.find(entity);
-		if(idx >= 0)
+		if(idx >= 0 && !m_is_updating_actors)
 		{
 			RigidActor* actor = m_actors.at(idx);
 			if (actor->physx_actor)
 			{
 				Transform trans = m_universe.getTransform(entity);
 				actor->physx_actor->setGlobalPose(toPhysx(trans), false);
+				actor->pose = trans;
+				actor->prev_pose = trans;
 				if (actor->resource) actor->rescale();
 			}
 		}
@@ -2447,53 +2889,30 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	void heightmapLoaded(Heightfield& terrain)
 	{
 		PROFILE_FUNCTION();
-		Array<PxHeightFieldSample> heights(m_allocator);
-
 		int width = terrain.m_heightmap->width;
 		int height = terrain.m_heightmap->height;
-		heights.resize(width * height);
 		int bytes_per_pixel = terrain.m_heightmap->bytes_per_pixel;
-		if (bytes_per_pixel == 2)
+		if (terrain.m_rows * terrain.m_columns != width * height)
 		{
-			PROFILE_BLOCK("copyData");
-			const i16* LUMIX_RESTRICT data = (const i16*)terrain.m_heightmap->getData();
-			for (int j = 0; j < height; ++j)
-			{
-				int idx = j * width;
-				for (int i = 0; i < width; ++i)
-				{
-					int idx2 = j + i * height;
-					heights[idx].height = PxI16((i32)data[idx2] - 0x7fff);
-					heights[idx].materialIndex0 = heights[idx].materialIndex1 = 0;
-					heights[idx].setTessFlag();
-					++idx;
-				}
-			}
+			if (terrain.m_samples) m_allocator.deallocate(terrain.m_samples);
+			terrain.m_samples = (PxHeightFieldSample*)m_allocator.allocate(width * height * sizeof(PxHeightFieldSample));
 		}
-		else
+		terrain.m_rows = width;
+		terrain.m_columns = height;
+		terrain.m_dirty_from_x = terrain.m_dirty_to_x = 0;
+		terrain.m_dirty_from_y = terrain.m_dirty_to_y = 0;
 		{
 			PROFILE_BLOCK("copyData");
-			const u8* data = terrain.m_heightmap->getData();
-			for (int j = 0; j < height; ++j)
-			{
-				for (int i = 0; i < width; ++i)
-				{
-					int idx = i + j * width;
-					int idx2 = j + i * height;
-					heights[idx].height = PxI16((i32)data[idx2 * bytes_per_pixel] - 0x7f);
-					heights[idx].materialIndex0 = heights[idx].materialIndex1 = 0;
-					heights[idx].setTessFlag();
-				}
-			}
+			convertHeights(terrain.m_heightmap->getData(), bytes_per_pixel, width, width, height, terrain.m_samples, height);
 		}
 
 		{ // PROFILE_BLOCK scope
 			PROFILE_BLOCK("PhysX");
 			PxHeightFieldDesc hfDesc;
 			hfDesc.format = PxHeightFieldFormat::eS16_TM;
-			hfDesc.nbColumns = width;
-			hfDesc.nbRows = height;
-			hfDesc.samples.data = &heights[0];
+			hfDesc.nbColumns = height;
+			hfDesc.nbRows = width;
+			hfDesc.samples.data = terrain.m_samples;
 			hfDesc.samples.stride = sizeof(PxHeightFieldSample);
 			hfDesc.thickness = -1;
 
@@ -2506,6 +2925,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 				terrain.m_xz_scale);
 			if (terrain.m_actor)
 			{
+				waitForSimulation();
 				PxRigidActor* actor = terrain.m_actor;
 				m_scene->removeActor(*actor);
 				actor->release();
@@ -2789,14 +3209,6 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		}
 
 		actor->dynamic_type = new_value;
-		if (new_value == DynamicType::DYNAMIC)
-		{
-			m_dynamic_actors.push(actor);
-		}
-		else
-		{
-			m_dynamic_actors.eraseItemFast(actor);
-		}
 		PxShape* shapes;
 		if (actor->physx_actor && actor->physx_actor->getNbShapes() == 1 &&
 			actor->physx_actor->getShapes(&shapes, 1, 0))
@@ -3232,7 +3644,6 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		{
 			serializer.read((int*)&actor->dynamic_type);
 		}
-		if (actor->dynamic_type == DynamicType::DYNAMIC) m_dynamic_actors.push(actor);
 		if (scene_version > (int)PhysicsSceneVersion::TRIGGERS)
 		{
 			serializer.read(&actor->is_trigger);
@@ -3538,6 +3949,7 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		serializer.write(m_layers_count);
 		serializer.write(m_layers_names);
 		serializer.write(m_collision_filter);
+		serializer.write(m_fixed_time_step);
 		serializer.write((i32)m_actors.size());
 		for (auto* actor : m_actors)
 		{
@@ -4102,7 +4514,6 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 				LUMIX_DELETE(m_allocator, actor);
 				continue;
 			}
-			if (actor->dynamic_type == DynamicType::DYNAMIC) m_dynamic_actors.push(actor);
 			m_actors.insert(actor->entity, actor);
 			deserializeActor(serializer, actor);
 		}
@@ -4321,6 +4732,9 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 		serializer.read(m_layers_count);
 		serializer.read(m_layers_names);
 		serializer.read(m_collision_filter);
+		float fixed_time_step;
+		serializer.read(fixed_time_step);
+		setFixedTimeStep(fixed_time_step);
 
 		deserializeActors(serializer);
 		deserializeControllers(serializer);
@@ -4430,9 +4844,26 @@ struct PhysicsSceneImpl LUMIX_FINAL : public PhysicsScene
 	AssociativeArray<Entity, Controller> m_controllers;
 	AssociativeArray<Entity, Heightfield> m_terrains;
 
-	Array<RigidActor*> m_dynamic_actors;
+	Array<RigidActor*> m_active_actors;
+	Array<RigidActor*> m_last_active_actors;
+	Array<RigidActor*> m_settled_actors;
+	Array<Entity> m_moved_entities;
+	Array<Transform> m_moved_transforms;
+	u32 m_step_index;
+	MTJD::Group m_query_sync_point;
+	Array<RaycastQuery> m_lua_raycasts;
+	Array<RaycastHit> m_lua_hits;
+	Array<SweepQuery> m_lua_sweeps;
+	Array<OverlapQuery> m_lua_overlaps;
+	Array<Entity> m_lua_overlap_results;
+	Array<PxHeightFieldSample> m_heightfield_scratch;
 	bool m_is_game_running;
 	bool m_is_updating_ragdoll;
+	bool m_is_updating_actors;
+	bool m_is_querying;
+	bool m_is_simulating;
+	float m_fixed_time_step;
+	float m_time_accumulator;
 	u32 m_debug_visualization_flags;
 	Array<QueuedForce> m_queued_forces;
 	u32 m_collision_filter[32];
@@ -4448,16 +4879,9 @@ PhysicsScene* PhysicsScene::create(PhysicsSystem& system, Universe& context, Eng
 	impl->m_engine = &engine;
 	PxSceneDesc sceneDesc(system.getPhysics()->getTolerancesScale());
 	sceneDesc.gravity = PxVec3(0.0f, -9.8f, 0.0f);
-	if (!sceneDesc.cpuDispatcher)
-	{
-		PxDefaultCpuDispatcher* cpu_dispatcher = PxDefaultCpuDispatcherCreate(1);
-		if (!cpu_dispatcher)
-		{
-			g_log_error.log("Physics") << "PxDefaultCpuDispatcherCreate failed!";
-		}
-		sceneDesc.cpuDispatcher = cpu_dispatcher;
-	}
+	sceneDesc.cpuDispatcher = system.getCpuDispatcher();
 
+	sceneDesc.flags |= PxSceneFlag::eENABLE_ACTIVETRANSFORMS;
 	sceneDesc.filterShader = impl->filterShader;
 	sceneDesc.simulationEventCallback = &impl->m_contact_callback;
 
@@ -4528,6 +4952,7 @@ void PhysicsSceneImpl::RigidActor::rescale()
 
 void PhysicsSceneImpl::RigidActor::setPhysxActor(PxRigidActor* actor)
 {
+	scene.waitForSimulation();
 	if (physx_actor)
 	{
 		scene.m_scene->removeActor(*physx_actor);
@@ -4537,6 +4962,8 @@ void PhysicsSceneImpl::RigidActor::setPhysxActor(PxRigidActor* actor)
 	if (actor)
 	{
 		scene.m_scene->addActor(*actor);
+		pose = fromPhysx(actor->getGlobalPose());
+		prev_pose = pose;
 		actor->userData = (void*)(intptr_t)entity.index;
 		scene.updateFilterData(actor, layer);
 		scene.setIsTrigger({entity.index}, is_trigger);
@@ -4566,12 +4993,16 @@ Heightfield::Heightfield()
 	m_y_scale = 1.0f;
 	m_actor = nullptr;
 	m_layer = 0;
+	m_samples = nullptr;
+	m_rows = m_columns = 0;
+	m_dirty_from_x = m_dirty_from_y = m_dirty_to_x = m_dirty_to_y = 0;
 }
 
 
 Heightfield::~Heightfield()
 {
 	if(m_actor) m_actor->release();
+	if (m_samples) m_scene->m_allocator.deallocate(m_samples);
 	if (m_heightmap)
 	{
 		m_heightmap->getResourceManager().unload(*m_heightmap);
@@ -4604,8 +5035,13 @@ void PhysicsScene::registerLuaAPI(lua_State* L)
 	REGISTER_FUNCTION(moveController);
 	REGISTER_FUNCTION(setRagdollKinematic);
 	REGISTER_FUNCTION(addForceAtPos);
+	REGISTER_FUNCTION(setFixedTimeStep);
+	REGISTER_FUNCTION(getFixedTimeStep);
 	
 	LuaWrapper::createSystemFunction(L, "Physics", "raycast", &PhysicsSceneImpl::LUA_raycast);
+	LuaWrapper::createSystemFunction(L, "Physics", "raycastBatch", &PhysicsSceneImpl::LUA_raycastBatch);
+	LuaWrapper::createSystemFunction(L, "Physics", "sweepBatch", &PhysicsSceneImpl::LUA_sweepBatch);
+	LuaWrapper::createSystemFunction(L, "Physics", "overlapBatch", &PhysicsSceneImpl::LUA_overlapBatch);
 
 	#undef REGISTER_FUNCTION
 }
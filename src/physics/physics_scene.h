@@ -46,6 +46,33 @@ struct RaycastHit
 };
 
 
+struct RaycastQuery
+{
+	Vec3 origin;
+	Vec3 dir;
+	float distance;
+	Entity ignored;
+};
+
+
+struct SweepQuery
+{
+	Vec3 origin;
+	Vec3 dir;
+	float distance;
+	float radius;
+	Entity ignored;
+};
+
+
+struct OverlapQuery
+{
+	Vec3 position;
+	float radius;
+	Entity ignored;
+};
+
+
 class LUMIX_PHYSICS_API PhysicsScene : public IScene
 {
 public:
@@ -82,7 +109,17 @@ public:
 	virtual void render() = 0;
 	virtual Entity raycast(const Vec3& origin, const Vec3& dir, Entity ignore_entity) = 0;
 	virtual bool raycastEx(const Vec3& origin, const Vec3& dir, float distance, RaycastHit& result, Entity ignored) = 0;
+	// queries run in parallel jobs, results[i].entity is INVALID_ENTITY if queries[i] did not hit anything;
+	// batches of one scene must not run concurrently
+	virtual void raycastBatch(const RaycastQuery* queries, RaycastHit* results, int count) = 0;
+	// sweeps spheres along dir
+	virtual void sweepBatch(const SweepQuery* queries, RaycastHit* results, int count) = 0;
+	// first entity overlapping each sphere
+	virtual void overlapBatch(const OverlapQuery* queries, Entity* results, int count) = 0;
 	virtual PhysicsSystem& getSystem() const = 0;
+	// 0 simulates with the frame time, otherwise the scene runs in fixed steps overlapped with the rest of the frame
+	virtual void setFixedTimeStep(float time_step) = 0;
+	virtual float getFixedTimeStep() const = 0;
 
 	virtual ComponentHandle getActorComponent(Entity entity) = 0;
 	virtual void setActorLayer(ComponentHandle cmp, int layer) = 0;
@@ -4,11 +4,18 @@
 
 #include "cooking/PxCooking.h"
 #include "engine/base_proxy_allocator.h"
+#include "engine/command_line_parser.h"
+#include "engine/fs/disk_file_device.h"
 #include "engine/log.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/manager.h"
+#include "engine/profiler.h"
 #include "engine/resource_manager.h"
 #include "engine/engine.h"
 #include "engine/property_descriptor.h"
 #include "engine/property_register.h"
+#include "engine/string.h"
+#include "engine/system.h"
 #include "physics/physics_geometry_manager.h"
 #include "physics/physics_scene.h"
 #include "renderer/render_scene.h"
@@ -375,15 +382,64 @@ namespace Lumix
 	};
 
 
+	// runs PhysX tasks as MTJD jobs, so physics shares the engine's worker threads instead of spawning its own
+	struct JobDispatcher LUMIX_FINAL : public physx::PxCpuDispatcher
+	{
+		JobDispatcher(MTJD::Manager& manager, IAllocator& allocator)
+			: m_manager(manager)
+			, m_allocator(allocator)
+			, m_worker_count(manager.getCpuThreadsCount())
+		{
+		}
+
+
+		void submitTask(physx::PxBaseTask& task) override
+		{
+			if (m_worker_count == 0)
+			{
+				runTask(task);
+				return;
+			}
+
+			MTJD::Job* job = MTJD::makeJob(m_manager, [&task]() { runTask(task); }, m_allocator);
+			m_manager.schedule(job);
+		}
+
+
+		static void runTask(physx::PxBaseTask& task)
+		{
+			PROFILE_BLOCK(task.getName());
+			task.run();
+			task.release();
+		}
+
+
+		physx::PxU32 getWorkerCount() const override { return m_worker_count; }
+
+
+		MTJD::Manager& m_manager;
+		IAllocator& m_allocator;
+		physx::PxU32 m_worker_count;
+	};
+
+
 	struct PhysicsSystemImpl LUMIX_FINAL : public PhysicsSystem
 	{
 		explicit PhysicsSystemImpl(Engine& engine)
 			: m_allocator(engine.getAllocator())
 			, m_engine(engine)
-			, m_manager(*this, engine.getAllocator())
+			, m_manager(*this, engine.getMTJDManager(), engine.getAllocator())
+			, m_dispatcher(engine.getMTJDManager(), m_allocator)
 		{
+			parseCommandLine();
+
 			registerProperties(engine.getAllocator());
 			m_manager.create(PHYSICS_TYPE, engine.getResourceManager());
+			if (engine.getDiskFileDevice())
+			{
+				StaticString<MAX_PATH_LENGTH> cache_dir(engine.getDiskFileDevice()->getBasePath(), "physics_cache");
+				m_manager.setCacheDir(cache_dir);
+			}
 			PhysicsScene::registerLuaAPI(m_engine.getState());
 
 			m_foundation = PxCreateFoundation(PX_PHYSICS_VERSION, m_physx_allocator, m_error_callback);
@@ -398,6 +454,7 @@ namespace Lumix
 
 		~PhysicsSystemImpl()
 		{
+			m_manager.finishCooking();
 			m_cooking->release();
 			m_physics->release();
 			m_foundation->release();
@@ -414,6 +471,9 @@ namespace Lumix
 		void destroyScene(IScene* scene) override { PhysicsScene::destroy(static_cast<PhysicsScene*>(scene)); }
 
 
+		void update(float) override { m_manager.update(); }
+
+
 		physx::PxPhysics* getPhysics() override
 		{
 			return m_physics;
@@ -424,6 +484,34 @@ namespace Lumix
 			return m_cooking;
 		}
 
+
+		physx::PxCpuDispatcher* getCpuDispatcher() override
+		{
+			return &m_dispatcher;
+		}
+
+
+		void parseCommandLine()
+		{
+			char cmd_line[2048];
+			getCommandLine(cmd_line, lengthOf(cmd_line));
+			CommandLineParser parser(cmd_line);
+			while (parser.next())
+			{
+				if (!parser.currentEquals("-physics_threads")) continue;
+				if (!parser.next()) break;
+
+				char tmp[16];
+				parser.getCurrent(tmp, lengthOf(tmp));
+				int count;
+				if (fromCString(tmp, lengthOf(tmp), &count) && count >= 0)
+				{
+					m_dispatcher.m_worker_count = Math::minimum((u32)count, m_engine.getMTJDManager().getCpuThreadsCount());
+				}
+				break;
+			}
+		}
+
 		bool connect2VisualDebugger()
 		{
 			if (m_physics->getPvdConnectionManager() == nullptr) return false;
@@ -448,6 +536,7 @@ namespace Lumix
 		PhysicsGeometryManager m_manager;
 		Engine& m_engine;
 		BaseProxyAllocator m_allocator;
+		JobDispatcher m_dispatcher;
 	};
 
 
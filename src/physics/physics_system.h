@@ -10,6 +10,7 @@ namespace physx
 
 	class PxControllerManager;
 	class PxCooking;
+	class PxCpuDispatcher;
 	class PxPhysics;
 
 } // namespace physx
@@ -28,6 +29,7 @@ class PhysicsSystem : public IPlugin
 		
 		virtual physx::PxPhysics* getPhysics() = 0;
 		virtual physx::PxCooking* getCooking() = 0;
+		virtual physx::PxCpuDispatcher* getCpuDispatcher() = 0;
 
 	protected:
 		PhysicsSystem() {}
@@ -742,6 +742,47 @@ struct FBXImporter
 	}
 
 
+	// range of the bone followed by 3 x u16 per key
+	void writeQuantized(const Array<TranslationKey>& positions)
+	{
+		Vec3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vec3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (const TranslationKey& key : positions)
+		{
+			min.set(Math::minimum(min.x, key.pos.x), Math::minimum(min.y, key.pos.y), Math::minimum(min.z, key.pos.z));
+			max.set(Math::maximum(max.x, key.pos.x), Math::maximum(max.y, key.pos.y), Math::maximum(max.z, key.pos.z));
+		}
+		if (positions.empty()) min = max = Vec3(0, 0, 0);
+		Vec3 extent = max - min;
+		write(min);
+		write(extent);
+		for (const TranslationKey& key : positions)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				float t = (&extent.x)[i] > 0 ? ((&key.pos.x)[i] - (&min.x)[i]) / (&extent.x)[i] : 0;
+				write(u16(Math::clamp(t, 0.0f, 1.0f) * 65535 + 0.5f));
+			}
+		}
+	}
+
+
+	void writeQuantized(const Array<RotationKey>& rotations)
+	{
+		for (const RotationKey& key : rotations)
+		{
+			Quat rot = fixOrientation(key.rot);
+			rot.normalize();
+			const float* components = &rot.x;
+			for (int i = 0; i < 4; ++i)
+			{
+				float c = Math::clamp(components[i], -1.0f, 1.0f) * 32767;
+				write(i16(c < 0 ? c - 0.5f : c + 0.5f));
+			}
+		}
+	}
+
+
 	void writeAnimations(const char* output_dir)
 	{
 		for (ImportAnimation& anim : animations)
@@ -787,12 +828,14 @@ struct FBXImporter
 			}
 			Animation::Header header;
 			header.magic = Animation::HEADER_MAGIC;
-			header.version = 3;
+			header.version = 4;
 			header.fps = (u32)(scene_frame_rate + 0.5f);
 			write(header);
 
 			int root_motion_bone_idx = -1;
 			write(root_motion_bone_idx);
+			u32 flags = quantize_animations ? Animation::QUANTIZED_KEYS : 0;
+			write(flags);
 			write(int(duration / sampling_period));
 			int used_bone_count = 0;
 
@@ -833,14 +876,29 @@ struct FBXImporter
 				{
 					// TODO check this in isValid function
 					// assert(scale > 0.99f && scale < 1.01f);
-					write(fixOrientation(key.pos * mesh_scale));
+					key.pos = fixOrientation(key.pos * mesh_scale);
+				}
+				if (quantize_animations)
+				{
+					writeQuantized(positions);
+				}
+				else
+				{
+					for (TranslationKey& key : positions) write(key.pos);
 				}
 
 				compressRotations(rotations, frames, sampling_period, rotation_node, *bone, 0.0001f);
 
 				write(rotations.size());
 				for (RotationKey& key : rotations) write(key.frame);
-				for (RotationKey& key : rotations) write(fixOrientation(key.rot));
+				if (quantize_animations)
+				{
+					writeQuantized(rotations);
+				}
+				else
+				{
+					for (RotationKey& key : rotations) write(fixOrientation(key.rot));
+				}
 			}
 			out_file.close();
 		}
@@ -1322,6 +1380,7 @@ struct FBXImporter
 	bool center_mesh = false;
 	bool ignore_skeleton = false;
 	bool ignore_vertex_colors = true;
+	bool quantize_animations = false;
 	Orientation orientation = Orientation::Y_UP;
 };
 
@@ -2317,6 +2376,7 @@ void ImportAssetDialog::onAnimationsGUI()
 	ImGui::DragFloat("Time scale", &m_model.time_scale, 1.0f, 0, FLT_MAX, "%.5f");
 	ImGui::DragFloat("Max position error", &m_model.position_error, 0, FLT_MAX);
 	ImGui::DragFloat("Max rotation error", &m_model.rotation_error, 0, FLT_MAX);
+	ImGui::Checkbox("Quantize keys", &m_fbx_importer->quantize_animations);
 
 	ImGui::Indent();
 	ImGui::Columns(3);
@@ -144,6 +144,7 @@ void Material::unload(void)
 	{
 		if (m_textures[i])
 		{
+			m_textures[i]->getHandleChangedCb().unbind<Material, &Material::onTextureHandleChanged>(this);
 			removeDependency(*m_textures[i]);
 			texture_manager->unload(*m_textures[i]);
 		}
@@ -421,12 +422,17 @@ void Material::setTexture(int i, Texture* texture)
 {
 	Texture* old_texture = i < m_texture_count ? m_textures[i] : nullptr;
 
-	if (texture) addDependency(*texture);
+	if (texture)
+	{
+		addDependency(*texture);
+		texture->getHandleChangedCb().bind<Material, &Material::onTextureHandleChanged>(this);
+	}
 	m_textures[i] = texture;
 	if (i >= m_texture_count) m_texture_count = i + 1;
 
 	if (old_texture)
 	{
+		old_texture->getHandleChangedCb().unbind<Material, &Material::onTextureHandleChanged>(this);
 		removeDependency(*old_texture);
 		m_resource_manager.getOwner().get(TEXTURE_TYPE)->unload(*old_texture);
 	}
@@ -451,6 +457,12 @@ void Material::setTexture(int i, Texture* texture)
 }
 
 
+void Material::onTextureHandleChanged(Texture&)
+{
+	if (isReady()) createCommandBuffer();
+}
+
+
 void Material::setShader(const Path& path)
 {
 	Shader* shader = static_cast<Shader*>(m_resource_manager.getOwner().get(SHADER_TYPE)->load(path));
@@ -656,6 +668,7 @@ bool Material::deserializeTexture(JsonSerializer& serializer, const char* materi
 				auto* mng = m_resource_manager.getOwner().get(TEXTURE_TYPE);
 				m_textures[m_texture_count] = static_cast<Texture*>(mng->load(Path(texture_path)));
 				addDependency(*m_textures[m_texture_count]);
+				m_textures[m_texture_count]->getHandleChangedCb().bind<Material, &Material::onTextureHandleChanged>(this);
 			}
 		}
 		else if (equalStrings(label, "min_filter"))
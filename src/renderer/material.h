@@ -103,6 +103,7 @@ private:
 	void unload(void) override;
 	bool load(FS::IFile& file) override;
 
+	void onTextureHandleChanged(Texture& texture);
 	bool deserializeTexture(JsonSerializer& serializer, const char* material_dir);
 	void deserializeUniforms(JsonSerializer& serializer);
 	void deserializeDefines(JsonSerializer& serializer);
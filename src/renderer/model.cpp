@@ -63,6 +63,9 @@ Model::Model(const Path& path, ResourceManagerBase& resource_manager, IAllocator
 	, m_bone_map(m_allocator)
 	, m_meshes(m_allocator)
 	, m_bones(m_allocator)
+	, m_bones_by_depth(m_allocator)
+	, m_bone_levels(m_allocator)
+	, m_bone_parents(m_allocator)
 	, m_indices(m_allocator)
 	, m_vertices(m_allocator)
 	, m_skin(m_allocator)
@@ -70,6 +73,7 @@ Model::Model(const Path& path, ResourceManagerBase& resource_manager, IAllocator
 	, m_vertices_handle(BGFX_INVALID_HANDLE)
 	, m_indices_handle(BGFX_INVALID_HANDLE)
 	, m_first_nonroot_bone_index(0)
+	, m_skeleton_hash(0)
 	, m_flags(0)
 	, m_loading_flags(0)
 {
@@ -480,6 +484,7 @@ bool Model::parseBones(FS::IFile& file)
 		return false;
 	}
 	m_bones.reserve(bone_count);
+	m_skeleton_hash = 0;
 	for (int i = 0; i < bone_count; ++i)
 	{
 		Model::Bone& b = m_bones.emplace(m_allocator);
@@ -493,7 +498,9 @@ bool Model::parseBones(FS::IFile& file)
 		file.read(tmp, len);
 		tmp[len] = 0;
 		b.name = tmp;
-		m_bone_map.insert(crc32(b.name.c_str()), m_bones.size() - 1);
+		u32 name_hash = crc32(b.name.c_str());
+		m_bone_map.insert(name_hash, m_bones.size() - 1);
+		m_skeleton_hash = continueCrc32(m_skeleton_hash, &name_hash, sizeof(name_hash));
 		file.read(&len, sizeof(len));
 		if (len >= MAX_PATH_LENGTH)
 		{
@@ -543,9 +550,42 @@ bool Model::parseBones(FS::IFile& file)
 	{
 		m_bones[i].inv_bind_transform = m_bones[i].transform.inverted();
 	}
+	computeBoneLevels();
 	return true;
 }
 
+
+void Model::computeBoneLevels()
+{
+	m_bones_by_depth.clear();
+	m_bone_levels.clear();
+	int bone_count = m_bones.size();
+	m_bone_parents.resize(bone_count);
+	for (int i = 0; i < bone_count; ++i) m_bone_parents[i] = m_bones[i].parent_idx;
+	if (m_first_nonroot_bone_index < 0) return;
+
+	Array<int> depths(m_allocator);
+	depths.resize(bone_count);
+	int max_depth = 0;
+	for (int i = 0; i < bone_count; ++i)
+	{
+		int parent = m_bones[i].parent_idx;
+		depths[i] = parent < 0 ? 0 : depths[parent] + 1;
+		max_depth = Math::maximum(max_depth, depths[i]);
+	}
+
+	for (int depth = 1; depth <= max_depth; ++depth)
+	{
+		m_bone_levels.push(m_bones_by_depth.size());
+		for (int i = m_first_nonroot_bone_index; i < bone_count; ++i)
+		{
+			if (depths[i] == depth) m_bones_by_depth.push(i);
+		}
+	}
+	m_bone_levels.push(m_bones_by_depth.size());
+}
+
+
 int Model::getBoneIdx(const char* name)
 {
 	for (int i = 0, c = m_bones.size(); i < c; ++i)
@@ -736,6 +776,11 @@ void Model::unload(void)
 	}
 	m_meshes.clear();
 	m_bones.clear();
+	m_bone_map.clear();
+	m_bones_by_depth.clear();
+	m_bone_levels.clear();
+	m_bone_parents.clear();
+	m_skeleton_hash = 0;
 	m_uvs.clear();
 	m_vertices.clear();
 
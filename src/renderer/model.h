@@ -185,7 +185,15 @@ public:
 	int getBoneCount() const { return m_bones.size(); }
 	const Bone& getBone(int i) const { return m_bones[i]; }
 	int getFirstNonrootBoneIndex() const { return m_first_nonroot_bone_index; }
+	// non-root bones sorted by their depth in the hierarchy, bones in one level do not depend on each other;
+	// level i is [getBoneLevels()[i], getBoneLevels()[i + 1]) in getBonesByDepth()
+	const Array<int>& getBonesByDepth() const { return m_bones_by_depth; }
+	const Array<int>& getBoneLevels() const { return m_bone_levels; }
+	// parent_idx of each bone, packed for the pose kernels
+	const Array<int>& getBoneParents() const { return m_bone_parents; }
 	BoneMap::iterator getBoneIndex(u32 hash) { return m_bone_map.find(hash); }
+	// models with the same bone names in the same order have the same skeleton hash
+	u32 getSkeletonHash() const { return m_skeleton_hash; }
 	void getPose(Pose& pose);
 	float getBoundingRadius() const { return m_bounding_radius; }
 	RayCastModelHit castRay(const Vec3& origin, const Vec3& dir, const Matrix& model_transform, const Pose* pose);
@@ -218,6 +226,7 @@ private:
 	bool parseMeshes(FS::IFile& file, FileVersion version);
 	bool parseLODs(FS::IFile& file);
 	int getBoneIdx(const char* name);
+	void computeBoneLevels();
 	void computeRuntimeData(const u8* vertices, bool compute_bounding_shape);
 
 	void unload(void) override;
@@ -237,10 +246,14 @@ private:
 	LOD m_lods[MAX_LOD_COUNT];
 	float m_bounding_radius;
 	BoneMap m_bone_map;
+	Array<int> m_bones_by_depth;
+	Array<int> m_bone_levels;
+	Array<int> m_bone_parents;
 	AABB m_aabb;
 	u32 m_flags;
 	u32 m_loading_flags;
 	int m_first_nonroot_bone_index;
+	u32 m_skeleton_hash;
 };
 
 
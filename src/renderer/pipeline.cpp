@@ -2989,6 +2989,7 @@ int renderModels(lua_State* L)
 	auto* pipeline = LuaWrapper::checkArg<PipelineImpl*>(L, 1);
 
 	pipeline->renderAll(pipeline->m_camera_frustum, true, pipeline->m_camera_frustum.position, pipeline->m_layer_mask);
+	pipeline->m_scene->requestTextureMips(pipeline->m_camera_frustum, (float)pipeline->m_height);
 	pipeline->m_layer_mask = 0;
 	return 0;
 }
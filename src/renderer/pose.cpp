@@ -2,6 +2,7 @@
 #include "engine/matrix.h"
 #include "engine/quat.h"
 #include "engine/profiler.h"
+#include "engine/simd.h"
 #include "engine/vec.h"
 #include "renderer/model.h"
 
@@ -27,13 +28,150 @@ Pose::~Pose()
 }
 
 
+// 4 bones in structure-of-arrays layout, so each kernel works on 4 bones at once
+struct BoneLanes
+{
+	float4 px, py, pz;
+	float4 qx, qy, qz, qw;
+};
+
+
+static LUMIX_FORCE_INLINE void loadRotations(const Quat* rotations, const int* indices, BoneLanes& out)
+{
+	out.qx = f4LoadUnaligned(&rotations[indices[0]]);
+	out.qy = f4LoadUnaligned(&rotations[indices[1]]);
+	out.qz = f4LoadUnaligned(&rotations[indices[2]]);
+	out.qw = f4LoadUnaligned(&rotations[indices[3]]);
+	f4Transpose(out.qx, out.qy, out.qz, out.qw);
+}
+
+
+static LUMIX_FORCE_INLINE void storeRotations(BoneLanes& lanes, const int* indices, Quat* rotations)
+{
+	f4Transpose(lanes.qx, lanes.qy, lanes.qz, lanes.qw);
+	f4StoreUnaligned(&rotations[indices[0]], lanes.qx);
+	f4StoreUnaligned(&rotations[indices[1]], lanes.qy);
+	f4StoreUnaligned(&rotations[indices[2]], lanes.qz);
+	f4StoreUnaligned(&rotations[indices[3]], lanes.qw);
+}
+
+
+// Vec3 is not padded, reading 4 floats could go past the end of the array
+static LUMIX_FORCE_INLINE void loadPositions(const Vec3* positions, const int* indices, BoneLanes& out)
+{
+	float LUMIX_ALIGN_BEGIN(16) tmp[3][4] LUMIX_ALIGN_END(16);
+	for (int i = 0; i < 4; ++i)
+	{
+		const Vec3& pos = positions[indices[i]];
+		tmp[0][i] = pos.x;
+		tmp[1][i] = pos.y;
+		tmp[2][i] = pos.z;
+	}
+	out.px = f4Load(tmp[0]);
+	out.py = f4Load(tmp[1]);
+	out.pz = f4Load(tmp[2]);
+}
+
+
+static LUMIX_FORCE_INLINE void storePositions(const BoneLanes& lanes, const int* indices, Vec3* positions)
+{
+	float LUMIX_ALIGN_BEGIN(16) tmp[3][4] LUMIX_ALIGN_END(16);
+	f4Store(tmp[0], lanes.px);
+	f4Store(tmp[1], lanes.py);
+	f4Store(tmp[2], lanes.pz);
+	for (int i = 0; i < 4; ++i)
+	{
+		positions[indices[i]].set(tmp[0][i], tmp[1][i], tmp[2][i]);
+	}
+}
+
+
+// same as Quat::rotate
+static void rotate(const BoneLanes& q, float4 vx, float4 vy, float4 vz, float4* out_x, float4* out_y, float4* out_z)
+{
+	float4 uvx = f4Sub(f4Mul(q.qy, vz), f4Mul(q.qz, vy));
+	float4 uvy = f4Sub(f4Mul(q.qz, vx), f4Mul(q.qx, vz));
+	float4 uvz = f4Sub(f4Mul(q.qx, vy), f4Mul(q.qy, vx));
+	float4 uuvx = f4Sub(f4Mul(q.qy, uvz), f4Mul(q.qz, uvy));
+	float4 uuvy = f4Sub(f4Mul(q.qz, uvx), f4Mul(q.qx, uvz));
+	float4 uuvz = f4Sub(f4Mul(q.qx, uvy), f4Mul(q.qy, uvx));
+	float4 two = f4Splat(2);
+	float4 two_w = f4Mul(q.qw, two);
+	*out_x = f4Add(vx, f4Add(f4Mul(uvx, two_w), f4Mul(uuvx, two)));
+	*out_y = f4Add(vy, f4Add(f4Mul(uvy, two_w), f4Mul(uuvy, two)));
+	*out_z = f4Add(vz, f4Add(f4Mul(uvz, two_w), f4Mul(uuvz, two)));
+}
+
+
+// same as Quat::operator*
+static void multiply(const BoneLanes& a, const BoneLanes& b, BoneLanes* out)
+{
+	float4 x = f4Add(f4Add(f4Mul(a.qw, b.qx), f4Mul(b.qw, a.qx)), f4Sub(f4Mul(a.qy, b.qz), f4Mul(b.qy, a.qz)));
+	float4 y = f4Add(f4Add(f4Mul(a.qw, b.qy), f4Mul(b.qw, a.qy)), f4Sub(f4Mul(a.qz, b.qx), f4Mul(b.qz, a.qx)));
+	float4 z = f4Add(f4Add(f4Mul(a.qw, b.qz), f4Mul(b.qw, a.qz)), f4Sub(f4Mul(a.qx, b.qy), f4Mul(b.qx, a.qy)));
+	float4 w = f4Sub(f4Sub(f4Mul(a.qw, b.qw), f4Mul(a.qx, b.qx)), f4Add(f4Mul(a.qy, b.qy), f4Mul(a.qz, b.qz)));
+	out->qx = x;
+	out->qy = y;
+	out->qz = z;
+	out->qw = w;
+}
+
+
+// nlerp, rotations in the opposite hemisphere are blended with -t
+static void nlerpLanes(BoneLanes& a, const BoneLanes& b, float weight)
+{
+	float4 inv = f4Splat(1.0f - weight);
+	float4 t = f4Splat(weight);
+	float4 dot = f4Add(f4Add(f4Mul(a.qx, b.qx), f4Mul(a.qy, b.qy)), f4Add(f4Mul(a.qz, b.qz), f4Mul(a.qw, b.qw)));
+	int negative = f4MoveMask(dot);
+	if (negative)
+	{
+		float LUMIX_ALIGN_BEGIN(16) tmp[4] LUMIX_ALIGN_END(16);
+		for (int i = 0; i < 4; ++i) tmp[i] = (negative & (1 << i)) ? -weight : weight;
+		t = f4Load(tmp);
+	}
+	float4 x = f4Add(f4Mul(a.qx, inv), f4Mul(b.qx, t));
+	float4 y = f4Add(f4Mul(a.qy, inv), f4Mul(b.qy, t));
+	float4 z = f4Add(f4Mul(a.qz, inv), f4Mul(b.qz, t));
+	float4 w = f4Add(f4Mul(a.qw, inv), f4Mul(b.qw, t));
+	float4 len_sq = f4Add(f4Add(f4Mul(x, x), f4Mul(y, y)), f4Add(f4Mul(z, z), f4Mul(w, w)));
+	float4 inv_len = f4Div(f4Splat(1), f4Sqrt(len_sq));
+	a.qx = f4Mul(x, inv_len);
+	a.qy = f4Mul(y, inv_len);
+	a.qz = f4Mul(z, inv_len);
+	a.qw = f4Mul(w, inv_len);
+}
+
+
 void Pose::blend(Pose& rhs, float weight)
 {
 	ASSERT(count == rhs.count);
 	if (weight <= 0.001f) return;
 	weight = Math::clamp(weight, 0.0f, 1.0f);
 	float inv = 1.0f - weight;
-	for (int i = 0, c = count; i < c; ++i)
+	float4 inv4 = f4Splat(inv);
+	float4 weight4 = f4Splat(weight);
+	int i = 0;
+	for (int c = count & ~3; i < c; i += 4)
+	{
+		// 4 positions are 3 float4s, lerp does not care which component is which
+		float* lhs_pos = &positions[i].x;
+		const float* rhs_pos = &rhs.positions[i].x;
+		for (int j = 0; j < 12; j += 4)
+		{
+			float4 lerped = f4Add(f4Mul(f4LoadUnaligned(lhs_pos + j), inv4), f4Mul(f4LoadUnaligned(rhs_pos + j), weight4));
+			f4StoreUnaligned(lhs_pos + j, lerped);
+		}
+
+		int indices[] = {i, i + 1, i + 2, i + 3};
+		BoneLanes lhs_lanes;
+		BoneLanes rhs_lanes;
+		loadRotations(rotations, indices, lhs_lanes);
+		loadRotations(rhs.rotations, indices, rhs_lanes);
+		nlerpLanes(lhs_lanes, rhs_lanes, weight);
+		storeRotations(lhs_lanes, indices, rotations);
+	}
+	for (int c = count; i < c; ++i)
 	{
 		positions[i] = positions[i] * inv + rhs.positions[i] * weight;
 		nlerp(rotations[i], rhs.rotations[i], &rotations[i], weight);
@@ -60,29 +198,108 @@ void Pose::resize(int count)
 }
 
 
+static int getLevelCount(const Model& model)
+{
+	return Math::maximum(0, model.getBoneLevels().size() - 1);
+}
+
+
 void Pose::computeAbsolute(Model& model)
+{
+	ASSERT(is_absolute || count == model.getBoneCount());
+	computeAbsolute(model.getBonesByDepth().begin(),
+		model.getBoneLevels().begin(),
+		getLevelCount(model),
+		model.getBoneParents().begin());
+}
+
+
+void Pose::computeRelative(Model& model)
+{
+	ASSERT(!is_absolute || count == model.getBoneCount());
+	computeRelative(model.getBonesByDepth().begin(),
+		model.getBoneLevels().begin(),
+		getLevelCount(model),
+		model.getBoneParents().begin());
+}
+
+
+void Pose::computeAbsolute(const int* bones, const int* levels, int level_count, const int* parents)
 {
 	PROFILE_FUNCTION();
 	if (is_absolute) return;
-	for (int i = model.getFirstNonrootBoneIndex(); i < count; ++i)
+	// bones in one level depend only on bones in previous levels
+	for (int level = 0; level < level_count; ++level)
 	{
-		int parent = model.getBone(i).parent_idx;
-		positions[i] = rotations[parent].rotate(positions[i]) + positions[parent];
-		rotations[i] = rotations[parent] * rotations[i];
+		int j = levels[level];
+		for (int end = levels[level + 1]; j + 4 <= end; j += 4)
+		{
+			const int* indices = &bones[j];
+			int bone_parents[4];
+			for (int k = 0; k < 4; ++k) bone_parents[k] = parents[indices[k]];
+			BoneLanes bone;
+			BoneLanes parent;
+			loadPositions(positions, indices, bone);
+			loadRotations(rotations, indices, bone);
+			loadPositions(positions, bone_parents, parent);
+			loadRotations(rotations, bone_parents, parent);
+			rotate(parent, bone.px, bone.py, bone.pz, &bone.px, &bone.py, &bone.pz);
+			bone.px = f4Add(bone.px, parent.px);
+			bone.py = f4Add(bone.py, parent.py);
+			bone.pz = f4Add(bone.pz, parent.pz);
+			multiply(parent, bone, &bone);
+			storePositions(bone, indices, positions);
+			storeRotations(bone, indices, rotations);
+		}
+		for (int end = levels[level + 1]; j < end; ++j)
+		{
+			int i = bones[j];
+			int parent = parents[i];
+			positions[i] = rotations[parent].rotate(positions[i]) + positions[parent];
+			rotations[i] = rotations[parent] * rotations[i];
+		}
 	}
 	is_absolute = true;
 }
 
 
-void Pose::computeRelative(Model& model)
+void Pose::computeRelative(const int* bones, const int* levels, int level_count, const int* parents)
 {
 	PROFILE_FUNCTION();
 	if (!is_absolute) return;
-	for (int i = count - 1; i >= model.getFirstNonrootBoneIndex(); --i)
+	// deepest level first, so parents are still absolute when their children are processed
+	for (int level = level_count - 1; level >= 0; --level)
 	{
-		int parent = model.getBone(i).parent_idx;
-		positions[i] = -rotations[parent].rotate(positions[i] - positions[parent]);
-		rotations[i] = rotations[i] * -rotations[parent];
+		int j = levels[level];
+		for (int end = levels[level + 1]; j + 4 <= end; j += 4)
+		{
+			const int* indices = &bones[j];
+			int bone_parents[4];
+			for (int k = 0; k < 4; ++k) bone_parents[k] = parents[indices[k]];
+			BoneLanes bone;
+			BoneLanes parent;
+			loadPositions(positions, indices, bone);
+			loadRotations(rotations, indices, bone);
+			loadPositions(positions, bone_parents, parent);
+			loadRotations(rotations, bone_parents, parent);
+			// same as Quat::conjugated
+			parent.qw = f4Sub(f4Splat(0), parent.qw);
+			float4 x = f4Sub(bone.px, parent.px);
+			float4 y = f4Sub(bone.py, parent.py);
+			float4 z = f4Sub(bone.pz, parent.pz);
+			rotate(parent, x, y, z, &bone.px, &bone.py, &bone.pz);
+			multiply(parent, bone, &bone);
+			storePositions(bone, indices, positions);
+			storeRotations(bone, indices, rotations);
+		}
+		for (int end = levels[level + 1]; j < end; ++j)
+		{
+			int i = bones[j];
+			int parent = parents[i];
+			Quat inv_parent_rot = rotations[parent].conjugated();
+			positions[i] = inv_parent_rot.rotate(positions[i] - positions[parent]);
+			rotations[i] = inv_parent_rot * rotations[i];
+		}
 	}
 	is_absolute = false;
 }
@@ -23,6 +23,10 @@ struct LUMIX_RENDERER_API Pose
 	void resize(int count);
 	void computeAbsolute(Model& model);
 	void computeRelative(Model& model);
+	// skeleton as returned by Model::getBonesByDepth, Model::getBoneLevels and Model::getBoneParents,
+	// levels has level_count + 1 entries
+	void computeAbsolute(const int* bones_by_depth, const int* levels, int level_count, const int* parents);
+	void computeRelative(const int* bones_by_depth, const int* levels, int level_count, const int* parents);
 	void blend(Pose& rhs, float weight);
 
 	IAllocator& allocator;
@@ -2476,6 +2476,12 @@ public:
 	}
 
 
+	Terrain* getTerrain(ComponentHandle cmp) override
+	{
+		return m_terrains[{cmp.index}];
+	}
+
+
 	Vec2 getTerrainResolution(ComponentHandle cmp) override
 	{
 		auto* terrain = m_terrains[{cmp.index}];
@@ -3286,6 +3292,33 @@ public:
 	}
 
 
+	void requestTextureMips(const Frustum& frustum, float viewport_height) override
+	{
+		PROFILE_FUNCTION();
+		TextureManager& texture_manager = m_renderer.getTextureManager();
+		if (!texture_manager.isStreamingEnabled() || frustum.fov <= 0) return;
+
+		float size_multiplier = viewport_height / tanf(frustum.fov * 0.5f);
+		for (auto& subinfos : m_temporary_infos)
+		{
+			for (const ModelInstanceMesh& info : subinfos)
+			{
+				const Sphere& sphere = m_culling_system->getSphere(info.model_instance);
+				float distance = (sphere.position - frustum.position).length() - sphere.radius;
+				distance = Math::maximum(distance, frustum.near_distance);
+				float screen_size = sphere.radius / distance * size_multiplier;
+
+				const Material* material = info.mesh->material;
+				for (int i = 0, c = material->getTextureCount(); i < c; ++i)
+				{
+					Texture* texture = material->getTexture(i);
+					if (texture && texture->is_streamed) texture_manager.requestMip(*texture, screen_size);
+				}
+			}
+		}
+	}
+
+
 	void setCameraSlot(ComponentHandle cmp, const char* slot) override
 	{
 		auto& camera = m_cameras[{cmp.index}];
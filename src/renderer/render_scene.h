@@ -320,6 +320,7 @@ public:
 		const Vec3& lod_ref_point,
 		u64 layer_mask) = 0;
 	virtual void getModelInstanceEntities(const Frustum& frustum, Array<Entity>& entities) = 0;
+	virtual void requestTextureMips(const Frustum& frustum, float viewport_height) = 0;
 	virtual Entity getModelInstanceEntity(ComponentHandle cmp) = 0;
 	virtual ComponentHandle getFirstModelInstance() = 0;
 	virtual ComponentHandle getNextModelInstance(ComponentHandle cmp) = 0;
@@ -349,6 +350,7 @@ public:
 	virtual AABB getTerrainAABB(ComponentHandle cmp) = 0;
 	virtual ComponentHandle getTerrainComponent(Entity entity) = 0;
 	virtual Entity getTerrainEntity(ComponentHandle cmp) = 0;
+	virtual Terrain* getTerrain(ComponentHandle cmp) = 0;
 	virtual Vec2 getTerrainResolution(ComponentHandle cmp) = 0;
 	virtual ComponentHandle getFirstTerrain() = 0;
 	virtual ComponentHandle getNextTerrain(ComponentHandle cmp) = 0;
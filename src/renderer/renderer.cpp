@@ -611,7 +611,10 @@ struct RendererImpl LUMIX_FINAL : public Renderer
 			if (cmd_line_parser.currentEquals("-opengl"))
 			{
 				renderer_type = bgfx::RendererType::OpenGL;
-				break;
+			}
+			else if (cmd_line_parser.currentEquals("-texture_streaming"))
+			{
+				m_texture_manager.enableStreaming(true);
 			}
 		}
 
@@ -756,6 +759,7 @@ struct RendererImpl LUMIX_FINAL : public Renderer
 	void frame(bool capture) override
 	{
 		PROFILE_FUNCTION();
+		m_texture_manager.updateStreaming();
 		bgfx::frame(capture);
 		m_view_counter = 0;
 	}
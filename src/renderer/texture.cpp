@@ -25,6 +25,14 @@ Texture::Texture(const Path& path, ResourceManagerBase& resource_manager, IAlloc
 	, bytes_per_pixel(-1)
 	, depth(-1)
 	, layers(1)
+	, is_streamed(false)
+	, resident_mip(0)
+	, requested_mip(0)
+	, last_request_frame(0)
+	, resident_size(0)
+	, m_handle_changed_cb(_allocator)
+	, m_stream_async_op(FS::FileSystem::INVALID_ASYNC)
+	, m_stream_mip(0)
 {
 	bgfx_flags = 0;
 	is_cubemap = false;
@@ -593,6 +601,107 @@ static bool loadDDSorKTX(Texture& texture, FS::IFile& file)
 }
 
 
+int Texture::getStreamableMipCount(const void* file_data, int size)
+{
+	static const u32 DDSCAPS2_CUBEMAP = 0x200;
+	static const u32 DDSCAPS2_VOLUME = 0x200000;
+	static const int DDS_HEADER_SIZE = 128;
+
+	if (size < DDS_HEADER_SIZE) return 0;
+	const u8* bytes = (const u8*)file_data;
+	if (bytes[0] != 'D' || bytes[1] != 'D' || bytes[2] != 'S' || bytes[3] != ' ') return 0;
+
+	u32 mip_count;
+	u32 caps2;
+	copyMemory(&mip_count, bytes + 28, sizeof(mip_count));
+	copyMemory(&caps2, bytes + 112, sizeof(caps2));
+	if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) return 0;
+	return (int)mip_count;
+}
+
+
+int Texture::computeStreamingMip(int width, int height, int mips, float screen_size)
+{
+	if (mips <= 1) return 0;
+	if (screen_size < 1) return mips - 1;
+
+	float texels_per_pixel = Math::maximum(width, height) / screen_size;
+	int mip = 0;
+	while (texels_per_pixel >= 2 && mip < mips - 1)
+	{
+		texels_per_pixel *= 0.5f;
+		++mip;
+	}
+	return mip;
+}
+
+
+bool Texture::setResidentMip(const void* file_data, int size, int mip)
+{
+	PROFILE_FUNCTION();
+	bgfx::TextureInfo info;
+	const auto* mem = bgfx::copy(file_data, (u32)size);
+	bgfx::TextureHandle new_handle = bgfx::createTexture(mem, bgfx_flags, (u8)mip, &info);
+	if (!bgfx::isValid(new_handle)) return false;
+
+	u32 full_width;
+	u32 full_height;
+	copyMemory(&full_height, (const u8*)file_data + 12, sizeof(full_height));
+	copyMemory(&full_width, (const u8*)file_data + 16, sizeof(full_width));
+	width = (int)full_width;
+	height = (int)full_height;
+	mips = Math::maximum(getStreamableMipCount(file_data, size), 1);
+	depth = info.depth;
+	layers = info.numLayers;
+	is_cubemap = info.cubeMap;
+	resident_mip = Math::minimum(mip, mips - 1);
+
+	bgfx::TextureInfo resident_info;
+	bgfx::calcTextureSize(resident_info,
+		(u16)Math::maximum(width >> resident_mip, 1),
+		(u16)Math::maximum(height >> resident_mip, 1),
+		1,
+		false,
+		mips - resident_mip > 1,
+		1,
+		info.format);
+	resident_size = resident_info.storageSize;
+
+	bgfx::TextureHandle old_handle = handle;
+	handle = new_handle;
+	if (bgfx::isValid(old_handle))
+	{
+		bgfx::destroyTexture(old_handle);
+		m_handle_changed_cb.invoke(*this);
+	}
+	return true;
+}
+
+
+void Texture::streamMip(int mip)
+{
+	if (isStreaming() || mip == resident_mip) return;
+
+	m_stream_mip = mip;
+	FS::FileSystem& fs = m_resource_manager.getOwner().getFileSystem();
+	FS::ReadCallback cb;
+	cb.bind<Texture, &Texture::streamFileLoaded>(this);
+	m_stream_async_op = fs.openAsync(fs.getDefaultDevice(), getPath(), FS::Mode::OPEN_AND_READ, cb);
+}
+
+
+void Texture::streamFileLoaded(FS::IFile& file, bool success)
+{
+	m_stream_async_op = FS::FileSystem::INVALID_ASYNC;
+	if (!success || !isReady() || !is_streamed) return;
+
+	if (!setResidentMip(file.getBuffer(), (int)file.size(), m_stream_mip))
+	{
+		g_log_warning.log("Renderer") << "Failed to stream texture " << getPath();
+	}
+}
+
+
 bool Texture::load(FS::IFile& file)
 {
 	PROFILE_FUNCTION();
@@ -602,7 +711,23 @@ bool Texture::load(FS::IFile& file)
 	bool loaded = false;
 	if (len > 3 && (equalStrings(path + len - 4, ".dds") || equalStrings(path + len - 4, ".ktx")))
 	{
-		loaded = loadDDSorKTX(*this, file);
+		auto& manager = static_cast<TextureManager&>(getResourceManager());
+		int streamable_mips = 0;
+		if (manager.isStreamingEnabled() && data_reference == 0)
+		{
+			streamable_mips = getStreamableMipCount(file.getBuffer(), (int)file.size());
+		}
+		if (streamable_mips > manager.getStreamingLowestMips())
+		{
+			is_streamed = true;
+			loaded = setResidentMip(
+				file.getBuffer(), (int)file.size(), streamable_mips - manager.getStreamingLowestMips());
+			if (loaded) manager.addStreamed(*this);
+		}
+		else
+		{
+			loaded = loadDDSorKTX(*this, file);
+		}
 	}
 	else if (len > 3 && equalStrings(path + len - 4, ".raw"))
 	{
@@ -625,6 +750,19 @@ bool Texture::load(FS::IFile& file)
 
 void Texture::unload(void)
 {
+	if (m_stream_async_op != FS::FileSystem::INVALID_ASYNC)
+	{
+		FS::FileSystem& fs = m_resource_manager.getOwner().getFileSystem();
+		fs.cancelAsync(m_stream_async_op);
+		m_stream_async_op = FS::FileSystem::INVALID_ASYNC;
+	}
+	if (is_streamed)
+	{
+		static_cast<TextureManager&>(getResourceManager()).removeStreamed(*this);
+		is_streamed = false;
+		resident_mip = 0;
+		resident_size = 0;
+	}
 	if (bgfx::isValid(handle))
 	{
 		bgfx::destroyTexture(handle);
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "engine/delegate_list.h"
 #include "engine/resource.h"
 #include <bgfx/bgfx.h>
 
@@ -34,6 +35,9 @@ struct TGAHeader
 
 class LUMIX_RENDERER_API Texture LUMIX_FINAL : public Resource
 {
+	public:
+		typedef DelegateList<void(Texture&)> HandleChangedCallback;
+
 	public:
 		Texture(const Path& path, ResourceManagerBase& resource_manager, IAllocator& allocator);
 		~Texture();
@@ -51,6 +55,13 @@ class LUMIX_RENDERER_API Texture LUMIX_FINAL : public Resource
 		void setFlag(u32 flag, bool value);
 		u32 getPixelNearest(int x, int y) const;
 		u32 getPixel(float x, float y) const;
+		HandleChangedCallback& getHandleChangedCb() { return m_handle_changed_cb; }
+		bool setResidentMip(const void* file_data, int size, int mip);
+		void streamMip(int mip);
+		bool isStreaming() const { return m_stream_async_op != FS::FileSystem::INVALID_ASYNC; }
+
+		static int getStreamableMipCount(const void* file_data, int size);
+		static int computeStreamingMip(int width, int height, int mips, float screen_size);
 
 		static unsigned int compareTGA(FS::IFile* file1, FS::IFile* file2, int difference, IAllocator& allocator);
 		static bool saveTGA(FS::IFile* file,
@@ -75,11 +86,22 @@ class LUMIX_RENDERER_API Texture LUMIX_FINAL : public Resource
 		IAllocator& allocator;
 		int data_reference;
 		Array<u8> data;
+		bool is_streamed;
+		int resident_mip;
+		int requested_mip;
+		u32 last_request_frame;
+		u32 resident_size;
 
 	private:
 		void unload(void) override;
 		bool load(FS::IFile& file) override;
 		bool loadTGA(FS::IFile& file);
+		void streamFileLoaded(FS::IFile& file, bool success);
+
+	private:
+		HandleChangedCallback m_handle_changed_cb;
+		u32 m_stream_async_op;
+		int m_stream_mip;
 };
 
 
@@ -1,17 +1,46 @@
 #include "engine/lumix.h"
 #include "renderer/texture_manager.h"
 
+#include "engine/math_utils.h"
+#include "engine/profiler.h"
 #include "engine/resource.h"
 #include "renderer/texture.h"
+#include <cstdlib>
 
 namespace Lumix
 {
+	static const int MAX_STREAMING_IN_FLIGHT = 8;
+	static const u32 STREAMING_UNSEEN_FRAMES = 60;
+
+
+	static int streamingPriority(const Texture* texture)
+	{
+		return texture->resident_mip - texture->requested_mip;
+	}
+
+
+	static int compareStreamingPriority(const void* a, const void* b)
+	{
+		const Texture* tex_a = *(const Texture**)a;
+		const Texture* tex_b = *(const Texture**)b;
+		int diff = streamingPriority(tex_b) - streamingPriority(tex_a);
+		if (diff != 0) return diff;
+		return tex_a->requested_mip - tex_b->requested_mip;
+	}
+
+
 	TextureManager::TextureManager(IAllocator& allocator)
 		: ResourceManagerBase(allocator)
 		, m_allocator(allocator)
+		, m_streamed(allocator)
+		, m_is_streaming_enabled(false)
+		, m_streaming_budget(256 * 1024 * 1024)
+		, m_streaming_lowest_mips(4)
+		, m_frame(1)
 	{
 		m_buffer = nullptr;
 		m_buffer_size = -1;
+		m_streaming_stats = {};
 	}
 
 
@@ -46,4 +75,105 @@ namespace Lumix
 		}
 		return m_buffer;
 	}
-}
\ No newline at end of file
+
+
+	void TextureManager::addStreamed(Texture& texture)
+	{
+		texture.requested_mip = texture.resident_mip;
+		texture.last_request_frame = m_frame;
+		m_streamed.push(&texture);
+	}
+
+
+	void TextureManager::removeStreamed(Texture& texture)
+	{
+		m_streamed.eraseItemFast(&texture);
+	}
+
+
+	void TextureManager::requestMip(Texture& texture, float screen_size)
+	{
+		if (!texture.is_streamed) return;
+
+		int mip = Texture::computeStreamingMip(texture.width, texture.height, texture.mips, screen_size);
+		if (texture.last_request_frame != m_frame)
+		{
+			texture.last_request_frame = m_frame;
+			texture.requested_mip = mip;
+		}
+		else
+		{
+			texture.requested_mip = Math::minimum(texture.requested_mip, mip);
+		}
+	}
+
+
+	void TextureManager::collectStreamingRequests(Array<Texture*>& requests)
+	{
+		for (Texture* texture : m_streamed)
+		{
+			if (texture->isStreaming()) continue;
+			if (texture->last_request_frame != m_frame) continue;
+			if (texture->requested_mip >= texture->resident_mip) continue;
+			requests.push(texture);
+		}
+
+		if (!requests.empty())
+		{
+			qsort(&requests[0], requests.size(), sizeof(requests[0]), compareStreamingPriority);
+		}
+	}
+
+
+	void TextureManager::updateStreaming()
+	{
+		PROFILE_FUNCTION();
+		m_streaming_stats.streamed_count = m_streamed.size();
+		m_streaming_stats.in_flight_count = 0;
+		m_streaming_stats.resident_size = 0;
+
+		int in_flight = 0;
+		u32 resident_size = 0;
+		for (Texture* texture : m_streamed)
+		{
+			resident_size += texture->resident_size;
+			if (texture->isStreaming()) ++in_flight;
+		}
+
+		if (m_is_streaming_enabled)
+		{
+			// textures nobody asked for in a while give their high mips back when over budget
+			for (int i = 0, c = m_streamed.size(); i < c && resident_size > m_streaming_budget; ++i)
+			{
+				if (in_flight >= MAX_STREAMING_IN_FLIGHT) break;
+				Texture* texture = m_streamed[i];
+				if (texture->isStreaming() || !texture->isReady()) continue;
+				if (m_frame - texture->last_request_frame < STREAMING_UNSEEN_FRAMES) continue;
+				int lowest_mip = Math::maximum(texture->mips - m_streaming_lowest_mips, 0);
+				if (texture->resident_mip >= lowest_mip) continue;
+
+				u32 lowest_size = texture->resident_size >> (2 * (lowest_mip - texture->resident_mip));
+				resident_size -= texture->resident_size - lowest_size;
+				texture->streamMip(lowest_mip);
+				++in_flight;
+			}
+
+			Array<Texture*> requests(m_allocator);
+			collectStreamingRequests(requests);
+			for (Texture* texture : requests)
+			{
+				if (in_flight >= MAX_STREAMING_IN_FLIGHT) break;
+				u32 new_size = texture->resident_size << (2 * streamingPriority(texture));
+				if (resident_size + new_size - texture->resident_size > m_streaming_budget) continue;
+
+				resident_size += new_size - texture->resident_size;
+				texture->streamMip(texture->requested_mip);
+				++in_flight;
+			}
+		}
+
+		m_streaming_stats.in_flight_count = in_flight;
+		m_streaming_stats.resident_size = resident_size;
+		++m_frame;
+	}
+}
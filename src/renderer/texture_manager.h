@@ -1,17 +1,42 @@
 #pragma once
 
+#include "engine/array.h"
 #include "engine/resource_manager_base.h"
 
 namespace Lumix
 {
+	class Texture;
+
 	class LUMIX_RENDERER_API TextureManager LUMIX_FINAL : public ResourceManagerBase
 	{
+	public:
+		struct StreamingStats
+		{
+			int streamed_count;
+			int in_flight_count;
+			u32 resident_size;
+		};
+
 	public:
 		explicit TextureManager(IAllocator& allocator);
 		~TextureManager();
 
 		u8* getBuffer(i32 size);
 
+		void enableStreaming(bool enable) { m_is_streaming_enabled = enable; }
+		bool isStreamingEnabled() const { return m_is_streaming_enabled; }
+		void setStreamingBudget(u32 bytes) { m_streaming_budget = bytes; }
+		u32 getStreamingBudget() const { return m_streaming_budget; }
+		void setStreamingLowestMips(int count) { m_streaming_lowest_mips = count; }
+		int getStreamingLowestMips() const { return m_streaming_lowest_mips; }
+		void requestMip(Texture& texture, float screen_size);
+		void collectStreamingRequests(Array<Texture*>& requests);
+		void updateStreaming();
+		const StreamingStats& getStreamingStats() const { return m_streaming_stats; }
+
+		void addStreamed(Texture& texture);
+		void removeStreamed(Texture& texture);
+
 	protected:
 		Resource* createResource(const Path& path) override;
 		void destroyResource(Resource& resource) override;
@@ -20,5 +45,11 @@ namespace Lumix
 		IAllocator& m_allocator;
 		u8* m_buffer;
 		i32 m_buffer_size;
+		Array<Texture*> m_streamed;
+		bool m_is_streaming_enabled;
+		u32 m_streaming_budget;
+		int m_streaming_lowest_mips;
+		u32 m_frame;
+		StreamingStats m_streaming_stats;
 	};
-}
\ No newline at end of file
+}
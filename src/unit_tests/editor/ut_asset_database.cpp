@@ -0,0 +1,193 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "editor/asset_database.h"
+#include "engine/default_allocator.h"
+#include "engine/fs/os_file.h"
+#include "engine/path_utils.h"
+#include "engine/string.h"
+#include "unit_tests/suite/temp_dir.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const ResourceType MODEL_TYPE("model");
+	const ResourceType TEXTURE_TYPE("texture");
+
+
+	ResourceType resolveType(const char* path)
+	{
+		char ext[10];
+		PathUtils::getExtension(ext, lengthOf(ext), path);
+		if (equalStrings(ext, "msh")) return MODEL_TYPE;
+		if (equalStrings(ext, "tga")) return TEXTURE_TYPE;
+		return INVALID_RESOURCE_TYPE;
+	}
+
+
+	void addAssets(AssetDatabase& db, const char* const* paths, int count)
+	{
+		// the files do not exist, so they are added with zero time and hash
+		for (int i = 0; i < count; ++i) db.refresh(Path(paths[i]), paths[i]);
+	}
+
+
+	bool contains(const Array<Path>& paths, const char* path)
+	{
+		for (const Path& p : paths)
+		{
+			if (p == Path(path)) return true;
+		}
+		return false;
+	}
+
+
+	void UT_asset_database_find(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+		AssetDatabase db(allocator);
+		db.getTypeResolver().bind<resolveType>();
+
+		const char* paths[] = {"models/a.msh", "models/a.tga", "models/b.msh", "models_x/c.msh", "textures/d.tga"};
+		addAssets(db, paths, lengthOf(paths));
+
+		Array<Path> found(allocator);
+		db.findAssets(MODEL_TYPE, "models/", found);
+		LUMIX_EXPECT(found.size() == 2);
+		LUMIX_EXPECT(contains(found, "models/a.msh"));
+		LUMIX_EXPECT(contains(found, "models/b.msh"));
+
+		found.clear();
+		db.findAssets(INVALID_RESOURCE_TYPE, "Models", found);
+		LUMIX_EXPECT(found.size() == 4);
+
+		found.clear();
+		db.findAssets(TEXTURE_TYPE, "", found);
+		LUMIX_EXPECT(found.size() == 2);
+
+		// the sorted index is rebuilt after changes
+		const char* added[] = {"models/0.msh"};
+		addAssets(db, added, lengthOf(added));
+		db.remove(Path("models/b.msh"));
+		found.clear();
+		db.findAssets(MODEL_TYPE, "models/", found);
+		LUMIX_EXPECT(found.size() == 2);
+		LUMIX_EXPECT(contains(found, "models/0.msh"));
+		LUMIX_EXPECT(contains(found, "models/a.msh"));
+
+		found.clear();
+		db.findAssets(MODEL_TYPE, "missing/", found);
+		LUMIX_EXPECT(found.empty());
+	}
+
+
+	void UT_asset_database_dependencies(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+		AssetDatabase db(allocator);
+
+		const char* paths[] = {"a.mat", "b.mat", "c.tga", "d.tga"};
+		addAssets(db, paths, lengthOf(paths));
+		Path a_deps[] = {Path("c.tga"), Path("d.tga")};
+		Path b_deps[] = {Path("c.tga")};
+		db.setDependencies(Path("a.mat"), a_deps, lengthOf(a_deps));
+		db.setDependencies(Path("b.mat"), b_deps, lengthOf(b_deps));
+
+		Array<Path> out(allocator);
+		db.getDependencies(Path("a.mat"), out);
+		LUMIX_EXPECT(out.size() == 2);
+
+		out.clear();
+		db.getDependents(Path("c.tga"), out);
+		LUMIX_EXPECT(out.size() == 2);
+		LUMIX_EXPECT(contains(out, "a.mat"));
+		LUMIX_EXPECT(contains(out, "b.mat"));
+
+		db.setDependencies(Path("a.mat"), b_deps, lengthOf(b_deps));
+		out.clear();
+		db.getDependents(Path("d.tga"), out);
+		LUMIX_EXPECT(out.empty());
+
+		db.remove(Path("b.mat"));
+		out.clear();
+		db.getDependents(Path("c.tga"), out);
+		LUMIX_EXPECT(out.size() == 1);
+		LUMIX_EXPECT(contains(out, "a.mat"));
+	}
+
+
+	bool writeFile(const char* path, const void* data, int size, IAllocator& allocator)
+	{
+		FS::OsFile file;
+		if (!file.open(path, FS::Mode::CREATE_AND_WRITE, allocator)) return false;
+		bool success = file.write(data, size);
+		file.close();
+		return success;
+	}
+
+
+	void UT_asset_database_load(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+		UnitTest::TempDir dir("asset_database");
+		LUMIX_EXPECT(dir.isValid());
+		char db_path[MAX_PATH_LENGTH];
+		dir.getFilePath("asset_database.bin", db_path, lengthOf(db_path));
+
+		AssetDatabase db(allocator);
+		const char* paths[] = {"a.mat", "b.tga"};
+		addAssets(db, paths, lengthOf(paths));
+		Path deps[] = {Path("b.tga")};
+		db.setDependencies(Path("a.mat"), deps, lengthOf(deps));
+		LUMIX_EXPECT(db.save(db_path));
+
+		AssetDatabase loaded(allocator);
+		LUMIX_EXPECT(loaded.load(db_path));
+		LUMIX_EXPECT(loaded.getAssetCount() == 2);
+		LUMIX_EXPECT(loaded.getAsset(Path("b.tga")) != nullptr);
+		Array<Path> out(allocator);
+		loaded.getDependents(Path("b.tga"), out);
+		LUMIX_EXPECT(out.size() == 1);
+
+		FS::OsFile file;
+		LUMIX_EXPECT(file.open(db_path, FS::Mode::OPEN_AND_READ, allocator));
+		Array<u8> data(allocator);
+		data.resize((int)file.size());
+		file.read(&data[0], data.size());
+		file.close();
+
+		// truncated index
+		LUMIX_EXPECT(writeFile(db_path, &data[0], data.size() - 3, allocator));
+		LUMIX_EXPECT(!loaded.load(db_path));
+		LUMIX_EXPECT(loaded.getAssetCount() == 0);
+
+		// asset count larger than the file
+		const int COUNT_OFFSET = sizeof(u32) + sizeof(i32);
+		i32 huge_count = 0x7fffffff;
+		copyMemory(&data[COUNT_OFFSET], &huge_count, sizeof(huge_count));
+		LUMIX_EXPECT(writeFile(db_path, &data[0], data.size(), allocator));
+		LUMIX_EXPECT(!loaded.load(db_path));
+		LUMIX_EXPECT(loaded.getAssetCount() == 0);
+
+		// path size larger than the file
+		huge_count = 2;
+		copyMemory(&data[COUNT_OFFSET], &huge_count, sizeof(huge_count));
+		i32 huge_size = 0x7fffffff;
+		copyMemory(&data[COUNT_OFFSET + sizeof(i32)], &huge_size, sizeof(huge_size));
+		LUMIX_EXPECT(writeFile(db_path, &data[0], data.size(), allocator));
+		LUMIX_EXPECT(!loaded.load(db_path));
+		LUMIX_EXPECT(loaded.getAssetCount() == 0);
+
+		FS::OsFile::deleteFile(db_path);
+	}
+}
+
+
+REGISTER_TEST("unit_tests/editor/asset_database/find", UT_asset_database_find, "");
+REGISTER_TEST("unit_tests/editor/asset_database/dependencies", UT_asset_database_dependencies, "");
+REGISTER_TEST("unit_tests/editor/asset_database/load", UT_asset_database_load, "");
@@ -1,4 +1,7 @@
 #include "unit_tests/suite/lumix_unit_tests.h"
+#include "engine/mt/atomic.h"
+#include "engine/mtjd/generic_job.h"
+#include "engine/mtjd/group.h"
 #include "engine/mtjd/job.h"
 #include "engine/mtjd/manager.h"
 
@@ -195,5 +198,32 @@ void UT_MTJDFrameworkDependencyTest(const char* params)
 	allocator.deallocate(jobs);
 }
 
+void UT_MTJDRunBatchesTest(const char* params)
+{
+	DefaultAllocator allocator;
+	MTJD::Manager* manager = MTJD::Manager::create(allocator);
+	MTJD::Group sync_point(true, allocator);
+
+	static const int BATCH_SIZE = 64;
+	static i32 visits[BUFFER_SIZE];
+	int counts[] = {0, 1, BATCH_SIZE, BATCH_SIZE + 1, BATCH_SIZE * 10, BUFFER_SIZE};
+	for (int count : counts)
+	{
+		for (int i = 0; i < BUFFER_SIZE; ++i) visits[i] = 0;
+		volatile i32 calls = 0;
+		auto f = [&calls](int from, int to) {
+			for (int i = from; i < to; ++i) MT::atomicIncrement(&visits[i]);
+			MT::atomicIncrement(&calls);
+		};
+		MTJD::runBatches(*manager, sync_point, count, BATCH_SIZE, f, allocator);
+
+		for (int i = 0; i < BUFFER_SIZE; ++i) LUMIX_EXPECT(visits[i] == (i < count ? 1 : 0));
+		LUMIX_EXPECT(calls == (count <= BATCH_SIZE ? 1 : (count + BATCH_SIZE - 1) / BATCH_SIZE));
+	}
+
+	MTJD::Manager::destroy(*manager);
+}
+
 REGISTER_TEST("unit_tests/engine/mtjd/frameworkTest", UT_MTJDFrameworkTest, "")
 REGISTER_TEST("unit_tests/engine/mtjd/frameworkDependencyTest", UT_MTJDFrameworkDependencyTest, "")
+REGISTER_TEST("unit_tests/engine/mtjd/runBatches", UT_MTJDRunBatchesTest, "")
@@ -0,0 +1,103 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "engine/blob.h"
+#include "engine/property_descriptor.h"
+#include "engine/vec.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+
+
+struct TestScene : public IScene
+{
+	ComponentHandle createComponent(ComponentType, Entity) override { return INVALID_COMPONENT; }
+	void destroyComponent(ComponentHandle component, ComponentType type) override {}
+	void serialize(OutputBlob& serializer) override {}
+	void deserialize(InputBlob& serializer) override {}
+	IPlugin& getPlugin() const override { return *plugin; }
+	void update(float time_delta, bool paused) override {}
+	ComponentHandle getComponent(Entity entity, ComponentType type) override { return INVALID_COMPONENT; }
+	Universe& getUniverse() override { return *universe; }
+	void clear() override {}
+
+	float getDecimal(ComponentHandle cmp) { return decimal[cmp.index]; }
+	void setDecimal(ComponentHandle cmp, float value) { decimal[cmp.index] = value; }
+	float getArrayDecimal(ComponentHandle cmp, int index) { return decimal[index]; }
+	void setArrayDecimal(ComponentHandle cmp, int index, float value) { decimal[index] = value; }
+	bool getBool(ComponentHandle cmp) { return boolean; }
+	void setBool(ComponentHandle cmp, bool value) { boolean = value; }
+	Vec3 getVec3(ComponentHandle cmp) { return vec3; }
+	void setVec3(ComponentHandle cmp, const Vec3& value) { vec3 = value; }
+	Entity getEntity(ComponentHandle cmp) { return entity; }
+	void setEntity(ComponentHandle cmp, Entity value) { entity = value; }
+
+	IPlugin* plugin = nullptr;
+	Universe* universe = nullptr;
+	float decimal[2];
+	bool boolean;
+	Vec3 vec3;
+	Entity entity;
+};
+
+
+}
+
+
+void UT_property_descriptor_raw(const char* params)
+{
+	TestScene scene;
+	scene.decimal[0] = scene.decimal[1] = 0;
+	scene.boolean = false;
+	scene.vec3.set(0, 0, 0);
+	scene.entity = INVALID_ENTITY;
+	ComponentHandle cmp = {1};
+	ComponentUID cmp_uid(INVALID_ENTITY, {0}, &scene, cmp);
+
+	DecimalPropertyDescriptor<TestScene> decimal_desc(
+		"decimal", &TestScene::getDecimal, &TestScene::setDecimal, 0, 1, 0.1f);
+	float f = 0.5f;
+	decimal_desc.getRawSetter()(decimal_desc, &scene, cmp, &f);
+	LUMIX_EXPECT(scene.decimal[1] == 0.5f);
+	f = 0;
+	decimal_desc.getRawGetter()(decimal_desc, &scene, cmp, &f);
+	LUMIX_EXPECT(f == 0.5f);
+	OutputBlob blob(&f, sizeof(f));
+	decimal_desc.get(cmp_uid, -1, blob);
+	LUMIX_EXPECT(f == 0.5f);
+
+	DecimalPropertyDescriptor<TestScene> array_decimal_desc(
+		"decimal", &TestScene::getArrayDecimal, &TestScene::setArrayDecimal, 0, 1, 0.1f);
+	LUMIX_EXPECT(!array_decimal_desc.getRawGetter());
+	LUMIX_EXPECT(!array_decimal_desc.getRawSetter());
+
+	BoolPropertyDescriptor<TestScene> bool_desc("bool", &TestScene::getBool, &TestScene::setBool);
+	bool b = true;
+	bool_desc.getRawSetter()(bool_desc, &scene, cmp, &b);
+	LUMIX_EXPECT(scene.boolean);
+	b = false;
+	bool_desc.getRawGetter()(bool_desc, &scene, cmp, &b);
+	LUMIX_EXPECT(b);
+
+	SimplePropertyDescriptor<Vec3, TestScene> vec3_desc("vec3", &TestScene::getVec3, &TestScene::setVec3);
+	Vec3 v(1, 2, 3);
+	vec3_desc.getRawSetter()(vec3_desc, &scene, cmp, &v);
+	LUMIX_EXPECT(scene.vec3.y == 2);
+	v.set(0, 0, 0);
+	vec3_desc.getRawGetter()(vec3_desc, &scene, cmp, &v);
+	LUMIX_EXPECT(v.x == 1);
+	LUMIX_EXPECT(v.z == 3);
+
+	EntityPropertyDescriptor<TestScene> entity_desc("entity", &TestScene::getEntity, &TestScene::setEntity);
+	Entity e = {7};
+	entity_desc.getRawSetter()(entity_desc, &scene, cmp, &e);
+	LUMIX_EXPECT(scene.entity.index == 7);
+	e = INVALID_ENTITY;
+	entity_desc.getRawGetter()(entity_desc, &scene, cmp, &e);
+	LUMIX_EXPECT(e.index == 7);
+}
+
+REGISTER_TEST("unit_tests/engine/property_descriptor/raw", UT_property_descriptor_raw, "")
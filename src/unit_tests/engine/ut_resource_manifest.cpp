@@ -0,0 +1,89 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+#include "engine/blob.h"
+#include "engine/path.h"
+#include "engine/resource_manifest.h"
+#include "engine/string.h"
+
+
+using namespace Lumix;
+
+
+void UT_resource_manifest(const char* params)
+{
+	DefaultAllocator allocator;
+	PathManager path_manager(allocator);
+	ResourceManifest manifest(allocator);
+
+	ResourceType model_type("model");
+	ResourceType material_type("material");
+	ResourceType texture_type("texture");
+
+	manifest.add(model_type, Path("models/a.msh"));
+	int prev = manifest.beginDependencies(Path("models/a.msh"));
+	manifest.add(material_type, Path("materials/a.mat"));
+	manifest.add(material_type, Path("materials/a.mat"));
+	int prev2 = manifest.beginDependencies(Path("materials/a.mat"));
+	manifest.add(texture_type, Path("textures/a.dds"));
+	manifest.endDependencies(prev2);
+	manifest.endDependencies(prev);
+	manifest.add(texture_type, Path("textures/b.dds"));
+
+	LUMIX_EXPECT(manifest.getCount() == 4);
+	LUMIX_EXPECT(manifest.getEntry(0).parent == -1);
+	LUMIX_EXPECT(manifest.getEntry(1).parent == 0);
+	LUMIX_EXPECT(manifest.getEntry(2).parent == 1);
+	LUMIX_EXPECT(manifest.getEntry(3).parent == -1);
+	LUMIX_EXPECT(manifest.getEntry(2).type == texture_type);
+
+	OutputBlob blob(allocator);
+	blob.write((u32)ResourceManifest::MAGIC);
+	blob.write((int)0);
+	blob.write((int)2);
+	blob.write(model_type.type);
+	blob.write((int)-1);
+	blob.writeString("models/b.msh");
+	blob.write(material_type.type);
+	blob.write((int)0);
+	blob.writeString("materials/b.mat");
+
+	InputBlob input(blob);
+	LUMIX_EXPECT(manifest.deserialize(input));
+	LUMIX_EXPECT(manifest.getCount() == 2);
+	LUMIX_EXPECT(equalStrings(manifest.getEntry(1).path.c_str(), "materials/b.mat"));
+	LUMIX_EXPECT(manifest.getEntry(1).parent == 0);
+
+	OutputBlob huge_count(allocator);
+	huge_count.write((u32)ResourceManifest::MAGIC);
+	huge_count.write((int)0);
+	huge_count.write((int)0x7fffffff);
+	huge_count.write(model_type.type);
+	huge_count.write((int)-1);
+	huge_count.writeString("models/c.msh");
+	InputBlob huge_count_input(huge_count);
+	LUMIX_EXPECT(!manifest.deserialize(huge_count_input));
+	LUMIX_EXPECT(manifest.getCount() == 0);
+
+	OutputBlob truncated(allocator);
+	truncated.write(blob.getData(), blob.getPos() - 4);
+	InputBlob truncated_input(truncated);
+	LUMIX_EXPECT(!manifest.deserialize(truncated_input));
+	LUMIX_EXPECT(manifest.getCount() == 0);
+
+	OutputBlob huge_path(allocator);
+	huge_path.write((u32)ResourceManifest::MAGIC);
+	huge_path.write((int)0);
+	huge_path.write((int)1);
+	huge_path.write(model_type.type);
+	huge_path.write((int)-1);
+	huge_path.write((i32)(MAX_PATH_LENGTH + 1));
+	for (int i = 0; i < MAX_PATH_LENGTH + 1; ++i) huge_path.write('a');
+	InputBlob huge_path_input(huge_path);
+	LUMIX_EXPECT(!manifest.deserialize(huge_path_input));
+	LUMIX_EXPECT(manifest.getCount() == 0);
+
+	char path[MAX_PATH_LENGTH];
+	ResourceManifest::getPath(path, lengthOf(path), "universes/level.unv");
+	LUMIX_EXPECT(equalStrings(path, "universes/level.lpm"));
+}
+
+REGISTER_TEST("unit_tests/engine/resource_manifest", UT_resource_manifest, "")
@@ -152,6 +152,54 @@ void UT_simd_min_max(const char* params)
 }
 
 
+void UT_simd_transpose(const char* params)
+{
+	float4 a = f4Load(c0);
+	float4 b = f4Load(c1);
+	float4 c = f4Load(c2);
+	float4 d = f4Load(c3);
+	f4Transpose(a, b, c, d);
+
+	float LUMIX_ALIGN_BEGIN(16) tmp[4] LUMIX_ALIGN_END(16);
+	float LUMIX_ALIGN_BEGIN(16) expected[4] LUMIX_ALIGN_END(16) = { c0[1], c1[1], c2[1], c3[1] };
+	f4Store(tmp, b);
+	LUMIX_EXPECT_FLOAT4_EQUAL(tmp, expected);
+
+	f4Transpose(a, b, c, d);
+	f4StoreUnaligned(tmp, d);
+	LUMIX_EXPECT_FLOAT4_EQUAL(tmp, c3);
+}
+
+
+void UT_simd_int(const char* params)
+{
+	const u8 bytes[4] = { 0, 1, 200, 255 };
+	const u16 words[4] = { 0, 300, 40000, 65535 };
+	const i32 ints[16] = { 0, 1, 2, 3, 10, 11, 12, 13, 20, 21, 22, 23, 30, 31, 32, 33 };
+	i32 tmp[4];
+
+	i4StoreUnaligned(tmp, i4LoadU8(bytes));
+	for (int i = 0; i < 4; ++i) LUMIX_EXPECT(tmp[i] == bytes[i]);
+
+	int4 a = i4Add(i4LoadU16(words), i4Splat(-0x7fff));
+	i4StoreUnaligned(tmp, i4Or(i4And(a, i4Splat(0xffff)), i4Splat(0x10000)));
+	for (int i = 0; i < 4; ++i)
+	{
+		LUMIX_EXPECT(tmp[i] == (((words[i] - 0x7fff) & 0xffff) | 0x10000));
+	}
+
+	a = i4LoadUnaligned(ints);
+	int4 b = i4LoadUnaligned(ints + 4);
+	int4 c = i4LoadUnaligned(ints + 8);
+	int4 d = i4LoadUnaligned(ints + 12);
+	i4Transpose(a, b, c, d);
+	i4StoreUnaligned(tmp, c);
+	for (int i = 0; i < 4; ++i) LUMIX_EXPECT(tmp[i] == ints[i * 4 + 2]);
+	i4StoreUnaligned(tmp, d);
+	for (int i = 0; i < 4; ++i) LUMIX_EXPECT(tmp[i] == ints[i * 4 + 3]);
+}
+
+
 REGISTER_TEST("unit_tests/engine/simd/load_store", UT_simd_load_store, "")
 REGISTER_TEST("unit_tests/engine/simd/add", UT_simd_add, "")
 REGISTER_TEST("unit_tests/engine/simd/sub", UT_simd_sub, "")
@@ -161,3 +209,5 @@ REGISTER_TEST("unit_tests/engine/simd/rcp", UT_simd_rcp, "")
 REGISTER_TEST("unit_tests/engine/simd/sqrt", UT_simd_sqrt, "")
 REGISTER_TEST("unit_tests/engine/simd/rsqrt", UT_simd_rsqrt, "")
 REGISTER_TEST("unit_tests/engine/simd/min_max", UT_simd_min_max, "")
+REGISTER_TEST("unit_tests/engine/simd/transpose", UT_simd_transpose, "")
+REGISTER_TEST("unit_tests/engine/simd/int", UT_simd_int, "")
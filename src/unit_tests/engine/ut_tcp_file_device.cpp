@@ -0,0 +1,209 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "engine/array.h"
+#include "engine/fs/file_system.h"
+#include "engine/fs/os_file.h"
+#include "engine/fs/tcp_file_device.h"
+#include "engine/fs/tcp_file_server.h"
+#include "engine/log.h"
+#include "engine/lz.h"
+#include "engine/mt/thread.h"
+#include "engine/network.h"
+#include "engine/path.h"
+#include "engine/string.h"
+#include "engine/timer.h"
+#include "unit_tests/suite/temp_dir.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const int FILE_COUNT = 10000;
+	const u16 PORT = 10021;
+
+
+	void getTestFilePath(char* out, int max_size, int index)
+	{
+		char tmp[16];
+		toCString(index, tmp, lengthOf(tmp));
+		copyString(out, max_size, "tcp_file_test_");
+		catString(out, max_size, tmp);
+		catString(out, max_size, ".tmp");
+	}
+
+
+	void getTestFileContent(char* out, int max_size, int index)
+	{
+		copyString(out, max_size, "");
+		for (int i = 0; i < 8; ++i)
+		{
+			char tmp[16];
+			toCString(index, tmp, lengthOf(tmp));
+			catString(out, max_size, "content of file ");
+			catString(out, max_size, tmp);
+			catString(out, max_size, "\n");
+		}
+	}
+
+
+	bool checkFile(FS::TCPFileDevice& device, const Path& path, int index)
+	{
+		char content[512];
+		getTestFileContent(content, lengthOf(content), index);
+
+		FS::IFile* file = device.createFile(nullptr);
+		bool ok = file->open(path, FS::Mode::OPEN_AND_READ);
+		ok = ok && file->size() == (size_t)stringLength(content);
+		ok = ok && compareStringN((const char*)file->getBuffer(), content, stringLength(content)) == 0;
+		file->close();
+		device.destroyFile(file);
+		return ok;
+	}
+
+
+	struct AsyncReadCounter
+	{
+		void onLoaded(FS::IFile& file, bool success)
+		{
+			++loaded_count;
+			if (!success) return;
+			++success_count;
+			size += file.size();
+		}
+
+		int loaded_count = 0;
+		int success_count = 0;
+		u64 size = 0;
+	};
+
+
+	void logThroughput(const char* name, float time, u64 bytes)
+	{
+		g_log_info.log("unit") << name << ": " << FILE_COUNT / time << " files/s, "
+							   << bytes / time / (1024 * 1024) << " MB/s";
+	}
+
+
+	void UT_lz(const char* params)
+	{
+		DefaultAllocator allocator;
+		Array<u8> src(allocator);
+		for (int i = 0; i < 5000; ++i) src.push(u8(i % 7 == 0 ? i * 31 : i / 100));
+
+		Array<u8> packed(allocator);
+		packed.resize(lzCompressBound(src.size()));
+		int packed_size = lzCompress(&src[0], src.size(), &packed[0], packed.size());
+		LUMIX_EXPECT(packed_size > 0);
+		LUMIX_EXPECT(packed_size < src.size());
+
+		Array<u8> unpacked(allocator);
+		unpacked.resize(src.size());
+		LUMIX_EXPECT(lzDecompress(&packed[0], packed_size, &unpacked[0], unpacked.size()));
+		LUMIX_EXPECT(compareMemory(&src[0], &unpacked[0], src.size()) == 0);
+		LUMIX_EXPECT(!lzDecompress(&packed[0], packed_size - 1, &unpacked[0], unpacked.size()));
+		LUMIX_EXPECT(lzCompress(&src[0], src.size(), &packed[0], 16) == 0);
+	}
+
+
+	void UT_tcp_file_device(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+		UnitTest::TempDir dir("tcp_file_device");
+		LUMIX_EXPECT(dir.isValid());
+
+		// the server serves the temporary directory, the device uses paths relative to it
+		Array<Path> paths(allocator);
+		u64 total_size = 0;
+		for (int i = 0; i < FILE_COUNT; ++i)
+		{
+			char path[MAX_PATH_LENGTH];
+			char full_path[MAX_PATH_LENGTH];
+			char content[512];
+			getTestFilePath(path, lengthOf(path), i);
+			dir.getFilePath(path, full_path, lengthOf(full_path));
+			getTestFileContent(content, lengthOf(content), i);
+			FS::OsFile file;
+			LUMIX_EXPECT(file.open(full_path, FS::Mode::CREATE_AND_WRITE, allocator));
+			file.write(content, stringLength(content));
+			file.close();
+			paths.emplace(path);
+			total_size += stringLength(content);
+		}
+
+		FS::TCPFileServer server;
+		server.start(dir.path, allocator, PORT, 2);
+		FS::TCPFileDevice device;
+		device.connect("127.0.0.1", PORT, allocator);
+		LUMIX_EXPECT(device.isConnected());
+
+		FS::IFile* file = device.createFile(nullptr);
+		Path written_path("tcp_file_test_written.tmp");
+		LUMIX_EXPECT(file->open(written_path, FS::Mode::CREATE_AND_WRITE));
+		file->write("written", 7);
+		file->close();
+		LUMIX_EXPECT(file->open(written_path, FS::Mode::OPEN_AND_READ));
+		LUMIX_EXPECT(file->size() == 7);
+		LUMIX_EXPECT(compareStringN((const char*)file->getBuffer(), "written", 7) == 0);
+		file->close();
+		LUMIX_EXPECT(!file->open(Path("tcp_file_test_missing.tmp"), FS::Mode::OPEN_AND_READ));
+		device.destroyFile(file);
+		char full_path[MAX_PATH_LENGTH];
+		dir.getFilePath(written_path.c_str(), full_path, lengthOf(full_path));
+		FS::OsFile::deleteFile(full_path);
+
+		Timer* timer = Timer::create(allocator);
+		bool all_ok = true;
+		for (int i = 0; i < FILE_COUNT; ++i) all_ok = checkFile(device, paths[i], i) && all_ok;
+		logThroughput("TCP file device, one request per file", timer->tick(), total_size);
+		LUMIX_EXPECT(all_ok);
+
+		device.setCompression(true);
+		device.prefetch(&paths[0], paths.size());
+		all_ok = true;
+		for (int i = 0; i < FILE_COUNT; ++i) all_ok = checkFile(device, paths[i], i) && all_ok;
+		logThroughput("TCP file device, batched and compressed", timer->tick(), total_size);
+		LUMIX_EXPECT(all_ok);
+
+		// async opens of the file system are pipelined
+		FS::FileSystem* fs = FS::FileSystem::create(allocator);
+		fs->mount(&device);
+		fs->setDefaultDevice("tcp");
+		AsyncReadCounter counter;
+		FS::ReadCallback callback;
+		callback.bind<AsyncReadCounter, &AsyncReadCounter::onLoaded>(&counter);
+		timer->tick();
+		for (const Path& path : paths) fs->openAsync(fs->getDefaultDevice(), path, FS::Mode::OPEN_AND_READ, callback);
+		while (counter.loaded_count < FILE_COUNT || fs->hasWork()) fs->updateAsyncTransactions();
+		logThroughput("TCP file device, async file system", timer->tick(), total_size);
+		LUMIX_EXPECT(counter.success_count == FILE_COUNT);
+		LUMIX_EXPECT(counter.size == total_size);
+		fs->unMount(&device);
+		FS::FileSystem::destroy(fs);
+		Timer::destroy(timer);
+
+		// unconsumed prefetched responses are dropped
+		device.prefetch(&paths[0], 100);
+		device.disconnect();
+
+		// the server does not wait for connected clients to disconnect
+		Net::TCPConnector connector(allocator);
+		Net::TCPStream* idle_client = connector.connect("127.0.0.1", PORT);
+		LUMIX_EXPECT(idle_client != nullptr);
+		// give a worker time to start serving the client
+		MT::sleep(100);
+		server.stop();
+		if (idle_client) connector.close(idle_client);
+
+		for (const Path& path : paths)
+		{
+			dir.getFilePath(path.c_str(), full_path, lengthOf(full_path));
+			FS::OsFile::deleteFile(full_path);
+		}
+	}
+}
+
+REGISTER_TEST("unit_tests/engine/lz", UT_lz, "")
+REGISTER_TEST("unit_tests/engine/tcp_file_device", UT_tcp_file_device, "")
@@ -275,6 +275,37 @@ namespace
 			LUMIX_EXPECT_CLOSE_EQ(pos.z, float(i), 0.00001f);
 		}
 	}
+
+
+	void UT_universe_set_transforms(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+		Universe universe(allocator);
+
+		Entity parent = universe.createEntity({0, 0, 0}, {0, 0, 0, 1});
+		Entity child = universe.createEntity({1, 0, 0}, {0, 0, 0, 1});
+		Entity other = universe.createEntity({0, 0, 0}, {0, 0, 0, 1});
+		universe.setParent(parent, child);
+
+		Entity entities[] = {parent, other};
+		Transform transforms[] = {{{0, 5, 0}, {0, 0, 0, 1}}, {{2, 3, 4}, {0, 0, 0, 1}}};
+		universe.setTransforms(entities, transforms, lengthOf(entities));
+
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(parent).y, 5, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(child).x, 1, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(child).y, 5, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(other).x, 2, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(other).z, 4, 0.00001f);
+
+		// child listed before its parent keeps its new transform
+		Entity reversed[] = {child, parent};
+		Transform reversed_transforms[] = {{{3, 0, 0}, {0, 0, 0, 1}}, {{0, 1, 0}, {0, 0, 0, 1}}};
+		universe.setTransforms(reversed, reversed_transforms, lengthOf(reversed));
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(parent).y, 1, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(child).x, 3, 0.00001f);
+		LUMIX_EXPECT_CLOSE_EQ(universe.getPosition(child).y, 0, 0.00001f);
+	}
 } // anonymous namespace
 
 REGISTER_TEST("unit_tests/engine/universe", UT_universe, "");
@@ -282,3 +313,4 @@ REGISTER_TEST("unit_tests/engine/universe/hierarchy", UT_universe_hierarchy, "")
 REGISTER_TEST("unit_tests/engine/universe/hierarchy2", UT_universe_hierarchy2, "");
 REGISTER_TEST("unit_tests/engine/universe/hierarchy3", UT_universe_hierarchy3, "");
 REGISTER_TEST("unit_tests/engine/universe/hierarchy4", UT_universe_hierarchy4, "");
+REGISTER_TEST("unit_tests/engine/universe/set_transforms", UT_universe_set_transforms, "");
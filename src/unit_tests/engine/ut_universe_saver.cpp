@@ -0,0 +1,77 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "engine/blob.h"
+#include "engine/engine.h"
+#include "engine/fs/file_system.h"
+#include "engine/fs/os_file.h"
+#include "engine/path.h"
+#include "engine/universe/universe.h"
+#include "engine/universe_saver.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	bool g_is_saved = false;
+
+
+	void onSaved(const Path& path, bool success)
+	{
+		g_is_saved = success;
+	}
+
+
+	void UT_universe_saver(const char* params)
+	{
+		DefaultAllocator allocator;
+		Engine* engine = Engine::create(".", "", nullptr, allocator);
+		Universe& universe = engine->createUniverse(false);
+		for (int i = 0; i < 1000; ++i) universe.createEntity(Vec3((float)i, 0, 0), Quat(0, 0, 0, 1));
+
+		{
+			UniverseSaver saver(*engine, allocator);
+			OutputBlob& blob = saver.snapshot(universe);
+			blob.write((u32)0xABCD);
+			UniverseSaver::Callback callback;
+			callback.bind<onSaved>();
+			saver.saveAsync(Path("universe_saver_test.unv"), true, callback);
+			universe.destroyEntity(universe.getFirstEntity());
+			saver.wait();
+			LUMIX_EXPECT(g_is_saved);
+			LUMIX_EXPECT(!saver.isSaving());
+		}
+
+		FS::FileSystem& fs = engine->getFileSystem();
+		FS::IFile* file = fs.open(fs.getDefaultDevice(), Path("universe_saver_test.unv"), FS::Mode::OPEN_AND_READ);
+		LUMIX_EXPECT(file != nullptr);
+		OutputBlob data(allocator);
+		file->getContents(data);
+		fs.close(*file);
+		FS::OsFile::deleteFile("universe_saver_test.unv");
+
+		Array<u8> storage(allocator);
+		int payload_size = 0;
+		const u8* payload = UniverseSaver::unpack(data.getData(), data.getPos(), storage, &payload_size);
+		LUMIX_EXPECT(payload != nullptr);
+		LUMIX_EXPECT(!storage.empty());
+
+		Universe& loaded = engine->createUniverse(false);
+		InputBlob input(payload, payload_size);
+		LUMIX_EXPECT(engine->deserialize(loaded, input));
+		u32 tail = 0;
+		input.read(tail);
+		LUMIX_EXPECT(tail == 0xABCD);
+		LUMIX_EXPECT(loaded.getPosition(Entity{999}).x == 999);
+
+		((u8*)data.getMutableData())[data.getPos() - 1] ^= 0xff;
+		LUMIX_EXPECT(UniverseSaver::unpack(data.getData(), data.getPos(), storage, &payload_size) == nullptr);
+
+		engine->destroyUniverse(loaded);
+		engine->destroyUniverse(universe);
+		Engine::destroy(engine, allocator);
+	}
+}
+
+REGISTER_TEST("unit_tests/engine/universe_saver", UT_universe_saver, "")
@@ -0,0 +1,324 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "animation/animation.h"
+#include "engine/engine.h"
+#include "engine/fs/file_system.h"
+#include "engine/fs/os_file.h"
+#include "engine/hash_map.h"
+#include "engine/log.h"
+#include "engine/path.h"
+#include "engine/quat.h"
+#include "engine/timer.h"
+#include "engine/vec.h"
+#include "renderer/pose.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const char* ANIMATION_PATH = "ut_animation_benchmark.ani";
+	const char* QUANTIZED_ANIMATION_PATH = "ut_animation_quantized.ani";
+	const int BONE_COUNT = 60;
+	const int KEY_COUNT = 300;
+	const int CHARACTER_COUNT = 1000;
+	const int FPS = 30;
+
+
+	Vec3 getKeyPosition(int bone, int key) { return Vec3((float)bone, (float)key, (float)(bone * key % 7)); }
+
+
+	bool writeAnimation(IAllocator& allocator, const char* path, bool quantized)
+	{
+		FS::OsFile file;
+		if (!file.open(path, FS::Mode::CREATE_AND_WRITE, allocator)) return false;
+
+		Animation::Header header;
+		header.magic = Animation::HEADER_MAGIC;
+		header.version = quantized ? 4 : 2;
+		header.fps = FPS;
+		file.write(&header, sizeof(header));
+		if (quantized)
+		{
+			int root_motion_bone_idx = -1;
+			file.write(&root_motion_bone_idx, sizeof(root_motion_bone_idx));
+			u32 flags = Animation::QUANTIZED_KEYS;
+			file.write(&flags, sizeof(flags));
+		}
+		int frame_count = KEY_COUNT * 2;
+		file.write(&frame_count, sizeof(frame_count));
+		int bone_count = BONE_COUNT;
+		file.write(&bone_count, sizeof(bone_count));
+		for (int i = 0; i < BONE_COUNT; ++i)
+		{
+			u32 name = i;
+			file.write(&name, sizeof(name));
+			int key_count = KEY_COUNT + 1;
+			file.write(&key_count, sizeof(key_count));
+			for (int j = 0; j <= KEY_COUNT; ++j)
+			{
+				u16 time = u16(j * 2);
+				file.write(&time, sizeof(time));
+			}
+			if (quantized)
+			{
+				Vec3 min(0, 0, 0);
+				Vec3 extent((float)i, (float)KEY_COUNT, 6);
+				file.write(&min, sizeof(min));
+				file.write(&extent, sizeof(extent));
+			}
+			for (int j = 0; j <= KEY_COUNT; ++j)
+			{
+				Vec3 pos = getKeyPosition(i, j);
+				if (quantized)
+				{
+					u16 q[3] = {u16(i > 0 ? 65535 : 0), u16(pos.y / KEY_COUNT * 65535 + 0.5f), u16(pos.z / 6 * 65535 + 0.5f)};
+					file.write(q, sizeof(q));
+				}
+				else
+				{
+					file.write(&pos, sizeof(pos));
+				}
+			}
+			file.write(&key_count, sizeof(key_count));
+			for (int j = 0; j <= KEY_COUNT; ++j)
+			{
+				u16 time = u16(j * 2);
+				file.write(&time, sizeof(time));
+			}
+			for (int j = 0; j <= KEY_COUNT; ++j)
+			{
+				Quat rot(Vec3(0, 1, 0), j * 0.1f + i);
+				if (quantized)
+				{
+					i16 q[4];
+					const float* c = &rot.x;
+					for (int k = 0; k < 4; ++k) q[k] = i16(c[k] * 32767 + (c[k] < 0 ? -0.5f : 0.5f));
+					file.write(q, sizeof(q));
+				}
+				else
+				{
+					file.write(&rot, sizeof(rot));
+				}
+			}
+		}
+		file.close();
+		return true;
+	}
+
+
+	bool arePosesEqual(const Pose& a, const Pose& b)
+	{
+		for (int i = 0; i < a.count; ++i)
+		{
+			if (a.positions[i].x != b.positions[i].x || a.positions[i].y != b.positions[i].y) return false;
+			if (a.rotations[i].x != b.rotations[i].x || a.rotations[i].w != b.rotations[i].w) return false;
+		}
+		return true;
+	}
+
+
+	// sampling as it was done before bone remaps, a bone map lookup and a linear key search for each bone
+	struct LegacyAnimation
+	{
+		explicit LegacyAnimation(IAllocator& allocator)
+			: times(allocator)
+			, positions(allocator)
+			, rotations(allocator)
+			, bone_map(allocator)
+		{
+			for (int j = 0; j <= KEY_COUNT; ++j) times.push(u16(j * 2));
+			for (int i = 0; i < BONE_COUNT; ++i)
+			{
+				for (int j = 0; j <= KEY_COUNT; ++j)
+				{
+					positions.push(getKeyPosition(i, j));
+					rotations.push(Quat(Vec3(0, 1, 0), j * 0.1f + i));
+				}
+				bone_map.insert(i, BONE_COUNT - 1 - i);
+			}
+		}
+
+		void getRelativePose(float time, Pose& pose) const
+		{
+			int frame = (int)(time * FPS);
+			float rcp_fps = 1.0f / FPS;
+			for (int i = 0; i < BONE_COUNT; ++i)
+			{
+				auto iter = bone_map.find(i);
+				if (!iter.isValid()) continue;
+
+				int idx = 1;
+				for (int c = times.size(); idx < c; ++idx)
+				{
+					if (times[idx] > frame) break;
+				}
+				float t = float(time - times[idx - 1] * rcp_fps) / ((times[idx] - times[idx - 1]) * rcp_fps);
+				const Vec3* pos = &positions[i * (KEY_COUNT + 1)];
+				const Quat* rot = &rotations[i * (KEY_COUNT + 1)];
+				lerp(pos[idx - 1], pos[idx], &pose.positions[iter.value()], t);
+				nlerp(rot[idx - 1], rot[idx], &pose.rotations[iter.value()], t);
+			}
+		}
+
+		Array<u16> times;
+		Array<Vec3> positions;
+		Array<Quat> rotations;
+		HashMap<u32, int> bone_map;
+	};
+
+
+	void UT_animation_sampling(const char* params)
+	{
+		DefaultAllocator allocator;
+		LUMIX_EXPECT(writeAnimation(allocator, ANIMATION_PATH, false));
+
+		Engine* engine = Engine::create(".", "", nullptr, allocator);
+		{
+			AnimationManager manager(allocator);
+			manager.create(ResourceType("animation"), engine->getResourceManager());
+			Animation* animation = static_cast<Animation*>(manager.load(Path(ANIMATION_PATH)));
+			while (animation->isEmpty()) engine->getFileSystem().updateAsyncTransactions();
+			LUMIX_EXPECT(animation->isReady());
+
+			int bone_remap[BONE_COUNT];
+			for (int i = 0; i < BONE_COUNT; ++i) bone_remap[i] = BONE_COUNT - 1 - i;
+
+			Pose pose(allocator);
+			Pose reference(allocator);
+			pose.resize(BONE_COUNT);
+			reference.resize(BONE_COUNT);
+
+			LegacyAnimation legacy(allocator);
+			AnimationCursor test_cursor(allocator);
+			bool is_equal = true;
+			float times[] = {0, 0.1f, 0.5f, 0.51f, 3.0f, 0.2f, 19.9f, 19.99f, 0};
+			for (float time : times)
+			{
+				animation->getRelativePose(time, pose, bone_remap);
+				legacy.getRelativePose(time, reference);
+				is_equal = is_equal && arePosesEqual(pose, reference);
+				animation->getRelativePose(time, reference, bone_remap, &test_cursor);
+				is_equal = is_equal && arePosesEqual(pose, reference);
+			}
+			LUMIX_EXPECT(is_equal);
+
+			AnimationPoseCache pose_cache(allocator);
+			pose_cache.setTimeStep(0.25f);
+			for (int i = 0; i < 4; ++i)
+			{
+				float time = 1 + i * 0.25f;
+				pose_cache.getRelativePose(*animation, time, pose, bone_remap);
+				animation->getRelativePose(time, reference, bone_remap);
+				LUMIX_EXPECT(arePosesEqual(pose, reference));
+				pose_cache.getRelativePose(*animation, time, pose, bone_remap, 0.5f);
+				animation->getRelativePose(time, reference, bone_remap, 0.5f);
+				LUMIX_EXPECT(arePosesEqual(pose, reference));
+			}
+			pose_cache.clear();
+			LUMIX_EXPECT(pose_cache.getHitCount() == 4);
+			LUMIX_EXPECT(pose_cache.getMissCount() == 4);
+
+			Transform transform = animation->getBoneTransform(1.0f / FPS, 3);
+			LUMIX_EXPECT_CLOSE_EQ(transform.pos.y, 0.5f, 0.0001f);
+
+			Timer* timer = Timer::create(allocator);
+			for (int frame = 0; frame < 60; ++frame)
+			{
+				for (int i = 0; i < CHARACTER_COUNT; ++i)
+				{
+					float time = (i % 100) * 0.1f + frame / 60.0f;
+					legacy.getRelativePose(time, pose);
+				}
+			}
+			float legacy_time = timer->tick();
+			for (int frame = 0; frame < 60; ++frame)
+			{
+				for (int i = 0; i < CHARACTER_COUNT; ++i)
+				{
+					float time = (i % 100) * 0.1f + frame / 60.0f;
+					animation->getRelativePose(time, pose, bone_remap);
+				}
+			}
+			float remap_time = timer->tick();
+			Array<AnimationCursor> cursors(allocator);
+			cursors.reserve(CHARACTER_COUNT);
+			for (int i = 0; i < CHARACTER_COUNT; ++i) cursors.emplace(allocator);
+			timer->tick();
+			for (int frame = 0; frame < 60; ++frame)
+			{
+				for (int i = 0; i < CHARACTER_COUNT; ++i)
+				{
+					float time = (i % 100) * 0.1f + frame / 60.0f;
+					animation->getRelativePose(time, pose, bone_remap, &cursors[i]);
+				}
+			}
+			float cursor_time = timer->tick();
+			Timer::destroy(timer);
+			g_log_info.log("unit") << CHARACTER_COUNT << " characters x " << BONE_COUNT
+								   << " bones, 60 frames: bone map and linear search " << legacy_time * 1000
+								   << " ms, bone remap and binary search " << remap_time * 1000
+								   << " ms, bone remap and keyframe cursors " << cursor_time * 1000 << " ms";
+
+			manager.unload(*animation);
+			manager.destroy();
+		}
+		Engine::destroy(engine, allocator);
+		FS::OsFile::deleteFile(ANIMATION_PATH);
+	}
+
+	void UT_animation_quantized(const char* params)
+	{
+		DefaultAllocator allocator;
+		LUMIX_EXPECT(writeAnimation(allocator, ANIMATION_PATH, false));
+		LUMIX_EXPECT(writeAnimation(allocator, QUANTIZED_ANIMATION_PATH, true));
+
+		Engine* engine = Engine::create(".", "", nullptr, allocator);
+		{
+			AnimationManager manager(allocator);
+			manager.create(ResourceType("animation"), engine->getResourceManager());
+			Animation* animation = static_cast<Animation*>(manager.load(Path(ANIMATION_PATH)));
+			Animation* quantized = static_cast<Animation*>(manager.load(Path(QUANTIZED_ANIMATION_PATH)));
+			while (animation->isEmpty() || quantized->isEmpty()) engine->getFileSystem().updateAsyncTransactions();
+			LUMIX_EXPECT(animation->isReady());
+			LUMIX_EXPECT(quantized->isReady());
+			// key times stay u16, a position key shrinks from 12 to 6 bytes and a rotation key from 16 to 8 bytes;
+			// the quantized file adds the root motion bone, flags and the position range of each bone
+			const int key_count = KEY_COUNT + 1;
+			const int saved_per_bone = key_count * (sizeof(Vec3) - 3 * sizeof(u16)) +
+									   key_count * (sizeof(Quat) - 4 * sizeof(i16)) - 2 * sizeof(Vec3);
+			const size_t expected_size = animation->size() + 2 * sizeof(u32) - BONE_COUNT * saved_per_bone;
+			LUMIX_EXPECT(quantized->size() == expected_size);
+
+			Pose pose(allocator);
+			Pose reference(allocator);
+			pose.resize(BONE_COUNT);
+			reference.resize(BONE_COUNT);
+			float times[] = {0, 0.1f, 0.5f, 3.0f, 19.9f, 25.0f};
+			for (float time : times)
+			{
+				quantized->getRelativePose(time, pose, (const int*)nullptr);
+				animation->getRelativePose(time, reference, (const int*)nullptr);
+				for (int i = 0; i < BONE_COUNT; ++i)
+				{
+					LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].x, reference.positions[i].x, 0.01f);
+					LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].y, reference.positions[i].y, 0.01f);
+					LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].z, reference.positions[i].z, 0.01f);
+					LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].y, reference.rotations[i].y, 0.001f);
+					LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].w, reference.rotations[i].w, 0.001f);
+				}
+			}
+
+			manager.unload(*animation);
+			manager.unload(*quantized);
+			manager.destroy();
+		}
+		Engine::destroy(engine, allocator);
+		FS::OsFile::deleteFile(ANIMATION_PATH);
+		FS::OsFile::deleteFile(QUANTIZED_ANIMATION_PATH);
+	}
+
+	REGISTER_TEST("unit_tests/graphics/animation/sampling", UT_animation_sampling, "");
+	REGISTER_TEST("unit_tests/graphics/animation/quantized", UT_animation_quantized, "");
+}
@@ -0,0 +1,98 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "animation/animation_lod.h"
+#include "engine/math_utils.h"
+#include "engine/quat.h"
+#include <cmath>
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const float REDUCED_SCREEN_SIZE = 0.2f;
+	const float FROZEN_SCREEN_SIZE = 0.02f;
+
+
+	AnimationLODTier getTier(const AnimationLODView& view, const Vec3& center, float radius)
+	{
+		return getAnimationLODTier(center, radius, view, REDUCED_SCREEN_SIZE, FROZEN_SCREEN_SIZE);
+	}
+
+
+	void UT_animation_lod_tier(const char* params)
+	{
+		AnimationLODView view;
+		view.position.set(0, 0, 0);
+		view.frustum.computePerspective(
+			view.position, Vec3(0, 0, -1), Vec3(0, 1, 0), Math::PI * 0.5f, 1, 0.1f, 1000);
+		view.size_scale = 1 / tanf(Math::PI * 0.25f);
+		view.is_ortho = false;
+
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -0.5f), 1) == AnimationLODTier::FULL);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -2), 1) == AnimationLODTier::FULL);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -10), 1) == AnimationLODTier::REDUCED);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -100), 1) == AnimationLODTier::FROZEN);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -100), 10) == AnimationLODTier::REDUCED);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, 10), 1) == AnimationLODTier::FROZEN);
+		LUMIX_EXPECT(getTier(view, Vec3(100, 0, -10), 1) == AnimationLODTier::FROZEN);
+
+		// ortho frustums face -direction, as for ortho cameras in RenderScene::getCameraFrustum
+		view.frustum.computeOrtho(view.position, Vec3(0, 0, 1), Vec3(0, 1, 0), 20, 20, 0.1f, 1000);
+		view.size_scale = 1 / 10.0f;
+		view.is_ortho = true;
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -100), 5) == AnimationLODTier::FULL);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -100), 1) == AnimationLODTier::REDUCED);
+		LUMIX_EXPECT(getTier(view, Vec3(0, 0, -100), 0.1f) == AnimationLODTier::FROZEN);
+	}
+
+
+	void UT_animation_lod_interpolation(const char* params)
+	{
+		DefaultAllocator allocator;
+		AnimationLODState lod(allocator);
+		lod.interval = 3;
+		lod.accumulated_time = 1;
+		lod.setTier(AnimationLODTier::FROZEN, 0);
+		LUMIX_EXPECT(lod.accumulated_time == 0);
+		lod.setTier(AnimationLODTier::REDUCED, 0);
+
+		Pose pose(allocator);
+		pose.resize(2);
+		// poses are evaluated in frames 0, 1, 4 and 7, frames in between lag behind by up to one interval
+		bool expected_updates[] = {true, true, false, false, true, false, false, true};
+		float expected_x[] = {0, 1 / 3.0f, 2 / 3.0f, 1, 2, 3, 4, 5};
+		for (int frame = 0; frame < lengthOf(expected_x); ++frame)
+		{
+			bool is_update = lod.isUpdateFrame();
+			LUMIX_EXPECT(is_update == expected_updates[frame]);
+			if (is_update)
+			{
+				for (int i = 0; i < pose.count; ++i)
+				{
+					pose.positions[i].set((float)frame, (float)i, 0);
+					pose.rotations[i].set(0, 0, 0, 1);
+				}
+				lod.storePose(pose);
+			}
+			lod.interpolatePose(pose);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[0].x, expected_x[frame], 0.0001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[1].x, expected_x[frame], 0.0001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[1].y, 1, 0.0001f);
+		}
+
+		// instances entering the tier in the same frame with a different phase update in different frames
+		AnimationLODState other(allocator);
+		other.interval = 3;
+		other.setTier(AnimationLODTier::REDUCED, 1);
+		other.isUpdateFrame();
+		other.storePose(pose);
+		LUMIX_EXPECT(!other.isUpdateFrame());
+		LUMIX_EXPECT(other.isUpdateFrame());
+	}
+}
+
+
+REGISTER_TEST("unit_tests/graphics/animation_lod/tier", UT_animation_lod_tier, "");
+REGISTER_TEST("unit_tests/graphics/animation_lod/interpolation", UT_animation_lod_interpolation, "");
@@ -0,0 +1,190 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "animation/condition.h"
+#include "engine/log.h"
+#include "engine/string.h"
+#include "engine/timer.h"
+
+
+using namespace Lumix;
+using namespace Lumix::Anim;
+
+
+namespace
+{
+	const int CONDITION_COUNT = 10000;
+	const int FRAME_COUNT = 60;
+
+
+	struct Inputs
+	{
+		float speed;
+		bool jump;
+		int state;
+	};
+
+
+	const struct
+	{
+		const char* expression;
+		Condition::FastPath fast_path;
+		bool (*reference)(const Inputs&);
+	} EXPRESSIONS[] = {
+		{"speed > 1", Condition::FastPath::TEST, [](const Inputs& i) { return i.speed > 1; }},
+		{"1 < speed", Condition::FastPath::TEST, [](const Inputs& i) { return 1 < i.speed; }},
+		{"speed < 2 * 2 - 3.5", Condition::FastPath::TEST, [](const Inputs& i) { return i.speed < 0.5f; }},
+		{"jump", Condition::FastPath::TEST, [](const Inputs& i) { return i.jump; }},
+		{"not jump", Condition::FastPath::TEST, [](const Inputs& i) { return !i.jump; }},
+		{"state = IDLE", Condition::FastPath::TEST, [](const Inputs& i) { return i.state == 2; }},
+		{"IDLE <> state", Condition::FastPath::TEST, [](const Inputs& i) { return i.state != 2; }},
+		{"speed > 1 and jump", Condition::FastPath::AND, [](const Inputs& i) { return i.speed > 1 && i.jump; }},
+		{"speed < 0.5 or state = IDLE",
+			Condition::FastPath::OR,
+			[](const Inputs& i) { return i.speed < 0.5f || i.state == 2; }},
+		{"jump and true", Condition::FastPath::TEST, [](const Inputs& i) { return i.jump; }},
+		{"true and speed > 1", Condition::FastPath::TEST, [](const Inputs& i) { return i.speed > 1; }},
+		{"false or not jump", Condition::FastPath::TEST, [](const Inputs& i) { return !i.jump; }},
+		{"jump or true", Condition::FastPath::CONSTANT, [](const Inputs& i) { return true; }},
+		{"speed > 1 and 2 < 1", Condition::FastPath::CONSTANT, [](const Inputs& i) { return false; }},
+		{"", Condition::FastPath::CONSTANT, [](const Inputs& i) { return true; }},
+		{"speed * 2 - 1 > speed", Condition::FastPath::NONE, [](const Inputs& i) { return i.speed * 2 - 1 > i.speed; }},
+		{"(speed + 1) * 2 > 3 and not jump",
+			Condition::FastPath::NONE,
+			[](const Inputs& i) { return (i.speed + 1) * 2 > 3 && !i.jump; }}};
+
+
+	void initDecl(InputDecl& decl)
+	{
+		const char* names[] = {"speed", "jump", "state"};
+		InputDecl::Type types[] = {InputDecl::FLOAT, InputDecl::BOOL, InputDecl::INT};
+		for (int i = 0; i < lengthOf(names); ++i)
+		{
+			decl.inputs[i].type = types[i];
+			copyString(decl.inputs[i].name, names[i]);
+		}
+		decl.inputs_count = lengthOf(names);
+		decl.recalculateOffsets();
+
+		decl.constants[0].type = InputDecl::INT;
+		decl.constants[0].i_value = 2;
+		copyString(decl.constants[0].name, "IDLE");
+		decl.constants_count = 1;
+	}
+
+
+	void setInputs(const InputDecl& decl, const Inputs& inputs, u8* data)
+	{
+		*(float*)(data + decl.inputs[0].offset) = inputs.speed;
+		*(bool*)(data + decl.inputs[1].offset) = inputs.jump;
+		*(int*)(data + decl.inputs[2].offset) = inputs.state;
+	}
+
+
+	void UT_condition(const char* params)
+	{
+		DefaultAllocator allocator;
+		InputDecl decl;
+		initDecl(decl);
+		u8 data[64];
+		RunningContext rc = {};
+		rc.input = data;
+
+		Inputs inputs[] = {{0, false, 0}, {0.25f, true, 2}, {1, false, 2}, {3, true, 0}, {3, false, 1}};
+		for (const auto& expr : EXPRESSIONS)
+		{
+			Condition condition(allocator);
+			LUMIX_EXPECT(condition.compile(expr.expression, decl));
+			LUMIX_EXPECT(condition.fast_path == expr.fast_path);
+			for (const Inputs& input : inputs)
+			{
+				setInputs(decl, input, data);
+				bool expected = expr.reference(input);
+				LUMIX_EXPECT(condition(rc) == expected);
+				Condition::FastPath fast_path = condition.fast_path;
+				condition.fast_path = Condition::FastPath::NONE;
+				LUMIX_EXPECT(condition(rc) == expected);
+				condition.fast_path = fast_path;
+			}
+		}
+	}
+
+
+	void UT_condition_optimize_malformed(const char* params)
+	{
+		DefaultAllocator allocator;
+		InputDecl decl;
+		initDecl(decl);
+
+		// input, push, mul, push, sub, input, gt, ret
+		Condition condition(allocator);
+		LUMIX_EXPECT(condition.compile("speed * 2 - 1 > speed", decl));
+		LUMIX_EXPECT(condition.bytecode.size() == 24);
+
+		// the first input becomes a constant, so the optimizer folds the code before it finds the missing ret
+		u8 push_float = condition.bytecode[5];
+		float value = 3;
+		condition.bytecode[0] = push_float;
+		copyMemory(&condition.bytecode[1], &value, sizeof(value));
+		condition.bytecode.pop();
+		Array<u8> original(condition.bytecode);
+
+		condition.optimize();
+		LUMIX_EXPECT(condition.fast_path == Condition::FastPath::NONE);
+		LUMIX_EXPECT(condition.bytecode.size() == original.size());
+		LUMIX_EXPECT(compareMemory(&condition.bytecode[0], &original[0], original.size()) == 0);
+	}
+
+
+	void UT_condition_benchmark(const char* params)
+	{
+		DefaultAllocator allocator;
+		InputDecl decl;
+		initDecl(decl);
+		u8 data[64];
+		RunningContext rc = {};
+		rc.input = data;
+
+		Array<Condition> conditions(allocator);
+		conditions.reserve(CONDITION_COUNT);
+		for (int i = 0; i < CONDITION_COUNT; ++i)
+		{
+			Condition& condition = conditions.emplace(allocator);
+			condition.compile(EXPRESSIONS[i % lengthOf(EXPRESSIONS)].expression, decl);
+		}
+
+		Timer* timer = Timer::create(allocator);
+		int vm_count = 0;
+		for (int frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			setInputs(decl, {frame * 0.1f, (frame & 1) != 0, frame % 3}, data);
+			for (Condition& condition : conditions)
+			{
+				Condition::FastPath fast_path = condition.fast_path;
+				condition.fast_path = Condition::FastPath::NONE;
+				vm_count += condition(rc) ? 1 : 0;
+				condition.fast_path = fast_path;
+			}
+		}
+		float vm_time = timer->tick();
+
+		int fast_count = 0;
+		for (int frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			setInputs(decl, {frame * 0.1f, (frame & 1) != 0, frame % 3}, data);
+			for (Condition& condition : conditions)
+			{
+				fast_count += condition(rc) ? 1 : 0;
+			}
+		}
+		float fast_time = timer->tick();
+		Timer::destroy(timer);
+
+		LUMIX_EXPECT(vm_count == fast_count);
+		g_log_info.log("unit") << CONDITION_COUNT << " conditions, " << FRAME_COUNT << " frames: bytecode "
+							   << vm_time * 1000 << " ms, closed-form " << fast_time * 1000 << " ms";
+	}
+}
+
+REGISTER_TEST("unit_tests/graphics/condition", UT_condition, "");
+REGISTER_TEST("unit_tests/graphics/condition/optimize_malformed", UT_condition_optimize_malformed, "");
+REGISTER_TEST("unit_tests/graphics/condition/benchmark", UT_condition_benchmark, "");
@@ -0,0 +1,201 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "engine/array.h"
+#include "engine/quat.h"
+#include "engine/vec.h"
+#include "renderer/pose.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const int BONE_COUNT = 63;
+
+
+	void fillPose(Pose& pose, float seed)
+	{
+		for (int i = 0; i < pose.count; ++i)
+		{
+			pose.positions[i].set(i * seed, seed - i, (float)(i % 5));
+			Vec3 axis(1, seed, (float)(i % 3));
+			axis.normalize();
+			pose.rotations[i] = Quat(axis, i * 0.7f + seed);
+		}
+	}
+
+
+	// 10 levels of 1 to 21 bones, so both the 4-wide and the scalar paths are used
+	struct Skeleton
+	{
+		explicit Skeleton(IAllocator& allocator)
+			: parents(allocator)
+			, bones_by_depth(allocator)
+			, levels(allocator)
+		{
+			Array<int> depths(allocator);
+			for (int i = 0; i < BONE_COUNT; ++i)
+			{
+				int parent = i == 0 ? -1 : i * 2 / 3;
+				parents.push(parent);
+				depths.push(parent < 0 ? 0 : depths[parent] + 1);
+			}
+			for (int depth = 1;; ++depth)
+			{
+				int level_start = bones_by_depth.size();
+				for (int i = 0; i < BONE_COUNT; ++i)
+				{
+					if (depths[i] == depth) bones_by_depth.push(i);
+				}
+				if (level_start == bones_by_depth.size()) break;
+				levels.push(level_start);
+			}
+			levels.push(bones_by_depth.size());
+		}
+
+		int getLevelCount() const { return levels.size() - 1; }
+
+		Array<int> parents;
+		Array<int> bones_by_depth;
+		Array<int> levels;
+	};
+
+
+	void computeAbsoluteReference(Pose& pose, const Skeleton& skeleton)
+	{
+		// parents have lower indices than their children
+		for (int i = 1; i < pose.count; ++i)
+		{
+			int parent = skeleton.parents[i];
+			pose.positions[i] = pose.rotations[parent].rotate(pose.positions[i]) + pose.positions[parent];
+			pose.rotations[i] = pose.rotations[parent] * pose.rotations[i];
+		}
+	}
+
+
+	// inverse of computeAbsoluteReference, children first
+	void computeRelativeReference(Pose& pose, const Skeleton& skeleton)
+	{
+		for (int i = pose.count - 1; i > 0; --i)
+		{
+			int parent = skeleton.parents[i];
+			Quat inv_parent_rot = pose.rotations[parent].conjugated();
+			pose.positions[i] = inv_parent_rot.rotate(pose.positions[i] - pose.positions[parent]);
+			pose.rotations[i] = inv_parent_rot * pose.rotations[i];
+		}
+	}
+
+
+	void expectPosesClose(const Pose& pose, const Pose& reference, float tolerance)
+	{
+		for (int i = 0; i < BONE_COUNT; ++i)
+		{
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].x, reference.positions[i].x, tolerance);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].y, reference.positions[i].y, tolerance);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].z, reference.positions[i].z, tolerance);
+			LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].x, reference.rotations[i].x, 0.0001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].y, reference.rotations[i].y, 0.0001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].z, reference.rotations[i].z, 0.0001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].w, reference.rotations[i].w, 0.0001f);
+		}
+	}
+
+
+	// rotations may come back negated, which is the same rotation
+	void expectSameRotations(const Pose& pose, const Pose& reference)
+	{
+		for (int i = 0; i < BONE_COUNT; ++i)
+		{
+			const Quat& a = pose.rotations[i];
+			const Quat& b = reference.rotations[i];
+			float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+			LUMIX_EXPECT_CLOSE_EQ(dot * dot, 1.0f, 0.0001f);
+		}
+	}
+
+
+	void UT_pose_hierarchy(const char* params)
+	{
+		DefaultAllocator allocator;
+		Skeleton skeleton(allocator);
+		LUMIX_EXPECT(skeleton.getLevelCount() > 2);
+		const int* bones = &skeleton.bones_by_depth[0];
+		const int* levels = &skeleton.levels[0];
+		const int* parents = &skeleton.parents[0];
+
+		Pose pose(allocator);
+		Pose reference(allocator);
+		Pose relative(allocator);
+		pose.resize(BONE_COUNT);
+		reference.resize(BONE_COUNT);
+		relative.resize(BONE_COUNT);
+		fillPose(pose, 0.3f);
+		fillPose(reference, 0.3f);
+		fillPose(relative, 0.3f);
+
+		pose.computeAbsolute(bones, levels, skeleton.getLevelCount(), parents);
+		computeAbsoluteReference(reference, skeleton);
+		LUMIX_EXPECT(pose.is_absolute);
+		expectPosesClose(pose, reference, 0.001f);
+
+		pose.computeRelative(bones, levels, skeleton.getLevelCount(), parents);
+		computeRelativeReference(reference, skeleton);
+		LUMIX_EXPECT(!pose.is_absolute);
+		expectPosesClose(pose, reference, 0.001f);
+		for (int i = 0; i < BONE_COUNT; ++i)
+		{
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].x, relative.positions[i].x, 0.001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].y, relative.positions[i].y, 0.001f);
+			LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].z, relative.positions[i].z, 0.001f);
+		}
+		expectSameRotations(pose, relative);
+	}
+
+
+	void blendReference(Pose& lhs, const Pose& rhs, float weight)
+	{
+		float inv = 1.0f - weight;
+		for (int i = 0; i < lhs.count; ++i)
+		{
+			lhs.positions[i] = lhs.positions[i] * inv + rhs.positions[i] * weight;
+			nlerp(lhs.rotations[i], rhs.rotations[i], &lhs.rotations[i], weight);
+		}
+	}
+
+
+	void UT_pose_blend(const char* params)
+	{
+		DefaultAllocator allocator;
+		Pose pose(allocator);
+		Pose reference(allocator);
+		Pose rhs(allocator);
+		pose.resize(BONE_COUNT);
+		reference.resize(BONE_COUNT);
+		rhs.resize(BONE_COUNT);
+
+		float weights[] = {0.0001f, 0.25f, 0.5f, 0.9f, 1.0f, 2.0f};
+		for (float weight : weights)
+		{
+			fillPose(pose, 0.3f);
+			fillPose(reference, 0.3f);
+			fillPose(rhs, 2.1f);
+			pose.blend(rhs, weight);
+			if (weight > 0.001f) blendReference(reference, rhs, weight > 1 ? 1 : weight);
+
+			for (int i = 0; i < BONE_COUNT; ++i)
+			{
+				LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].x, reference.positions[i].x, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].y, reference.positions[i].y, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.positions[i].z, reference.positions[i].z, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].x, reference.rotations[i].x, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].y, reference.rotations[i].y, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].z, reference.rotations[i].z, 0.0001f);
+				LUMIX_EXPECT_CLOSE_EQ(pose.rotations[i].w, reference.rotations[i].w, 0.0001f);
+			}
+		}
+	}
+}
+
+REGISTER_TEST("unit_tests/graphics/pose/blend", UT_pose_blend, "");
+REGISTER_TEST("unit_tests/graphics/pose/hierarchy", UT_pose_hierarchy, "");
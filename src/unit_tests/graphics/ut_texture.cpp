@@ -2,7 +2,16 @@
 
 #include "engine/fs/disk_file_device.h"
 #include "engine/fs/file_system.h"
+#include "engine/fs/memory_file_device.h"
+#include "engine/fs/os_file.h"
+#include "engine/math_utils.h"
+#include "engine/mt/thread.h"
+#include "engine/resource_manager.h"
+#include "engine/string.h"
 #include "renderer/texture.h"
+#include "renderer/texture_manager.h"
+#include "unit_tests/suite/temp_dir.h"
+#include <bgfx/bgfx.h>
 
 
 using namespace Lumix;
@@ -63,4 +72,221 @@ namespace
 
 	REGISTER_TEST("unit_tests/graphics/texture/compareTGA", UT_texture_compareTGA, "");
 
+
+	void UT_texture_streaming(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+
+		u8 header[128];
+		setMemory(header, 0, sizeof(header));
+		copyMemory(header, "DDS ", 4);
+		u32 mip_count = 10;
+		copyMemory(header + 28, &mip_count, sizeof(mip_count));
+		LUMIX_EXPECT(Texture::getStreamableMipCount(header, sizeof(header)) == 10);
+		LUMIX_EXPECT(Texture::getStreamableMipCount(header, 64) == 0);
+		u32 caps2_cubemap = 0x200;
+		copyMemory(header + 112, &caps2_cubemap, sizeof(caps2_cubemap));
+		LUMIX_EXPECT(Texture::getStreamableMipCount(header, sizeof(header)) == 0);
+
+		LUMIX_EXPECT(Texture::computeStreamingMip(512, 512, 10, 512) == 0);
+		LUMIX_EXPECT(Texture::computeStreamingMip(512, 512, 10, 128) == 2);
+		LUMIX_EXPECT(Texture::computeStreamingMip(512, 256, 10, 0.5f) == 9);
+		LUMIX_EXPECT(Texture::computeStreamingMip(512, 512, 1, 16) == 0);
+
+		TextureManager manager(allocator);
+		Texture near_tex(Path("near.dds"), manager, allocator);
+		Texture far_tex(Path("far.dds"), manager, allocator);
+		Texture hidden_tex(Path("hidden.dds"), manager, allocator);
+		Texture* textures[] = { &near_tex, &far_tex, &hidden_tex };
+		for (Texture* tex : textures)
+		{
+			tex->width = tex->height = 512;
+			tex->mips = 10;
+			tex->resident_mip = 6;
+			tex->is_streamed = true;
+			manager.addStreamed(*tex);
+		}
+
+		Array<Texture*> requests(allocator);
+		manager.updateStreaming();
+		manager.requestMip(far_tex, 64);
+		manager.requestMip(near_tex, 128);
+		manager.requestMip(near_tex, 512);
+		manager.collectStreamingRequests(requests);
+		LUMIX_EXPECT(requests.size() == 2);
+		LUMIX_EXPECT(requests[0] == &near_tex);
+		LUMIX_EXPECT(requests[1] == &far_tex);
+		LUMIX_EXPECT(near_tex.requested_mip == 0);
+		LUMIX_EXPECT(far_tex.requested_mip == 3);
+
+		for (Texture* tex : textures) manager.removeStreamed(*tex);
+	}
+
+	REGISTER_TEST("unit_tests/graphics/texture/streaming", UT_texture_streaming, "");
+
+
+	const ResourceType TEXTURE_TYPE("texture");
+	const int DDS_SIZE = 256;
+	const int DDS_MIPS = 9;
+	const int TEXTURE_COUNT = 3;
+
+
+	void writeU32(u8* data, int offset, u32 value)
+	{
+		copyMemory(data + offset, &value, sizeof(value));
+	}
+
+
+	// DXT1 texture with a full mip chain
+	bool writeDDS(const char* path, IAllocator& allocator)
+	{
+		u8 header[128];
+		setMemory(header, 0, sizeof(header));
+		copyMemory(header, "DDS ", 4);
+		writeU32(header, 4, 124);
+		writeU32(header, 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+		writeU32(header, 12, DDS_SIZE);
+		writeU32(header, 16, DDS_SIZE);
+		writeU32(header, 20, (DDS_SIZE / 4) * (DDS_SIZE / 4) * 8);
+		writeU32(header, 28, DDS_MIPS);
+		writeU32(header, 76, 32);
+		writeU32(header, 80, 0x4);
+		copyMemory(header + 84, "DXT1", 4);
+		writeU32(header, 108, 0x1000 | 0x400000 | 0x8);
+
+		FS::OsFile file;
+		if (!file.open(path, FS::Mode::CREATE_AND_WRITE, allocator)) return false;
+		bool success = file.write(header, sizeof(header));
+		u8 block[8] = { 0xff, 0xff, 0, 0, 0, 0, 0, 0 };
+		for (int mip = 0; mip < DDS_MIPS; ++mip)
+		{
+			int blocks = Math::maximum((DDS_SIZE >> mip) / 4, 1);
+			for (int i = 0; i < blocks * blocks; ++i) success = success && file.write(block, sizeof(block));
+		}
+		file.close();
+		return success;
+	}
+
+
+	bool isAnyStreaming(Texture* const* textures, int count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			if (textures[i]->isStreaming()) return true;
+		}
+		return false;
+	}
+
+
+	void waitForStreaming(FS::FileSystem& fs, Texture* const* textures, int count)
+	{
+		for (int i = 0; i < 5000 && isAnyStreaming(textures, count); ++i)
+		{
+			fs.updateAsyncTransactions();
+			MT::sleep(1);
+		}
+	}
+
+
+	void UT_texture_streaming_eviction(const char* params)
+	{
+		DefaultAllocator allocator;
+		PathManager path_manager(allocator);
+
+		UnitTest::TempDir dir("texture_streaming");
+		LUMIX_EXPECT(dir.isValid());
+		const char* filenames[TEXTURE_COUNT] = { "seen.dds", "unseen0.dds", "unseen1.dds" };
+		for (const char* filename : filenames)
+		{
+			char path[MAX_PATH_LENGTH];
+			dir.getFilePath(filename, path, lengthOf(path));
+			LUMIX_EXPECT(writeDDS(path, allocator));
+		}
+
+		LUMIX_EXPECT(bgfx::init(bgfx::RendererType::Noop));
+
+		FS::FileSystem* fs = FS::FileSystem::create(allocator);
+		FS::MemoryFileDevice memory_device(allocator);
+		FS::DiskFileDevice disk_device("disk", dir.path, allocator);
+		fs->mount(&memory_device);
+		fs->mount(&disk_device);
+		fs->setDefaultDevice("memory:disk");
+		ResourceManager resource_manager(allocator);
+		resource_manager.create(*fs);
+		TextureManager manager(allocator);
+		manager.create(TEXTURE_TYPE, resource_manager);
+		manager.enableStreaming(true);
+		manager.setStreamingLowestMips(4);
+
+		Texture* textures[TEXTURE_COUNT];
+		for (int i = 0; i < TEXTURE_COUNT; ++i)
+		{
+			textures[i] = static_cast<Texture*>(manager.load(Path(filenames[i])));
+		}
+		for (int i = 0; i < 5000; ++i)
+		{
+			bool is_loading = false;
+			for (Texture* tex : textures) is_loading = is_loading || !(tex->isReady() || tex->isFailure());
+			if (!is_loading) break;
+			fs->updateAsyncTransactions();
+			MT::sleep(1);
+		}
+
+		const int lowest_mip = DDS_MIPS - manager.getStreamingLowestMips();
+		for (Texture* tex : textures)
+		{
+			LUMIX_EXPECT(tex->isReady());
+			LUMIX_EXPECT(tex->is_streamed);
+			LUMIX_EXPECT(tex->resident_mip == lowest_mip);
+		}
+
+		for (Texture* tex : textures) manager.requestMip(*tex, DDS_SIZE);
+		manager.updateStreaming();
+		waitForStreaming(*fs, textures, TEXTURE_COUNT);
+		u32 full_size = textures[0]->resident_size;
+		for (Texture* tex : textures)
+		{
+			LUMIX_EXPECT(tex->resident_mip == 0);
+			LUMIX_EXPECT(tex->resident_size == full_size);
+		}
+
+		// only the seen texture fits with its full mip chain, the rest must give their high mips back
+		manager.setStreamingBudget(full_size + full_size / 2);
+		for (int frame = 0; frame < 100; ++frame)
+		{
+			manager.requestMip(*textures[0], DDS_SIZE);
+			manager.updateStreaming();
+			waitForStreaming(*fs, textures, TEXTURE_COUNT);
+		}
+
+		LUMIX_EXPECT(textures[0]->resident_mip == 0);
+		LUMIX_EXPECT(bgfx::isValid(textures[0]->handle));
+		for (int i = 1; i < TEXTURE_COUNT; ++i)
+		{
+			LUMIX_EXPECT(textures[i]->resident_mip == lowest_mip);
+			LUMIX_EXPECT(textures[i]->resident_size < full_size);
+			LUMIX_EXPECT(bgfx::isValid(textures[i]->handle));
+		}
+		manager.updateStreaming();
+		LUMIX_EXPECT(manager.getStreamingStats().resident_size <= manager.getStreamingBudget());
+
+		for (Texture* tex : textures) manager.unload(*tex);
+		manager.destroy();
+		fs->unMount(&disk_device);
+		fs->unMount(&memory_device);
+		FS::FileSystem::destroy(fs);
+		bgfx::frame();
+		bgfx::shutdown();
+
+		for (const char* filename : filenames)
+		{
+			char path[MAX_PATH_LENGTH];
+			dir.getFilePath(filename, path, lengthOf(path));
+			FS::OsFile::deleteFile(path);
+		}
+	}
+
+	REGISTER_TEST("unit_tests/graphics/texture/streaming_eviction", UT_texture_streaming_eviction, "");
+
 }
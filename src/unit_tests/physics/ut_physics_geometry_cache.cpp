@@ -0,0 +1,78 @@
+#include "unit_tests/suite/lumix_unit_tests.h"
+
+#include "engine/blob.h"
+#include "engine/string.h"
+#include "engine/vec.h"
+#include "physics/physics_geometry_cache.h"
+
+
+using namespace Lumix;
+
+
+namespace
+{
+	const u32 PHYSX_VERSION = 0x03030400;
+
+
+	PhysicsGeometryCacheHeader makeKey(const Vec3* verts, int vertex_count, const u32* indices, int index_count)
+	{
+		return makePhysicsGeometryCacheHeader(
+			verts, vertex_count, sizeof(verts[0]), indices, index_count, false, PHYSX_VERSION);
+	}
+
+
+	void UT_physics_geometry_cache_round_trip(const char* params)
+	{
+		DefaultAllocator allocator;
+		Vec3 verts[] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+		u32 indices[] = {0, 1, 2, 0, 2, 3};
+		u8 cooked[] = {1, 2, 3, 4, 5, 6, 7};
+
+		PhysicsGeometryCacheHeader key = makeKey(verts, lengthOf(verts), indices, lengthOf(indices));
+		PhysicsGeometryCacheHeader header = key;
+		header.data_size = sizeof(cooked);
+		OutputBlob blob(allocator);
+		blob.write(header);
+		blob.write(cooked, sizeof(cooked));
+
+		InputBlob input(blob);
+		PhysicsGeometryCacheHeader read_header;
+		input.read(read_header);
+		LUMIX_EXPECT(isPhysicsGeometryCacheValid(read_header, key, blob.getPos()));
+		u8 read_cooked[sizeof(cooked)];
+		input.read(read_cooked, read_header.data_size);
+		for (int i = 0; i < lengthOf(cooked); ++i) LUMIX_EXPECT(read_cooked[i] == cooked[i]);
+
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, key, blob.getPos() - 1));
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, key, blob.getPos() + 1));
+
+		PhysicsGeometryCacheHeader other = makeKey(verts, lengthOf(verts) - 1, indices, lengthOf(indices));
+		LUMIX_EXPECT(other.hash != key.hash);
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, other, blob.getPos()));
+		other.hash = key.hash;
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, other, blob.getPos()));
+
+		other = makeKey(verts, lengthOf(verts), indices, lengthOf(indices) - 3);
+		other.hash = key.hash;
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, other, blob.getPos()));
+
+		indices[5] = 1;
+		other = makeKey(verts, lengthOf(verts), indices, lengthOf(indices));
+		LUMIX_EXPECT(other.hash != key.hash);
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, other, blob.getPos()));
+
+		other = makePhysicsGeometryCacheHeader(
+			verts, lengthOf(verts), sizeof(verts[0]), indices, lengthOf(indices), false, PHYSX_VERSION + 1);
+		LUMIX_EXPECT(other.hash != key.hash);
+		other.hash = key.hash;
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, other, blob.getPos()));
+
+		// cache files written in the format without version are rejected
+		u32 old_header[] = {PhysicsGeometryCacheHeader::MAGIC, PHYSX_VERSION, (u32)key.hash, 0};
+		copyMemory(&read_header, old_header, sizeof(old_header));
+		LUMIX_EXPECT(!isPhysicsGeometryCacheValid(read_header, key, blob.getPos()));
+	}
+}
+
+
+REGISTER_TEST("unit_tests/physics/geometry_cache/round_trip", UT_physics_geometry_cache_round_trip, "");
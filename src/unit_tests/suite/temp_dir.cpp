@@ -0,0 +1,53 @@
+#include "unit_tests/suite/temp_dir.h"
+
+#include "engine/fs/os_file.h"
+#include "engine/string.h"
+#ifdef _WIN32
+	#include <direct.h>
+#else
+	#include <unistd.h>
+#endif
+#include <cstdlib>
+
+
+namespace Lumix
+{
+	namespace UnitTest
+	{
+		TempDir::TempDir(const char* name)
+		{
+			#ifdef _WIN32
+				const char* base = getenv("TEMP");
+			#else
+				const char* base = getenv("TMPDIR");
+				if (!base) base = "/tmp";
+			#endif
+			path[0] = '\0';
+			if (!base) return;
+
+			copyString(path, base);
+			catString(path, "/lumix_");
+			catString(path, name);
+			if (!FS::OsFile::makeDirectory(path)) path[0] = '\0';
+		}
+
+
+		TempDir::~TempDir()
+		{
+			if (!isValid()) return;
+			#ifdef _WIN32
+				_rmdir(path);
+			#else
+				rmdir(path);
+			#endif
+		}
+
+
+		void TempDir::getFilePath(const char* filename, char* out, int max_size) const
+		{
+			copyString(out, max_size, path);
+			catString(out, max_size, "/");
+			catString(out, max_size, filename);
+		}
+	} // namespace UnitTest
+} // namespace Lumix
@@ -0,0 +1,23 @@
+#pragma once
+
+
+#include "engine/lumix.h"
+
+
+namespace Lumix
+{
+	namespace UnitTest
+	{
+		// directory in the system temporary directory, removed when empty on destruction
+		struct TempDir
+		{
+			explicit TempDir(const char* name);
+			~TempDir();
+
+			bool isValid() const { return path[0] != '\0'; }
+			void getFilePath(const char* filename, char* out, int max_size) const;
+
+			char path[MAX_PATH_LENGTH];
+		};
+	} // namespace UnitTest
+} // namespace Lumix